@@ -130,18 +130,10 @@ void CheMPS2::CASSCF::copy2DMover(TwoDM * theDMRG2DM, const int totOrbDMRG, doub
 
 void CheMPS2::CASSCF::copy3DMover(ThreeDM * theDMRG3DM, const int numL, double * three_dm){
 
-   for ( int i = 0; i < numL; i++ ){
-      for ( int j = 0; j < numL; j++ ){
-         for ( int k = 0; k < numL; k++ ){
-            for ( int l = 0; l < numL; l++ ){
-               for ( int m = 0; m < numL; m++ ){
-                  for ( int n = 0; n < numL; n++ ){
-                     three_dm[ i + numL * ( j + numL * ( k + numL * ( l + numL * ( m + numL * n ) ) ) ) ] = theDMRG3DM->get_ham_index(i, j, k, l, m, n);
-                  }
-               }
-            }
-         }
-      }
+   // Fill the dense 3-RDM with the blocked read-out of ThreeDM, one value of the sixth orbital index at a time
+   const long long block = ( long long ) numL * numL * numL * numL * numL;
+   for ( int orb = 0; orb < numL; orb++ ){
+      theDMRG3DM->fill_ham_block( three_dm + block * orb, orb, 1 );
    }
 
 }
@@ -107,6 +107,7 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
    }
 
    int nIterations = 0;
+   CheMPS2::FCI * theFCI = NULL; // The string and lookup tables of the FCI solver are reused in all macro-iterations
 
    /*******************************
    ***   Actual DMRGSCF loops   ***
@@ -164,17 +165,20 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
 
       if (( OptScheme == NULL ) && ( rootNum == 1 )){ // Do FCI, and calculate the 2DM
 
-         const int nalpha = ( num_elec + TwoS ) / 2;
-         const int nbeta  = ( num_elec - TwoS ) / 2;
-         const double workmem = 1000.0; // 1GB
-         const int verbose = 2;
-         CheMPS2::FCI * theFCI = new CheMPS2::FCI( HamDMRG, nalpha, nbeta, Irrep, workmem, verbose );
+         if ( theFCI == NULL ){
+            const int nalpha = ( num_elec + TwoS ) / 2;
+            const int nbeta  = ( num_elec - TwoS ) / 2;
+            const double workmem = 1000.0; // 1GB
+            const int verbose = 2;
+            theFCI = new CheMPS2::FCI( HamDMRG, nalpha, nbeta, Irrep, workmem, verbose );
+         } else {
+            theFCI->setHamiltonian( HamDMRG );
+         }
          double * inoutput = new double[ theFCI->getVecLength(0) ];
          theFCI->ClearVector( theFCI->getVecLength(0), inoutput );
          inoutput[ theFCI->LowestEnergyDeterminant() ] = 1.0;
          Energy = theFCI->GSDavidson( inoutput );
          theFCI->Fill2RDM( inoutput, DMRG2DM );
-         delete theFCI;
          delete [] inoutput;
 
       } else { //Do the DMRG sweeps, and calculate the 2DM
@@ -182,17 +186,20 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
          assert( OptScheme != NULL );
          for ( int cnt = 0; cnt < dmrgsize_power4; cnt++ ){ DMRG2DM[ cnt ] = 0.0; } //Clear the 2-RDM (to allow for state-averaged calculations)
          DMRG * theDMRG = new DMRG(Prob, OptScheme);
+         theDMRG->activateFusedRDMs( false ); // The 2-RDM is accumulated during the last right sweep of each Solve()
+         RDMrequest request( nOrbDMRG ); // The Correlations are only needed when they are printed
+         request.set_correlations( scf_options->getDumpCorrelations() );
          for (int state = 0; state < rootNum; state++){
             if (state > 0){ theDMRG->newExcitation( fabs( Energy ) ); }
             Energy = theDMRG->Solve();
             if ( scf_options->getStateAveraging() ){ // When SA-DMRGSCF: 2DM += current 2DM
-               theDMRG->calc2DMandCorrelations();
+               theDMRG->calc_rdms_and_correlations( &request );
                copy2DMover( theDMRG->get2DM(), nOrbDMRG, DMRG2DM );
             }
             if ((state == 0) && (rootNum > 1)){ theDMRG->activateExcitations( rootNum-1 ); }
          }
          if ( !( scf_options->getStateAveraging() )){ // When SS-DMRGSCF: 2DM += last 2DM
-            theDMRG->calc2DMandCorrelations();
+            theDMRG->calc_rdms_and_correlations( &request );
             copy2DMover( theDMRG->get2DM(), nOrbDMRG, DMRG2DM );
          }
          if (scf_options->getDumpCorrelations()){ theDMRG->getCorrelations()->Print(); } // Correlations have been calculated in the loop (SA) or outside of the loop (SS)
@@ -233,6 +240,7 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
    delete [] mem2;
    delete_file( tmp_filename );
 
+   if ( theFCI != NULL ){ delete theFCI; }
    delete Prob;
    delete HamDMRG;
    delete [] gradient;
@@ -85,8 +85,10 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
    fillConstAndTmatDMRG( HamAS );
    DMRGSCFrotations::rotate( VMAT_ORIG, HamAS->getVmat(), NULL, 'A', 'A', 'A', 'A', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
    double E_CASSCF = 0.0;
-   double * three_dm = new double[ tot_dmrg_power6 ];
-   double * contract = new double[ tot_dmrg_power6 ];
+   /* CASPT2 consumes the 3-RDM and the Fock-contracted 4-RDM as dense arrays of tot_dmrg_power6 doubles, so that its peak memory grows with L^6.
+      With THREE_RDM_storeOnDisk both are backed by files in the tmp folder, so that the kernel can page them out, like the DMRG 3-RDM. */
+   double * three_dm = (( CheMPS2::THREE_RDM_storeOnDisk ) ? ThreeDM::allocate_mapped_array( tot_dmrg_power6, CheMPS2::defaultTMPpath ) : new double[ tot_dmrg_power6 ] );
+   double * contract = (( CheMPS2::THREE_RDM_storeOnDisk ) ? ThreeDM::allocate_mapped_array( tot_dmrg_power6, CheMPS2::defaultTMPpath ) : new double[ tot_dmrg_power6 ] );
 
    // Solve the active space problem
    if (( OptScheme == NULL ) && ( rootNum == 1 )){ // Do FCI
@@ -120,34 +122,18 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
          E_CASSCF = theDMRG->Solve();
          if ((state == 0) && (rootNum > 1)){ theDMRG->activateExcitations( rootNum-1 ); }
       }
-      theDMRG->calc_rdms_and_correlations( true );
+      CheMPS2::RDMrequest request( nOrbDMRG ); // CASPT2 requires the 2-RDM and the 3-RDM, not the Correlations
+      request.set_3rdm( true );
+      request.set_3rdm_distributed( true ); // With MPI, Symm4RDM_fock and copy3DMover work on the slabs of the 3-RDM
+      request.set_correlations( false );
+      theDMRG->calc_rdms_and_correlations( &request );
       copy2DMover( theDMRG->get2DM(), nOrbDMRG, DMRG2DM  ); // 2-RDM
       setDMRG1DM( num_elec, nOrbDMRG, DMRG1DM, DMRG2DM ); // 1-RDM
       buildQmatACT();
       construct_fock( theFmatrix, theTmatrix, theQmatOCC, theQmatACT, iHandler );
       copy_active( theFmatrix, mem2, iHandler ); // Fock
-      for ( int cnt = 0; cnt < tot_dmrg_power6; cnt++ ){ contract[ cnt ] = 0.0; }
-      for ( int ham_orbz = 0; ham_orbz < nOrbDMRG; ham_orbz++ ){
-         theDMRG->Symm4RDM( three_dm, ham_orbz, ham_orbz, false );
-         int size = tot_dmrg_power6;
-         double f_zz = 0.5 * mem2[ ham_orbz + nOrbDMRG * ham_orbz ];
-         int inc1 = 1;
-         daxpy_( &size, &f_zz, three_dm, &inc1, contract, &inc1 ); // trace( Fock * 4-RDM )
-      }
-      if ( PSEUDOCANONICAL == false ){
-         for ( int ham_orb1 = 0; ham_orb1 < nOrbDMRG; ham_orb1++ ){
-            for ( int ham_orb2 = ham_orb1 + 1; ham_orb2 < nOrbDMRG; ham_orb2++ ){
-               if ( HamAS->getOrbitalIrrep( ham_orb1 ) == HamAS->getOrbitalIrrep( ham_orb2 ) ){
-                  theDMRG->Symm4RDM( three_dm, ham_orb1, ham_orb2, false );
-                  int size = tot_dmrg_power6;
-                  double f_12 = 0.5 * ( mem2[ ham_orb1 + nOrbDMRG * ham_orb2 ] + mem2[ ham_orb2 + nOrbDMRG * ham_orb1 ] );
-                  int inc1 = 1;
-                  daxpy_( &size, &f_12, three_dm, &inc1, contract, &inc1 ); // trace( Fock * 4-RDM )
-               }
-            }
-         }
-         // CheMPS2::Cumulant::gamma4_fock_contract_ham( Prob, theDMRG->get3DM(), theDMRG->get2DM(), mem2, contract );
-      }
+      theDMRG->Symm4RDM_fock( contract, mem2, PSEUDOCANONICAL, false ); // trace( Fock * 4-RDM )
+      // CheMPS2::Cumulant::gamma4_fock_contract_ham( Prob, theDMRG->get3DM(), theDMRG->get2DM(), mem2, contract );
       copy3DMover( theDMRG->get3DM(), nOrbDMRG, three_dm ); // 3-RDM
       if (CheMPS2::DMRG_storeMpsOnDisk){        theDMRG->deleteStoredMPS();       }
       if (CheMPS2::DMRG_storeRenormOptrOnDisk){ theDMRG->deleteStoredOperators(); }
@@ -183,8 +169,13 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
    const double E_CASPT2 = myCASPT2->solve( IMAG );
 
    delete myCASPT2;
-   delete [] three_dm;
-   delete [] contract;
+   if ( CheMPS2::THREE_RDM_storeOnDisk ){
+      ThreeDM::free_mapped_array( three_dm, tot_dmrg_power6 );
+      ThreeDM::free_mapped_array( contract, tot_dmrg_power6 );
+   } else {
+      delete [] three_dm;
+      delete [] contract;
+   }
 
    return E_CASPT2;
 
@@ -0,0 +1,284 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2016 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+
+#include "COCG.h"
+
+using std::cout;
+using std::endl;
+
+CheMPS2::COCG::COCG( const int veclength_in, const double RTOL_in, const double DIAG_CUTOFF_in, const int MAX_MATVEC_in, const double BREAKDOWN_in, const bool print_in ){
+
+   veclength = veclength_in;
+   RTOL = RTOL_in;
+   DIAG_CUTOFF = DIAG_CUTOFF_in;
+   MAX_MATVEC = MAX_MATVEC_in;
+   BREAKDOWN = BREAKDOWN_in;
+   print = print_in;
+
+   state = 'I';
+   num_matvec = 0;
+
+   for ( int part = 0; part < 2; part++ ){
+      XVEC[ part ]   = new double[ veclength ];
+      PRECON[ part ] = new double[ veclength ];
+      RHS[ part ]    = new double[ veclength ];
+      RESID[ part ]  = new double[ veclength ];
+      ZVEC[ part ]   = new double[ veclength ];
+      PVEC[ part ]   = new double[ veclength ];
+      OPVEC[ part ]  = new double[ veclength ];
+   }
+
+}
+
+CheMPS2::COCG::~COCG(){
+
+   for ( int part = 0; part < 2; part++ ){
+      delete [] XVEC[ part ];
+      delete [] PRECON[ part ];
+      delete [] RHS[ part ];
+      delete [] RESID[ part ];
+      delete [] ZVEC[ part ];
+      delete [] PVEC[ part ];
+      delete [] OPVEC[ part ];
+   }
+
+}
+
+int CheMPS2::COCG::get_num_matvec() const{ return num_matvec; }
+
+char CheMPS2::COCG::step( double ** pointers ){
+
+   /*
+      Possible states:
+       - I : just created the class
+       - G : the guess has been set in XVEC, the diagonal in PRECON, and the right-hand side in RHS
+       - H : PRECON = 1 / diag( operator ) has been set
+       - J : at start-up OPVEC contains operator * XVEC
+       - K : RESID, ZVEC = PRECON * RESID, PVEC have just been set, as well as rnorm and rdotz = RESID^T * ZVEC
+       - L : OPVEC contains operator * PVEC
+       - Y : OPVEC contains operator * XVEC of the converged solution
+       - Z : the converged signal has been given to the user, nothing remains to be done
+       - X : the algorithm broke down or reached MAX_MATVEC, nothing remains to be done
+
+      Possible instructions:
+       - A : copy the guess to pointers[0,1], the diagonal of the operator to pointers[2,3], and the right-hand side of the problem to pointers[4,5]
+       - B : perform ( pointers[2] + I * pointers[3] ) = operator * ( pointers[0] + I * pointers[1] )
+       - C : pointers[0,1] contain the solution; pointers[2][0] the residual norm
+       - D : the algorithm broke down; pointers[0,1] contain the current approximation to the solution
+   */
+
+   if ( state == 'I' ){
+      pointers[0] = XVEC[0];
+      pointers[1] = XVEC[1];
+      pointers[2] = PRECON[0];
+      pointers[3] = PRECON[1];
+      pointers[4] = RHS[0];
+      pointers[5] = RHS[1];
+      state = 'G';
+      return 'A';
+   }
+
+   if ( state == 'G' ){
+      stepG2H();
+      state = 'H';
+   }
+
+   if ( state == 'H' ){
+      pointers[0] = XVEC[0];
+      pointers[1] = XVEC[1];
+      pointers[2] = OPVEC[0];
+      pointers[3] = OPVEC[1];
+      state = 'J';
+      num_matvec++;
+      return 'B';
+   }
+
+   if ( state == 'J' ){
+      stepJ2K();
+      state = 'K';
+   }
+
+   if ( state == 'L' ){
+      const bool success = stepL2K();
+      state = ( success ) ? 'K' : 'X';
+   }
+
+   if (( state == 'K' ) && ( rnorm >= RTOL ) && ( num_matvec >= MAX_MATVEC )){
+      state = 'X';
+   }
+
+   if ( state == 'K' ){
+      pointers[0] = ( rnorm >= RTOL ) ? PVEC[0] : XVEC[0];
+      pointers[1] = ( rnorm >= RTOL ) ? PVEC[1] : XVEC[1];
+      pointers[2] = OPVEC[0];
+      pointers[3] = OPVEC[1];
+      state = ( rnorm >= RTOL ) ? 'L' : 'Y';
+      num_matvec++;
+      return 'B';
+   }
+
+   if ( state == 'Y' ){
+      stepY2Z();
+      pointers[0] = XVEC[0];
+      pointers[1] = XVEC[1];
+      pointers[2] = ZVEC[0];
+      pointers[2][0] = rnorm;
+      state = 'Z';
+      return 'C';
+   }
+
+   if ( state == 'X' ){
+      if ( print ){ cout << "COCG : Breakdown after " << num_matvec << " matrix-vector products, the residual of O * x = RHS is " << rnorm << endl; }
+      pointers[0] = XVEC[0];
+      pointers[1] = XVEC[1];
+   }
+
+   return 'D';
+
+}
+
+void CheMPS2::COCG::stepG2H(){
+
+   // PRECON = 1 / diag( operator ), with | diag( operator ) | >= DIAG_CUTOFF
+   for ( int elem = 0; elem < veclength; elem++ ){
+      double re = PRECON[0][ elem ];
+      double im = PRECON[1][ elem ];
+      double modulus = sqrt( re * re + im * im );
+      if ( modulus < DIAG_CUTOFF ){
+         if ( modulus == 0.0 ){ re = DIAG_CUTOFF; im = 0.0; }
+         else { re = re * DIAG_CUTOFF / modulus; im = im * DIAG_CUTOFF / modulus; }
+         modulus = DIAG_CUTOFF;
+      }
+      PRECON[0][ elem ] =   re / ( modulus * modulus );
+      PRECON[1][ elem ] = - im / ( modulus * modulus );
+   }
+
+}
+
+void CheMPS2::COCG::stepJ2K(){
+
+   for ( int part = 0; part < 2; part++ ){
+      for ( int elem = 0; elem < veclength; elem++ ){
+         RESID[ part ][ elem ] = RHS[ part ][ elem ] - OPVEC[ part ][ elem ]; // RESID = RHS - operator * XVEC
+      }
+   }
+   apply_precon( RESID, ZVEC );                                               // ZVEC  = PRECON * RESID
+   for ( int part = 0; part < 2; part++ ){
+      for ( int elem = 0; elem < veclength; elem++ ){
+         PVEC[ part ][ elem ] = ZVEC[ part ][ elem ];                         // PVEC  = ZVEC
+      }
+   }
+   bilinear( RESID, ZVEC, rdotz );
+   rnorm = norm( RESID );
+   rdotz_scale = rnorm * norm( ZVEC );
+
+}
+
+bool CheMPS2::COCG::stepL2K(){
+
+   double pdotop[2];
+   bilinear( PVEC, OPVEC, pdotop );                              // pdotop = PVEC_old^T * operator * PVEC_old
+   const double denom = pdotop[0] * pdotop[0] + pdotop[1] * pdotop[1];
+   if ( sqrt( denom ) <= BREAKDOWN * norm( PVEC ) * norm( OPVEC ) ){ return false; }
+   const double old_norm = rdotz[0] * rdotz[0] + rdotz[1] * rdotz[1];
+   if ( sqrt( old_norm ) <= BREAKDOWN * rdotz_scale ){ return false; }
+   const double alpha_re = ( rdotz[0] * pdotop[0] + rdotz[1] * pdotop[1] ) / denom; // alpha = rdotz_old / pdotop
+   const double alpha_im = ( rdotz[1] * pdotop[0] - rdotz[0] * pdotop[1] ) / denom;
+   for ( int elem = 0; elem < veclength; elem++ ){
+      XVEC[0][ elem ]  += alpha_re * PVEC[0][ elem ]  - alpha_im * PVEC[1][ elem ];  // XVEC_new  = XVEC_old  + alpha * PVEC_old
+      XVEC[1][ elem ]  += alpha_re * PVEC[1][ elem ]  + alpha_im * PVEC[0][ elem ];
+      RESID[0][ elem ] -= alpha_re * OPVEC[0][ elem ] - alpha_im * OPVEC[1][ elem ]; // RESID_new = RESID_old - alpha * operator * PVEC_old
+      RESID[1][ elem ] -= alpha_re * OPVEC[1][ elem ] + alpha_im * OPVEC[0][ elem ];
+   }
+   apply_precon( RESID, ZVEC );                                  // ZVEC_new = PRECON * RESID_new
+   double new_rdotz[2];
+   bilinear( RESID, ZVEC, new_rdotz );
+   const double beta_re = ( new_rdotz[0] * rdotz[0] + new_rdotz[1] * rdotz[1] ) / old_norm; // beta = rdotz_new / rdotz_old
+   const double beta_im = ( new_rdotz[1] * rdotz[0] - new_rdotz[0] * rdotz[1] ) / old_norm;
+   for ( int elem = 0; elem < veclength; elem++ ){
+      const double p_re = PVEC[0][ elem ];
+      const double p_im = PVEC[1][ elem ];
+      PVEC[0][ elem ] = ZVEC[0][ elem ] + beta_re * p_re - beta_im * p_im; // PVEC_new = ZVEC_new + beta * PVEC_old
+      PVEC[1][ elem ] = ZVEC[1][ elem ] + beta_re * p_im + beta_im * p_re;
+   }
+   rdotz[0] = new_rdotz[0];
+   rdotz[1] = new_rdotz[1];
+   rnorm = norm( RESID );
+   rdotz_scale = rnorm * norm( ZVEC );
+   if ( print ){ cout << "COCG : After " << num_matvec << " matrix-vector products, the residual of O * x = RHS is " << rnorm << endl; }
+   return true;
+
+}
+
+void CheMPS2::COCG::stepY2Z(){
+
+   rnorm = 0.0;
+   for ( int part = 0; part < 2; part++ ){
+      for ( int elem = 0; elem < veclength; elem++ ){
+         const double diff = OPVEC[ part ][ elem ] - RHS[ part ][ elem ];
+         rnorm += diff * diff;
+      }
+   }
+   rnorm = sqrt( rnorm );
+   if ( print ){ cout << "COCG : At convergence the residual of O * x = RHS is " << rnorm << endl; }
+
+}
+
+void CheMPS2::COCG::bilinear( double ** vector, double ** othervector, double * result ) const{
+
+   // result = vector^T * othervector, without complex conjugation
+   double re = 0.0;
+   double im = 0.0;
+   for ( int elem = 0; elem < veclength; elem++ ){
+      re += vector[0][ elem ] * othervector[0][ elem ] - vector[1][ elem ] * othervector[1][ elem ];
+      im += vector[0][ elem ] * othervector[1][ elem ] + vector[1][ elem ] * othervector[0][ elem ];
+   }
+   result[0] = re;
+   result[1] = im;
+
+}
+
+double CheMPS2::COCG::norm( double ** vector ) const{
+
+   double value = 0.0;
+   for ( int part = 0; part < 2; part++ ){
+      for ( int elem = 0; elem < veclength; elem++ ){
+         value += vector[ part ][ elem ] * vector[ part ][ elem ];
+      }
+   }
+   return sqrt( value );
+
+}
+
+void CheMPS2::COCG::apply_precon( double ** vector, double ** result ) const{
+
+   for ( int elem = 0; elem < veclength; elem++ ){
+      const double re = vector[0][ elem ];
+      const double im = vector[1][ elem ];
+      result[0][ elem ] = PRECON[0][ elem ] * re - PRECON[1][ elem ] * im;
+      result[1][ elem ] = PRECON[0][ elem ] * im + PRECON[1][ elem ] * re;
+   }
+
+}
+
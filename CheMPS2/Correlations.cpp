@@ -18,6 +18,7 @@
 */
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -37,16 +38,54 @@ CheMPS2::Correlations::Correlations(const SyBookkeeper * denBKIn, const Problem
 
    denBK = denBKIn;
    Prob = ProbIn;
-   the2DM = the2DMin;
    
    L = denBK->gL();
    
+   pairs = new double[5*L*L];
+   for (int row=0; row<L; row++){
+      for (int col=0; col<L; col++){
+         pairs[row + L*(col + L*0)] = the2DMin->getTwoDMA_DMRG(row,col,row,col);
+         pairs[row + L*(col + L*1)] = the2DMin->getTwoDMB_DMRG(row,col,row,col);
+         pairs[row + L*(col + L*2)] = the2DMin->getTwoDMA_DMRG(row,col,col,row);
+         pairs[row + L*(col + L*3)] = the2DMin->getTwoDMB_DMRG(row,col,col,row);
+         pairs[row + L*(col + L*4)] = the2DMin->getTwoDMA_DMRG(row,row,col,col);
+      }
+   }
+   
+   Initialize();
+
+}
+
+CheMPS2::Correlations::Correlations(const SyBookkeeper * denBKIn, const Problem * ProbIn, const double * pairsIn){
+
+   denBK = denBKIn;
+   Prob = ProbIn;
+   
+   L = denBK->gL();
+   
+   pairs = new double[5*L*L];
+   for (int cnt=0; cnt<5*L*L; cnt++){ pairs[cnt] = pairsIn[cnt]; }
+   
+   Initialize();
+
+}
+
+void CheMPS2::Correlations::Initialize(){
+
+   OneRDM    = new double[L];
    Cspin     = new double[L*L];
    Cdens     = new double[L*L];
    Cspinflip = new double[L*L];
    Cdirad    = new double[L*L];
    MutInfo   = new double[L*L];
    
+   //Same as TwoDM::get1RDM_DMRG(index, index)
+   for (int index=0; index<L; index++){
+      double value = 0.0;
+      for (int orbsum=0; orbsum<L; orbsum++){ value += pairs[index + L*orbsum]; }
+      OneRDM[index] = value / ( Prob->gN() - 1.0 );
+   }
+   
    for (int cnt=0; cnt<L*L; cnt++){ Cspin[cnt]     = 0.0; }
    for (int cnt=0; cnt<L*L; cnt++){ Cdens[cnt]     = 0.0; }
    for (int cnt=0; cnt<L*L; cnt++){ Cspinflip[cnt] = 0.0; }
@@ -59,6 +98,8 @@ CheMPS2::Correlations::Correlations(const SyBookkeeper * denBKIn, const Problem
 
 CheMPS2::Correlations::~Correlations(){
 
+   delete [] pairs;
+   delete [] OneRDM;
    delete [] Cspin;
    delete [] Cdens;
    delete [] Cspinflip;
@@ -72,32 +113,32 @@ void CheMPS2::Correlations::FillSpinDensSpinflip(){
    //Spin
    for (int row=0; row<L; row++){
       for (int col=0; col<L; col++){
-         Cspin[row + L*col] = the2DM->getTwoDMB_DMRG(row,col,row,col);
+         Cspin[row + L*col] = pairs[row + L*(col + L*1)];
       }
-      Cspin[row + L*row] += the2DM->get1RDM_DMRG(row, row);
+      Cspin[row + L*row] += OneRDM[row];
    }
    
    //Density
    for (int row=0; row<L; row++){
       for (int col=0; col<L; col++){
-         Cdens[row + L*col] = the2DM->getTwoDMA_DMRG(row,col,row,col) - the2DM->get1RDM_DMRG(row, row) * the2DM->get1RDM_DMRG(col, col);
+         Cdens[row + L*col] = pairs[row + L*(col + L*0)] - OneRDM[row] * OneRDM[col];
       }
-      Cdens[row + L*row] += the2DM->get1RDM_DMRG(row, row);
+      Cdens[row + L*row] += OneRDM[row];
    }
    
    //Spin-flip
    for (int row=0; row<L; row++){
       for (int col=0; col<L; col++){
-         Cspinflip[row + L*col] = 0.5 * ( the2DM->getTwoDMB_DMRG(row,col,col,row) - the2DM->getTwoDMA_DMRG(row,col,col,row) );
+         Cspinflip[row + L*col] = 0.5 * ( pairs[row + L*(col + L*3)] - pairs[row + L*(col + L*2)] );
       }
-      Cspinflip[row + L*row] += the2DM->get1RDM_DMRG(row, row);
+      Cspinflip[row + L*row] += OneRDM[row];
    }
    
    //Singlet diradical: partial fill
    for (int row=0; row<L; row++){
       for (int col=0; col<L; col++){
-         Cdirad[row + L*col] = - 0.5 * ( the2DM->get1RDM_DMRG(row, row) - the2DM->getTwoDMA_DMRG(row,row,row,row) )
-                                     * ( the2DM->get1RDM_DMRG(col, col) - the2DM->getTwoDMA_DMRG(col,col,col,col) );
+         Cdirad[row + L*col] = - 0.5 * ( OneRDM[row] - pairs[row + L*row] )
+                                     * ( OneRDM[col] - pairs[col + L*col] );
       }
    }
 
@@ -163,11 +204,31 @@ double CheMPS2::Correlations::getMutualInformation_HAM(const int row, const int
 
 }
 
+void CheMPS2::Correlations::SingleOrbitalRDM_DMRG(const int index, double * rdm) const{
+
+   rdm[3] = 0.5 * pairs[index + L*index];
+   rdm[1] = rdm[2] = 0.5 * ( OneRDM[index] - pairs[index + L*index] );
+   rdm[0] = 1.0 - rdm[3] - rdm[1] - rdm[2];
+
+}
+
+void CheMPS2::Correlations::SingleOrbitalRDM_HAM(const int index, double * rdm) const{
+
+   if ( Prob->gReorder() ){
+      SingleOrbitalRDM_DMRG( Prob->gf1(index), rdm );
+   } else {
+      SingleOrbitalRDM_DMRG( index, rdm );
+   }
+
+}
+
 double CheMPS2::Correlations::SingleOrbitalEntropy_DMRG(const int index) const{
 
-   const double val4  = 0.5 * the2DM->getTwoDMA_DMRG(index,index,index,index);
-   const double val23 = 0.5 * ( the2DM->get1RDM_DMRG(index, index) - the2DM->getTwoDMA_DMRG(index,index,index,index) );
-   const double val1  = 1.0 - val4 - 2*val23;
+   double rdm[4];
+   SingleOrbitalRDM_DMRG(index, rdm);
+   const double val4  = rdm[3];
+   const double val23 = rdm[1];
+   const double val1  = rdm[0];
    
    if (val1  < 0.0){ cerr << "   Correlations::SingleOrbitalEntropy : Warning : val1  for orbital " << index << " = " << val1  << endl; }
    if (val23 < 0.0){ cerr << "   Correlations::SingleOrbitalEntropy : Warning : val23 for orbital " << index << " = " << val23 << endl; }
@@ -204,6 +265,26 @@ double CheMPS2::Correlations::MutualInformationDistance(const double power) cons
 
 }
 
+void CheMPS2::Correlations::writeEntropiesFile(const string filename) const{
+
+   FILE * capturing;
+   capturing = fopen( filename.c_str(), "w" ); // "w" with fopen means truncate file
+   fprintf( capturing, " &ENTROPIES NORB= %d,NELEC= %d,MS2= %d,\n /\n", L, Prob->gN(), Prob->gTwoS() );
+   
+   // Single-orbital entropies on the diagonal, two-orbital mutual information off the diagonal (HAM indices)
+   for (int ham_i=0; ham_i<L; ham_i++){
+      fprintf( capturing, " % 23.16E %3d %3d\n", SingleOrbitalEntropy_HAM( ham_i ), ham_i+1, ham_i+1 );
+   }
+   for (int ham_i=0; ham_i<L; ham_i++){
+      for (int ham_j=ham_i+1; ham_j<L; ham_j++){
+         fprintf( capturing, " % 23.16E %3d %3d\n", getMutualInformation_HAM( ham_i, ham_j ), ham_i+1, ham_j+1 );
+      }
+   }
+   fclose( capturing );
+   cout << "Created the file " << filename << "." << endl;
+
+}
+
 #ifdef CHEMPS2_MPI_COMPILATION
 void CheMPS2::Correlations::mpi_broadcast(){
 
@@ -218,6 +299,14 @@ void CheMPS2::Correlations::FillSite(TensorT * denT, TensorGYZ ** Gtensors, Tens
 
    const int theindex = denT->gIndex();
    const int MAXDIM = max(denBK->gMaxDimAtBound(theindex), denBK->gMaxDimAtBound(theindex+1));
+   const double prefactorSpin = 1.0/(Prob->gTwoS() + 1.0);
+   const double sqrt_one_half = sqrt(0.5);
+   
+   /* Every previousindex only writes to the entries (previousindex, theindex) and (theindex, previousindex)
+      of MutInfo and Cdirad, so the two-orbital RDMs can be handled by different threads. */
+   #pragma omp parallel
+   {
+   
    double * workmem  = new double[MAXDIM*MAXDIM];
    int lindimRDM = 16;
    double * RDM = new double[lindimRDM*lindimRDM];
@@ -225,15 +314,13 @@ void CheMPS2::Correlations::FillSite(TensorT * denT, TensorGYZ ** Gtensors, Tens
    double * work = new double[lwork];
    double * eigs = new double[lindimRDM];
    
-   const double prefactorSpin = 1.0/(Prob->gTwoS() + 1.0);
-   const double sqrt_one_half = sqrt(0.5);
-   
+   #pragma omp for schedule(dynamic)
    for (int previousindex=0; previousindex<theindex; previousindex++){
    
       const bool equalIrreps = (denBK->gIrrep(previousindex) == denBK->gIrrep(theindex)) ? true : false;
       const double diag1  = diagram3(denT, Gtensors[previousindex], workmem) * prefactorSpin * 0.5 * sqrt_one_half;
-      const double diag2  = 0.125 * (   the2DM->getTwoDMB_DMRG(previousindex,theindex,theindex,previousindex)
-                                      - the2DM->getTwoDMA_DMRG(previousindex,theindex,theindex,previousindex) );
+      const double diag2  = 0.125 * (   pairs[previousindex + L*(theindex + L*3)]
+                                      - pairs[previousindex + L*(theindex + L*2)] );
       
       const double val1 = diagram1(denT, Ytensors[previousindex], workmem) * prefactorSpin;                                  //1x1 block N=0, Sz=0
       const double val2 = diagram2(denT, Ztensors[previousindex], workmem) * prefactorSpin;                                  //1x1 block N=4, Sz=0
@@ -252,7 +339,7 @@ void CheMPS2::Correlations::FillSite(TensorT * denT, TensorGYZ ** Gtensors, Tens
       const double lambda  = 2*diag2;
       const double delta   = (equalIrreps) ? ( - diagram5(denT, Ktensors[previousindex], workmem) * prefactorSpin * 0.5 ) : 0.0;
       const double epsilon = (equalIrreps) ? (   diagram4(denT, Mtensors[previousindex], workmem) * prefactorSpin * 0.5 ) : 0.0;
-      const double kappa   = 0.5 * the2DM->getTwoDMA_DMRG(previousindex,previousindex,theindex,theindex);
+      const double kappa   = 0.5 * pairs[previousindex + L*(theindex + L*4)];
       
       /*
       
@@ -296,14 +383,19 @@ void CheMPS2::Correlations::FillSite(TensorT * denT, TensorGYZ ** Gtensors, Tens
       RDM[7  + lindimRDM * 8 ] = RDM[8  + lindimRDM * 7 ] = lambda;
       
       if (CheMPS2::CORRELATIONS_debugPrint){
-         const double RDM_1orb_prev_4  = 0.5 * the2DM->getTwoDMA_DMRG(previousindex,previousindex,previousindex,previousindex);
-         const double RDM_1orb_prev_23 = 0.5 * (   the2DM->get1RDM_DMRG(previousindex, previousindex)
-                                                 - the2DM->getTwoDMA_DMRG(previousindex,previousindex,previousindex,previousindex) );
-         const double RDM_1orb_prev_1  = 1.0 - RDM_1orb_prev_4 - 2*RDM_1orb_prev_23;
+         #pragma omp critical
+         {
+         double RDM_1orb_prev[4];
+         double RDM_1orb_curr[4];
+         SingleOrbitalRDM_DMRG(previousindex, RDM_1orb_prev);
+         SingleOrbitalRDM_DMRG(theindex,      RDM_1orb_curr);
+         const double RDM_1orb_prev_4  = RDM_1orb_prev[3];
+         const double RDM_1orb_prev_23 = RDM_1orb_prev[1];
+         const double RDM_1orb_prev_1  = RDM_1orb_prev[0];
          
-         const double RDM_1orb_curr_4  = 0.5 * the2DM->getTwoDMA_DMRG(theindex,theindex,theindex,theindex);
-         const double RDM_1orb_curr_23 = 0.5 * ( the2DM->get1RDM_DMRG(theindex, theindex) - the2DM->getTwoDMA_DMRG(theindex,theindex,theindex,theindex) );
-         const double RDM_1orb_curr_1  = 1.0 - RDM_1orb_curr_4 - 2*RDM_1orb_curr_23;
+         const double RDM_1orb_curr_4  = RDM_1orb_curr[3];
+         const double RDM_1orb_curr_23 = RDM_1orb_curr[1];
+         const double RDM_1orb_curr_1  = RDM_1orb_curr[0];
          
          cout << "   Correlations::FillSite : Looking at DMRG sites (" << previousindex << "," << theindex << ")." << endl;
          
@@ -327,6 +419,7 @@ void CheMPS2::Correlations::FillSite(TensorT * denT, TensorGYZ ** Gtensors, Tens
          getal4 = RDM[9  + lindimRDM * 9 ] + RDM[12 + lindimRDM * 12] + RDM[14 + lindimRDM * 14] + RDM[15 + lindimRDM * 15] - RDM_1orb_prev_4;
          RMS = sqrt(getal1*getal1 + getal2*getal2 + getal3*getal3 + getal4*getal4);
          cout << "                            2-norm difference of one-orb RDM of the PREVIOUS site via 2DM and via trace(2-orb RDM) = " << RMS << endl;
+         }
       }
       
       char jobz = 'N'; //eigenvalues only
@@ -355,6 +448,8 @@ void CheMPS2::Correlations::FillSite(TensorT * denT, TensorGYZ ** Gtensors, Tens
    delete [] work;
    delete [] RDM;
    delete [] workmem;
+   
+   }
 
 }
 
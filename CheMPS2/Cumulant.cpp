@@ -23,6 +23,7 @@
 #include <iostream>
 
 #include "Cumulant.h"
+#include "Lapack.h"
 
 /*void CheMPS2::Cumulant::gamma4_fock_contract_ham_slow(const Problem * prob, const ThreeDM * the3DM, const TwoDM * the2DM, double * fock, double * result){
 
@@ -85,283 +86,293 @@ void CheMPS2::Cumulant::gamma4_fock_contract_ham(const Problem * prob, const Thr
 
    struct timeval start, end;
    gettimeofday(&start, NULL);
-   const int L = prob->gL();
-   
-   /* Clear result */
-   for ( int cnt = 0; cnt < L*L*L*L*L*L; cnt++ ){ result[ cnt ] = 0.0; }
-   
-   /* Construct an array with the orbital irreps in Hamiltonian indices */
-   int * irreps = new int[ L ];
-   for ( int orb = 0; orb < L; orb++ ){ irreps[ orb ] = prob->gIrrep(( prob->gReorder() ) ? prob->gf1( orb ) : orb ); }
+   const int L  = prob->gL();
+   const int L2 = L * L;
+   const int L3 = L * L2;
+   const int L4 = L * L3;
+   const int L5 = L * L4;
+   const long long L6 = L3 * ( long long ) L3;
+   const int num_irreps = Irreps::getNumberOfIrreps( prob->gSy() );
    
-   /* Helper arrays with partial (mult) or full (dot) contractions of objects with the CASPT2 Fock operator */
-   double * G3dotF  = new double[ L*L*L*L ];
-   double * lambda2 = new double[ L*L*L*L ];
-   double * G2multF = new double[ L*L*L*L ];
-   double * L2multF = new double[ L*L*L*L ];
-   double * gamma1  = new double[ L*L ];
-   double * G1multF = new double[ L*L ];
-   double * G2dotF  = new double[ L*L ];
-   double * L2dotF  = new double[ L*L ];
-   for ( int cnt = 0; cnt < L*L*L*L; cnt++ ){  G3dotF[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L*L*L; cnt++ ){ lambda2[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L*L*L; cnt++ ){ G2multF[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L*L*L; cnt++ ){ L2multF[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L;     cnt++ ){  gamma1[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L;     cnt++ ){ G1multF[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L;     cnt++ ){  G2dotF[ cnt ] = 0.0; }
-   for ( int cnt = 0; cnt < L*L;     cnt++ ){  L2dotF[ cnt ] = 0.0; }
-   double G1dotF = 0.0;
-   
-   /* Fill gamma1 */
-   for ( int i = 0; i < L; i++ ){
-      for ( int j = i; j < L; j++ ){
-         const double value = the2DM->get1RDM_HAM( i, j );
-         gamma1[ i + L * j ] = value;
-         gamma1[ j + L * i ] = value;
+   /* Work in an orbital order which is sorted per irrep: sorted orbital s is Hamiltonian orbital perm[ s ].
+      The one-body objects are then block diagonal, with blocks [ irrep_start[ I ], irrep_start[ I + 1 ] ). */
+   int * perm        = new int[ L ];
+   int * irreps      = new int[ L ];
+   int * irrep_start = new int[ num_irreps + 1 ];
+   {
+      int * ham_irreps = new int[ L ];
+      for ( int orb = 0; orb < L; orb++ ){ ham_irreps[ orb ] = prob->gIrrep(( prob->gReorder() ) ? prob->gf1( orb ) : orb ); }
+      int count = 0;
+      for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+         irrep_start[ irrep ] = count;
+         for ( int orb = 0; orb < L; orb++ ){
+            if ( ham_irreps[ orb ] == irrep ){
+               perm  [ count ] = orb;
+               irreps[ count ] = irrep;
+               count++;
+            }
+         }
       }
+      irrep_start[ num_irreps ] = count;
+      delete [] ham_irreps;
    }
    
-   /* Build  G3dotF[i,j,p,q] = sum_[l,s] Gamma3[i,j,l,p,q,s] F[l,s]
-      Build lambda2[i,j,p,q] = Lambda2[i,j,p,q]                     */
-   for ( int i = 0; i < L; i++ ){
-      for ( int j = i; j < L; j++ ){
-         const int irrep_ij = Irreps::directProd( irreps[ i ], irreps[ j ] );
-         for ( int p = i; p < L; p++ ){
-            for ( int q = i; q < L; q++ ){
-               const int irrep_pq = Irreps::directProd( irreps[ p ], irreps[ q ] );
-               if ( irrep_ij == irrep_pq ){
-                  { // sum_[l,s] Gamma3[i,j,l,p,q,s] F[l,s]
-                     double value = 0.0;
-                     for ( int l = 0; l < L; l++ ){
-                        for ( int s = 0; s < L; s++ ){
-                           if ( irreps[ l ] == irreps[ s ] ){
-                              value += the3DM->get_ham_index(i,j,l,p,q,s) * fock[ l + L * s ];
-                           }
-                        }
-                     }
-                     G3dotF[ i + L * ( j + L * ( p + L * q )) ] = value;
-                     G3dotF[ j + L * ( i + L * ( q + L * p )) ] = value;
-                     G3dotF[ p + L * ( q + L * ( i + L * j )) ] = value;
-                     G3dotF[ q + L * ( p + L * ( j + L * i )) ] = value;
-                  }
-                  { // Lambda2[i,j,p,q]
-                     const double val_lambda = the2DM->getTwoDMA_HAM( i, j, p, q )
-                                             - gamma1[ i + L * p ] * gamma1[ j + L * q ]
-                                             + gamma1[ i + L * q ] * gamma1[ j + L * p ] * 0.5;
-                     lambda2[ i + L * ( j + L * ( p + L * q )) ] = val_lambda;
-                     lambda2[ j + L * ( i + L * ( q + L * p )) ] = val_lambda;
-                     lambda2[ p + L * ( q + L * ( i + L * j )) ] = val_lambda;
-                     lambda2[ q + L * ( p + L * ( j + L * i )) ] = val_lambda;
-                  }
-               }
+   /* Orbital triples a + L * ( b + L * c ), grouped per irrep of their direct product */
+   int * trip_start = new int[ num_irreps + 1 ];
+   int * trip_list  = new int[ L3 ];
+   {
+      int count = 0;
+      for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+         trip_start[ irrep ] = count;
+         for ( int trip = 0; trip < L3; trip++ ){
+            if ( Irreps::directProd( Irreps::directProd( irreps[ trip % L ], irreps[ ( trip / L ) % L ] ), irreps[ trip / L2 ] ) == irrep ){
+               trip_list[ count ] = trip;
+               count++;
             }
          }
       }
+      trip_start[ num_irreps ] = count;
    }
    
-   /* Build G1multF[i,j] = sum_[p]   Gamma1[i,p] F[p,j]
-      Build       G1dotF = sum_[i,j] Gamma1[i,j] F[j,i] */
+   /* Dense copies of the one- and two-body objects and the CASPT2 Fock operator in the sorted orbital order; the 3-RDM is read slab by slab */
+   double * gamma1  = new double[ L2 ];
+   double * fockS   = new double[ L2 ];
+   double * gamma2  = new double[ L4 ];
+   double * lambda2 = new double[ L4 ];
+   double * slab    = new double[ L5 ]; // slab[i+L*(j+L*(k+L*(p+L*q)))] = Gamma3[i,j,k,p,q,r] for one value of r
    for ( int i = 0; i < L; i++ ){
       for ( int j = 0; j < L; j++ ){
-         if ( irreps[ i ] == irreps[ j ] ){
-            double value = 0.0;
-            for ( int p = 0; p < L; p++ ){
-               if ( irreps[ j ] == irreps[ p ] ){
-                  value += gamma1[ i + L * p ] * fock[ p + L * j ];
-               }
-            }
-            G1multF[ i + L * j ] = value;
-         }
+         const bool same = ( irreps[ i ] == irreps[ j ] );
+         gamma1[ i + L * j ] = (( same ) ? the2DM->get1RDM_HAM( perm[ i ], perm[ j ] ) : 0.0 );
+         fockS [ i + L * j ] = (( same ) ? fock[ perm[ i ] + L * perm[ j ] ] : 0.0 );
+      }
+   }
+   #pragma omp parallel for schedule(static)
+   for ( int pq = 0; pq < L2; pq++ ){
+      const int p = pq % L;
+      const int q = pq / L;
+      const int irrep_pq = Irreps::directProd( irreps[ p ], irreps[ q ] );
+      for ( int ij = 0; ij < L2; ij++ ){
+         const int i = ij % L;
+         const int j = ij / L;
+         const double value = (( Irreps::directProd( irreps[ i ], irreps[ j ] ) == irrep_pq ) ? the2DM->getTwoDMA_HAM( perm[ i ], perm[ j ], perm[ p ], perm[ q ] ) : 0.0 );
+         gamma2 [ ij + L2 * pq ] = value;
+         lambda2[ ij + L2 * pq ] = value - gamma1[ i + L * p ] * gamma1[ j + L * q ] + gamma1[ i + L * q ] * gamma1[ j + L * p ] * 0.5;
       }
-      G1dotF += G1multF[ i * ( L + 1 ) ];
    }
    
-   /* Build G2dotF[i,j] = sum_[p,q]  Gamma2[i,p,j,q] F[p,q]
-      Build L2dotF[i,j] = sum_[p,q] Lambda2[i,p,j,q] F[p,q] */
+   /* Helper arrays with partial (mult) or full (dot) contractions of objects with the CASPT2 Fock operator */
+   double * G1multF = new double[ L2 ]; // G1multF[i,j]     = sum_[p]    Gamma1[i,p] F[p,j]
+   double * G2dotF  = new double[ L2 ]; //  G2dotF[i,j]     = sum_[p,q]  Gamma2[i,p,j,q] F[p,q]
+   double * L2dotF  = new double[ L2 ]; //  L2dotF[i,j]     = sum_[p,q] Lambda2[i,p,j,q] F[p,q]
+   double * G2multF = new double[ L4 ]; // G2multF[i,s,j,k] = sum_[l]    Gamma2[i,l,j,k] F[l,s]
+   double * L2multF = new double[ L4 ]; // L2multF[i,s,j,k] = sum_[l]   Lambda2[i,l,j,k] F[l,s]
+   double * G2multS = new double[ L4 ]; // G2multS[i,s,j,k] = G2multF[i,s,j,k] + 0.5 * G2multF[i,s,k,j]
+   double * L2multS = new double[ L4 ]; // L2multS[i,s,j,k] = L2multF[i,s,j,k] + 0.5 * L2multF[i,s,k,j]
+   double * G3dotF  = new double[ L4 ]; //  G3dotF[i,j,p,q] = sum_[l,s]  Gamma3[i,j,l,p,q,s] F[l,s]
+   double G1dotF = 0.0;
+   
    for ( int i = 0; i < L; i++ ){
-      for ( int j = i; j < L; j++ ){
-         if ( irreps[ i ] == irreps[ j ] ){
+      for ( int j = 0; j < L; j++ ){
+         double value = 0.0;
+         for ( int p = irrep_start[ irreps[ j ] ]; p < irrep_start[ irreps[ j ] + 1 ]; p++ ){ value += gamma1[ i + L * p ] * fockS[ p + L * j ]; }
+         G1multF[ i + L * j ] = value;
+      }
+      G1dotF += G1multF[ i * ( L + 1 ) ];
+   }
+   
+   #pragma omp parallel for schedule(static)
+   for ( int ij = 0; ij < L2; ij++ ){
+      const int i = ij % L;
+      const int j = ij / L;
+      double val_gamma  = 0.0;
+      double val_lambda = 0.0;
+      for ( int q = 0; q < L; q++ ){
+         for ( int p = irrep_start[ irreps[ q ] ]; p < irrep_start[ irreps[ q ] + 1 ]; p++ ){
+            val_gamma  += fockS[ p + L * q ] *  gamma2[ i + L * ( p + L * ( j + L * q )) ];
+            val_lambda += fockS[ p + L * q ] * lambda2[ i + L * ( p + L * ( j + L * q )) ];
+         }
+      }
+      G2dotF[ ij ] = val_gamma;
+      L2dotF[ ij ] = val_lambda;
+   }
+   
+   #pragma omp parallel for schedule(static)
+   for ( int jk = 0; jk < L2; jk++ ){
+      for ( int s = 0; s < L; s++ ){
+         for ( int i = 0; i < L; i++ ){
             double val_gamma  = 0.0;
             double val_lambda = 0.0;
-            for ( int p = 0; p < L; p++ ){
-               for ( int q = 0; q < L; q++ ){
-                  if ( irreps[ p ] == irreps[ q ] ){
-                     val_gamma  += fock[ p + L * q ] * the2DM->getTwoDMA_HAM( i, p, j, q );
-                     val_lambda += fock[ p + L * q ] * lambda2[ i + L * ( p + L * ( j + L * q )) ];
-                  }
-               }
+            for ( int l = irrep_start[ irreps[ s ] ]; l < irrep_start[ irreps[ s ] + 1 ]; l++ ){
+               val_gamma  += fockS[ l + L * s ] *  gamma2[ i + L * l + L2 * jk ];
+               val_lambda += fockS[ l + L * s ] * lambda2[ i + L * l + L2 * jk ];
             }
-            G2dotF[ i + L * j ] = val_gamma;
-            G2dotF[ j + L * i ] = val_gamma;
-            L2dotF[ i + L * j ] = val_lambda;
-            L2dotF[ j + L * i ] = val_lambda;
+            G2multF[ i + L * s + L2 * jk ] = val_gamma;
+            L2multF[ i + L * s + L2 * jk ] = val_lambda;
          }
       }
    }
+   #pragma omp parallel for schedule(static)
+   for ( int jk = 0; jk < L2; jk++ ){
+      const int kj = ( jk / L ) + L * ( jk % L );
+      for ( int is = 0; is < L2; is++ ){
+         G2multS[ is + L2 * jk ] = G2multF[ is + L2 * jk ] + 0.5 * G2multF[ is + L2 * kj ];
+         L2multS[ is + L2 * jk ] = L2multF[ is + L2 * jk ] + 0.5 * L2multF[ is + L2 * kj ];
+      }
+   }
    
-   /* Build G2multF[i,s,j,k] = sum_[l]  Gamma2[i,l,j,k] F[l,s]
-      Build L2multF[i,s,j,k] = sum_[l] Lambda2[i,l,j,k] F[l,s] */
-   for ( int i = 0; i < L; i++ ){
-      for ( int j = 0; j < L; j++ ){
-         const int irrep_ij = Irreps::directProd( irreps[ i ], irreps[ j ] );
-         for ( int k = 0; k < L; k++ ){
-            for ( int s = 0; s < L; s++ ){
-               const int irrep_ks = Irreps::directProd( irreps[ k ], irreps[ s ] );
-               if ( irrep_ij == irrep_ks ){
-                  double val_gamma  = 0.0;
-                  double val_lambda = 0.0;
-                  for ( int l = 0; l < L; l++ ){
-                     if ( irreps[ l ] == irreps[ s ] ){
-                        val_gamma  += fock[ l + L * s ] * the2DM->getTwoDMA_HAM( i, l, j, k );
-                        val_lambda += fock[ l + L * s ] * lambda2[ i + L * ( l + L * ( j + L * k ) ) ];
-                     }
-                  }
-                  G2multF[ i + L * ( s + L * ( j + L * k ) ) ] = val_gamma;
-                  L2multF[ i + L * ( s + L * ( j + L * k ) ) ] = val_lambda;
-               }
-            }
+   /* Per slab r of Gamma3: G3dotF, the term Gamma3 * G1dotF, and - 0.5 * sum_[ls] Gamma3 with one index replaced by ls * G1multF[index,ls] */
+   for ( long long cnt = 0; cnt < L6; cnt++ ){ result[ cnt ] = 0.0; }
+   for ( int ij = 0; ij < L4; ij++ ){ G3dotF[ ij ] = 0.0; }
+   for ( int r = 0; r < L; r++ ){
+      #pragma omp parallel for schedule(static)
+      for ( int pq = 0; pq < L2; pq++ ){
+         const int p = pq % L;
+         const int q = pq / L;
+         const int irrep_pqr = Irreps::directProd( Irreps::directProd( irreps[ p ], irreps[ q ] ), irreps[ r ] );
+         for ( int ijk = 0; ijk < L3; ijk++ ){
+            const int i = ijk % L;
+            const int j = ( ijk / L ) % L;
+            const int k = ijk / L2;
+            const int irrep_ijk = Irreps::directProd( Irreps::directProd( irreps[ i ], irreps[ j ] ), irreps[ k ] );
+            slab[ ijk + L3 * pq ] = (( irrep_ijk == irrep_pqr ) ? the3DM->get_ham_index( perm[ i ], perm[ j ], perm[ k ], perm[ p ], perm[ q ], perm[ r ] ) : 0.0 );
+         }
+      }
+      #pragma omp parallel for schedule(static)
+      for ( int pq = 0; pq < L2; pq++ ){
+         for ( int l = irrep_start[ irreps[ r ] ]; l < irrep_start[ irreps[ r ] + 1 ]; l++ ){
+            const double f_lr = fockS[ l + L * r ];
+            const double * block = slab + L2 * ( l + L * pq );
+            for ( int ij = 0; ij < L2; ij++ ){ G3dotF[ ij + L2 * pq ] += f_lr * block[ ij ]; }
          }
       }
+      double * result_r = result + L5 * ( long long ) r;
+      for ( int x = irrep_start[ irreps[ r ] ]; x < irrep_start[ irreps[ r ] + 1 ]; x++ ){
+         const double prefactor = - 0.5 * G1multF[ x + L * r ] + (( x == r ) ? G1dotF : 0.0 );
+         double * result_x = result + L5 * ( long long ) x;
+         #pragma omp parallel for schedule(static)
+         for ( int cnt = 0; cnt < L5; cnt++ ){ result_x[ cnt ] += prefactor * slab[ cnt ]; }
+      }
+      for ( int slot = 0; slot < 5; slot++ ){
+         mode_product( slab, G1multF, result_r, L, slot, -0.5, num_irreps, irrep_start );
+      }
    }
    
-   /* Fill result */
-   #pragma omp parallel for schedule(dynamic)
-   for ( int i = 0; i < L; i++ ){
-      for ( int j = i; j < L; j++ ){
-         for ( int k = i; k < L; k++ ){
-            const int irrep_ijk = Irreps::directProd( Irreps::directProd( irreps[ i ], irreps[ j ] ), irreps[ k ] );
-            for ( int p = i; p < L; p++ ){
-               for ( int q = i; q < L; q++ ){
-                  for ( int r = q; r < L; r++ ){
-                     const int irrep_pqr = Irreps::directProd( Irreps::directProd( irreps[ p ], irreps[ q ] ), irreps[ r ] );
-                     if ( irrep_ijk == irrep_pqr ){
-                     
-                        double dm3_contribution = 0.0;
-                        double gamma2_part1 = 0.0;
-                        double gamma2_part2 = 0.0;
-                        double lambda2_part1 = 0.0;
-                        double lambda2_part2 = 0.0;
-                        
-                        for ( int ls = 0; ls < L; ls++ ){
-                        
-                           dm3_contribution += ( the3DM->get_ham_index( ls, j, k, p, q, r ) * G1multF[ i + L * ls ]
-                                               + the3DM->get_ham_index( i, ls, k, p, q, r ) * G1multF[ j + L * ls ]
-                                               + the3DM->get_ham_index( i, j, ls, p, q, r ) * G1multF[ k + L * ls ]
-                                               + the3DM->get_ham_index( i, j, k, ls, q, r ) * G1multF[ p + L * ls ]
-                                               + the3DM->get_ham_index( i, j, k, p, ls, r ) * G1multF[ q + L * ls ]
-                                               + the3DM->get_ham_index( i, j, k, p, q, ls ) * G1multF[ r + L * ls ] );
-                           
-                           gamma2_part1 += ( the2DM->getTwoDMA_HAM( i, j, p, ls ) * G2multF[ k + L * ( ls + L * ( r + L * q )) ]
-                                           + the2DM->getTwoDMA_HAM( i, j, ls, q ) * G2multF[ k + L * ( ls + L * ( r + L * p )) ]
-                                           + the2DM->getTwoDMA_HAM( i, k, p, ls ) * G2multF[ j + L * ( ls + L * ( q + L * r )) ]
-                                           + the2DM->getTwoDMA_HAM( i, k, ls, r ) * G2multF[ j + L * ( ls + L * ( q + L * p )) ]
-                                           + the2DM->getTwoDMA_HAM( k, j, ls, q ) * G2multF[ i + L * ( ls + L * ( p + L * r )) ]
-                                           + the2DM->getTwoDMA_HAM( k, j, r, ls ) * G2multF[ i + L * ( ls + L * ( p + L * q )) ] );
-                           
-                           gamma2_part2 += ( the2DM->getTwoDMA_HAM( i, j, r, ls ) * ( G2multF[ k + L * ( ls + L * ( p + L * q )) ] 
-                                                                              + 0.5 * G2multF[ k + L * ( ls + L * ( q + L * p )) ] )
-                                           + the2DM->getTwoDMA_HAM( i, j, ls, r ) * ( G2multF[ k + L * ( ls + L * ( q + L * p )) ]
-                                                                              + 0.5 * G2multF[ k + L * ( ls + L * ( p + L * q )) ] )
-                                           + the2DM->getTwoDMA_HAM( i, k, q, ls ) * ( G2multF[ j + L * ( ls + L * ( p + L * r )) ]
-                                                                              + 0.5 * G2multF[ j + L * ( ls + L * ( r + L * p )) ] )
-                                           + the2DM->getTwoDMA_HAM( i, k, ls, q ) * ( G2multF[ j + L * ( ls + L * ( r + L * p )) ]
-                                                                              + 0.5 * G2multF[ j + L * ( ls + L * ( p + L * r )) ] )
-                                           + the2DM->getTwoDMA_HAM( k, j, p, ls ) * ( G2multF[ i + L * ( ls + L * ( r + L * q )) ]
-                                                                              + 0.5 * G2multF[ i + L * ( ls + L * ( q + L * r )) ] )
-                                           + the2DM->getTwoDMA_HAM( k, j, ls, p ) * ( G2multF[ i + L * ( ls + L * ( q + L * r )) ]
-                                                                              + 0.5 * G2multF[ i + L * ( ls + L * ( r + L * q )) ] ) );
-                           
-                           lambda2_part1 += ( lambda2[ i + L * ( j + L * ( p + L * ls )) ] * L2multF[ k + L * ( ls + L * ( r + L * q )) ]
-                                            + lambda2[ i + L * ( j + L * ( ls + L * q )) ] * L2multF[ k + L * ( ls + L * ( r + L * p )) ]
-                                            + lambda2[ i + L * ( k + L * ( p + L * ls )) ] * L2multF[ j + L * ( ls + L * ( q + L * r )) ]
-                                            + lambda2[ i + L * ( k + L * ( ls + L * r )) ] * L2multF[ j + L * ( ls + L * ( q + L * p )) ]
-                                            + lambda2[ k + L * ( j + L * ( ls + L * q )) ] * L2multF[ i + L * ( ls + L * ( p + L * r )) ]
-                                            + lambda2[ k + L * ( j + L * ( r + L * ls )) ] * L2multF[ i + L * ( ls + L * ( p + L * q )) ] );
-                           
-                           lambda2_part2 += ( lambda2[ i + L * ( j + L * ( r + L * ls )) ] * ( L2multF[ k + L * ( ls + L * ( p + L * q )) ] 
-                                                                                       + 0.5 * L2multF[ k + L * ( ls + L * ( q + L * p )) ] )
-                                            + lambda2[ i + L * ( j + L * ( ls + L * r )) ] * ( L2multF[ k + L * ( ls + L * ( q + L * p )) ]
-                                                                                       + 0.5 * L2multF[ k + L * ( ls + L * ( p + L * q )) ] )
-                                            + lambda2[ i + L * ( k + L * ( q + L * ls )) ] * ( L2multF[ j + L * ( ls + L * ( p + L * r )) ]
-                                                                                       + 0.5 * L2multF[ j + L * ( ls + L * ( r + L * p )) ] )
-                                            + lambda2[ i + L * ( k + L * ( ls + L * q )) ] * ( L2multF[ j + L * ( ls + L * ( r + L * p )) ]
-                                                                                       + 0.5 * L2multF[ j + L * ( ls + L * ( p + L * r )) ] )
-                                            + lambda2[ k + L * ( j + L * ( p + L * ls )) ] * ( L2multF[ i + L * ( ls + L * ( r + L * q )) ]
-                                                                                       + 0.5 * L2multF[ i + L * ( ls + L * ( q + L * r )) ] )
-                                            + lambda2[ k + L * ( j + L * ( ls + L * p )) ] * ( L2multF[ i + L * ( ls + L * ( q + L * r )) ]
-                                                                                       + 0.5 * L2multF[ i + L * ( ls + L * ( r + L * q )) ] ) );
-                        }
-                     
-                        const double contracted_value = ( the3DM->get_ham_index( i, j, k, p, q, r ) * G1dotF
-
-                                                  +       G3dotF[ i + L * ( j + L * ( p + L * q )) ] * gamma1[ k + L * r ]
-                                                  - 0.5 * G3dotF[ i + L * ( j + L * ( r + L * q )) ] * gamma1[ k + L * p ]
-                                                  - 0.5 * G3dotF[ i + L * ( j + L * ( p + L * r )) ] * gamma1[ k + L * q ]
-                                                  +       G3dotF[ i + L * ( k + L * ( p + L * r )) ] * gamma1[ j + L * q ]
-                                                  - 0.5 * G3dotF[ i + L * ( k + L * ( q + L * r )) ] * gamma1[ j + L * p ]
-                                                  - 0.5 * G3dotF[ i + L * ( k + L * ( p + L * q )) ] * gamma1[ j + L * r ]
-                                                  +       G3dotF[ j + L * ( k + L * ( q + L * r )) ] * gamma1[ i + L * p ]
-                                                  - 0.5 * G3dotF[ j + L * ( k + L * ( p + L * r )) ] * gamma1[ i + L * q ]
-                                                  - 0.5 * G3dotF[ j + L * ( k + L * ( q + L * p )) ] * gamma1[ i + L * r ]
-
-                                                  - 0.5 * dm3_contribution
-
-                                                  -       the2DM->getTwoDMA_HAM( i, j, p, q ) * G2dotF[ k + L * r ]
-                                                  + 0.5 * the2DM->getTwoDMA_HAM( i, j, p, r ) * G2dotF[ k + L * q ]
-                                                  + 0.5 * the2DM->getTwoDMA_HAM( i, j, r, q ) * G2dotF[ k + L * p ]
-                                                  -       the2DM->getTwoDMA_HAM( i, k, p, r ) * G2dotF[ j + L * q ]
-                                                  + 0.5 * the2DM->getTwoDMA_HAM( i, k, p, q ) * G2dotF[ j + L * r ]
-                                                  + 0.5 * the2DM->getTwoDMA_HAM( i, k, q, r ) * G2dotF[ j + L * p ]
-                                                  -       the2DM->getTwoDMA_HAM( k, j, r, q ) * G2dotF[ i + L * p ]
-                                                  + 0.5 * the2DM->getTwoDMA_HAM( k, j, p, q ) * G2dotF[ i + L * r ]
-                                                  + 0.5 * the2DM->getTwoDMA_HAM( k, j, r, p ) * G2dotF[ i + L * q ]
-
-                                                  + 0.5 * gamma2_part1
-                                                  -       gamma2_part2 / 3.0
-
-                                                  + 2 * lambda2[ i + L * ( j + L * ( p + L * q )) ] * L2dotF[ k + L * r ]
-                                                  -     lambda2[ i + L * ( j + L * ( p + L * r )) ] * L2dotF[ k + L * q ]
-                                                  -     lambda2[ i + L * ( j + L * ( r + L * q )) ] * L2dotF[ k + L * p ]
-                                                  + 2 * lambda2[ i + L * ( k + L * ( p + L * r )) ] * L2dotF[ j + L * q ]
-                                                  -     lambda2[ i + L * ( k + L * ( p + L * q )) ] * L2dotF[ j + L * r ]
-                                                  -     lambda2[ i + L * ( k + L * ( q + L * r )) ] * L2dotF[ j + L * p ]
-                                                  + 2 * lambda2[ k + L * ( j + L * ( r + L * q )) ] * L2dotF[ i + L * p ]
-                                                  -     lambda2[ k + L * ( j + L * ( p + L * q )) ] * L2dotF[ i + L * r ]
-                                                  -     lambda2[ k + L * ( j + L * ( r + L * p )) ] * L2dotF[ i + L * q ]
-
-                                                  - lambda2_part1
-                                                  + lambda2_part2 / 1.5 );
+   /* Add to result, in the sorted orbital order: terms which are products of a G3dotF, Gamma2 or Lambda2 element with a one-body object */
+   #pragma omp parallel for schedule(static)
+   for ( int qr = 0; qr < L2; qr++ ){
+      const int q = qr % L;
+      const int r = qr / L;
+      for ( int p = 0; p < L; p++ ){
+         const int irrep_pqr = Irreps::directProd( Irreps::directProd( irreps[ p ], irreps[ q ] ), irreps[ r ] );
+         for ( int ijk = 0; ijk < L3; ijk++ ){
+            const int i = ijk % L;
+            const int j = ( ijk / L ) % L;
+            const int k = ijk / L2;
+            const long long pointer = ijk + L3 * ( p + L * ( long long ) qr );
+            if ( Irreps::directProd( Irreps::directProd( irreps[ i ], irreps[ j ] ), irreps[ k ] ) != irrep_pqr ){ continue; }
+            result[ pointer ] += (       G3dotF[ i + L * ( j + L * ( p + L * q )) ] * gamma1[ k + L * r ]
+                              - 0.5 * G3dotF[ i + L * ( j + L * ( r + L * q )) ] * gamma1[ k + L * p ]
+                              - 0.5 * G3dotF[ i + L * ( j + L * ( p + L * r )) ] * gamma1[ k + L * q ]
+                              +       G3dotF[ i + L * ( k + L * ( p + L * r )) ] * gamma1[ j + L * q ]
+                              - 0.5 * G3dotF[ i + L * ( k + L * ( q + L * r )) ] * gamma1[ j + L * p ]
+                              - 0.5 * G3dotF[ i + L * ( k + L * ( p + L * q )) ] * gamma1[ j + L * r ]
+                              +       G3dotF[ j + L * ( k + L * ( q + L * r )) ] * gamma1[ i + L * p ]
+                              - 0.5 * G3dotF[ j + L * ( k + L * ( p + L * r )) ] * gamma1[ i + L * q ]
+                              - 0.5 * G3dotF[ j + L * ( k + L * ( q + L * p )) ] * gamma1[ i + L * r ]
                               
-                        result[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r )))) ] = contracted_value;
-                        result[ i + L * ( k + L * ( j + L * ( p + L * ( r + L * q )))) ] = contracted_value;
-                        result[ j + L * ( i + L * ( k + L * ( q + L * ( p + L * r )))) ] = contracted_value;
-                        result[ k + L * ( i + L * ( j + L * ( r + L * ( p + L * q )))) ] = contracted_value;
-                        result[ j + L * ( k + L * ( i + L * ( q + L * ( r + L * p )))) ] = contracted_value;
-                        result[ k + L * ( j + L * ( i + L * ( r + L * ( q + L * p )))) ] = contracted_value;
-                        result[ p + L * ( q + L * ( r + L * ( i + L * ( j + L * k )))) ] = contracted_value;
-                        result[ p + L * ( r + L * ( q + L * ( i + L * ( k + L * j )))) ] = contracted_value;
-                        result[ q + L * ( p + L * ( r + L * ( j + L * ( i + L * k )))) ] = contracted_value;
-                        result[ r + L * ( p + L * ( q + L * ( k + L * ( i + L * j )))) ] = contracted_value;
-                        result[ q + L * ( r + L * ( p + L * ( j + L * ( k + L * i )))) ] = contracted_value;
-                        result[ r + L * ( q + L * ( p + L * ( k + L * ( j + L * i )))) ] = contracted_value;
-                     }
-                  }
-               }
+                              -       gamma2[ i + L * ( j + L * ( p + L * q )) ] * G2dotF[ k + L * r ]
+                              + 0.5 * gamma2[ i + L * ( j + L * ( p + L * r )) ] * G2dotF[ k + L * q ]
+                              + 0.5 * gamma2[ i + L * ( j + L * ( r + L * q )) ] * G2dotF[ k + L * p ]
+                              -       gamma2[ i + L * ( k + L * ( p + L * r )) ] * G2dotF[ j + L * q ]
+                              + 0.5 * gamma2[ i + L * ( k + L * ( p + L * q )) ] * G2dotF[ j + L * r ]
+                              + 0.5 * gamma2[ i + L * ( k + L * ( q + L * r )) ] * G2dotF[ j + L * p ]
+                              -       gamma2[ k + L * ( j + L * ( r + L * q )) ] * G2dotF[ i + L * p ]
+                              + 0.5 * gamma2[ k + L * ( j + L * ( p + L * q )) ] * G2dotF[ i + L * r ]
+                              + 0.5 * gamma2[ k + L * ( j + L * ( r + L * p )) ] * G2dotF[ i + L * q ]
+                              
+                              + 2 * lambda2[ i + L * ( j + L * ( p + L * q )) ] * L2dotF[ k + L * r ]
+                              -     lambda2[ i + L * ( j + L * ( p + L * r )) ] * L2dotF[ k + L * q ]
+                              -     lambda2[ i + L * ( j + L * ( r + L * q )) ] * L2dotF[ k + L * p ]
+                              + 2 * lambda2[ i + L * ( k + L * ( p + L * r )) ] * L2dotF[ j + L * q ]
+                              -     lambda2[ i + L * ( k + L * ( p + L * q )) ] * L2dotF[ j + L * r ]
+                              -     lambda2[ i + L * ( k + L * ( q + L * r )) ] * L2dotF[ j + L * p ]
+                              + 2 * lambda2[ k + L * ( j + L * ( r + L * q )) ] * L2dotF[ i + L * p ]
+                              -     lambda2[ k + L * ( j + L * ( p + L * q )) ] * L2dotF[ i + L * r ]
+                              -     lambda2[ k + L * ( j + L * ( r + L * p )) ] * L2dotF[ i + L * q ] );
+         }
+      }
+   }
+   
+   /* Fill result: contractions of two Gamma2 or two Lambda2 objects over one index ls, e.g. Gamma2[i,j,p,ls] * G2multF[k,ls,r,q] */
+   {
+      const int num_terms = 12;
+      const int  a_ls[ num_terms ]    = { 3, 2, 3, 2, 2, 3, 3, 2, 3, 2, 3, 2 };
+      const int a_out[ num_terms ][ 3 ] = { { 0, 1, 3 }, { 0, 1, 4 }, { 0, 2, 3 }, { 0, 2, 5 }, { 2, 1, 4 }, { 2, 1, 5 },
+                                            { 0, 1, 5 }, { 0, 1, 5 }, { 0, 2, 4 }, { 0, 2, 4 }, { 2, 1, 3 }, { 2, 1, 3 } };
+      const int b_out[ num_terms ][ 3 ] = { { 2, 5, 4 }, { 2, 5, 3 }, { 1, 4, 5 }, { 1, 4, 3 }, { 0, 3, 5 }, { 0, 3, 4 },
+                                            { 2, 3, 4 }, { 2, 4, 3 }, { 1, 3, 5 }, { 1, 5, 3 }, { 0, 5, 4 }, { 0, 4, 5 } };
+      for ( int term = 0; term < num_terms; term++ ){
+         const bool symm = ( term >= 6 ); // The second six terms use the symmetrized contractions with the Fock operator
+         contract_pair( result, (( symm ) ? -1.0 / 3.0 : 0.5 ),  gamma2, a_ls[ term ], a_out[ term ], (( symm ) ? G2multS : G2multF ), b_out[ term ], L, num_irreps, irrep_start, trip_start, trip_list );
+         contract_pair( result, (( symm ) ?  1.0 / 1.5 : -1.0 ), lambda2, a_ls[ term ], a_out[ term ], (( symm ) ? L2multS : L2multF ), b_out[ term ], L, num_irreps, irrep_start, trip_start, trip_list );
+      }
+   }
+   
+   /* Return to the Hamiltonian orbital order in place: first within each column of L^3 elements, then the columns themselves along the cycles of the permutation */
+   #pragma omp parallel
+   {
+      double * column = new double[ L3 ];
+      #pragma omp for schedule(static)
+      for ( int pqr = 0; pqr < L3; pqr++ ){
+         double * target = result + L3 * ( long long ) pqr;
+         for ( int ijk = 0; ijk < L3; ijk++ ){ column[ ijk ] = target[ ijk ]; }
+         for ( int ijk = 0; ijk < L3; ijk++ ){ target[ perm[ ijk % L ] + L * ( perm[ ( ijk / L ) % L ] + L * perm[ ijk / L2 ] ) ] = column[ ijk ]; }
+      }
+      delete [] column;
+   }
+   {
+      bool * done = new bool[ L3 ];
+      for ( int pqr = 0; pqr < L3; pqr++ ){ done[ pqr ] = false; }
+      double * column = new double[ L3 ];
+      for ( int first = 0; first < L3; first++ ){
+         if ( done[ first ] ){ continue; }
+         int current = first;
+         for ( int ijk = 0; ijk < L3; ijk++ ){ column[ ijk ] = result[ ijk + L3 * ( long long ) current ]; }
+         while ( done[ current ] == false ){ // The column in column belongs at position ham_pqr
+            done[ current ] = true;
+            const int ham_pqr = perm[ current % L ] + L * ( perm[ ( current / L ) % L ] + L * perm[ current / L2 ] );
+            double * target = result + L3 * ( long long ) ham_pqr;
+            for ( int ijk = 0; ijk < L3; ijk++ ){
+               const double temp = target[ ijk ];
+               target[ ijk ] = column[ ijk ];
+               column[ ijk ] = temp;
             }
+            current = ham_pqr;
          }
       }
+      delete [] column;
+      delete [] done;
    }
    
+   delete [] G1multF;
+   delete [] G2dotF;
+   delete [] L2dotF;
+   delete [] G2multS;
+   delete [] L2multS;
    delete [] G3dotF;
-   delete [] lambda2;
    delete [] G2multF;
    delete [] L2multF;
    delete [] gamma1;
-   delete [] G1multF;
-   delete [] G2dotF;
-   delete [] L2dotF;
+   delete [] fockS;
+   delete [] gamma2;
+   delete [] lambda2;
+   delete [] slab;
+   delete [] trip_start;
+   delete [] trip_list;
+   delete [] perm;
    delete [] irreps;
+   delete [] irrep_start;
    
    gettimeofday(&end, NULL);
    const double elapsed = (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
@@ -369,6 +380,128 @@ void CheMPS2::Cumulant::gamma4_fock_contract_ham(const Problem * prob, const Thr
 
 }
 
+void CheMPS2::Cumulant::mode_product(double * tensor, double * matrix, double * output, const int L, const int slot, double alpha, const int num_irreps, const int * irrep_start){
+
+   /* output[ lo + left * ( x + L * hi ) ] += alpha * sum_[y] matrix[ x + L * y ] * tensor[ lo + left * ( y + L * hi ) ],
+      with matrix block diagonal: x and y belong to the same block [ irrep_start[ I ], irrep_start[ I + 1 ] ) */
+   int left  = 1;
+   int right = 1;
+   for ( int cnt = 0; cnt < slot;     cnt++ ){ left  *= L; }
+   for ( int cnt = 0; cnt < 4 - slot; cnt++ ){ right *= L; }
+   const int L3 = L * L * L;
+   char notrans = 'N';
+   char trans   = 'T';
+   double one   = 1.0;
+
+   if ( slot == 0 ){ // One GEMM per irrep and per chunk of L^3 columns
+      #pragma omp parallel for schedule(static)
+      for ( int chunk = 0; chunk < L; chunk++ ){
+         for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+            int start = irrep_start[ irrep ];
+            int num   = irrep_start[ irrep + 1 ] - start;
+            int ld    = L;
+            int cols  = L3;
+            if ( num > 0 ){
+               dgemm_( &notrans, &notrans, &num, &cols, &num, &alpha, matrix + start * ( L + 1 ), &ld, tensor + start + L * L3 * chunk, &ld, &one, output + start + L * L3 * chunk, &ld );
+            }
+         }
+      }
+   } else { // One GEMM per irrep, per value of the indices after slot, and per chunk of at most L^3 rows
+      const int row_chunk  = (( left < L3 ) ? left : L3 );
+      const int num_chunks = right * ( left / row_chunk );
+      #pragma omp parallel for schedule(static)
+      for ( int task = 0; task < num_chunks; task++ ){
+         const int hi = task % right;
+         const int lo = row_chunk * ( task / right );
+         for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+            int start = irrep_start[ irrep ];
+            int num   = irrep_start[ irrep + 1 ] - start;
+            int ld_t  = left;
+            int ld_m  = L;
+            int rows  = row_chunk;
+            if ( num > 0 ){
+               dgemm_( &notrans, &trans, &rows, &num, &num, &alpha, tensor + lo + left * ( start + L * hi ), &ld_t, matrix + start * ( L + 1 ), &ld_m, &one, output + lo + left * ( start + L * hi ), &ld_t );
+            }
+         }
+      }
+   }
+
+}
+
+void CheMPS2::Cumulant::contract_pair(double * result, double alpha, double * A, const int a_ls, const int * a_out, double * B, const int * b_out, const int L,
+                                      const int num_irreps, const int * irrep_start, const int * trip_start, const int * trip_list){
+
+   /* result[ ... ] += alpha * sum_[ls] A[ a0, a1, a2 with ls at position a_ls ] * B[ b0, ls, b1, b2 ]
+      with the free indices a0, a1, a2, b0, b1, b2 at the result positions a_out[ 0 ], a_out[ 1 ], a_out[ 2 ], b_out[ 0 ], b_out[ 1 ], b_out[ 2 ].
+      Only triples ( a0, a1, a2 ) and ( b0, b1, b2 ) with the irrep of ls contribute, so that the GEMMs are irrep-blocked. */
+   long long power[ 6 ];
+   power[ 0 ] = 1;
+   for ( int cnt = 1; cnt < 6; cnt++ ){ power[ cnt ] = power[ cnt - 1 ] * L; }
+   int a_free[ 3 ];
+   {
+      int count = 0;
+      for ( int pos = 0; pos < 4; pos++ ){
+         if ( pos != a_ls ){ a_free[ count ] = pos; count++; }
+      }
+   }
+   const int L2 = L * L;
+   char notrans = 'N';
+   double zero  = 0.0;
+
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+
+      const int start = irrep_start[ irrep ];
+      int num_ls      = irrep_start[ irrep + 1 ] - start;
+      int num_trip    = trip_start[ irrep + 1 ] - trip_start[ irrep ];
+      if (( num_ls == 0 ) || ( num_trip == 0 )){ continue; }
+      const int * trips = trip_list + trip_start[ irrep ];
+
+      double * A_pack = new double[ num_trip * num_ls ];
+      long long * row_offset = new long long[ num_trip ];
+      for ( int row = 0; row < num_trip; row++ ){
+         const int f0 = trips[ row ] % L;
+         const int f1 = ( trips[ row ] / L ) % L;
+         const int f2 = trips[ row ] / L2;
+         const long long base = f0 * power[ a_free[ 0 ] ] + f1 * power[ a_free[ 1 ] ] + f2 * power[ a_free[ 2 ] ];
+         for ( int ls = 0; ls < num_ls; ls++ ){ A_pack[ row + num_trip * ls ] = A[ base + ( start + ls ) * power[ a_ls ] ]; }
+         row_offset[ row ] = f0 * power[ a_out[ 0 ] ] + f1 * power[ a_out[ 1 ] ] + f2 * power[ a_out[ 2 ] ];
+      }
+
+      const int chunk      = (( num_trip < L ) ? num_trip : L );
+      const int num_chunks = ( num_trip + chunk - 1 ) / chunk;
+      #pragma omp parallel
+      {
+         double * B_pack = new double[ num_ls * chunk ];
+         double * C_pack = new double[ num_trip * chunk ];
+
+         #pragma omp for schedule(dynamic)
+         for ( int part = 0; part < num_chunks; part++ ){
+            const int first = part * chunk;
+            int num_cols = (( num_trip - first < chunk ) ? num_trip - first : chunk );
+            for ( int col = 0; col < num_cols; col++ ){
+               const int trip = trips[ first + col ];
+               const int base = ( trip % L ) + L2 * ( trip / L ); // b0 + L * ( ls + L * ( b1 + L * b2 ) ) with ls = 0
+               for ( int ls = 0; ls < num_ls; ls++ ){ B_pack[ ls + num_ls * col ] = B[ base + L * ( start + ls ) ]; }
+            }
+            dgemm_( &notrans, &notrans, &num_trip, &num_cols, &num_ls, &alpha, A_pack, &num_trip, B_pack, &num_ls, &zero, C_pack, &num_trip );
+            for ( int col = 0; col < num_cols; col++ ){
+               const int trip = trips[ first + col ];
+               const long long col_offset = ( trip % L ) * power[ b_out[ 0 ] ] + (( trip / L ) % L ) * power[ b_out[ 1 ] ] + ( trip / L2 ) * power[ b_out[ 2 ] ];
+               for ( int row = 0; row < num_trip; row++ ){ result[ row_offset[ row ] + col_offset ] += C_pack[ row + num_trip * col ]; }
+            }
+         }
+
+         delete [] B_pack;
+         delete [] C_pack;
+      }
+
+      delete [] A_pack;
+      delete [] row_offset;
+
+   }
+
+}
+
 double CheMPS2::Cumulant::lambda2_ham(const TwoDM * the2DM, const int i, const int j, const int p, const int q){
 
    const double value = the2DM->getTwoDMA_HAM( i, j, p, q )
@@ -90,9 +90,17 @@ CheMPS2::DMRG::DMRG( Problem * ProbIn, ConvergenceScheme * OptSchemeIn, const bo
    the2DM  = NULL;
    the3DM  = NULL;
    theCorr = NULL;
+   rdm_orbitals = NULL;
    Exc_activated = false;
+   fused_rdms_active = false;
+   fused_rdms_3rdm   = false;
+   fused_rdms_disk   = false;
+   fused_rdms_valid  = false;
    makecheckpoints = makechkpt;
    tempfolder = tmpfolder;
+   #ifdef CHEMPS2_MPI_COMPILATION
+   owners_balanced = false;
+   #endif
    
    setupBookkeeperAndMPS();
    PreSolve();
@@ -147,6 +155,9 @@ CheMPS2::DMRG::~DMRG(){
    if ( theCorr != NULL ){ delete theCorr; }
 
    deleteAllBoundaryOperators();
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( owners_balanced ){ MPIchemps2::release_owner_tables(); }
+   #endif
 
    delete [] Ltensors;
    delete [] F0tensors;
@@ -188,7 +199,11 @@ CheMPS2::DMRG::~DMRG(){
 
 void CheMPS2::DMRG::PreSolve(){
 
+   Prob->sync_mxelem(); // Changes by Prob->setMxElement() become visible to all MPI processes on the node
    deleteAllBoundaryOperators();
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( CheMPS2::DMRG_MPI_balanceOwners ){ balance_owners( false ); } // Only when no boundary operators are allocated
+   #endif
 
    for ( int cnt = 0; cnt < L - 2; cnt++ ){ updateMovingRightSafeFirstTime( cnt ); }
 
@@ -211,6 +226,10 @@ double CheMPS2::DMRG::Solve(){
 
    for ( int instruction = 0; instruction < OptScheme->get_number(); instruction++ ){
 
+      #ifdef CHEMPS2_MPI_COMPILATION
+      if (( CheMPS2::DMRG_MPI_balanceOwners ) && ( CheMPS2::DMRG_MPI_rebalanceOwners ) && ( instruction > 0 )){ balance_owners( true ); }
+      #endif
+
       int nIterations = 0;
       double EnergyPrevious = Energy + 10 * OptScheme->get_energy_conv( instruction ); // Guarantees that there's always at least 1 left-right sweep
 
@@ -235,15 +254,22 @@ double CheMPS2::DMRG::Solve(){
             print_tensor_update_performance();
             cout << "***     Minimum energy           = " << LastMinEnergy << endl;
             cout << "***     Maximum discarded weight = " << MaxDiscWeightLastSweep << endl;
-            if ( Exc_activated ){ calc_overlaps( false ); }
+         }
+         if ( Exc_activated ){ calc_overlaps( false ); } // All MPI processes: the overlaps are broadcasted by their owners
+         if ( am_i_master ){
             cout << "******************************************************************" << endl;
          }
          change = true; //rest of sweeps: variable virtual dimensions
+         /* In the last instruction, accumulate the RDMs during the right sweep which follows a converged left sweep, or during the last allowed right sweep.
+            This right sweep then always ends the instruction, so that the fused RDMs belong to the final MPS. */
+         const bool fuse_rdms = (( fused_rdms_active ) && ( instruction == OptScheme->get_number() - 1 )
+                              && (( nIterations + 1 == OptScheme->get_max_sweeps( instruction ) ) || ( fabs( Energy - EnergyPrevious ) <= OptScheme->get_energy_conv( instruction ) )));
+         fused_rdms_valid = false;
          for ( int timecnt = 0; timecnt < CHEMPS2_TIME_VECLENGTH; timecnt++ ){ timings[ timecnt ] = 0.0; }
          num_double_write_disk = 0;
          num_double_read_disk  = 0;
          gettimeofday( &start, NULL );
-         Energy = sweepright( change, instruction, am_i_master ); // Only relevant call in this block of code
+         Energy = sweepright( change, instruction, am_i_master, fuse_rdms ); // Only relevant call in this block of code
          gettimeofday( &end, NULL );
          elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
          if ( am_i_master ){
@@ -257,12 +283,15 @@ double CheMPS2::DMRG::Solve(){
             cout << "***     Minimum energy           = " << LastMinEnergy << endl;
             cout << "***     Maximum discarded weight = " << MaxDiscWeightLastSweep << endl;
             cout << "***     Energy difference with respect to previous leftright sweep = " << fabs(Energy-EnergyPrevious) << endl;
-            if ( Exc_activated ){ calc_overlaps( true ); }
+         }
+         if ( Exc_activated ){ calc_overlaps( true ); } // All MPI processes: the overlaps are broadcasted by their owners
+         if ( am_i_master ){
             cout << "******************************************************************" << endl;
             if ( makecheckpoints ){ saveMPS( MPSstoragename, MPS, denBK, false ); } // Only the master proc makes MPS checkpoints !!
          }
 
          nIterations++;
+         if ( fuse_rdms ){ break; }
 
       }
 
@@ -312,7 +341,7 @@ double CheMPS2::DMRG::sweepleft( const bool change, const int instruction, const
 
 }
 
-double CheMPS2::DMRG::sweepright( const bool change, const int instruction, const bool am_i_master ){
+double CheMPS2::DMRG::sweepright( const bool change, const int instruction, const bool am_i_master, const bool fuse_rdms ){
 
    double Energy = 0.0;
    const double noise_level = fabs( OptScheme->get_noise_prefactor( instruction ) ) * MaxDiscWeightLastSweep;
@@ -321,6 +350,8 @@ double CheMPS2::DMRG::sweepright( const bool change, const int instruction, cons
    MaxDiscWeightLastSweep = 0.0;
    LastMinEnergy = 1e8;
 
+   if ( fuse_rdms ){ fused_rdms_begin( am_i_master ); }
+
    for ( int index = 0; index < L - 2; index++ ){
 
       Energy = solve_site( index, dvdson_rtol, noise_level, vir_dimension, am_i_master, true, change );
@@ -333,12 +364,15 @@ double CheMPS2::DMRG::sweepright( const bool change, const int instruction, cons
       // Prepare for next step
       struct timeval start, end;
       gettimeofday( &start, NULL );
-      updateMovingRightSafe( index );
+      if ( fuse_rdms ){ fused_rdms_step( index ); }
+      else { updateMovingRightSafe( index ); }
       gettimeofday( &end, NULL );
       timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
 
    }
 
+   if ( fuse_rdms ){ fused_rdms_end( am_i_master ); }
+
    return Energy;
 
 }
@@ -354,7 +388,7 @@ double CheMPS2::DMRG::solve_site( const int index, const double dvdson_rtol, con
    gettimeofday( &end, NULL );
    timings[ CHEMPS2_TIME_S_JOIN ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
 
-   // Feed everything to the solver. Each MPI process returns the correct energy. Only MPI_CHEMPS2_MASTER has the correct denS solution.
+   // Feed everything to the solver. Each MPI process returns the correct energy and denS solution.
    gettimeofday( &start, NULL );
    Heff Solver( denBK, Prob, dvdson_rtol );
    double ** VeffTilde = NULL;
@@ -397,6 +431,7 @@ void CheMPS2::DMRG::newExcitation( const double EshiftIn ){
    if ( the2DM  != NULL ){ delete the2DM;  the2DM  = NULL; }
    if ( the3DM  != NULL ){ delete the3DM;  the3DM  = NULL; }
    if ( theCorr != NULL ){ delete theCorr; theCorr = NULL; }
+   fused_rdms_valid = false;
    deleteAllBoundaryOperators();
 
    Exc_Eshifts[ nStates - 1 ] = EshiftIn;
@@ -26,12 +26,14 @@
 #include <assert.h>
 #include <sys/time.h>
 #include <unistd.h>
+#include <climits>
 
 #include "DMRG.h"
 #include "Lapack.h"
 #include "Heff.h"
 #include "MPIchemps2.h"
 #include "Excitation.h"
+#include "Options.h"
 
 using std::cout;
 using std::endl;
@@ -44,6 +46,7 @@ void CheMPS2::DMRG::Symm4RDM( double * output, const int Y, const int Z, const b
    gettimeofday( &start, NULL );
 
    assert( the3DM != NULL );
+   assert( !( the3DM->is_distributed() ) ); // The index substitutions require the whole 3-RDM
 
    symm_4rdm_helper( output, Y, Z, 1.0, 1.0, false, 0.5 ); // output = 0.5 *   3rdm[ ( 1 + E_{YZ} + E_{ZY} ) | 0 > ]
    symm_4rdm_helper( output, Y, Z, 1.0, 0.0, true, -0.5 ); // output = 0.5 * ( 3rdm[ ( 1 + E_{YZ} + E_{ZY} ) | 0 > ] - 3rdm[ E_{YZ} + E_{ZY} | 0 > ] )
@@ -82,6 +85,148 @@ void CheMPS2::DMRG::Symm4RDM( double * output, const int Y, const int Z, const b
 
 }
 
+void CheMPS2::DMRG::Symm4RDM_fock( double * contract, const double * fock, const bool diagonal, const bool last_case ){
+
+   struct timeval start, end;
+   gettimeofday( &start, NULL );
+
+   assert( the3DM != NULL );
+
+   /* contract = sum_{Y <= Z} weight_{YZ} * Symm4RDM( Y, Z ) is linear in the Symm4RDM terms:
+         - The 3-RDMs of the perturbed wavefunctions are added with their weight straight into contract.
+         - The unperturbed 3-RDM terms of all orbital pairs are gathered in one pass with the matrix
+           subst[ a + L * b ] = weight_{ab} + weight_{ba}, which picks up all index substitutions. */
+   int * pair_orb1 = new int[ ( L * ( L + 1 ) ) / 2 ];
+   int * pair_orb2 = new int[ ( L * ( L + 1 ) ) / 2 ];
+   double * pair_weight = new double[ ( L * ( L + 1 ) ) / 2 ];
+   double * subst = new double[ L * L ];
+   for ( int cnt = 0; cnt < L * L; cnt++ ){ subst[ cnt ] = 0.0; }
+   double weight_sum = 0.0;
+   int num_pairs = 0;
+   for ( int ham_orb2 = 0; ham_orb2 < L; ham_orb2++ ){
+      const int irrep2 = Prob->gIrrep( ( Prob->gReorder() ) ? Prob->gf1( ham_orb2 ) : ham_orb2 );
+      for ( int ham_orb1 = (( diagonal ) ? ham_orb2 : 0 ); ham_orb1 <= ham_orb2; ham_orb1++ ){
+         const int irrep1 = Prob->gIrrep( ( Prob->gReorder() ) ? Prob->gf1( ham_orb1 ) : ham_orb1 );
+         const double weight = (( ham_orb1 == ham_orb2 ) ? 0.5 * fock[ ham_orb1 + L * ham_orb1 ] : 0.5 * ( fock[ ham_orb1 + L * ham_orb2 ] + fock[ ham_orb2 + L * ham_orb1 ] ));
+         if (( irrep1 == irrep2 ) && ( weight != 0.0 )){
+            pair_orb1[ num_pairs ] = ham_orb1;
+            pair_orb2[ num_pairs ] = ham_orb2;
+            pair_weight[ num_pairs ] = weight;
+            subst[ ham_orb1 + L * ham_orb2 ] += weight;
+            subst[ ham_orb2 + L * ham_orb1 ] += weight;
+            weight_sum += weight;
+            num_pairs++;
+         }
+      }
+   }
+
+   const long long tot_size = (( long long ) L ) * L * L * L * L * L;
+   for ( long long cnt = 0; cnt < tot_size; cnt++ ){ contract[ cnt ] = 0.0; }
+
+   /* With MPI, the orbital pairs are distributed over rank groups, which each evaluate their pairs
+      with their own communicator. The ownership of the renormalized operators is redistributed over
+      the processes of each group, which requires that no other DMRG object uses the ownership tables. */
+   int my_group   = 0;
+   int num_groups = 1;
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( MPIchemps2::communicator() == MPI_COMM_WORLD ){
+      num_groups = max( 1, min( min( CheMPS2::DMRG_MPI_symm4rdmRankGroups, MPIchemps2::mpi_size() ), num_pairs ) );
+      if ( MPIchemps2::owner_tables_users() > (( owners_balanced ) ? 1 : 0 ) ){ num_groups = 1; }
+   }
+   if ( num_groups > 1 ){
+      deleteAllBoundaryOperators(); // Operators are deleted with the ownership under which they were allocated
+      if ( owners_balanced ){
+         MPIchemps2::release_owner_tables();
+         owners_balanced = false;
+      }
+      my_group = MPIchemps2::split_rank_groups( num_groups );
+      if ( CheMPS2::DMRG_MPI_balanceOwners ){ balance_owners( false ); }
+   }
+   #endif
+
+   for ( int pair = my_group; pair < num_pairs; pair += num_groups ){
+      symm_4rdm_helper( contract, pair_orb1[ pair ], pair_orb2[ pair ], 1.0, 1.0, true,  0.5 * pair_weight[ pair ] ); // 0.5 * 3rdm[ ( 1 + E_{YZ} + E_{ZY} ) | 0 > ]
+      symm_4rdm_helper( contract, pair_orb1[ pair ], pair_orb2[ pair ], 1.0, 0.0, true, -0.5 * pair_weight[ pair ] ); // 0.5 * 3rdm[ ( E_{YZ} + E_{ZY} ) | 0 > ]
+   }
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( num_groups > 1 ){
+      deleteAllBoundaryOperators();
+      if ( owners_balanced ){
+         MPIchemps2::release_owner_tables();
+         owners_balanced = false;
+      }
+      if ( MPIchemps2::mpi_rank() != MPI_CHEMPS2_MASTER ){ // Each rank group contributes once
+         for ( long long cnt = 0; cnt < tot_size; cnt++ ){ contract[ cnt ] = 0.0; }
+      }
+      MPIchemps2::release_rank_groups();
+      if ( CheMPS2::DMRG_MPI_balanceOwners ){ balance_owners( false ); }
+      assert( tot_size <= INT_MAX );
+      MPIchemps2::allreduce_array_double_inplace( contract, tot_size );
+   }
+   #endif
+
+   /* Subtract the unperturbed 3-RDM terms of all orbital pairs at once. The terms are linear in the 3-RDM
+      elements: with distributed storage, each process subtracts the terms of its own slab, and the
+      partial contractions are summed. */
+   #ifdef CHEMPS2_MPI_COMPILATION
+   const bool distributed_3rdm = the3DM->is_distributed();
+   if (( distributed_3rdm ) && ( MPIchemps2::mpi_rank() != MPI_CHEMPS2_MASTER )){
+      for ( long long cnt = 0; cnt < tot_size; cnt++ ){ contract[ cnt ] = 0.0; }
+   }
+   #endif
+   #pragma omp parallel
+   {
+      int index[ 6 ];
+
+      #pragma omp for schedule(static)
+      for ( int combined = 0; combined < L * L; combined++ ){
+         index[ 4 ] = combined % L;
+         index[ 5 ] = combined / L;
+         for ( index[ 3 ] = 0; index[ 3 ] < L; index[ 3 ]++ ){
+            for ( index[ 2 ] = 0; index[ 2 ] < L; index[ 2 ]++ ){
+               for ( index[ 1 ] = 0; index[ 1 ] < L; index[ 1 ]++ ){
+                  for ( index[ 0 ] = 0; index[ 0 ] < L; index[ 0 ]++ ){
+                     double value = weight_sum * the3DM->get_slab_ham_index( index[ 0 ], index[ 1 ], index[ 2 ], index[ 3 ], index[ 4 ], index[ 5 ] );
+                     for ( int slot = 0; slot < 6; slot++ ){
+                        const int orig = index[ slot ];
+                        for ( int other = 0; other < L; other++ ){
+                           const double factor = subst[ orig + L * other ];
+                           if ( factor != 0.0 ){
+                              index[ slot ] = other;
+                              value += factor * the3DM->get_slab_ham_index( index[ 0 ], index[ 1 ], index[ 2 ], index[ 3 ], index[ 4 ], index[ 5 ] );
+                           }
+                        }
+                        index[ slot ] = orig;
+                     }
+                     contract[ index[ 0 ] + L * ( index[ 1 ] + L * ( index[ 2 ] + L * ( index[ 3 ] + L * combined ))) ] -= 0.5 * value;
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed_3rdm ){
+      assert( tot_size <= INT_MAX );
+      MPIchemps2::allreduce_array_double_inplace( contract, tot_size );
+   }
+   #endif
+
+   delete [] pair_orb1;
+   delete [] pair_orb2;
+   delete [] pair_weight;
+   delete [] subst;
+
+   if ( last_case ){ PreSolve(); } // Need to set up the renormalized operators again to continue sweeping
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   cout << "CheMPS2::DMRG::Symm4RDM_fock( " << num_pairs << " orbital pairs ) : Elapsed wall time = " << elapsed << " seconds." << endl;
+
+}
+
 void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const int ham_orb2, const double alpha, const double beta, const bool add, const double factor ){
 
    #ifdef CHEMPS2_MPI_COMPILATION
@@ -184,6 +329,7 @@ void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const
    delete [] tensor_3rdm_d_J1_doublet;
    delete [] tensor_3rdm_d_J1_quartet;
    if ( add ){
+      #pragma omp parallel for schedule(static)
       for ( int ham1 = 0; ham1 < L; ham1++ ){
          for ( int ham2 = 0; ham2 < L; ham2++ ){
             for ( int ham3 = 0; ham3 < L; ham3++ ){
@@ -198,6 +344,7 @@ void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const
          }
       }
    } else {
+      #pragma omp parallel for schedule(static)
       for ( int ham1 = 0; ham1 < L; ham1++ ){
          for ( int ham2 = 0; ham2 < L; ham2++ ){
             for ( int ham3 = 0; ham3 < L; ham3++ ){
@@ -89,7 +89,13 @@ void CheMPS2::DMRG::updateMovingRightSafe(const int cnt){
       isAllocated[cnt]=1;
    }
    updateMovingRight(cnt);
-   
+   updateMovingRightSafeDisk(cnt);
+
+}
+
+void CheMPS2::DMRG::updateMovingRightSafeDisk(const int cnt){
+
+   // Store and prefetch the boundary operators around cnt for the next step of a right sweep
    if (CheMPS2::DMRG_storeRenormOptrOnDisk){
       if (cnt>0){
          if (isAllocated[cnt-1]==1){
@@ -510,15 +516,16 @@ void CheMPS2::DMRG::updateMovingRight( const int index ){
       const int owner_absigma = MPIchemps2::owner_absigma( index, index );
       const int owner_cdf     = MPIchemps2::owner_cdf( L, index, index );
       const int Idiff         = 0; // Irreps::directProd( denBK->gIrrep( index ), denBK->gIrrep( index ) );
+      MPI_Request requests[ 4 ] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL }; // Q, A, C, D
 
       if ( owner_x != owner_q ){
          if ( owner_x == MPIRANK ){ Qtensors[ index - 1 ][ 0 ] = new TensorQ( index, denBK->gIrrep( index ), true, denBK, Prob, index ); }
-         if (( owner_x == MPIRANK ) || ( owner_q == MPIRANK )){ MPIchemps2::sendreceive_tensor( Qtensors[ index - 1 ][ 0 ], owner_q, owner_x, 3 * L + 3 ); }
+         if (( owner_x == MPIRANK ) || ( owner_q == MPIRANK )){ MPIchemps2::isendreceive_tensor( Qtensors[ index - 1 ][ 0 ], owner_q, owner_x, 3 * L + 3, requests + 0 ); }
       }
 
       if ( owner_x != owner_absigma ){
          if ( owner_x == MPIRANK ){ Atensors[ index - 1 ][ 0 ][ 0 ] = new TensorOperator( index, 0, 2, Idiff, true, true, false, denBK, denBK ); }
-         if (( owner_x == MPIRANK ) || ( owner_absigma == MPIRANK )){ MPIchemps2::sendreceive_tensor( Atensors[ index - 1 ][ 0 ][ 0 ], owner_absigma, owner_x, 3 * L + 4 ); }
+         if (( owner_x == MPIRANK ) || ( owner_absigma == MPIRANK )){ MPIchemps2::isendreceive_tensor( Atensors[ index - 1 ][ 0 ][ 0 ], owner_absigma, owner_x, 3 * L + 4, requests + 1 ); }
       }
 
       if ( owner_x != owner_cdf ){
@@ -527,11 +534,13 @@ void CheMPS2::DMRG::updateMovingRight( const int index ){
             Dtensors[ index - 1 ][ 0 ][ 0 ] = new TensorOperator( index, 2, 0, Idiff, true, true, false, denBK, denBK );
          }
          if (( owner_x == MPIRANK ) || ( owner_cdf == MPIRANK )){
-            MPIchemps2::sendreceive_tensor( Ctensors[ index - 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 5 );
-            MPIchemps2::sendreceive_tensor( Dtensors[ index - 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 6 );
+            MPIchemps2::isendreceive_tensor( Ctensors[ index - 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 5, requests + 2 );
+            MPIchemps2::isendreceive_tensor( Dtensors[ index - 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 6, requests + 3 );
          }
       }
 
+      MPIchemps2::wait_all( 4, requests );
+
       if ( owner_x == MPIRANK ){
       #endif
 
@@ -843,15 +852,16 @@ void CheMPS2::DMRG::updateMovingLeft( const int index ){
       const int owner_absigma = MPIchemps2::owner_absigma( index + 1, index + 1 );
       const int owner_cdf     = MPIchemps2::owner_cdf(  L, index + 1, index + 1 );
       const int Idiff         = 0; // Irreps::directProd( denBK->gIrrep( index + 1 ), denBK->gIrrep( index + 1 ) );
+      MPI_Request requests[ 4 ] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL }; // Q, A, C, D
 
       if ( owner_x != owner_q ){
          if ( owner_x == MPIRANK ){ Qtensors[ index + 1 ][ 0 ] = new TensorQ( index + 2, denBK->gIrrep( index + 1 ), false, denBK, Prob, index + 1 ); }
-         if (( owner_x == MPIRANK ) || ( owner_q == MPIRANK )){ MPIchemps2::sendreceive_tensor( Qtensors[ index + 1 ][ 0 ], owner_q, owner_x, 3 * L + 3 ); }
+         if (( owner_x == MPIRANK ) || ( owner_q == MPIRANK )){ MPIchemps2::isendreceive_tensor( Qtensors[ index + 1 ][ 0 ], owner_q, owner_x, 3 * L + 3, requests + 0 ); }
       }
 
       if ( owner_x != owner_absigma ){
          if ( owner_x == MPIRANK ){ Atensors[ index + 1 ][ 0 ][ 0 ] = new TensorOperator( index + 2, 0, 2, Idiff, false, true, false, denBK, denBK ); }
-         if (( owner_x == MPIRANK ) || ( owner_absigma == MPIRANK )){ MPIchemps2::sendreceive_tensor( Atensors[ index + 1 ][ 0 ][ 0 ], owner_absigma, owner_x, 3 * L + 4 ); }
+         if (( owner_x == MPIRANK ) || ( owner_absigma == MPIRANK )){ MPIchemps2::isendreceive_tensor( Atensors[ index + 1 ][ 0 ][ 0 ], owner_absigma, owner_x, 3 * L + 4, requests + 1 ); }
       }
 
       if ( owner_x != owner_cdf ){
@@ -860,11 +870,13 @@ void CheMPS2::DMRG::updateMovingLeft( const int index ){
             Dtensors[ index + 1 ][ 0 ][ 0 ] = new TensorOperator( index + 2, 2, 0, Idiff, false, false, false, denBK, denBK );
          }
          if (( owner_x == MPIRANK ) || ( owner_cdf == MPIRANK )){
-            MPIchemps2::sendreceive_tensor( Ctensors[ index + 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 5 );
-            MPIchemps2::sendreceive_tensor( Dtensors[ index + 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 6 );
+            MPIchemps2::isendreceive_tensor( Ctensors[ index + 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 5, requests + 2 );
+            MPIchemps2::isendreceive_tensor( Dtensors[ index + 1 ][ 0 ][ 0 ], owner_cdf, owner_x, 3 * L + 6, requests + 3 );
          }
       }
 
+      MPIchemps2::wait_all( 4, requests );
+
       if ( owner_x == MPIRANK ){
       #endif
 
@@ -1547,3 +1559,110 @@ void CheMPS2::DMRG::deleteStoredOperators(){
 
 }
 
+#ifdef CHEMPS2_MPI_COMPILATION
+double CheMPS2::DMRG::block_cost( const int boundary, const int delta_N, const int irrep_op ) const{
+
+   // Number of doubles in an operator with particle number change delta_N and symmetry irrep_op at a boundary
+   double num_elements = 0.0;
+   const int two_s_shift = ( delta_N % 2 == 0 ) ? 2 : 1;
+   for ( int N = denBK->gNmin( boundary ); N <= denBK->gNmax( boundary ); N++ ){
+      for ( int TwoS = denBK->gTwoSmin( boundary, N ); TwoS <= denBK->gTwoSmax( boundary, N ); TwoS += 2 ){
+         for ( int irrep = 0; irrep < denBK->getNumberOfIrreps(); irrep++ ){
+            const int dim_up = denBK->gCurrentDim( boundary, N, TwoS, irrep );
+            if ( dim_up > 0 ){
+               const int irrep_down = Irreps::directProd( irrep, irrep_op );
+               for ( int TwoSdown = TwoS - two_s_shift; TwoSdown <= TwoS + two_s_shift; TwoSdown += 2 ){
+                  num_elements += ((double) dim_up) * denBK->gCurrentDim( boundary, N + delta_N, TwoSdown, irrep_down );
+               }
+            }
+         }
+      }
+   }
+   return num_elements;
+
+}
+
+void CheMPS2::DMRG::balance_owners( const bool rebuild_operators ){
+
+   /* Cost model, based on the current virtual dimensions:
+         - Each boundary operator costs its number of elements, for both sweep directions.
+         - The complementary operators and the Q-tensors are built from all renormalized
+           operators on the other side of the boundary: their cost is multiplied with the
+           number of orbitals on that side.
+         - The X-tensors and the diagrams of the effective Hamiltonian which are not
+           assigned to an operator owner are always handled by MPI_CHEMPS2_MASTER.
+      All processes compute identical costs, and hence identical ownership tables. */
+
+   const int num_pairs = ( L * ( L + 1 ) ) / 2;
+   const int num_trios = ( L * ( L + 1 ) * ( L + 2 ) ) / 6;
+   double * cost_absigma = new double[ num_pairs ];
+   double * cost_cdf     = new double[ num_pairs ];
+   double * cost_q       = new double[ L ];
+   double * cost_3rdm    = new double[ num_trios ];
+   double   cost_master  = 0.0;
+   const int num_irreps  = denBK->getNumberOfIrreps();
+   double * size_op      = new double[ 3 * num_irreps ]; // size_op[ delta_N + 3 * irrep_op ]
+
+   for ( int pair = 0; pair < num_pairs; pair++ ){ cost_absigma[ pair ] = 0.0; cost_cdf[ pair ] = 0.0; }
+   for ( int orb  = 0; orb  < L;         orb++  ){ cost_q[ orb ] = 0.0; }
+   for ( int trio = 0; trio < num_trios; trio++ ){ cost_3rdm[ trio ] = 0.0; }
+
+   for ( int index = 0; index < L - 1; index++ ){ // Boundary index + 1 lies between the orbitals index and index + 1
+      const int boundary  = index + 1;
+      const int num_left  = index + 1;
+      const int num_right = L - 1 - index;
+      for ( int irrep_op = 0; irrep_op < num_irreps; irrep_op++ ){
+         for ( int delta_N = 0; delta_N < 3; delta_N++ ){ size_op[ delta_N + 3 * irrep_op ] = block_cost( boundary, delta_N, irrep_op ); }
+      }
+      cost_master += L * ( num_left + num_right ) * size_op[ 0 ];
+      for ( int orb2 = 0; orb2 < L; orb2++ ){
+         for ( int orb1 = 0; orb1 <= orb2; orb1++ ){
+            const int pair = orb1 + ( orb2 * ( orb2 + 1 ) ) / 2;
+            const int irrep_op = Irreps::directProd( denBK->gIrrep( orb1 ), denBK->gIrrep( orb2 ) );
+            const double size_cdf     = size_op[ 0 + 3 * irrep_op ];
+            const double size_absigma = size_op[ 2 + 3 * irrep_op ];
+            if ( orb2 <= index ){ // Moving right: regular operators; moving left: complementary operators
+               cost_cdf[ pair ]     += ( 1 + num_right ) * size_cdf;
+               cost_absigma[ pair ] += ( 1 + num_right ) * size_absigma;
+            }
+            if ( orb1 > index ){ // Moving right: complementary operators; moving left: regular operators
+               cost_cdf[ pair ]     += ( num_left + 1 ) * size_cdf;
+               cost_absigma[ pair ] += ( num_left + 1 ) * size_absigma;
+            }
+         }
+      }
+      for ( int orb = 0; orb < L; orb++ ){
+         cost_q[ orb ] += (( orb > index ) ? num_left : num_right ) * size_op[ 1 + 3 * denBK->gIrrep( orb ) ];
+      }
+      for ( int orb3 = 0; orb3 <= index; orb3++ ){ // The 3-RDM tensors of orbitals j <= k <= l live on boundaries l + 1 to L - 1
+         for ( int orb2 = 0; orb2 <= orb3; orb2++ ){
+            for ( int orb1 = 0; orb1 <= orb2; orb1++ ){
+               const int trio = orb1 + ( orb2 * ( orb2 + 1 ) ) / 2 + ( orb3 * ( orb3 + 1 ) * ( orb3 + 2 ) ) / 6;
+               const int irrep_op = Irreps::directProd( Irreps::directProd( denBK->gIrrep( orb1 ), denBK->gIrrep( orb2 ) ), denBK->gIrrep( orb3 ) );
+               cost_3rdm[ trio ] += size_op[ 1 + 3 * irrep_op ];
+            }
+         }
+      }
+   }
+
+   if ( owners_balanced ){
+      // Operators are deleted with the ownership under which they were allocated
+      if ( rebuild_operators ){ deleteAllBoundaryOperators(); }
+      MPIchemps2::rebalance_owner_tables( L, cost_absigma, cost_cdf, cost_q, cost_3rdm, cost_master );
+      if ( rebuild_operators ){
+         for ( int cnt = 0; cnt < L - 2; cnt++ ){ updateMovingRightSafeFirstTime( cnt ); }
+      }
+   } else {
+      MPIchemps2::acquire_owner_tables( L, cost_absigma, cost_cdf, cost_q, cost_3rdm, cost_master );
+      owners_balanced = true;
+   }
+
+   delete [] cost_absigma;
+   delete [] cost_cdf;
+   delete [] cost_q;
+   delete [] cost_3rdm;
+   delete [] size_op;
+
+}
+#endif
+
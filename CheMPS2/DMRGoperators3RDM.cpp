@@ -25,6 +25,30 @@
 #include "MPIchemps2.h"
 #include "Special.h"
 
+#ifdef CHEMPS2_MPI_COMPILATION
+/* Allocate the temporary duplicates of F_jk and S_jk at the boundary index on the processes which do not own them, and post
+   their broadcasts from the owners. The four requests should be completed with MPIchemps2::wait_all before the tensors are used. */
+static void ibroadcast_jk_duplicates( const int L, const int index, const int orb_j, const int orb_k, const CheMPS2::SyBookkeeper * denBK,
+                                      CheMPS2::TensorF0 **** F0tensors, CheMPS2::TensorF1 **** F1tensors, CheMPS2::TensorS0 **** S0tensors, CheMPS2::TensorS1 **** S1tensors, MPI_Request * requests ){
+
+   const int MPIRANK  = CheMPS2::MPIchemps2::mpi_rank();
+   const int irrjk    = CheMPS2::Irreps::directProd( denBK->gIrrep( orb_j ), denBK->gIrrep( orb_k ) );
+   const int cnt1     = orb_k - orb_j;
+   const int own_S_jk = CheMPS2::MPIchemps2::owner_absigma( orb_j, orb_k );
+   const int own_F_jk = CheMPS2::MPIchemps2::owner_cdf(  L, orb_j, orb_k );
+   if ( MPIRANK != own_F_jk ){ F0tensors[index-1][cnt1][index-orb_k-1] = new CheMPS2::TensorF0( index, irrjk, true, denBK );
+                               F1tensors[index-1][cnt1][index-orb_k-1] = new CheMPS2::TensorF1( index, irrjk, true, denBK ); }
+   if ( MPIRANK != own_S_jk ){ S0tensors[index-1][cnt1][index-orb_k-1] = new CheMPS2::TensorS0( index, irrjk, true, denBK );
+              if ( cnt1 > 0 ){ S1tensors[index-1][cnt1][index-orb_k-1] = new CheMPS2::TensorS1( index, irrjk, true, denBK ); }}
+   for ( int cnt = 0; cnt < 4; cnt++ ){ requests[ cnt ] = MPI_REQUEST_NULL; }
+                    CheMPS2::MPIchemps2::ibroadcast_tensor( F0tensors[index-1][cnt1][index-orb_k-1], own_F_jk, requests + 0 );
+                    CheMPS2::MPIchemps2::ibroadcast_tensor( F1tensors[index-1][cnt1][index-orb_k-1], own_F_jk, requests + 1 );
+                    CheMPS2::MPIchemps2::ibroadcast_tensor( S0tensors[index-1][cnt1][index-orb_k-1], own_S_jk, requests + 2 );
+   if ( cnt1 > 0 ){ CheMPS2::MPIchemps2::ibroadcast_tensor( S1tensors[index-1][cnt1][index-orb_k-1], own_S_jk, requests + 3 ); }
+
+}
+#endif
+
 void CheMPS2::DMRG::update_safe_3rdm_operators(const int boundary){
 
    /*
@@ -93,6 +117,23 @@ void CheMPS2::DMRG::update_3rdm_operators(const int boundary){
    const int dimR  = denBK->gMaxDimAtBound(boundary);
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
+
+   /* The (j,k) for which all processes need a duplicate of S_jk and F_jk. The broadcasts of these duplicates
+      are posted one (j,k) ahead, so that they are in flight while the operators of the current (j,k) are updated. */
+   int num_dupl = 0;
+   int * dupl_j = new int[ ( boundary * ( boundary + 1 ) ) / 2 + 1 ];
+   int * dupl_k = new int[ ( boundary * ( boundary + 1 ) ) / 2 + 1 ];
+   for ( int orb_j = 0; orb_j < boundary; orb_j++ ){
+      for ( int orb_k = orb_j; orb_k < boundary; orb_k++ ){
+         if (( orb_k < index-1 ) && ( rdm_orbitals_requested( orb_j, orb_k, index ) )){ // All processes own Fx/Sx[ index - 1 ][ k - j ][ index - 1 - k == 0 ]
+            dupl_j[ num_dupl ] = orb_j;
+            dupl_k[ num_dupl ] = orb_k;
+            num_dupl++;
+         }
+      }
+   }
+   MPI_Request requests[ 8 ]; // Two sets of four: the current and the next (j,k)
+   if ( num_dupl > 0 ){ ibroadcast_jk_duplicates( L, index, dupl_j[ 0 ], dupl_k[ 0 ], denBK, F0tensors, F1tensors, S0tensors, S1tensors, requests ); }
    #endif
 
    #pragma omp parallel
@@ -104,25 +145,21 @@ void CheMPS2::DMRG::update_3rdm_operators(const int boundary){
 /* Strategy for MPI:
      - outer loop is (j,k)
      - everyone has a temporary duplicate of S_jk and F_jk
+     - the broadcast of the duplicates of the next (j,k) overlaps with the work of the current (j,k)
 */
+      int dupl_cnt = 0; // Same value on all threads
       for ( int orb_j = 0; orb_j < boundary; orb_j++ ){
          for ( int orb_k = orb_j; orb_k < boundary; orb_k++ ){
             
-            const int irrjk = Irreps::directProd( denBK->gIrrep( orb_j ), denBK->gIrrep( orb_k ) );
-            const int cnt1  = orb_k - orb_j;
+            const int cnt1 = orb_k - orb_j;
+            const bool duplicate = (( dupl_cnt < num_dupl ) && ( dupl_j[ dupl_cnt ] == orb_j ) && ( dupl_k[ dupl_cnt ] == orb_k ));
             
             #pragma omp single
-            if ( orb_k < index-1 ){ // All processes own Fx/Sx[ index - 1 ][ k - j ][ index - 1 - k == 0 ]
-               const int own_S_jk = MPIchemps2::owner_absigma( orb_j, orb_k );
-               const int own_F_jk = MPIchemps2::owner_cdf(  L, orb_j, orb_k );
-               if ( MPIRANK != own_F_jk ){ F0tensors[index-1][cnt1][index-orb_k-1] = new TensorF0( index, irrjk, true, denBK );
-                                           F1tensors[index-1][cnt1][index-orb_k-1] = new TensorF1( index, irrjk, true, denBK ); }
-               if ( MPIRANK != own_S_jk ){ S0tensors[index-1][cnt1][index-orb_k-1] = new TensorS0( index, irrjk, true, denBK );
-                          if ( cnt1 > 0 ){ S1tensors[index-1][cnt1][index-orb_k-1] = new TensorS1( index, irrjk, true, denBK ); }}
-                                MPIchemps2::broadcast_tensor( F0tensors[index-1][cnt1][index-orb_k-1], own_F_jk );
-                                MPIchemps2::broadcast_tensor( F1tensors[index-1][cnt1][index-orb_k-1], own_F_jk );
-                                MPIchemps2::broadcast_tensor( S0tensors[index-1][cnt1][index-orb_k-1], own_S_jk );
-               if ( cnt1 > 0 ){ MPIchemps2::broadcast_tensor( S1tensors[index-1][cnt1][index-orb_k-1], own_S_jk ); }
+            if ( duplicate ){
+               MPIchemps2::wait_all( 4, requests + 4 * ( dupl_cnt % 2 ) );
+               if ( dupl_cnt + 1 < num_dupl ){
+                  ibroadcast_jk_duplicates( L, index, dupl_j[ dupl_cnt + 1 ], dupl_k[ dupl_cnt + 1 ], denBK, F0tensors, F1tensors, S0tensors, S1tensors, requests + 4 * ( ( dupl_cnt + 1 ) % 2 ) );
+               }
             }
          
             #pragma omp for schedule(dynamic)
@@ -150,6 +187,7 @@ void CheMPS2::DMRG::update_3rdm_operators(const int boundary){
 #endif //######( loop j<=k<=l MPI )######//
 
          /* PERFORM THE UPDATES */
+         if ( !rdm_orbitals_requested( orb_j, orb_k, orb_l ) ){ continue; } // Not allocated
          if ( cnt3 == 0 ){ // Create tensors
             if ( cnt2 > 0 ){
                             tensor_3rdm_a_J0_doublet[index][cnt1][cnt2][0]->a1(S0tensors[index-1][cnt1][cnt2-1], MPS[index], workmem);
@@ -199,7 +237,7 @@ void CheMPS2::DMRG::update_3rdm_operators(const int boundary){
             }
 
             #pragma omp single
-            if ( orb_k < index - 1 ){ // All processes own Fx/Sx[ index - 1 ][ k - j ][ index - 1 - k == 0 ]
+            if ( duplicate ){
                const int own_S_jk = MPIchemps2::owner_absigma( orb_j, orb_k );
                const int own_F_jk = MPIchemps2::owner_cdf(  L, orb_j, orb_k );
                if ( MPIRANK != own_F_jk ){ delete F0tensors[index-1][cnt1][index-orb_k-1]; F0tensors[index-1][cnt1][index-orb_k-1] = NULL;
@@ -207,6 +245,7 @@ void CheMPS2::DMRG::update_3rdm_operators(const int boundary){
                if ( MPIRANK != own_S_jk ){ delete S0tensors[index-1][cnt1][index-orb_k-1]; S0tensors[index-1][cnt1][index-orb_k-1] = NULL;
                           if ( cnt1 > 0 ){ delete S1tensors[index-1][cnt1][index-orb_k-1]; S1tensors[index-1][cnt1][index-orb_k-1] = NULL; }}
             }
+            if ( duplicate ){ dupl_cnt++; }
          }
       }
       
@@ -218,6 +257,10 @@ void CheMPS2::DMRG::update_3rdm_operators(const int boundary){
 
       delete [] workmem;
    }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   delete [] dupl_j;
+   delete [] dupl_k;
+   #endif
    
    gettimeofday(&end, NULL);
    timings[ CHEMPS2_TIME_TENS_CALC ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
@@ -285,7 +328,9 @@ void CheMPS2::DMRG::allocate_3rdm_operators(const int boundary){
             const int irr   = Irreps::directProd( Irreps::directProd( denBK->gIrrep( orb_j ), denBK->gIrrep( orb_k ) ), denBK->gIrrep( orb_l ) );
             
             #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK ){
+            if (( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK ) && ( rdm_orbitals_requested( orb_j, orb_k, orb_l ) )){
+            #else
+            if ( rdm_orbitals_requested( orb_j, orb_k, orb_l ) ){
             #endif
                tensor_3rdm_a_J0_doublet[index][cnt1][cnt2][cnt3] = (cnt1+cnt2>0) ? new Tensor3RDM(boundary, 0, 1, 3, irr, true,  denBK) : NULL; // NOT j == k == l
                tensor_3rdm_a_J1_doublet[index][cnt1][cnt2][cnt3] = (cnt1>0)      ? new Tensor3RDM(boundary, 2, 1, 3, irr, true,  denBK) : NULL; //     j <  k <= l
@@ -299,7 +344,6 @@ void CheMPS2::DMRG::allocate_3rdm_operators(const int boundary){
                tensor_3rdm_d_J0_doublet[index][cnt1][cnt2][cnt3] =                 new Tensor3RDM(boundary, 0, 1, 1, irr, false, denBK);        //     j <= k <= l
                tensor_3rdm_d_J1_doublet[index][cnt1][cnt2][cnt3] =                 new Tensor3RDM(boundary, 2, 1, 1, irr, false, denBK);        //     j <= k <= l
                tensor_3rdm_d_J1_quartet[index][cnt1][cnt2][cnt3] = (cnt2>0)      ? new Tensor3RDM(boundary, 2, 3, 1, irr, false, denBK) : NULL; //     j <= k <  l
-            #ifdef CHEMPS2_MPI_COMPILATION
             } else {
                tensor_3rdm_a_J0_doublet[index][cnt1][cnt2][cnt3] = NULL;
                tensor_3rdm_a_J1_doublet[index][cnt1][cnt2][cnt3] = NULL;
@@ -314,7 +358,6 @@ void CheMPS2::DMRG::allocate_3rdm_operators(const int boundary){
                tensor_3rdm_d_J1_doublet[index][cnt1][cnt2][cnt3] = NULL;
                tensor_3rdm_d_J1_quartet[index][cnt1][cnt2][cnt3] = NULL;
             }
-            #endif
          
          }
       }
@@ -418,45 +461,64 @@ void CheMPS2::DMRG::update_correlations_tensors(const int siteindex){
 
    const int dimL = denBK->gMaxDimAtBound(siteindex-1);
    const int dimR = denBK->gMaxDimAtBound(siteindex);
-   double * workmemLR = new double[dimL*dimR];
-   
-   for ( int previousindex = 0; previousindex < siteindex-1; previousindex++ ){
-   
-      gettimeofday(&start, NULL);
-      TensorGYZ * newG = new TensorGYZ(siteindex, 'G', denBK);
-      TensorGYZ * newY = new TensorGYZ(siteindex, 'Y', denBK);
-      TensorGYZ * newZ = new TensorGYZ(siteindex, 'Z', denBK);
-      TensorKM  * newK = new TensorKM( siteindex, 'K', denBK->gIrrep(previousindex), denBK );
-      TensorKM  * newM = new TensorKM( siteindex, 'M', denBK->gIrrep(previousindex), denBK );
-      gettimeofday(&end, NULL);
-      timings[ CHEMPS2_TIME_TENS_ALLOC ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
-
-      gettimeofday(&start, NULL);
-      newG->update(Gtensors[previousindex], MPS[siteindex-1], MPS[siteindex-1], workmemLR);
-      newY->update(Ytensors[previousindex], MPS[siteindex-1], MPS[siteindex-1], workmemLR);
-      newZ->update(Ztensors[previousindex], MPS[siteindex-1], MPS[siteindex-1], workmemLR);
-      newK->update(Ktensors[previousindex], MPS[siteindex-1], MPS[siteindex-1], workmemLR);
-      newM->update(Mtensors[previousindex], MPS[siteindex-1], MPS[siteindex-1], workmemLR);
-      gettimeofday(&end, NULL);
-      timings[ CHEMPS2_TIME_TENS_CALC ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
-      
-      gettimeofday(&start, NULL);
-      delete Gtensors[previousindex];
-      delete Ytensors[previousindex];
-      delete Ztensors[previousindex];
-      delete Ktensors[previousindex];
-      delete Mtensors[previousindex];
-      gettimeofday(&end, NULL);
-      timings[ CHEMPS2_TIME_TENS_FREE ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
-      
-      Gtensors[previousindex] = newG;
-      Ytensors[previousindex] = newY;
-      Ztensors[previousindex] = newZ;
-      Ktensors[previousindex] = newK;
-      Mtensors[previousindex] = newM;
-      
+   const int num_prev = siteindex - 1;
+
+   gettimeofday(&start, NULL);
+   TensorGYZ ** newG = new TensorGYZ*[ num_prev ];
+   TensorGYZ ** newY = new TensorGYZ*[ num_prev ];
+   TensorGYZ ** newZ = new TensorGYZ*[ num_prev ];
+   TensorKM  ** newK = new TensorKM *[ num_prev ];
+   TensorKM  ** newM = new TensorKM *[ num_prev ];
+   for ( int previousindex = 0; previousindex < num_prev; previousindex++ ){
+      newG[ previousindex ] = new TensorGYZ( siteindex, 'G', denBK );
+      newY[ previousindex ] = new TensorGYZ( siteindex, 'Y', denBK );
+      newZ[ previousindex ] = new TensorGYZ( siteindex, 'Z', denBK );
+      newK[ previousindex ] = new TensorKM(  siteindex, 'K', denBK->gIrrep( previousindex ), denBK );
+      newM[ previousindex ] = new TensorKM(  siteindex, 'M', denBK->gIrrep( previousindex ), denBK );
+   }
+   gettimeofday(&end, NULL);
+   timings[ CHEMPS2_TIME_TENS_ALLOC ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
+
+   // The updates for different previousindex are independent: one work array per thread
+   gettimeofday(&start, NULL);
+   #pragma omp parallel
+   {
+      double * workmemLR = new double[ dimL * dimR ];
+
+      #pragma omp for schedule(dynamic)
+      for ( int previousindex = 0; previousindex < num_prev; previousindex++ ){
+         newG[ previousindex ]->update( Gtensors[ previousindex ], MPS[ siteindex - 1 ], MPS[ siteindex - 1 ], workmemLR );
+         newY[ previousindex ]->update( Ytensors[ previousindex ], MPS[ siteindex - 1 ], MPS[ siteindex - 1 ], workmemLR );
+         newZ[ previousindex ]->update( Ztensors[ previousindex ], MPS[ siteindex - 1 ], MPS[ siteindex - 1 ], workmemLR );
+         newK[ previousindex ]->update( Ktensors[ previousindex ], MPS[ siteindex - 1 ], MPS[ siteindex - 1 ], workmemLR );
+         newM[ previousindex ]->update( Mtensors[ previousindex ], MPS[ siteindex - 1 ], MPS[ siteindex - 1 ], workmemLR );
+      }
+
+      delete [] workmemLR;
    }
-   delete [] workmemLR;
+   gettimeofday(&end, NULL);
+   timings[ CHEMPS2_TIME_TENS_CALC ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
+
+   gettimeofday(&start, NULL);
+   for ( int previousindex = 0; previousindex < num_prev; previousindex++ ){
+      delete Gtensors[ previousindex ];
+      delete Ytensors[ previousindex ];
+      delete Ztensors[ previousindex ];
+      delete Ktensors[ previousindex ];
+      delete Mtensors[ previousindex ];
+      Gtensors[ previousindex ] = newG[ previousindex ];
+      Ytensors[ previousindex ] = newY[ previousindex ];
+      Ztensors[ previousindex ] = newZ[ previousindex ];
+      Ktensors[ previousindex ] = newK[ previousindex ];
+      Mtensors[ previousindex ] = newM[ previousindex ];
+   }
+   delete [] newG;
+   delete [] newY;
+   delete [] newZ;
+   delete [] newK;
+   delete [] newM;
+   gettimeofday(&end, NULL);
+   timings[ CHEMPS2_TIME_TENS_FREE ] += (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
    
    gettimeofday(&start, NULL);
    Gtensors[siteindex-1] = new TensorGYZ(siteindex, 'G', denBK);
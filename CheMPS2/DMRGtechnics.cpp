@@ -36,8 +36,27 @@
 
 using std::cout;
 using std::endl;
+using std::string;
 
-void CheMPS2::DMRG::calc_rdms_and_correlations( const bool do_3rdm ){
+void CheMPS2::DMRG::calc_rdms_and_correlations( const bool do_3rdm, const bool disk_3rdm ){
+
+   RDMrequest request( L );
+   request.set_3rdm( do_3rdm, disk_3rdm );
+   calc_rdms_and_correlations( &request );
+
+}
+
+void CheMPS2::DMRG::calc_rdms_and_correlations( const RDMrequest * request ){
+
+   assert( request->gL() == L );
+   const bool do_3rdm   = request->get_3rdm();
+   const bool disk_3rdm = request->get_3rdm_disk();
+   const bool do_corr   = request->get_correlations();
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const bool distribute_3rdm = (( do_3rdm ) && ( request->get_3rdm_distributed() ));
+   #else
+      const bool distribute_3rdm = false;
+   #endif
 
    #ifdef CHEMPS2_MPI_COMPILATION
       const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
@@ -52,65 +71,72 @@ void CheMPS2::DMRG::calc_rdms_and_correlations( const bool do_3rdm ){
    struct timeval start_global, end_global, start_part, end_part;
    gettimeofday( &start_global, NULL );
 
+   // The RDMs accumulated during the last right sweep of Solve() can be reused
+   const bool fused = (( fused_rdms_valid ) && (( !do_3rdm ) || (( fused_rdms_3rdm ) && ( the3DM != NULL ) && (( distribute_3rdm ) || ( !( the3DM->is_distributed() ))))));
+   if (( fused ) && ( !do_3rdm ) && ( the3DM != NULL )){ delete the3DM; the3DM = NULL; fused_rdms_3rdm = false; }
+
    // Get the whole MPS into left-canonical form
-   gettimeofday( &start_part, NULL );
-   left_normalize( L - 2, am_i_master, true  );
-   left_normalize( L - 1, am_i_master, false );
-   gettimeofday( &end_part, NULL );
-   timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+   if ( !fused ){
+      gettimeofday( &start_part, NULL );
+      left_normalize( L - 2, am_i_master, true  );
+      left_normalize( L - 1, am_i_master, false );
+      gettimeofday( &end_part, NULL );
+      timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+   }
 
+   const string what = (( do_3rdm ) ? (( do_corr ) ? "2-RDM, 3-RDM, and Correlations" : "2-RDM and 3-RDM" )
+                                    : (( do_corr ) ? "2-RDM and Correlations" : "2-RDM" ));
    if ( am_i_master ){
-      if ( do_3rdm ){
-         cout << "****************************************************" << endl;
-         cout << "***  2-RDM, 3-RDM, and Correlations calculation  ***" << endl;
-         cout << "****************************************************" << endl;
-      } else {
-         cout << "********************************************" << endl;
-         cout << "***  2-RDM and Correlations calculation  ***" << endl;
-         cout << "********************************************" << endl;
-      }
+      cout << string( what.length() + 22, '*' ) << endl;
+      cout << "***  " << what << " calculation  ***" << endl;
+      cout << string( what.length() + 22, '*' ) << endl;
+      if ( fused ){ cout << "   Reusing the RDMs accumulated during the last right sweep" << endl; }
    }
 
-   // Make the renormalized operators one site further ( one-dot )
-   gettimeofday( &start_part, NULL );
-   updateMovingRightSafe( L - 2 );
-   gettimeofday( &end_part, NULL );
-   timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
-
-   // Calculate the 2DM
-   if ( the2DM != NULL ){ delete the2DM; the2DM = NULL; }
-   the2DM = new TwoDM( denBK, Prob );
-
-   for ( int siteindex = L - 1; siteindex >= 0; siteindex-- ){
+   if ( !fused ){
 
+      // Make the renormalized operators one site further ( one-dot )
       gettimeofday( &start_part, NULL );
-      // Specific 2-RDM entries are internally added per MPI processes; after which an allreduce is called
-      the2DM->FillSite( MPS[ siteindex ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors );
+      updateMovingRightSafe( L - 2 );
       gettimeofday( &end_part, NULL );
-      timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
 
-      if ( siteindex > 0 ){
+      // Calculate the 2DM
+      if ( the2DM != NULL ){ delete the2DM; the2DM = NULL; }
+      the2DM = new TwoDM( denBK, Prob );
 
-         gettimeofday( &start_part, NULL );
-         right_normalize( siteindex, am_i_master, true );
-         gettimeofday( &end_part, NULL );
-         timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      for ( int siteindex = L - 1; siteindex >= 0; siteindex-- ){
 
          gettimeofday( &start_part, NULL );
-         updateMovingLeftSafe2DM( siteindex - 1 );
+         // Specific 2-RDM entries are internally added per MPI processes; after which an allreduce is called
+         the2DM->FillSite( MPS[ siteindex ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors );
          gettimeofday( &end_part, NULL );
-         timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+         timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+         if ( siteindex > 0 ){
+
+            gettimeofday( &start_part, NULL );
+            right_normalize( siteindex, am_i_master, true );
+            gettimeofday( &end_part, NULL );
+            timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+            gettimeofday( &start_part, NULL );
+            updateMovingLeftSafe2DM( siteindex - 1 );
+            gettimeofday( &end_part, NULL );
+            timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+         }
       }
-   }
 
-   #ifdef CHEMPS2_MPI_COMPILATION
-   gettimeofday( &start_part, NULL );
-   the2DM->mpi_allreduce();
-   gettimeofday( &end_part, NULL );
-   timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
-   #endif
+      #ifdef CHEMPS2_MPI_COMPILATION
+      gettimeofday( &start_part, NULL );
+      the2DM->mpi_allreduce();
+      gettimeofday( &end_part, NULL );
+      timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      #endif
 
-   the2DM->correct_higher_multiplicities();
+      the2DM->correct_higher_multiplicities();
+
+   }
 
    // Trace, energy, and NOON
    if ( am_i_master ){
@@ -121,100 +147,195 @@ void CheMPS2::DMRG::calc_rdms_and_correlations( const bool do_3rdm ){
    }
 
    // Calculate the 3DM and Correlations
-   if ( the3DM  != NULL ){ delete the3DM;  the3DM  = NULL; }
+   if (( the3DM != NULL ) && ( !fused )){ delete the3DM; the3DM = NULL; }
    if ( theCorr != NULL ){ delete theCorr; theCorr = NULL; }
-   if ( do_3rdm ){ the3DM = new ThreeDM( denBK, Prob ); }
-   theCorr = new Correlations( denBK, Prob, the2DM );
-   if ( am_i_master ){
+   if (( do_3rdm ) && ( !fused )){
+      the3DM = new ThreeDM( denBK, Prob, disk_3rdm, tempfolder );
+      if ( !( request->all_orbitals() )){ // Only the renormalized operators of orbital triples in the subset are constructed
+         rdm_orbitals = new bool[ L ];
+         for ( int ham_orb = 0; ham_orb < L; ham_orb++ ){
+            rdm_orbitals[ (( Prob->gReorder() ) ? Prob->gf1( ham_orb ) : ham_orb ) ] = request->get_orbital( ham_orb );
+         }
+         the3DM->set_orbital_subset( rdm_orbitals );
+      }
+   }
+   if ( do_corr ){ theCorr = new Correlations( denBK, Prob, the2DM ); }
+   if (( am_i_master ) && ( do_corr ) && ( !fused )){
       Gtensors = new TensorGYZ*[ L - 1 ];
       Ytensors = new TensorGYZ*[ L - 1 ];
       Ztensors = new TensorGYZ*[ L - 1 ];
       Ktensors = new TensorKM *[ L - 1 ];
       Mtensors = new TensorKM *[ L - 1 ];
    }
-   if ( do_3rdm ){
-      tensor_3rdm_a_J0_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_a_J1_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_a_J1_quartet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_b_J0_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_b_J1_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_b_J1_quartet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_c_J0_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_c_J1_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_c_J1_quartet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_d_J0_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_d_J1_doublet = new Tensor3RDM****[ L - 1 ];
-      tensor_3rdm_d_J1_quartet = new Tensor3RDM****[ L - 1 ];
-
-      // Calculate the leftmost site contribution to the 3-RDM
-      gettimeofday( &start_part, NULL );
-      the3DM->fill_site( MPS[ 0 ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors,
-                         NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL );
-      gettimeofday( &end_part, NULL );
-      timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
-   }
 
-   for ( int siteindex = 1; siteindex < L; siteindex++ ){
+   if (( fused ) && ( do_corr )){
+
+      /* The Correlations only require the MPS: bring the center to site 0 and walk it back to the right,
+         without updating the renormalized operators. This is done on a copy of the MPS, so that the
+         renormalized operators of the sweeps remain valid for the original one. */
+      TensorT ** MPS_sweeps = MPS;
+      MPS = new TensorT*[ L ];
+      for ( int siteindex = 0; siteindex < L; siteindex++ ){ MPS[ siteindex ] = new TensorT( *( MPS_sweeps[ siteindex ] ) ); }
 
-      // Change MPS gauge
       gettimeofday( &start_part, NULL );
-      left_normalize( siteindex - 1, am_i_master, true );
+      for ( int siteindex = L - 1; siteindex > 0; siteindex-- ){ right_normalize( siteindex, am_i_master, true ); }
       gettimeofday( &end_part, NULL );
       timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
 
-      // Update 2-RDM, 3-RDM, and Correlations tensors
+      fill_correlations_moving_right( am_i_master );
+
+      for ( int siteindex = 0; siteindex < L; siteindex++ ){ delete MPS[ siteindex ]; }
+      delete [] MPS;
+      MPS = MPS_sweeps;
+
+   } else if ( !fused ){
+
+      if ( do_3rdm ){
+         allocate_3rdm_arrays();
+
+         // Calculate the leftmost site contribution to the 3-RDM
+         gettimeofday( &start_part, NULL );
+         the3DM->fill_site( MPS[ 0 ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors,
+                            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL );
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      }
+
+      for ( int siteindex = 1; siteindex < L; siteindex++ ){
+
+         // Change MPS gauge
+         gettimeofday( &start_part, NULL );
+         left_normalize( siteindex - 1, am_i_master, true );
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+         // Update 2-RDM, 3-RDM, and Correlations tensors
+         gettimeofday( &start_part, NULL );
+         if ( do_3rdm ){ update_safe_3rdm_operators( siteindex ); }
+         updateMovingRightSafe2DM( siteindex - 1 );
+         if (( am_i_master ) && ( do_corr )){ update_correlations_tensors( siteindex ); }
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+         // Calculate Correlation and 3-RDM diagrams. Specific contributions per MPI process. Afterwards an MPI allreduce/bcast is required.
+         gettimeofday( &start_part, NULL );
+         if (( am_i_master ) && ( do_corr )){ theCorr->FillSite( MPS[ siteindex ], Gtensors, Ytensors, Ztensors, Ktensors, Mtensors ); }
+         if ( do_3rdm ){ the3DM->fill_site( MPS[ siteindex ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors,
+                                            tensor_3rdm_a_J0_doublet[ siteindex - 1 ], tensor_3rdm_a_J1_doublet[ siteindex - 1 ], tensor_3rdm_a_J1_quartet[ siteindex - 1 ],
+                                            tensor_3rdm_b_J0_doublet[ siteindex - 1 ], tensor_3rdm_b_J1_doublet[ siteindex - 1 ], tensor_3rdm_b_J1_quartet[ siteindex - 1 ],
+                                            tensor_3rdm_c_J0_doublet[ siteindex - 1 ], tensor_3rdm_c_J1_doublet[ siteindex - 1 ], tensor_3rdm_c_J1_quartet[ siteindex - 1 ],
+                                            tensor_3rdm_d_J0_doublet[ siteindex - 1 ], tensor_3rdm_d_J1_doublet[ siteindex - 1 ], tensor_3rdm_d_J1_quartet[ siteindex - 1 ] ); }
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      }
+
+      // Delete the renormalized operators from boundary L-2 and load the ones from boundary L-3
       gettimeofday( &start_part, NULL );
-      if ( do_3rdm ){ update_safe_3rdm_operators( siteindex ); }
-      updateMovingRightSafe2DM( siteindex - 1 );
-      if ( am_i_master ){ update_correlations_tensors( siteindex ); }
+      assert( isAllocated[ L - 2 ] == 1 );                      // Renormalized operators exist on the last boundary (L-2) and are moving to the right.
+      assert( isAllocated[ L - 3 ] == 0 );                      // Renormalized operators do not exist on boundary L-3.
+        deleteTensors( L - 2, true ); isAllocated[ L - 2 ] = 0; // Delete the renormalized operators on the last boundary (L-2).
+      allocateTensors( L - 3, true ); isAllocated[ L - 3 ] = 1; // Create the renormalized operators on boundary L-3.
+      OperatorsOnDisk( L - 3, true, false );                    // Load the renormalized operators on boundary L-3.
       gettimeofday( &end_part, NULL );
       timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
 
-      // Calculate Correlation and 3-RDM diagrams. Specific contributions per MPI process. Afterwards an MPI allreduce/bcast is required.
+      #ifdef CHEMPS2_MPI_COMPILATION
       gettimeofday( &start_part, NULL );
-      if ( am_i_master ){ theCorr->FillSite( MPS[ siteindex ], Gtensors, Ytensors, Ztensors, Ktensors, Mtensors ); }
-      if ( do_3rdm ){ the3DM->fill_site( MPS[ siteindex ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors,
-                                         tensor_3rdm_a_J0_doublet[ siteindex - 1 ], tensor_3rdm_a_J1_doublet[ siteindex - 1 ], tensor_3rdm_a_J1_quartet[ siteindex - 1 ],
-                                         tensor_3rdm_b_J0_doublet[ siteindex - 1 ], tensor_3rdm_b_J1_doublet[ siteindex - 1 ], tensor_3rdm_b_J1_quartet[ siteindex - 1 ],
-                                         tensor_3rdm_c_J0_doublet[ siteindex - 1 ], tensor_3rdm_c_J1_doublet[ siteindex - 1 ], tensor_3rdm_c_J1_quartet[ siteindex - 1 ],
-                                         tensor_3rdm_d_J0_doublet[ siteindex - 1 ], tensor_3rdm_d_J1_doublet[ siteindex - 1 ], tensor_3rdm_d_J1_quartet[ siteindex - 1 ] ); }
+      if (do_corr){ theCorr->mpi_broadcast(); }
+      if (do_3rdm){
+         if ( distribute_3rdm ){ the3DM->mpi_distribute( true ); } // Every process keeps one summed slab
+         else { the3DM->mpi_allreduce(); }
+      }
       gettimeofday( &end_part, NULL );
       timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      #endif
+
+      if ( do_3rdm ){
+         the3DM->correct_higher_multiplicities();
+         delete_3rdm_operators( L - 1 );
+         delete_3rdm_arrays();
+      }
+      if ( rdm_orbitals != NULL ){ delete [] rdm_orbitals; rdm_orbitals = NULL; }
+
    }
 
-   // Delete the renormalized operators from boundary L-2 and load the ones from boundary L-3
-   gettimeofday( &start_part, NULL );
-   assert( isAllocated[ L - 2 ] == 1 );                      // Renormalized operators exist on the last boundary (L-2) and are moving to the right.
-   assert( isAllocated[ L - 3 ] == 0 );                      // Renormalized operators do not exist on boundary L-3.
-     deleteTensors( L - 2, true ); isAllocated[ L - 2 ] = 0; // Delete the renormalized operators on the last boundary (L-2).
-   allocateTensors( L - 3, true ); isAllocated[ L - 3 ] = 1; // Create the renormalized operators on boundary L-3.
-   OperatorsOnDisk( L - 3, true, false );                    // Load the renormalized operators on boundary L-3.
-   gettimeofday( &end_part, NULL );
-   timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+   if (( am_i_master ) && ( do_corr ) && ( !fused )){
+      for ( int previousindex = 0; previousindex < L - 1; previousindex++ ){
+         delete Gtensors[ previousindex ];
+         delete Ytensors[ previousindex ];
+         delete Ztensors[ previousindex ];
+         delete Ktensors[ previousindex ];
+         delete Mtensors[ previousindex ];
+      }
+      delete [] Gtensors;
+      delete [] Ytensors;
+      delete [] Ztensors;
+      delete [] Ktensors;
+      delete [] Mtensors;
+   }
 
    #ifdef CHEMPS2_MPI_COMPILATION
-   gettimeofday( &start_part, NULL );
-   theCorr->mpi_broadcast();
-   if (do_3rdm){ the3DM->mpi_allreduce(); }
-   gettimeofday( &end_part, NULL );
-   timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+   if (( fused ) && ( distribute_3rdm ) && ( !( the3DM->is_distributed() ))){ the3DM->mpi_distribute( false ); } // The fused 3-RDM is already summed
    #endif
+   const double trace_3rdm = (( do_3rdm ) ? the3DM->trace() : 0.0 ); // Collective when the 3-RDM is distributed
 
-   if ( do_3rdm ){
-      the3DM->correct_higher_multiplicities();
-      delete_3rdm_operators( L - 1 );
-      delete [] tensor_3rdm_a_J0_doublet;
-      delete [] tensor_3rdm_a_J1_doublet;
-      delete [] tensor_3rdm_a_J1_quartet;
-      delete [] tensor_3rdm_b_J0_doublet;
-      delete [] tensor_3rdm_b_J1_doublet;
-      delete [] tensor_3rdm_b_J1_quartet;
-      delete [] tensor_3rdm_c_J0_doublet;
-      delete [] tensor_3rdm_c_J1_doublet;
-      delete [] tensor_3rdm_c_J1_quartet;
-      delete [] tensor_3rdm_d_J0_doublet;
-      delete [] tensor_3rdm_d_J1_doublet;
-      delete [] tensor_3rdm_d_J1_quartet;
+   gettimeofday( &end_global, NULL );
+   const double elapsed_global = ( end_global.tv_sec - start_global.tv_sec ) + 1e-6 * ( end_global.tv_usec - start_global.tv_usec );
+
+   if ( am_i_master ){
+      if ( do_corr ){
+         cout << "   Single-orbital entropies (Hamiltonian index order is used!) = [ ";
+         for ( int index = 0; index < L - 1; index++ ){ cout << theCorr->SingleOrbitalEntropy_HAM( index ) << " , "; }
+         cout << theCorr->SingleOrbitalEntropy_HAM( L - 1 ) << " ]." << endl;
+         for ( int power = 0; power <= 2; power++ ){
+            cout << "   Idistance(" << power << ") = " << theCorr->MutualInformationDistance( (double) power ) << endl;
+         }
+      }
+      if ( do_3rdm ){ cout << "   N(N-1)(N-2)                = " << denBK->gN() * ( denBK->gN() - 1 ) * ( denBK->gN() - 2 ) << endl;
+                      cout << "   Triple trace of DMRG 3-RDM = " << trace_3rdm << endl; }
+      cout << string( what.length() + 29, '*' ) << endl;
+      cout << "***  Timing information " << what << "  ***" << endl;
+      cout << string( what.length() + 29, '*' ) << endl;
+      cout << "***     Elapsed wall time        = " << elapsed_global << " seconds" << endl;
+      cout << "***       |--> MPS gauge change  = " << timings[ CHEMPS2_TIME_S_SPLIT ] << " seconds" << endl;
+      cout << "***       |--> Diagram calc      = " << timings[ CHEMPS2_TIME_S_SOLVE ] << " seconds" << endl;
+      print_tensor_update_performance();
+      cout << string( what.length() + 29, '*' ) << endl;
+   }
+
+}
+
+void CheMPS2::DMRG::fill_correlations_moving_right( const bool am_i_master ){
+
+   // The MPS is in CRRRRRRR gauge: the orthogonality center moves to the right, and only the MPS is required
+   struct timeval start_part, end_part;
+
+   if ( am_i_master ){
+      Gtensors = new TensorGYZ*[ L - 1 ];
+      Ytensors = new TensorGYZ*[ L - 1 ];
+      Ztensors = new TensorGYZ*[ L - 1 ];
+      Ktensors = new TensorKM *[ L - 1 ];
+      Mtensors = new TensorKM *[ L - 1 ];
+   }
+
+   for ( int siteindex = 1; siteindex < L; siteindex++ ){
+
+      gettimeofday( &start_part, NULL );
+      left_normalize( siteindex - 1, am_i_master, true );
+      gettimeofday( &end_part, NULL );
+      timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+      if ( am_i_master ){
+         gettimeofday( &start_part, NULL );
+         update_correlations_tensors( siteindex );
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+         gettimeofday( &start_part, NULL );
+         theCorr->FillSite( MPS[ siteindex ], Gtensors, Ytensors, Ztensors, Ktensors, Mtensors );
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      }
    }
 
    if ( am_i_master ){
@@ -232,6 +353,147 @@ void CheMPS2::DMRG::calc_rdms_and_correlations( const bool do_3rdm ){
       delete [] Mtensors;
    }
 
+   #ifdef CHEMPS2_MPI_COMPILATION
+   theCorr->mpi_broadcast();
+   #endif
+
+}
+
+void CheMPS2::DMRG::calc_orbital_entropies(){
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      const bool am_i_master = true;
+   #endif
+
+   // Reset timings
+   for ( int timecnt = 0; timecnt < CHEMPS2_TIME_VECLENGTH; timecnt++ ){ timings[ timecnt ] = 0.0; }
+   num_double_write_disk = 0;
+   num_double_read_disk  = 0;
+   struct timeval start_global, end_global, start_part, end_part;
+   gettimeofday( &start_global, NULL );
+
+   const string what = "Orbital entropies";
+   if ( am_i_master ){
+      cout << string( what.length() + 22, '*' ) << endl;
+      cout << "***  " << what << " calculation  ***" << endl;
+      cout << string( what.length() + 22, '*' ) << endl;
+   }
+
+   // Work on a copy of the MPS, so that the renormalized operators of the sweeps remain valid
+   TensorT ** MPS_sweeps = MPS;
+   MPS = new TensorT*[ L ];
+   for ( int siteindex = 0; siteindex < L; siteindex++ ){ MPS[ siteindex ] = new TensorT( *( MPS_sweeps[ siteindex ] ) ); }
+
+   // Get the whole MPS into left-canonical form
+   gettimeofday( &start_part, NULL );
+   left_normalize( L - 2, am_i_master, true  );
+   left_normalize( L - 1, am_i_master, false );
+   gettimeofday( &end_part, NULL );
+   timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+   /* Two-orbital terms of the 2-RDM: moving left, only the diagonal F0, F1, and S0 tensors
+      of the sites j to the right of the orthogonality center are required */
+   double * pairs = new double[ 5 * L * L ];
+   for ( int cnt = 0; cnt < 5 * L * L; cnt++ ){ pairs[ cnt ] = 0.0; }
+   TensorF0 ** F0diag = NULL;
+   TensorF1 ** F1diag = NULL;
+   TensorS0 ** S0diag = NULL;
+   for ( int siteindex = L - 1; siteindex >= 0; siteindex-- ){
+
+      if ( am_i_master ){
+         gettimeofday( &start_part, NULL );
+         TwoDM::FillSitePairs( denBK, MPS[ siteindex ], F0diag, F1diag, S0diag, pairs );
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_S_SOLVE ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+      }
+
+      if ( siteindex > 0 ){
+
+         gettimeofday( &start_part, NULL );
+         right_normalize( siteindex, am_i_master, true );
+         gettimeofday( &end_part, NULL );
+         timings[ CHEMPS2_TIME_S_SPLIT ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+
+         if ( am_i_master ){
+            gettimeofday( &start_part, NULL );
+            const int num_old = L - 1 - siteindex;
+            const int num_new = L - siteindex;
+            const int dimL = denBK->gMaxDimAtBound( siteindex );
+            const int dimR = denBK->gMaxDimAtBound( siteindex + 1 );
+            TensorF0 ** F0new = new TensorF0*[ num_new ];
+            TensorF1 ** F1new = new TensorF1*[ num_new ];
+            TensorS0 ** S0new = new TensorS0*[ num_new ];
+            #pragma omp parallel
+            {
+               double * workmem = new double[ dimL * dimR ];
+
+               #pragma omp for schedule(static)
+               for ( int cnt = 0; cnt < num_new; cnt++ ){
+                  F0new[ cnt ] = new TensorF0( siteindex, 0, false, denBK );
+                  F1new[ cnt ] = new TensorF1( siteindex, 0, false, denBK );
+                  S0new[ cnt ] = new TensorS0( siteindex, 0, false, denBK );
+                  if ( cnt == 0 ){
+                     F0new[ cnt ]->makenew( MPS[ siteindex ] );
+                     F1new[ cnt ]->makenew( MPS[ siteindex ] );
+                     S0new[ cnt ]->makenew( MPS[ siteindex ] );
+                  } else {
+                     F0new[ cnt ]->update( F0diag[ cnt - 1 ], MPS[ siteindex ], MPS[ siteindex ], workmem );
+                     F1new[ cnt ]->update( F1diag[ cnt - 1 ], MPS[ siteindex ], MPS[ siteindex ], workmem );
+                     S0new[ cnt ]->update( S0diag[ cnt - 1 ], MPS[ siteindex ], MPS[ siteindex ], workmem );
+                  }
+               }
+
+               delete [] workmem;
+            }
+            for ( int cnt = 0; cnt < num_old; cnt++ ){
+               delete F0diag[ cnt ];
+               delete F1diag[ cnt ];
+               delete S0diag[ cnt ];
+            }
+            if ( F0diag != NULL ){ delete [] F0diag; }
+            if ( F1diag != NULL ){ delete [] F1diag; }
+            if ( S0diag != NULL ){ delete [] S0diag; }
+            F0diag = F0new;
+            F1diag = F1new;
+            S0diag = S0new;
+            gettimeofday( &end_part, NULL );
+            timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end_part.tv_sec - start_part.tv_sec ) + 1e-6 * ( end_part.tv_usec - start_part.tv_usec );
+         }
+      }
+   }
+   if ( am_i_master ){
+      for ( int cnt = 0; cnt < L - 1; cnt++ ){
+         delete F0diag[ cnt ];
+         delete F1diag[ cnt ];
+         delete S0diag[ cnt ];
+      }
+      delete [] F0diag;
+      delete [] F1diag;
+      delete [] S0diag;
+   }
+
+   // Same as TwoDM::correct_higher_multiplicities
+   if ( Prob->gTwoS() != 0 ){
+      const double alpha = 1.0 / ( Prob->gTwoS() + 1.0 );
+      for ( int cnt = 0; cnt < 5 * L * L; cnt++ ){ pairs[ cnt ] *= alpha; }
+   }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   MPIchemps2::broadcast_array_double( pairs, 5 * L * L, MPI_CHEMPS2_MASTER );
+   #endif
+
+   if ( theCorr != NULL ){ delete theCorr; theCorr = NULL; }
+   theCorr = new Correlations( denBK, Prob, pairs );
+   delete [] pairs;
+
+   // Mutual information: the MPS is now in CRRRRRRR gauge
+   fill_correlations_moving_right( am_i_master );
+
+   for ( int siteindex = 0; siteindex < L; siteindex++ ){ delete MPS[ siteindex ]; }
+   delete [] MPS;
+   MPS = MPS_sweeps;
+
    gettimeofday( &end_global, NULL );
    const double elapsed_global = ( end_global.tv_sec - start_global.tv_sec ) + 1e-6 * ( end_global.tv_usec - start_global.tv_usec );
 
@@ -242,21 +504,133 @@ void CheMPS2::DMRG::calc_rdms_and_correlations( const bool do_3rdm ){
       for ( int power = 0; power <= 2; power++ ){
          cout << "   Idistance(" << power << ") = " << theCorr->MutualInformationDistance( (double) power ) << endl;
       }
-      if ( do_3rdm ){ cout << "   N(N-1)(N-2)                = " << denBK->gN() * ( denBK->gN() - 1 ) * ( denBK->gN() - 2 ) << endl;
-                      cout << "   Triple trace of DMRG 3-RDM = " << the3DM->trace() << endl;
-                      cout << "***********************************************************" << endl;
-                      cout << "***  Timing information 2-RDM, 3-RDM, and Correlations  ***" << endl;
-                      cout << "***********************************************************" << endl; }
-               else { cout << "***************************************************" << endl;
-                      cout << "***  Timing information 2-RDM and Correlations  ***" << endl;
-                      cout << "***************************************************" << endl; }
-                      cout << "***     Elapsed wall time        = " << elapsed_global << " seconds" << endl;
-                      cout << "***       |--> MPS gauge change  = " << timings[ CHEMPS2_TIME_S_SPLIT ] << " seconds" << endl;
-                      cout << "***       |--> Diagram calc      = " << timings[ CHEMPS2_TIME_S_SOLVE ] << " seconds" << endl;
-                      print_tensor_update_performance();
-      if ( do_3rdm ){ cout << "***********************************************************" << endl; }
-               else { cout << "***************************************************" << endl; }
+      cout << string( what.length() + 29, '*' ) << endl;
+      cout << "***  Timing information " << what << "  ***" << endl;
+      cout << string( what.length() + 29, '*' ) << endl;
+      cout << "***     Elapsed wall time        = " << elapsed_global << " seconds" << endl;
+      cout << "***       |--> MPS gauge change  = " << timings[ CHEMPS2_TIME_S_SPLIT ] << " seconds" << endl;
+      cout << "***       |--> Diagram calc      = " << timings[ CHEMPS2_TIME_S_SOLVE ] << " seconds" << endl;
+      print_tensor_update_performance();
+      cout << string( what.length() + 29, '*' ) << endl;
+   }
+
+}
+
+void CheMPS2::DMRG::activateFusedRDMs( const bool do_3rdm, const bool disk_3rdm ){
+
+   fused_rdms_active = true;
+   fused_rdms_3rdm   = do_3rdm;
+   fused_rdms_disk   = disk_3rdm;
+
+}
+
+void CheMPS2::DMRG::allocate_3rdm_arrays(){
+
+   tensor_3rdm_a_J0_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_a_J1_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_a_J1_quartet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_b_J0_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_b_J1_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_b_J1_quartet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_c_J0_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_c_J1_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_c_J1_quartet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_d_J0_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_d_J1_doublet = new Tensor3RDM****[ L - 1 ];
+   tensor_3rdm_d_J1_quartet = new Tensor3RDM****[ L - 1 ];
+
+}
+
+void CheMPS2::DMRG::delete_3rdm_arrays(){
+
+   delete [] tensor_3rdm_a_J0_doublet;
+   delete [] tensor_3rdm_a_J1_doublet;
+   delete [] tensor_3rdm_a_J1_quartet;
+   delete [] tensor_3rdm_b_J0_doublet;
+   delete [] tensor_3rdm_b_J1_doublet;
+   delete [] tensor_3rdm_b_J1_quartet;
+   delete [] tensor_3rdm_c_J0_doublet;
+   delete [] tensor_3rdm_c_J1_doublet;
+   delete [] tensor_3rdm_c_J1_quartet;
+   delete [] tensor_3rdm_d_J0_doublet;
+   delete [] tensor_3rdm_d_J1_doublet;
+   delete [] tensor_3rdm_d_J1_quartet;
+
+}
+
+void CheMPS2::DMRG::fused_rdms_fill( const int siteindex ){
+
+   // MPS[ siteindex ] is the orthogonality center; renormalized operators exist on boundaries siteindex - 1 (moving right) and siteindex (moving left)
+   if ( the2DM != NULL ){ the2DM->FillSite( MPS[ siteindex ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors ); }
+   if ( the3DM != NULL ){
+      if ( siteindex == 0 ){
+         the3DM->fill_site( MPS[ 0 ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors,
+                            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL );
+      } else {
+         the3DM->fill_site( MPS[ siteindex ], Ltensors, F0tensors, F1tensors, S0tensors, S1tensors,
+                            tensor_3rdm_a_J0_doublet[ siteindex - 1 ], tensor_3rdm_a_J1_doublet[ siteindex - 1 ], tensor_3rdm_a_J1_quartet[ siteindex - 1 ],
+                            tensor_3rdm_b_J0_doublet[ siteindex - 1 ], tensor_3rdm_b_J1_doublet[ siteindex - 1 ], tensor_3rdm_b_J1_quartet[ siteindex - 1 ],
+                            tensor_3rdm_c_J0_doublet[ siteindex - 1 ], tensor_3rdm_c_J1_doublet[ siteindex - 1 ], tensor_3rdm_c_J1_quartet[ siteindex - 1 ],
+                            tensor_3rdm_d_J0_doublet[ siteindex - 1 ], tensor_3rdm_d_J1_doublet[ siteindex - 1 ], tensor_3rdm_d_J1_quartet[ siteindex - 1 ] );
+      }
+   }
+
+}
+
+void CheMPS2::DMRG::fused_rdms_begin( const bool am_i_master ){
+
+   if ( the2DM  != NULL ){ delete the2DM;  the2DM  = NULL; }
+   if ( the3DM  != NULL ){ delete the3DM;  the3DM  = NULL; }
+   if ( theCorr != NULL ){ delete theCorr; theCorr = NULL; }
+   the2DM = new TwoDM( denBK, Prob );
+   if ( fused_rdms_3rdm ){
+      the3DM = new ThreeDM( denBK, Prob, fused_rdms_disk, tempfolder );
+      allocate_3rdm_arrays();
+   }
+
+   // Move the orthogonality center from site 1 to site 0, and build the left-moving operators on boundary 0
+   right_normalize( 1, am_i_master, true );
+   if ( isAllocated[ 0 ] == 1 ){ deleteTensors( 0, true ); isAllocated[ 0 ] = 0; }
+   if ( isAllocated[ 0 ] == 0 ){ allocateTensors( 0, false ); isAllocated[ 0 ] = 2; }
+   updateMovingLeft( 0 );
+   fused_rdms_fill( 0 );
+
+}
+
+void CheMPS2::DMRG::fused_rdms_step( const int index ){
+
+   // After the right-moving split of sites ( index, index + 1 ), MPS[ index + 1 ] is the orthogonality center
+   if ( the3DM != NULL ){ update_safe_3rdm_operators( index + 1 ); } // Requires the operators on boundary index - 1
+   if ( isAllocated[ index ] == 2 ){ deleteTensors( index, false ); isAllocated[ index ] = 0; }
+   if ( isAllocated[ index ] == 0 ){ allocateTensors( index, true ); isAllocated[ index ] = 1; }
+   updateMovingRight( index );
+   fused_rdms_fill( index + 1 ); // Requires the operators on boundary index + 1, which updateMovingRightSafeDisk may remove
+   updateMovingRightSafeDisk( index );
+
+}
+
+void CheMPS2::DMRG::fused_rdms_end( const bool am_i_master ){
+
+   // Move the orthogonality center from site L - 2 to site L - 1, and build the right-moving operators on boundary L - 2
+   left_normalize( L - 2, am_i_master, true );
+   if ( the3DM != NULL ){ update_safe_3rdm_operators( L - 1 ); }
+   if ( isAllocated[ L - 2 ] == 2 ){ deleteTensors( L - 2, false ); isAllocated[ L - 2 ] = 0; }
+   allocateTensors( L - 2, true );
+   updateMovingRight( L - 2 );
+   fused_rdms_fill( L - 1 );
+   deleteTensors( L - 2, true ); // Same operator layout as at the end of a regular right sweep
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   the2DM->mpi_allreduce();
+   if ( the3DM != NULL ){ the3DM->mpi_allreduce(); }
+   #endif
+   the2DM->correct_higher_multiplicities();
+   if ( the3DM != NULL ){
+      the3DM->correct_higher_multiplicities();
+      delete_3rdm_operators( L - 1 );
+      delete_3rdm_arrays();
    }
+   fused_rdms_valid = true;
 
 }
 
@@ -20,17 +20,27 @@
 #include <math.h>
 #include <stdlib.h>
 #include <iostream>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
 
 #include "Davidson.h"
 #include "Lapack.h"
+#include "MPIchemps2.h"
 
 using std::cout;
 using std::endl;
+using std::string;
 
-CheMPS2::Davidson::Davidson(const int veclength_in, const int MAX_NUM_VEC_in, const int NUM_VEC_KEEP_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool debugPrint_in){
+CheMPS2::Davidson::Davidson(const int veclength_in, const int MAX_NUM_VEC_in, const int NUM_VEC_KEEP_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool debugPrint_in, const bool mpi_distributed_in, const bool disk_in, const string tmpfolder){
 
    debugPrint = debugPrint_in;
    veclength = veclength_in;
+   mpi_distributed = mpi_distributed_in;
+   #ifndef CHEMPS2_MPI_COMPILATION
+      assert( mpi_distributed == false );
+   #endif
    state = 'I'; // <I>nitialized Davidson
    nMultiplications = 0;
    
@@ -52,6 +62,27 @@ CheMPS2::Davidson::Davidson(const int veclength_in, const int MAX_NUM_VEC_in, co
    mxM_lwork = 3 * MAX_NUM_VEC - 1;
    mxM_work  = new double[ mxM_lwork ];
    
+   // Out-of-core storage
+   disk = disk_in;
+   disk_fd = -1;
+   disk_pending = -1;
+   disk_block_rows = 0;
+   disk_block = NULL;
+   if ( disk ){
+      /* The subspace is kept in a file which is unlinked right away, so it disappears when it is closed.
+         The matrix vector products are done on the in-memory vectors t_vec or work_vec, with the result in u_vec. */
+      const string name = tmpfolder + "/" + CheMPS2::DAVIDSON_storage_prefix + "XXXXXX";
+      char * filename = new char[ name.size() + 1 ];
+      strcpy( filename, name.c_str() );
+      disk_fd = mkstemp( filename );
+      if ( disk_fd == -1 ){
+         cout << "Davidson::Davidson : Could not create the file " << name << " : " << strerror( errno ) << endl;
+         abort();
+      }
+      unlink( filename );
+      delete [] filename;
+   }
+   
    // Vector spaces
    diag     = new double[ veclength ];
    t_vec    = new double[ veclength ];
@@ -89,11 +120,78 @@ CheMPS2::Davidson::~Davidson(){
    if ( Reortho_Overlap_eigs != NULL ){ delete [] Reortho_Overlap_eigs; }
    if ( Reortho_Overlap      != NULL ){ delete [] Reortho_Overlap; }
    if ( Reortho_Eigenvecs    != NULL ){ delete [] Reortho_Eigenvecs; }
+   
+   if ( disk_block != NULL ){ delete [] disk_block; }
+   if ( disk ){ close( disk_fd ); }
+
+}
+
+void CheMPS2::Davidson::disk_read(double * data, const int slot, const int start, const int num) const{
+
+   char * ptr = ( char * ) data;
+   size_t remaining = ( ( size_t ) num ) * sizeof(double);
+   off_t offset = ( off_t )(( ( ( long long ) slot ) * veclength + start ) * sizeof(double) );
+   while ( remaining > 0 ){
+      const ssize_t done = pread( disk_fd, ptr, remaining, offset );
+      if (( done < 0 ) && ( errno == EINTR )){ continue; }
+      if ( done <= 0 ){
+         cout << "Davidson::disk_read : Could not read " << remaining << " bytes from the subspace file : " << (( done < 0 ) ? strerror( errno ) : "unexpected end of file") << endl;
+         abort();
+      }
+      ptr       += done;
+      offset    += done;
+      remaining -= done;
+   }
+
+}
+
+void CheMPS2::Davidson::disk_write(const double * data, const int slot, const int start, const int num) const{
+
+   const char * ptr = ( const char * ) data;
+   size_t remaining = ( ( size_t ) num ) * sizeof(double);
+   off_t offset = ( off_t )(( ( ( long long ) slot ) * veclength + start ) * sizeof(double) );
+   while ( remaining > 0 ){
+      const ssize_t done = pwrite( disk_fd, ptr, remaining, offset );
+      if (( done < 0 ) && ( errno == EINTR )){ continue; }
+      if ( done <= 0 ){
+         cout << "Davidson::disk_write : Could not write " << remaining << " bytes to the subspace file : " << (( done < 0 ) ? strerror( errno ) : "nothing written") << endl;
+         abort();
+      }
+      ptr       += done;
+      offset    += done;
+      remaining -= done;
+   }
 
 }
 
 int CheMPS2::Davidson::GetNumMultiplications() const{ return nMultiplications; }
 
+double CheMPS2::Davidson::inprod(double * vec1, double * vec2) const{
+
+   int inc1 = 1;
+   int length = veclength;
+   double value = ddot_( &length, vec1, &inc1, vec2, &inc1 );
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+      double total = 0.0;
+      MPIchemps2::allreduce_array_double( &value, &total, 1 );
+      value = total;
+   }
+   #endif
+   return value;
+
+}
+
+double CheMPS2::Davidson::frobenius(double * vec) const{
+
+   if ( mpi_distributed ){ return sqrt( inprod( vec, vec ) ); }
+   char norm = 'F';
+   int inc1 = 1;
+   int length = veclength;
+   return dlange_( &norm, &length, &inc1, vec, &length, NULL ); // Work is not referenced for Frobenius norm
+
+}
+
 char CheMPS2::Davidson::FetchInstruction(double ** whichpointers){
 
    /* 
@@ -118,11 +216,23 @@ char CheMPS2::Davidson::FetchInstruction(double ** whichpointers){
       return 'A';
    }
    
+   // Out-of-core: the matrix vector product of the previous instruction is stored in u_vec
+   if ( disk_pending != -1 ){
+      disk_write( u_vec, MAX_NUM_VEC + disk_pending, 0, veclength );
+      disk_pending = -1;
+   }
+   
    if ( state == 'U' ){
       SafetyCheckGuess();
       AddNewVec();
-      whichpointers[0] =  vecs[ num_vec ];
-      whichpointers[1] = Hvecs[ num_vec ];
+      if ( disk ){
+         whichpointers[0] = t_vec;
+         whichpointers[1] = u_vec;
+         disk_pending = num_vec;
+      } else {
+         whichpointers[0] =  vecs[ num_vec ];
+         whichpointers[1] = Hvecs[ num_vec ];
+      }
       nMultiplications++;
       state = 'N';
       return 'B';
@@ -133,17 +243,31 @@ char CheMPS2::Davidson::FetchInstruction(double ** whichpointers){
       if ( rnorm > RTOL ){ // Not yet converged
          CalculateNewVec();
          if ( num_vec == MAX_NUM_VEC ){
-            Deflation();
-            whichpointers[0] =  vecs[ num_vec ];
-            whichpointers[1] = Hvecs[ num_vec ];
+            if ( disk ){
+               DeflationDisk();
+               disk_read( work_vec, num_vec, 0, veclength );
+               whichpointers[0] = work_vec;
+               whichpointers[1] = u_vec;
+               disk_pending = num_vec;
+            } else {
+               Deflation();
+               whichpointers[0] =  vecs[ num_vec ];
+               whichpointers[1] = Hvecs[ num_vec ];
+            }
             nMultiplications++;
             num_vec++;
             state = 'F';
             return 'B';
          }
          AddNewVec();
-         whichpointers[0] =  vecs[ num_vec ];
-         whichpointers[1] = Hvecs[ num_vec ];
+         if ( disk ){
+            whichpointers[0] = t_vec;
+            whichpointers[1] = u_vec;
+            disk_pending = num_vec;
+         } else {
+            whichpointers[0] =  vecs[ num_vec ];
+            whichpointers[1] = Hvecs[ num_vec ];
+         }
          nMultiplications++;
          state = 'N';
          return 'B';
@@ -159,14 +283,27 @@ char CheMPS2::Davidson::FetchInstruction(double ** whichpointers){
       if ( num_vec == NUM_VEC_KEEP ){
          MxMafterDeflation();
          AddNewVec();
-         whichpointers[0] =  vecs[ num_vec ];
-         whichpointers[1] = Hvecs[ num_vec ];
+         if ( disk ){
+            whichpointers[0] = t_vec;
+            whichpointers[1] = u_vec;
+            disk_pending = num_vec;
+         } else {
+            whichpointers[0] =  vecs[ num_vec ];
+            whichpointers[1] = Hvecs[ num_vec ];
+         }
          nMultiplications++;
          state = 'N';
          return 'B';
       } else {
-         whichpointers[0] =  vecs[ num_vec ];
-         whichpointers[1] = Hvecs[ num_vec ];
+         if ( disk ){
+            disk_read( work_vec, num_vec, 0, veclength );
+            whichpointers[0] = work_vec;
+            whichpointers[1] = u_vec;
+            disk_pending = num_vec;
+         } else {
+            whichpointers[0] =  vecs[ num_vec ];
+            whichpointers[1] = Hvecs[ num_vec ];
+         }
          nMultiplications++;
          num_vec++;
          state = 'F';
@@ -180,9 +317,7 @@ char CheMPS2::Davidson::FetchInstruction(double ** whichpointers){
 
 void CheMPS2::Davidson::SafetyCheckGuess(){
 
-   char frobenius = 'F';
-   int inc1 = 1;
-   const double twonorm = dlange_( &frobenius, &veclength, &inc1, t_vec, &veclength, NULL ); // Work is not referenced for Frobenius norm
+   const double twonorm = frobenius( t_vec );
    if ( twonorm == 0.0 ){
       for (int cnt = 0; cnt < veclength; cnt++){ t_vec[ cnt ] = ((double) rand())/RAND_MAX; }
       if ( debugPrint ){
@@ -198,17 +333,23 @@ void CheMPS2::Davidson::AddNewVec(){
    
    //1. Orthogonalize the new vector w.r.t. the old basis
    for (int cnt = 0; cnt < num_vec; cnt++){
-      double min_overlap = - ddot_( &veclength, t_vec, &inc1, vecs[ cnt ], &inc1 );
-      daxpy_( &veclength, &min_overlap, vecs[ cnt ], &inc1, t_vec, &inc1 );
+      double * old_vec = vecs[ cnt ];
+      if ( disk ){
+         disk_read( work_vec, cnt, 0, veclength );
+         old_vec = work_vec;
+      }
+      double min_overlap = - inprod( t_vec, old_vec );
+      daxpy_( &veclength, &min_overlap, old_vec, &inc1, t_vec, &inc1 );
    }
 
    //2. Normalize the new vector
-   char frobenius = 'F';
-   double alpha = 1.0 / dlange_( &frobenius, &veclength, &inc1, t_vec, &veclength, NULL ); // Work is not referenced for Frobenius norm
+   double alpha = 1.0 / frobenius( t_vec );
    dscal_( &veclength, &alpha, t_vec, &inc1 );
    
    //3. The new vector becomes part of vecs
-   if ( num_vec < num_allocated ){
+   if ( disk ){ // t_vec is kept as input for the matrix vector product
+      disk_write( t_vec, num_vec, 0, veclength );
+   } else if ( num_vec < num_allocated ){
       double * temp = vecs[ num_vec ];
       vecs[ num_vec ] = t_vec;
       t_vec = temp;
@@ -226,11 +367,20 @@ double CheMPS2::Davidson::DiagonalizeSmallMatrixAndCalcResidual(){
    int inc1 = 1;
 
    //4. mxM contains the Hamiltonian in the basis "vecs"
-   for (int cnt = 0; cnt < num_vec; cnt++){
-      mxM[ cnt + MAX_NUM_VEC * num_vec ] = ddot_( &veclength, vecs[ num_vec ], &inc1, Hvecs[ cnt ], &inc1 );
-      mxM[ num_vec + MAX_NUM_VEC * cnt ] = mxM[ cnt + MAX_NUM_VEC * num_vec ];
+   if ( disk ){ // vecs[ num_vec ] is still in t_vec and Hvecs[ num_vec ] in u_vec
+      for (int cnt = 0; cnt < num_vec; cnt++){
+         disk_read( work_vec, MAX_NUM_VEC + cnt, 0, veclength );
+         mxM[ cnt + MAX_NUM_VEC * num_vec ] = inprod( t_vec, work_vec );
+         mxM[ num_vec + MAX_NUM_VEC * cnt ] = mxM[ cnt + MAX_NUM_VEC * num_vec ];
+      }
+      mxM [ num_vec + MAX_NUM_VEC * num_vec ] = inprod( t_vec, u_vec );
+   } else {
+      for (int cnt = 0; cnt < num_vec; cnt++){
+         mxM[ cnt + MAX_NUM_VEC * num_vec ] = inprod( vecs[ num_vec ], Hvecs[ cnt ] );
+         mxM[ num_vec + MAX_NUM_VEC * cnt ] = mxM[ cnt + MAX_NUM_VEC * num_vec ];
+      }
+      mxM [ num_vec + MAX_NUM_VEC * num_vec ] = inprod( vecs[ num_vec ], Hvecs[ num_vec ] );
    }
-   mxM [ num_vec + MAX_NUM_VEC * num_vec ] = ddot_( &veclength, vecs[ num_vec ], &inc1, Hvecs[ num_vec ], &inc1 );
    
    //5. When t-vec was added to vecs, the number of vecs was actually increased by one. For convenience (doing 4.), only now the number is incremented.
    num_vec++;
@@ -251,15 +401,21 @@ double CheMPS2::Davidson::DiagonalizeSmallMatrixAndCalcResidual(){
    for (int cnt = 0; cnt < veclength; cnt++){ u_vec[ cnt ] = 0.0; }
    for (int cnt = 0; cnt < num_vec; cnt++){
       double alpha = mxM_vecs[ cnt ]; // Eigenvector with lowest eigenvalue, hence mxM_vecs[ cnt + MAX_NUM_VEC * 0 ]
-      daxpy_( &veclength, &alpha, Hvecs[ cnt ], &inc1, t_vec, &inc1 );
-      daxpy_( &veclength, &alpha,  vecs[ cnt ], &inc1, u_vec, &inc1 );
+      if ( disk ){
+         disk_read( work_vec, MAX_NUM_VEC + cnt, 0, veclength );
+         daxpy_( &veclength, &alpha, work_vec, &inc1, t_vec, &inc1 );
+         disk_read( work_vec, cnt, 0, veclength );
+         daxpy_( &veclength, &alpha, work_vec, &inc1, u_vec, &inc1 );
+      } else {
+         daxpy_( &veclength, &alpha, Hvecs[ cnt ], &inc1, t_vec, &inc1 );
+         daxpy_( &veclength, &alpha,  vecs[ cnt ], &inc1, u_vec, &inc1 );
+      }
    }
    double theEigenvalue = -mxM_eigs[0];
    daxpy_( &veclength, &theEigenvalue, u_vec, &inc1, t_vec, &inc1 );
    
    //8. Calculate the norm of r
-   char frobenius = 'F';
-   const double rnorm = dlange_( &frobenius, &veclength, &inc1, t_vec, &veclength, NULL ); // Work is not referenced for Frobenius norm
+   const double rnorm = frobenius( t_vec );
    return rnorm;
 
 }
@@ -279,7 +435,7 @@ void CheMPS2::Davidson::CalculateNewVec(){
          if ( debugPrint ){ cout << "WARNING AT DAVIDSON : | (diag[" << cnt << "] - mxM_eigs[0]) | = " << fabsdiff << endl; }
       }
    }
-   double alpha = - ddot_( &veclength, work_vec, &inc1, t_vec, &inc1 ) / ddot_( &veclength, work_vec, &inc1, u_vec, &inc1 ); // alpha = - (u^T K^(-1) r) / (u^T K^(-1) u)
+   double alpha = - inprod( work_vec, t_vec ) / inprod( work_vec, u_vec ); // alpha = - (u^T K^(-1) r) / (u^T K^(-1) u)
    daxpy_( &veclength, &alpha, u_vec, &inc1, t_vec, &inc1 ); // t_vec = r - (u^T K^(-1) r) / (u^T K^(-1) u) u
    for (int cnt = 0; cnt < veclength; cnt++){
       const double difference = diag[ cnt ] - mxM_eigs[0];
@@ -300,8 +456,7 @@ void CheMPS2::Davidson::Deflation(){
    // 9b. When the maximum number of vectors is reached: construct the one with lowest eigenvalue & restart
    if ( NUM_VEC_KEEP <= 1 ){
    
-      char frobenius = 'F';
-      double alpha = 1.0 / dlange_( &frobenius, &veclength, &inc1, u_vec, &veclength, NULL ); // Work is not referenced for Frobenius norm
+      double alpha = 1.0 / frobenius( u_vec );
       dscal_( &veclength, &alpha, u_vec, &inc1 );
       dcopy_( &veclength, u_vec, &inc1, vecs[0], &inc1 );
    
@@ -328,18 +483,12 @@ void CheMPS2::Davidson::Deflation(){
       char notr   = 'N';
       double one  = 1.0;
       double zero = 0.0; //set
-      dgemm_( &trans, &notr, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &veclength, &one, Reortho_Eigenvecs, &veclength, Reortho_Eigenvecs, &veclength, &zero, Reortho_Overlap, &NUM_VEC_KEEP );
-      
-      //Calculate the Lowdin tfo
-      char jobz = 'V';
-      char uplo = 'U';
-      int info;
-      dsyev_( &jobz, &uplo, &NUM_VEC_KEEP, Reortho_Overlap, &NUM_VEC_KEEP, Reortho_Overlap_eigs, mxM_work, &mxM_lwork, &info ); //Ascending order of eigs
-      for (int icnt = 0; icnt < NUM_VEC_KEEP; icnt++){
-         Reortho_Overlap_eigs[ icnt ] = pow( Reortho_Overlap_eigs[ icnt ], -0.25 );
-         dscal_( &NUM_VEC_KEEP, Reortho_Overlap_eigs + icnt, Reortho_Overlap + NUM_VEC_KEEP * icnt, &inc1 );
+      if ( veclength > 0 ){
+         dgemm_( &trans, &notr, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &veclength, &one, Reortho_Eigenvecs, &veclength, Reortho_Eigenvecs, &veclength, &zero, Reortho_Overlap, &NUM_VEC_KEEP );
+      } else {
+         for ( int cnt = 0; cnt < NUM_VEC_KEEP * NUM_VEC_KEEP; cnt++ ){ Reortho_Overlap[ cnt ] = 0.0; }
       }
-      dgemm_( &notr, &trans, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &one, Reortho_Overlap, &NUM_VEC_KEEP, Reortho_Overlap, &NUM_VEC_KEEP, &zero, Reortho_Lowdin, &NUM_VEC_KEEP );
+      CalculateLowdin();
       
       //Reortho: Put the Lowdin tfo eigenvecs in vecs
       for (int ivec = 0; ivec < NUM_VEC_KEEP; ivec++){
@@ -354,12 +503,110 @@ void CheMPS2::Davidson::Deflation(){
 
 }
 
-void CheMPS2::Davidson::MxMafterDeflation(){
+void CheMPS2::Davidson::CalculateLowdin(){
 
    int inc1 = 1;
+   char trans  = 'T';
+   char notr   = 'N';
+   double one  = 1.0;
+   double zero = 0.0; //set
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+      int size = NUM_VEC_KEEP * NUM_VEC_KEEP;
+      MPIchemps2::allreduce_array_double( Reortho_Overlap, Reortho_Lowdin, size ); // Reortho_Lowdin is used as workspace
+      dcopy_( &size, Reortho_Lowdin, &inc1, Reortho_Overlap, &inc1 );
+   }
+   #endif
+
+   //Calculate the Lowdin tfo
+   char jobz = 'V';
+   char uplo = 'U';
+   int info;
+   dsyev_( &jobz, &uplo, &NUM_VEC_KEEP, Reortho_Overlap, &NUM_VEC_KEEP, Reortho_Overlap_eigs, mxM_work, &mxM_lwork, &info ); //Ascending order of eigs
+   for (int icnt = 0; icnt < NUM_VEC_KEEP; icnt++){
+      Reortho_Overlap_eigs[ icnt ] = pow( Reortho_Overlap_eigs[ icnt ], -0.25 );
+      dscal_( &NUM_VEC_KEEP, Reortho_Overlap_eigs + icnt, Reortho_Overlap + NUM_VEC_KEEP * icnt, &inc1 );
+   }
+   dgemm_( &notr, &trans, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &one, Reortho_Overlap, &NUM_VEC_KEEP, Reortho_Overlap, &NUM_VEC_KEEP, &zero, Reortho_Lowdin, &NUM_VEC_KEEP );
+
+}
+
+void CheMPS2::Davidson::DeflationDisk(){
+
+   int inc1 = 1;
+
+   // 9b. Out-of-core version of Deflation: the subspace is streamed from the file in blocks of rows
+   if ( NUM_VEC_KEEP <= 1 ){
+   
+      double alpha = 1.0 / frobenius( u_vec );
+      dscal_( &veclength, &alpha, u_vec, &inc1 );
+      disk_write( u_vec, 0, 0, veclength );
+   
+   } else {
+   
+      if ( Reortho_Overlap      == NULL ){ Reortho_Overlap      = new double[ NUM_VEC_KEEP * NUM_VEC_KEEP ]; }
+      if ( Reortho_Overlap_eigs == NULL ){ Reortho_Overlap_eigs = new double[ NUM_VEC_KEEP                ]; }
+      if ( Reortho_Lowdin       == NULL ){ Reortho_Lowdin       = new double[ NUM_VEC_KEEP * NUM_VEC_KEEP ]; }
+      if ( disk_block == NULL ){ // About one vector: a block of rows of all vecs and of the NUM_VEC_KEEP eigenvectors
+         disk_block_rows = veclength / ( MAX_NUM_VEC + NUM_VEC_KEEP );
+         if ( disk_block_rows < 1 ){ disk_block_rows = 1; }
+         disk_block = new double[ disk_block_rows * ( MAX_NUM_VEC + NUM_VEC_KEEP ) ];
+      }
+      
+      char trans  = 'T';
+      char notr   = 'N';
+      double one  = 1.0;
+      double zero = 0.0; //set
+      for ( int cnt = 0; cnt < NUM_VEC_KEEP * NUM_VEC_KEEP; cnt++ ){ Reortho_Overlap[ cnt ] = 0.0; }
+      
+      /* Construct the lowest NUM_VEC_KEEP eigenvectors and their overlap matrix. The Hvecs are
+         recalculated after the deflation, so their slots temporarily hold the eigenvectors. */
+      for ( int start = 0; start < veclength; start += disk_block_rows ){
+         int rows = (( veclength - start < disk_block_rows ) ? veclength - start : disk_block_rows );
+         double * block_vecs  = disk_block;
+         double * block_eigen = disk_block + rows * MAX_NUM_VEC;
+         for ( int ivec = 0; ivec < MAX_NUM_VEC; ivec++ ){ disk_read( block_vecs + rows * ivec, ivec, start, rows ); }
+         dgemm_( &notr, &notr, &rows, &NUM_VEC_KEEP, &MAX_NUM_VEC, &one, block_vecs, &rows, mxM_vecs, &MAX_NUM_VEC, &zero, block_eigen, &rows );
+         dgemm_( &trans, &notr, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &rows, &one, block_eigen, &rows, block_eigen, &rows, &one, Reortho_Overlap, &NUM_VEC_KEEP );
+         for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){ disk_write( block_eigen + rows * ivec, MAX_NUM_VEC + ivec, start, rows ); }
+      }
+      
+      CalculateLowdin();
+      
+      //Reortho: Put the Lowdin tfo eigenvecs in vecs
+      for ( int start = 0; start < veclength; start += disk_block_rows ){
+         int rows = (( veclength - start < disk_block_rows ) ? veclength - start : disk_block_rows );
+         double * block_eigen = disk_block;
+         double * block_vecs  = disk_block + rows * NUM_VEC_KEEP;
+         for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){ disk_read( block_eigen + rows * ivec, MAX_NUM_VEC + ivec, start, rows ); }
+         dgemm_( &notr, &notr, &rows, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &one, block_eigen, &rows, Reortho_Lowdin, &NUM_VEC_KEEP, &zero, block_vecs, &rows );
+         for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){ disk_write( block_vecs + rows * ivec, ivec, start, rows ); }
+      }
+   }
+
+   num_vec = 0;
+
+}
+
+void CheMPS2::Davidson::MxMafterDeflation(){
+
+   if ( disk ){ // t_vec contains the new vector: work_vec and u_vec are used as buffers
+      for (int ivec = 0; ivec < NUM_VEC_KEEP; ivec++){
+         disk_read( work_vec, ivec, 0, veclength );
+         for (int ivec2 = ivec; ivec2 < NUM_VEC_KEEP; ivec2++){
+            disk_read( u_vec, MAX_NUM_VEC + ivec2, 0, veclength );
+            mxM[ ivec + MAX_NUM_VEC * ivec2 ] = inprod( work_vec, u_vec );
+            mxM[ ivec2 + MAX_NUM_VEC * ivec ] = mxM[ ivec + MAX_NUM_VEC * ivec2 ];
+         }
+      }
+      return;
+   }
+
+
    for (int ivec = 0; ivec < NUM_VEC_KEEP; ivec++){
       for (int ivec2 = ivec; ivec2 < NUM_VEC_KEEP; ivec2++){
-         mxM[ ivec + MAX_NUM_VEC * ivec2 ] = ddot_( &veclength, vecs[ ivec ], &inc1, Hvecs[ ivec2 ], &inc1 );
+         mxM[ ivec + MAX_NUM_VEC * ivec2 ] = inprod( vecs[ ivec ], Hvecs[ ivec2 ] );
          mxM[ ivec2 + MAX_NUM_VEC * ivec ] = mxM[ ivec + MAX_NUM_VEC * ivec2 ];
       }
    }
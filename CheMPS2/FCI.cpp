@@ -33,6 +33,29 @@ using std::endl;
 #include "Lapack.h"
 #include "Davidson.h"
 #include "ConjugateGradient.h"
+#include "COCG.h"
+#include "MPIchemps2.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+   #define CHEMPS2_FCI_X86_KERNELS
+   #include <immintrin.h>
+#endif
+
+static int popcount_str( const unsigned int string ){ return __builtin_popcount( string ); }
+
+static int lowest_bit( const unsigned int string ){ return __builtin_ctz( string ); }
+
+static int occupation( const unsigned int string, const int orb ){ return (( string >> orb ) & 1 ); }
+
+// The phase of a^+_r a_p on the string: the parity of the number of electrons strictly between p and r
+static int string_phase( const unsigned int string, const int p, const int r ){
+
+   const int low  = (( p < r ) ? p : r );
+   const int high = (( p < r ) ? r : p );
+   const unsigned int between = ( ( 1U << high ) - 1 ) & ( ~( ( 2U << low ) - 1 ) );
+   return (( popcount_str( string & between ) & 1 ) ? -1 : 1 );
+
+}
 
 CheMPS2::FCI::FCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigned int theNel_down, const int TargetIrrep_in, const double maxMemWorkMB_in, const int FCIverbose_in){
 
@@ -52,12 +75,35 @@ CheMPS2::FCI::FCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigne
    orb2irrep   = new int[ L ];
    for (unsigned int orb = 0; orb < L; orb++){ orb2irrep[ orb ] = Ham->getOrbitalIrrep( orb ); }
 
+   // Copy the Hamiltonian over
+   Gmat = new double[ L * L ];
+   ERI  = new double[ L * L * L * L ];
+   StartupIntegrals( Ham );
+   
+   // Set all other internal variables
+   StartupCountersVsBitstrings();
+   StartupLookupTables();
+   setKernel( CheMPS2::FCI_KERNEL_AVX512 ); // The widest alpha excitation kernel which the CPU supports
+   StartupIrrepCenter();
+   StartupDistribution();
+
+}
+
+void CheMPS2::FCI::setHamiltonian(Hamiltonian * Ham){
+
+   assert( Ham->getL() == (int) L );
+   assert( Irreps::getNumberOfIrreps( Ham->getNGroup() ) == (int) num_irreps );
+   for (unsigned int orb = 0; orb < L; orb++){ assert( Ham->getOrbitalIrrep( orb ) == orb2irrep[ orb ] ); }
+   StartupIntegrals( Ham );
+
+}
+
+void CheMPS2::FCI::StartupIntegrals(Hamiltonian * Ham){
+
    /* Copy the Hamiltonian over:
          G_ij = T_ij - 0.5 \sum_k <ik|kj> and ERI_{ijkl} = <ij|kl>
          <ij|kl> is the electron repulsion integral, int dr1 dr2 i(r1) j(r1) k(r2) l(r2) / |r1-r2| */
    Econstant = Ham->getEconst();
-   Gmat = new double[ L * L ];
-   ERI  = new double[ L * L * L * L ];
    for (unsigned int orb1 = 0; orb1 < L; orb1++){
       for (unsigned int orb2 = 0; orb2 < L; orb2++){
          double tempvar = 0.0;
@@ -71,11 +117,6 @@ CheMPS2::FCI::FCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigne
          Gmat[ orb1 + L * orb2 ] = Ham->getTmat( orb1 , orb2 ) - 0.5 * tempvar;
       }
    }
-   
-   // Set all other internal variables
-   StartupCountersVsBitstrings();
-   StartupLookupTables();
-   StartupIrrepCenter();
 
 }
 
@@ -102,21 +143,25 @@ CheMPS2::FCI::~FCI(){
 
    // FCI::StartupLookupTables
    for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
-      for ( unsigned int ij = 0; ij < L * L; ij++ ){
-         delete [] lookup_cnt_alpha[irrep][ij];
-         delete [] lookup_cnt_beta[irrep][ij];
-         delete [] lookup_sign_alpha[irrep][ij];
-         delete [] lookup_sign_beta[irrep][ij];
-      }
-      delete [] lookup_cnt_alpha[irrep];
-      delete [] lookup_cnt_beta[irrep];
-      delete [] lookup_sign_alpha[irrep];
-      delete [] lookup_sign_beta[irrep];
+      delete [] lookup_alpha[irrep][0];
+      delete [] lookup_beta[irrep][0];
+      delete [] lookup_alpha[irrep];
+      delete [] lookup_beta[irrep];
    }
-   delete [] lookup_cnt_alpha;
-   delete [] lookup_cnt_beta;
-   delete [] lookup_sign_alpha;
-   delete [] lookup_sign_beta;
+   delete [] lookup_alpha;
+   delete [] lookup_beta;
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+      delete [] alpha_conn_start[ irrep ];
+      delete [] alpha_conn_size[ irrep ];
+      delete [] alpha_conn_new[ irrep ];
+      delete [] alpha_conn_old[ irrep ];
+      delete [] alpha_conn_sign[ irrep ];
+   }
+   delete [] alpha_conn_start;
+   delete [] alpha_conn_size;
+   delete [] alpha_conn_new;
+   delete [] alpha_conn_old;
+   delete [] alpha_conn_sign;
 
    // FCI::StartupIrrepCenter
    for ( unsigned int irrep=0; irrep<num_irreps; irrep++ ){
@@ -132,6 +177,11 @@ CheMPS2::FCI::~FCI(){
    delete [] HXVworkbig1;
    delete [] HXVworkbig2;
 
+   // FCI::StartupDistribution
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){ delete [] mpi_slice_down[ irrep ]; }
+   delete [] mpi_slice_down;
+   delete [] mpi_jumps;
+
 }
 
 void CheMPS2::FCI::StartupCountersVsBitstrings(){
@@ -158,21 +208,12 @@ void CheMPS2::FCI::StartupCountersVsBitstrings(){
       str2cnt_down[ irrep ] = new int[ TwoPowL ];
    }
    
-   int * bits = new int[ L ]; // Temporary helper array
-   
    // Loop over all allowed bit strings in the spinless fermion Fock space
    for (unsigned int bitstring = 0; bitstring < TwoPowL; bitstring++){
    
       // Find the number of particles and the irrep which correspond to each basis vector
-      str2bits( L , bitstring , bits );
-      unsigned int Nparticles = 0;
-      int irrep = 0;
-      for (unsigned int orb=0; orb<L; orb++){
-         if ( bits[orb] ){
-            Nparticles++;
-            irrep = Irreps::directProd( irrep, getOrb2Irrep( orb ) );
-         }
-      }
+      const unsigned int Nparticles = popcount_str( bitstring );
+      const int irrep = getIrrepOfString( bitstring );
       
       // If allowed: set the corresponding str2cnt to the correct counter and keep track of the number of allowed vectors
       for ( unsigned int irr = 0; irr < num_irreps; irr++ ){
@@ -206,121 +247,119 @@ void CheMPS2::FCI::StartupCountersVsBitstrings(){
       }
    
    }
-   
-   delete [] bits; // Delete temporary helper array
 
 }
 
 void CheMPS2::FCI::StartupLookupTables(){
 
-   // Create a bunch of stuff
-   lookup_cnt_alpha  = new int**[ num_irreps ];
-   lookup_cnt_beta   = new int**[ num_irreps ];
-   lookup_sign_alpha = new int**[ num_irreps ];
-   lookup_sign_beta  = new int**[ num_irreps ];
+   /* Quick lookup tables for " sign | new > = E^spinproj_{ij} | old >, with sign and counter packed in one integer:
+      lookup_alpha[ irrep_new ][ i + L * j ][ cnt_new ] = 4 * cnt_old + ( sign == 1 ? 1 : 3 ) and 0 if E_ij | new > vanishes.
+      Per irrep, all L * L tables are stored in one contiguous block. */
+   lookup_alpha = new unsigned int**[ num_irreps ];
+   lookup_beta  = new unsigned int**[ num_irreps ];
 
-   int * bits = new int[ L ]; // Temporary helper array
-
-   // Quick lookup tables for " sign | new > = E^spinproj_{ij} | old >
    for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
 
       const unsigned int num_up   = numPerIrrep_up  [ irrep ];
       const unsigned int num_down = numPerIrrep_down[ irrep ];
 
-      lookup_cnt_alpha [ irrep ] = new int*[ L * L ];
-      lookup_cnt_beta  [ irrep ] = new int*[ L * L ];
-      lookup_sign_alpha[ irrep ] = new int*[ L * L ];
-      lookup_sign_beta [ irrep ] = new int*[ L * L ];
-
-      for ( unsigned int ij = 0; ij < L * L; ij++ ){
+      lookup_alpha[ irrep ] = new unsigned int*[ L * L ];
+      lookup_beta [ irrep ] = new unsigned int*[ L * L ];
+      lookup_alpha[ irrep ][ 0 ] = new unsigned int[ L * L * num_up   ];
+      lookup_beta [ irrep ][ 0 ] = new unsigned int[ L * L * num_down ];
+      for ( unsigned int ij = 1; ij < L * L; ij++ ){
+         lookup_alpha[ irrep ][ ij ] = lookup_alpha[ irrep ][ ij - 1 ] + num_up;
+         lookup_beta [ irrep ][ ij ] = lookup_beta [ irrep ][ ij - 1 ] + num_down;
+      }
 
-         lookup_cnt_alpha [ irrep ][ ij ] = new int[ num_up ];
-         lookup_cnt_beta  [ irrep ][ ij ] = new int[ num_down ];
-         lookup_sign_alpha[ irrep ][ ij ] = new int[ num_up ];
-         lookup_sign_beta [ irrep ][ ij ] = new int[ num_down ];
+      #pragma omp parallel
+      {
 
+         #pragma omp for schedule(static)
          for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < num_up; cnt_new_alpha++ ){
-            // Check for the sign. If no check for sign, you multiply with sign 0 and everything should be OK...
-            lookup_cnt_alpha [ irrep ][ ij ][ cnt_new_alpha ] = 0;
-            lookup_sign_alpha[ irrep ][ ij ][ cnt_new_alpha ] = 0;
+            for ( unsigned int ij = 0; ij < L * L; ij++ ){ lookup_alpha[ irrep ][ ij ][ cnt_new_alpha ] = 0; }
+            fill_lookup( cnt2str_up[ irrep ][ cnt_new_alpha ], irrep, str2cnt_up, lookup_alpha[ irrep ], cnt_new_alpha );
          }
+
+         #pragma omp for schedule(static)
          for ( unsigned int cnt_new_beta = 0; cnt_new_beta < num_down; cnt_new_beta++ ){
-            // Check for the sign. If no check for sign, you multiply with sign and everything should be OK...
-            lookup_cnt_beta [ irrep ][ ij ][ cnt_new_beta ] = 0;
-            lookup_sign_beta[ irrep ][ ij ][ cnt_new_beta ] = 0;
+            for ( unsigned int ij = 0; ij < L * L; ij++ ){ lookup_beta[ irrep ][ ij ][ cnt_new_beta ] = 0; }
+            fill_lookup( cnt2str_down[ irrep ][ cnt_new_beta ], irrep, str2cnt_down, lookup_beta[ irrep ], cnt_new_beta );
          }
-      }
 
-      for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < num_up; cnt_new_alpha++ ){
-
-         str2bits( L , cnt2str_up[ irrep ][ cnt_new_alpha ] , bits );
+      }
+   }
 
-         int phase_crea = 1;
-         for ( unsigned int crea = 0; crea < L; crea++ ){
-            if ( bits[ crea ] ){
-               bits[ crea ] = 0;
+   /* The alpha excitation kernels loop over the non-zero connections only: unpack them once into the new and old counters and a bit-packed sign.
+      Each list starts at a multiple of 8 connections, so that the signs of 8 consecutive connections form one byte. */
+   alpha_conn_start = new unsigned int*[ num_irreps ];
+   alpha_conn_size  = new unsigned int*[ num_irreps ];
+   alpha_conn_new   = new unsigned int*[ num_irreps ];
+   alpha_conn_old   = new unsigned int*[ num_irreps ];
+   alpha_conn_sign  = new unsigned char*[ num_irreps ];
 
-               int phase_anni = 1;
-               for ( unsigned int anni = 0; anni < L; anni++ ){
-                  if ( !(bits[ anni ]) ){
-                     bits[ anni ] = 1;
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
 
-                     const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
-                     const int cnt_old = str2cnt_up[ irrep_old ][ bits2str( L , bits ) ];
-                     const int phase = phase_crea * phase_anni;
+      const unsigned int num_up = numPerIrrep_up[ irrep ];
 
-                     lookup_cnt_alpha [ irrep ][ crea + L * anni ][ cnt_new_alpha ] = cnt_old;
-                     lookup_sign_alpha[ irrep ][ crea + L * anni ][ cnt_new_alpha ] = phase;
+      alpha_conn_start[ irrep ] = new unsigned int[ L * L + 1 ];
+      alpha_conn_size [ irrep ] = new unsigned int[ L * L ];
+      alpha_conn_start[ irrep ][ 0 ] = 0;
+      for ( unsigned int ij = 0; ij < L * L; ij++ ){
+         unsigned int num_conn = 0;
+         for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < num_up; cnt_new_alpha++ ){
+            if ( lookup_alpha[ irrep ][ ij ][ cnt_new_alpha ] != 0 ){ num_conn++; }
+         }
+         alpha_conn_size [ irrep ][ ij ] = num_conn;
+         alpha_conn_start[ irrep ][ ij + 1 ] = alpha_conn_start[ irrep ][ ij ] + 8 * (( num_conn + 7 ) / 8 );
+      }
 
-                     bits[ anni ] = 0;
-                  } else {
-                     phase_anni *= -1;
-                  }
-               }
+      const unsigned int total = alpha_conn_start[ irrep ][ L * L ];
+      alpha_conn_new [ irrep ] = new unsigned int[ total ];
+      alpha_conn_old [ irrep ] = new unsigned int[ total ];
+      alpha_conn_sign[ irrep ] = new unsigned char[ total / 8 ];
 
-               bits[ crea ] = 1;
-               phase_crea *= -1;
+      #pragma omp parallel for schedule(static)
+      for ( unsigned int ij = 0; ij < L * L; ij++ ){
+         const unsigned int first = alpha_conn_start[ irrep ][ ij ];
+         const unsigned int last  = alpha_conn_start[ irrep ][ ij + 1 ];
+         for ( unsigned int elem = first; elem < last; elem++ ){ // The padding connects result 0 with origin 0 with sign +1, but is never used
+            alpha_conn_new[ irrep ][ elem ] = 0;
+            alpha_conn_old[ irrep ][ elem ] = 0;
+         }
+         for ( unsigned int byte = first / 8; byte < last / 8; byte++ ){ alpha_conn_sign[ irrep ][ byte ] = 0; }
+         unsigned int elem = first;
+         for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < num_up; cnt_new_alpha++ ){
+            const unsigned int entry = lookup_alpha[ irrep ][ ij ][ cnt_new_alpha ];
+            if ( entry != 0 ){
+               alpha_conn_new[ irrep ][ elem ] = cnt_new_alpha;
+               alpha_conn_old[ irrep ][ elem ] = lookup_cnt( entry );
+               if ( lookup_sign( entry ) < 0 ){ alpha_conn_sign[ irrep ][ elem / 8 ] |= ( 1 << ( elem % 8 ) ); }
+               elem++;
             }
          }
       }
+   }
 
-      for ( unsigned int cnt_new_beta = 0; cnt_new_beta < num_down; cnt_new_beta++ ){
-
-         str2bits( L , cnt2str_down[ irrep ][ cnt_new_beta ] , bits );
-
-         int phase_crea = 1;
-         for ( unsigned int crea = 0; crea < L; crea++ ){
-            if ( bits[ crea ] ){
-               bits[ crea ] = 0;
-
-               int phase_anni = 1;
-               for ( unsigned int anni = 0; anni < L; anni++ ){
-                  if ( !(bits[ anni ]) ){
-                     bits[ anni ] = 1;
-
-                     const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
-                     const int cnt_old = str2cnt_down[ irrep_old ][ bits2str( L , bits ) ];
-                     const int phase = phase_crea * phase_anni;
+}
 
-                     lookup_cnt_beta  [ irrep ][ crea + L * anni ][ cnt_new_beta ] = cnt_old;
-                     lookup_sign_beta [ irrep ][ crea + L * anni ][ cnt_new_beta ] = phase;
+void CheMPS2::FCI::fill_lookup( const unsigned int string, const int irrep, int ** str2cnt, unsigned int ** lookup, const unsigned int cnt_new ) const{
 
-                     bits[ anni ] = 0;
-                  } else {
-                     phase_anni *= -1;
-                  }
-               }
+   const unsigned int full = ( 1U << L ) - 1;
+   for ( unsigned int occ = string; occ != 0; occ &= ( occ - 1 ) ){
+      const int crea = lowest_bit( occ );
+      const unsigned int removed = string ^ ( 1U << crea );
+      const int phase_crea = (( popcount_str( string & ( ( 1U << crea ) - 1 ) ) & 1 ) ? -1 : 1 );
 
-               bits[ crea ] = 1;
-               phase_crea *= -1;
-            }
-         }
+      for ( unsigned int empty = full & ( ~removed ); empty != 0; empty &= ( empty - 1 ) ){
+         const int anni = lowest_bit( empty );
+         const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
+         const int cnt_old = str2cnt[ irrep_old ][ removed | ( 1U << anni ) ];
+         const int phase = phase_crea * ((( popcount_str( removed & ( ( 1U << anni ) - 1 ) ) & 1 ) ? -1 : 1 ));
+         lookup[ crea + L * anni ][ cnt_new ] = 4 * cnt_old + (( phase == 1 ) ? 1 : 3 );
       }
-
    }
 
-   delete [] bits; // Delete temporary helper array
-
 }
 
 void CheMPS2::FCI::StartupIrrepCenter(){
@@ -388,6 +427,70 @@ void CheMPS2::FCI::StartupIrrepCenter(){
 
 }
 
+void CheMPS2::FCI::StartupDistribution(){
+
+   /* The FCI vectors are distributed over the MPI processes by slices of down (beta) strings. Process rank owns the same
+      beta strings in each sector, so that the alpha excitations in matvec_distributed only touch local data. */
+   const int num_procs = MPIchemps2::mpi_size();
+   const int my_rank   = MPIchemps2::mpi_rank();
+
+   mpi_slice_down = new unsigned int*[ num_irreps ];
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+      mpi_slice_down[ irrep ] = new unsigned int[ num_procs + 1 ];
+      for ( int rank = 0; rank <= num_procs; rank++ ){
+         mpi_slice_down[ irrep ][ rank ] = ( ((unsigned long long) numPerIrrep_down[ irrep ] ) * rank ) / num_procs;
+      }
+   }
+
+   mpi_jumps = new unsigned int[ num_irreps + 1 ];
+   mpi_jumps[ 0 ] = 0;
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int irrep_down = Irreps::directProd( irrep_up, TargetIrrep );
+      const unsigned int num_down = mpi_slice_down[ irrep_down ][ my_rank + 1 ] - mpi_slice_down[ irrep_down ][ my_rank ];
+      mpi_jumps[ irrep_up + 1 ] = mpi_jumps[ irrep_up ] + numPerIrrep_up[ irrep_up ] * num_down;
+   }
+   if (( FCIverbose > 0 ) && ( num_procs > 1 )){
+      cout << "FCI::Startup : Number of variables in the FCI vector slice of MPI process " << my_rank << " = " << getLocalVecLength() << endl;
+   }
+
+}
+
+void CheMPS2::FCI::ScatterVector( double * full, double * local ) const{
+
+   const int my_rank = MPIchemps2::mpi_rank();
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int irrep_down = Irreps::directProd( irrep_up, TargetIrrep );
+      const unsigned int offset = irrep_center_jumps[ 0 ][ irrep_up ] + numPerIrrep_up[ irrep_up ] * mpi_slice_down[ irrep_down ][ my_rank ];
+      FCIdcopy( mpi_jumps[ irrep_up + 1 ] - mpi_jumps[ irrep_up ], full + offset, local + mpi_jumps[ irrep_up ] );
+   }
+
+}
+
+void CheMPS2::FCI::GatherVector( double * local, double * full ) const{
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   const int num_procs = MPIchemps2::mpi_size();
+   if ( num_procs > 1 ){
+      int * sizes   = new int[ num_procs ];
+      int * offsets = new int[ num_procs ];
+      for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+         const int irrep_down = Irreps::directProd( irrep_up, TargetIrrep );
+         for ( int rank = 0; rank < num_procs; rank++ ){
+            sizes  [ rank ] = numPerIrrep_up[ irrep_up ] * ( mpi_slice_down[ irrep_down ][ rank + 1 ] - mpi_slice_down[ irrep_down ][ rank ] );
+            offsets[ rank ] = numPerIrrep_up[ irrep_up ] * mpi_slice_down[ irrep_down ][ rank ];
+         }
+         MPIchemps2::allgather_array_double( local + mpi_jumps[ irrep_up ], full + irrep_center_jumps[ 0 ][ irrep_up ], sizes, offsets );
+      }
+      delete [] sizes;
+      delete [] offsets;
+      return;
+   }
+   #endif
+
+   FCIdcopy( getVecLength( 0 ), local, full );
+
+}
+
 void CheMPS2::FCI::str2bits(const unsigned int Lval, const unsigned int bitstring, int * bits){
 
    for (unsigned int bit = 0; bit < Lval; bit++){ bits[ bit ] = ( bitstring & ( 1 << bit ) ) >> bit; }
@@ -416,6 +519,15 @@ int CheMPS2::FCI::getUpIrrepOfCounter(const int irrep_center, const unsigned int
 
 void CheMPS2::FCI::getBitsOfCounter(const int irrep_center, const unsigned int counter, int * bits_up, int * bits_down) const{
 
+   unsigned int string_up, string_down;
+   getStringsOfCounter( irrep_center, counter, string_up, string_down );
+   str2bits( L , string_up   , bits_up   );
+   str2bits( L , string_down , bits_down );
+
+}
+
+void CheMPS2::FCI::getStringsOfCounter(const int irrep_center, const unsigned int counter, unsigned int & string_up, unsigned int & string_down) const{
+
    const int localTargetIrrep = Irreps::directProd( irrep_center, TargetIrrep );
    
    const int irrep_up   = getUpIrrepOfCounter( irrep_center, counter );
@@ -424,25 +536,21 @@ void CheMPS2::FCI::getBitsOfCounter(const int irrep_center, const unsigned int c
    const unsigned int count_up   = ( counter - irrep_center_jumps[ irrep_center ][ irrep_up ] ) % numPerIrrep_up[ irrep_up ];
    const unsigned int count_down = ( counter - irrep_center_jumps[ irrep_center ][ irrep_up ] ) / numPerIrrep_up[ irrep_up ];
    
-   const unsigned int string_up   = cnt2str_up  [ irrep_up   ][ count_up   ];
-   const unsigned int string_down = cnt2str_down[ irrep_down ][ count_down ];
-   
-   str2bits( L , string_up   , bits_up   );
-   str2bits( L , string_down , bits_down );
+   string_up   = cnt2str_up  [ irrep_up   ][ count_up   ];
+   string_down = cnt2str_down[ irrep_down ][ count_down ];
 
 }
 
 double CheMPS2::FCI::getFCIcoeff(int * bits_up, int * bits_down, double * vector) const{
 
-   const unsigned string_up   = bits2str(L, bits_up  );
-   const unsigned string_down = bits2str(L, bits_down);
-   
-   int irrep_up   = 0;
-   int irrep_down = 0;
-   for ( unsigned int orb = 0; orb < L; orb++ ){
-      if ( bits_up  [ orb ] ){ irrep_up   = Irreps::directProd( irrep_up   , getOrb2Irrep( orb ) ); }
-      if ( bits_down[ orb ] ){ irrep_down = Irreps::directProd( irrep_down , getOrb2Irrep( orb ) ); }
-   }
+   return getFCIcoeff( bits2str( L, bits_up ), bits2str( L, bits_down ), vector );
+
+}
+
+double CheMPS2::FCI::getFCIcoeff(const unsigned int string_up, const unsigned int string_down, double * vector) const{
+
+   const int irrep_up   = getIrrepOfString( string_up   );
+   const int irrep_down = getIrrepOfString( string_down );
    
    const int counter_up   = str2cnt_up  [ irrep_up   ][ string_up   ];
    const int counter_down = str2cnt_down[ irrep_down ][ string_down ];
@@ -453,6 +561,16 @@ double CheMPS2::FCI::getFCIcoeff(int * bits_up, int * bits_down, double * vector
 
 }
 
+int CheMPS2::FCI::getIrrepOfString(const unsigned int string) const{
+
+   int irrep = 0;
+   for ( unsigned int occ = string; occ != 0; occ &= ( occ - 1 ) ){
+      irrep = Irreps::directProd( irrep, getOrb2Irrep( lowest_bit( occ ) ) );
+   }
+   return irrep;
+
+}
+
 /*void CheMPS2::FCI::CheckHamDEBUG() const{
 
    const unsigned int vecLength = getVecLength( 0 );
@@ -479,26 +597,18 @@ double CheMPS2::FCI::getFCIcoeff(int * bits_up, int * bits_down, double * vector
    cout << "The RMS difference of DiagHam() and diag(HamHXV) = " << RMSdiagdifference << endl;
    
    // Building Ham by getMatrixElement
-   int * work     = new int[ 8 ];
-   int * ket_up   = new int[ L ];
-   int * ket_down = new int[ L ];
-   int * bra_up   = new int[ L ];
-   int * bra_down = new int[ L ];
    double RMSconstructiondiff = 0.0;
    for (unsigned int row = 0; row < vecLength; row++){
+      unsigned int bra_up, bra_down;
+      getStringsOfCounter( 0 , row , bra_up , bra_down );
       for (unsigned int col = 0; col < vecLength; col++){
-         getBitsOfCounter( 0 , row , bra_up , bra_down );
-         getBitsOfCounter( 0 , col , ket_up , ket_down );
-         double tempvar = HamHXV[ row + vecLength * col ] - GetMatrixElement( bra_up , bra_down , ket_up , ket_down , work );
+         unsigned int ket_up, ket_down;
+         getStringsOfCounter( 0 , col , ket_up , ket_down );
+         double tempvar = HamHXV[ row + vecLength * col ] - GetMatrixElement( bra_up , bra_down , ket_up , ket_down );
          RMSconstructiondiff += tempvar * tempvar;
       }
    }
    cout << "The RMS difference of HamHXV - HamMXELEM = " << RMSconstructiondiff << endl;
-   delete [] work;
-   delete [] ket_up;
-   delete [] ket_down;
-   delete [] bra_up;
-   delete [] bra_down;
    
    // Building Ham^2 by matvec
    double * workspace2 = new double[ vecLength ];
@@ -527,13 +637,13 @@ double CheMPS2::FCI::getFCIcoeff(int * bits_up, int * bits_down, double * vector
 
 }*/
 
-void CheMPS2::FCI::excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, unsigned int * lookup ){
 
    #pragma omp parallel for schedule(static)
    for ( unsigned int cnt_new_up = 0; cnt_new_up < dim_new_up; cnt_new_up++ ){
-      const int sign_up = signmap[ cnt_new_up ];
+      const int sign_up = lookup_sign( lookup[ cnt_new_up ] );
       if ( sign_up != 0 ){
-         const int cnt_old_up = countmap[ cnt_new_up ];
+         const int cnt_old_up = lookup_cnt( lookup[ cnt_new_up ] );
          for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
             result[ cnt_new_up + dim_new_up * cnt_down ] += sign_up * origin[ cnt_old_up + dim_old_up * cnt_down ];
          }
@@ -542,13 +652,13 @@ void CheMPS2::FCI::excite_alpha_omp( const unsigned int dim_new_up, const unsign
 
 }
 
-void CheMPS2::FCI::excite_beta_omp( const unsigned int dim_up, const unsigned int dim_new_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_beta_omp( const unsigned int dim_up, const unsigned int dim_new_down, double * origin, double * result, unsigned int * lookup ){
 
    #pragma omp parallel for schedule(static)
    for ( unsigned int cnt_new_down = 0; cnt_new_down < dim_new_down; cnt_new_down++ ){
-      const int sign_down = signmap[ cnt_new_down ];
+      const int sign_down = lookup_sign( lookup[ cnt_new_down ] );
       if ( sign_down != 0 ){
-         const int cnt_old_down = countmap[ cnt_new_down ];
+         const int cnt_old_down = lookup_cnt( lookup[ cnt_new_down ] );
          for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
             result[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin[ cnt_up + dim_up * cnt_old_down ];
          }
@@ -557,58 +667,159 @@ void CheMPS2::FCI::excite_beta_omp( const unsigned int dim_up, const unsigned in
 
 }
 
-void CheMPS2::FCI::excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+/* The alpha excitation kernels per column: result[ conn_new[ e ] ] += ( -1 if bit e of conn_sign is set, else 1 ) * origin[ conn_old[ e ] ] for 0 <= e < num_conn.
+   The new (result) counters within one list are distinct, so that the vectorized kernels may gather, add, and store several result elements at once. */
+static void excite_alpha_column_scalar( const unsigned int first, const unsigned int num_conn, const unsigned int * conn_new, const unsigned int * conn_old, const unsigned char * conn_sign, const double * origin, double * result ){
 
-   for ( unsigned int cnt_new_up = 0; cnt_new_up < dim_new_up; cnt_new_up++ ){
-      const int sign_up = signmap[ cnt_new_up ];
-      if ( sign_up != 0 ){
-         const int cnt_old_up = countmap[ cnt_new_up ];
-         for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * ( cnt_down - start_down ) ] += sign_up * origin[ cnt_old_up + dim_old_up * cnt_down ];
-         }
+   for ( unsigned int elem = first; elem < num_conn; elem++ ){
+      const double value = origin[ conn_old[ elem ] ];
+      result[ conn_new[ elem ] ] += ((( conn_sign[ elem >> 3 ] >> ( elem & 7 ) ) & 1 ) ? -value : value );
+   }
+
+}
+
+#ifdef CHEMPS2_FCI_X86_KERNELS
+__attribute__((target("avx2")))
+static void excite_alpha_column_avx2( const unsigned int num_conn, const unsigned int * conn_new, const unsigned int * conn_old, const unsigned char * conn_sign, const double * origin, double * result ){
+
+   // Sign bit masks for the 16 possible nibbles of four consecutive sign bits
+   static const unsigned long long flip[ 16 ][ 4 ] = {
+      { 0ULL, 0ULL, 0ULL, 0ULL }, { 1ULL << 63, 0ULL, 0ULL, 0ULL }, { 0ULL, 1ULL << 63, 0ULL, 0ULL }, { 1ULL << 63, 1ULL << 63, 0ULL, 0ULL },
+      { 0ULL, 0ULL, 1ULL << 63, 0ULL }, { 1ULL << 63, 0ULL, 1ULL << 63, 0ULL }, { 0ULL, 1ULL << 63, 1ULL << 63, 0ULL }, { 1ULL << 63, 1ULL << 63, 1ULL << 63, 0ULL },
+      { 0ULL, 0ULL, 0ULL, 1ULL << 63 }, { 1ULL << 63, 0ULL, 0ULL, 1ULL << 63 }, { 0ULL, 1ULL << 63, 0ULL, 1ULL << 63 }, { 1ULL << 63, 1ULL << 63, 0ULL, 1ULL << 63 },
+      { 0ULL, 0ULL, 1ULL << 63, 1ULL << 63 }, { 1ULL << 63, 0ULL, 1ULL << 63, 1ULL << 63 }, { 0ULL, 1ULL << 63, 1ULL << 63, 1ULL << 63 }, { 1ULL << 63, 1ULL << 63, 1ULL << 63, 1ULL << 63 } };
+
+   const unsigned int num_block = num_conn & ( ~3U );
+   double store[ 4 ];
+   for ( unsigned int elem = 0; elem < num_block; elem += 4 ){
+      const __m128i idx_old = _mm_loadu_si128( ( const __m128i * )( conn_old + elem ) );
+      const __m128i idx_new = _mm_loadu_si128( ( const __m128i * )( conn_new + elem ) );
+      const unsigned int nibble = ( conn_sign[ elem >> 3 ] >> ( elem & 4 ) ) & 15;
+      const __m256d mask  = _mm256_castsi256_pd( _mm256_loadu_si256( ( const __m256i * )( flip[ nibble ] ) ) );
+      const __m256d value = _mm256_xor_pd( _mm256_i32gather_pd( origin, idx_old, 8 ), mask );
+      _mm256_storeu_pd( store, _mm256_add_pd( _mm256_i32gather_pd( result, idx_new, 8 ), value ) );
+      result[ conn_new[ elem     ] ] = store[ 0 ];
+      result[ conn_new[ elem + 1 ] ] = store[ 1 ];
+      result[ conn_new[ elem + 2 ] ] = store[ 2 ];
+      result[ conn_new[ elem + 3 ] ] = store[ 3 ];
+   }
+   excite_alpha_column_scalar( num_block, num_conn, conn_new, conn_old, conn_sign, origin, result );
+
+}
+
+__attribute__((target("avx512f")))
+static void excite_alpha_column_avx512( const unsigned int num_conn, const unsigned int * conn_new, const unsigned int * conn_old, const unsigned char * conn_sign, const double * origin, double * result ){
+
+   const __m512d zero = _mm512_setzero_pd();
+   const unsigned int num_block = num_conn & ( ~7U );
+   for ( unsigned int elem = 0; elem < num_block; elem += 8 ){
+      const __m256i idx_old = _mm256_loadu_si256( ( const __m256i * )( conn_old + elem ) );
+      const __m256i idx_new = _mm256_loadu_si256( ( const __m256i * )( conn_new + elem ) );
+      __m512d value = _mm512_i32gather_pd( idx_old, origin, 8 );
+      value = _mm512_mask_sub_pd( value, ( __mmask8 )( conn_sign[ elem >> 3 ] ), zero, value );
+      _mm512_i32scatter_pd( result, idx_new, _mm512_add_pd( _mm512_i32gather_pd( idx_new, result, 8 ), value ), 8 );
+   }
+   excite_alpha_column_scalar( num_block, num_conn, conn_new, conn_old, conn_sign, origin, result );
+
+}
+#endif
+
+bool CheMPS2::FCI::KernelSupported( const int kernel ){
+
+   if ( kernel == CheMPS2::FCI_KERNEL_SCALAR ){ return true; }
+   #ifdef CHEMPS2_FCI_X86_KERNELS
+   if ( kernel == CheMPS2::FCI_KERNEL_AVX2   ){ return ( __builtin_cpu_supports( "avx2" ) != 0 ); }
+   if ( kernel == CheMPS2::FCI_KERNEL_AVX512 ){ return ( __builtin_cpu_supports( "avx512f" ) != 0 ); }
+   #endif
+   return false;
+
+}
+
+void CheMPS2::FCI::setKernel( const int kernel ){
+
+   int choice = (( kernel > CheMPS2::FCI_KERNEL_AVX512 ) ? CheMPS2::FCI_KERNEL_AVX512 : (( kernel < CheMPS2::FCI_KERNEL_SCALAR ) ? CheMPS2::FCI_KERNEL_SCALAR : kernel ));
+   while ( KernelSupported( choice ) == false ){ choice--; }
+   alpha_kernel = choice;
+   if ( FCIverbose > 1 ){
+      cout << "FCI::setKernel : The alpha excitations use the " << (( alpha_kernel == CheMPS2::FCI_KERNEL_AVX512 ) ? "AVX-512" : (( alpha_kernel == CheMPS2::FCI_KERNEL_AVX2 ) ? "AVX2" : "scalar" )) << " kernel." << endl;
+   }
+
+}
+
+int CheMPS2::FCI::getKernel() const{ return alpha_kernel; }
+
+void CheMPS2::FCI::excite_alpha_column( const int irrep, const unsigned int ij, double * origin, double * result ) const{
+
+   const unsigned int first          = alpha_conn_start[ irrep ][ ij ];
+   const unsigned int num_conn       = alpha_conn_size[ irrep ][ ij ];
+   const unsigned int * conn_new     = alpha_conn_new[ irrep ] + first;
+   const unsigned int * conn_old     = alpha_conn_old[ irrep ] + first;
+   const unsigned char * conn_sign   = alpha_conn_sign[ irrep ] + first / 8;
+   #ifdef CHEMPS2_FCI_X86_KERNELS
+   if ( alpha_kernel == CheMPS2::FCI_KERNEL_AVX512 ){ excite_alpha_column_avx512( num_conn, conn_new, conn_old, conn_sign, origin, result ); return; }
+   if ( alpha_kernel == CheMPS2::FCI_KERNEL_AVX2   ){ excite_alpha_column_avx2(   num_conn, conn_new, conn_old, conn_sign, origin, result ); return; }
+   #endif
+   excite_alpha_column_scalar( 0, num_conn, conn_new, conn_old, conn_sign, origin, result );
+
+}
+
+void CheMPS2::FCI::excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, const int irrep, const unsigned int ij ) const{
+
+   for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
+      for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+         double * origin_col = origin + ((unsigned long long) origin_stride ) * vec + dim_old_up * cnt_down;
+         double * result_col = result + ((unsigned long long) result_stride ) * vec + dim_new_up * ( cnt_down - start_down );
+         excite_alpha_column( irrep, ij, origin_col, result_col );
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, unsigned int * lookup ){
 
    for ( unsigned int cnt_new_down = start_down; cnt_new_down < stop_down; cnt_new_down++ ){
-      const int sign_down = signmap[ cnt_new_down ];
+      const int sign_down = lookup_sign( lookup[ cnt_new_down ] );
       if ( sign_down != 0 ){
-         const int cnt_old_down = countmap[ cnt_new_down ];
-         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * ( cnt_new_down - start_down ) ] += sign_down * origin[ cnt_up + dim_up * cnt_old_down ];
+         const int cnt_old_down = lookup_cnt( lookup[ cnt_new_down ] );
+         for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+            double * origin_vec = origin + ((unsigned long long) origin_stride ) * vec;
+            double * result_vec = result + ((unsigned long long) result_stride ) * vec;
+            for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+               result_vec[ cnt_up + dim_up * ( cnt_new_down - start_down ) ] += sign_down * origin_vec[ cnt_up + dim_up * cnt_old_down ];
+            }
          }
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, const int irrep, const unsigned int ij ) const{
 
+   // The connections are indexed by the new (result) alpha string, so that different threads write different result columns
    #pragma omp parallel for schedule(static)
-   for ( unsigned int cnt_old_up = 0; cnt_old_up < dim_old_up; cnt_old_up++ ){
-      const int sign_up = signmap[ cnt_old_up ];
-      if ( sign_up != 0 ){ // Required for thread safety
-         const int cnt_new_up = countmap[ cnt_old_up ];
-         for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * cnt_down ] += sign_up * origin[ cnt_old_up + dim_old_up * ( cnt_down - start_down ) ];
-         }
+   for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
+      for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+         double * origin_col = origin + ((unsigned long long) origin_stride ) * vec + dim_old_up * ( cnt_down - start_down );
+         double * result_col = result + ((unsigned long long) result_stride ) * vec + dim_new_up * cnt_down;
+         excite_alpha_column( irrep, ij, origin_col, result_col );
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, unsigned int * lookup ){
 
    #pragma omp parallel for schedule(static)
    for ( unsigned int cnt_old_down = start_down; cnt_old_down < stop_down; cnt_old_down++ ){
-      const int sign_down = signmap[ cnt_old_down ];
+      const int sign_down = lookup_sign( lookup[ cnt_old_down ] );
       if ( sign_down != 0 ){ // Required for thread safety
-         const int cnt_new_down = countmap[ cnt_old_down ];
-         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin[ cnt_up + dim_up * ( cnt_old_down - start_down ) ];
+         const int cnt_new_down = lookup_cnt( lookup[ cnt_old_down ] );
+         for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+            double * origin_vec = origin + ((unsigned long long) origin_stride ) * vec;
+            double * result_vec = result + ((unsigned long long) result_stride ) * vec;
+            for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+               result_vec[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin_vec[ cnt_up + dim_up * ( cnt_old_down - start_down ) ];
+            }
          }
       }
    }
@@ -617,12 +828,71 @@ void CheMPS2::FCI::excite_beta_second_omp( const unsigned int dim_up, const unsi
 
 void CheMPS2::FCI::matvec( double * input, double * output ) const{
 
+   matvec_block( 1, input, output );
+
+}
+
+unsigned long long CheMPS2::FCI::block_workspace_size( const unsigned int num_vec ) const{
+
+   // A block can use up to num_vec times the workspace of a single vector, as long as it fits in maxMemWorkMB
+   if ( num_vec <= 1 ){ return HXVsizeWorkspace; }
+   const unsigned long long max_size = (unsigned long long) floor( ( maxMemWorkMB * 1048576 ) / ( 2 * sizeof(double) ) );
+   return std::max( HXVsizeWorkspace, std::min( num_vec * HXVsizeWorkspace, max_size ) );
+
+}
+
+void CheMPS2::FCI::matvec_block( const unsigned int num_vec, double * input, double * output, const unsigned long long size_work, double * work1, double * work2 ) const{
+
    struct timeval start, end;
    gettimeofday( &start, NULL );
 
-   ClearVector( getVecLength( 0 ), output );
+   const unsigned int vecLength = getVecLength( 0 );
+
+   // Workspaces which are given by the caller are reused; otherwise larger ones than HXVworkbig1 and HXVworkbig2 are only allocated for this call
+   const bool given = (( work1 != NULL ) && ( work2 != NULL ));
+   unsigned long long size_workspace = (( given ) ? size_work : block_workspace_size( num_vec ));
+   double * workbig1 = (( given ) ? work1 : HXVworkbig1 );
+   double * workbig2 = (( given ) ? work2 : HXVworkbig2 );
+   const bool allocated = (( !given ) && ( size_workspace > HXVsizeWorkspace ));
+   if ( allocated ){
+      workbig1 = new double[ size_workspace ];
+      workbig2 = new double[ size_workspace ];
+   }
+   assert( size_workspace >= HXVsizeWorkspace );
+
+   // Vectors which do not fit together are handled in several passes, each with the beta blocking of a single vector
+   const unsigned int vec_per_pass = std::max( (unsigned long long) 1, std::min( (unsigned long long) num_vec, size_workspace / std::max( (unsigned long long) 1, HXVsizeWorkspace ) ) );
+
+   for ( unsigned int first = 0; first < num_vec; first += vec_per_pass ){
+      const unsigned int num_pass = std::min( vec_per_pass, num_vec - first );
+      matvec_pass( num_pass,
+                   input  + ((unsigned long long) vecLength ) * first,
+                   output + ((unsigned long long) vecLength ) * first,
+                   size_workspace, workbig1, workbig2 );
+   }
+
+   if ( allocated ){
+      delete [] workbig1;
+      delete [] workbig2;
+   }
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   if ( FCIverbose >= 1 ){
+      cout << "FCI::matvec : Wall time = " << elapsed << " seconds";
+      if ( num_vec > 1 ){ cout << " for " << num_vec << " vectors"; }
+      cout << endl;
+   }
+
+}
+
+void CheMPS2::FCI::matvec_pass( const unsigned int num_vec, double * input, double * output, const unsigned long long size_workspace, double * workbig1, double * workbig2 ) const{
+
+   const unsigned int vecLength = getVecLength( 0 );
+   ClearVector( num_vec * vecLength, output );
 
    // P.J. Knowles and N.C. Handy, A new determinant-based full configuration interaction method, Chemical Physics Letters 111 (4-5), 315-321 (1984)
+   // All num_vec vectors pass through the lookup tables together, and are stacked in the rows of the workspaces to form one GEMM with the ERI
 
    // irrep_center is the center irrep of the ERI : (ij|kl) --> irrep_center = I_i x I_j = I_k x I_l
    for ( unsigned int irrep_center = 0; irrep_center < num_irreps; irrep_center++ ){
@@ -637,7 +907,7 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
          const int irrep_center_down = Irreps::directProd( irrep_target_center, irrep_center_up );
          const unsigned int dim_center_up   = numPerIrrep_up  [ irrep_center_up   ];
          const unsigned int dim_center_down = numPerIrrep_down[ irrep_center_down ];
-         const unsigned int blocksize_beta  = HXVsizeWorkspace / std::max( (unsigned int) 1, dim_center_up * num_pairs );
+         const unsigned int blocksize_beta  = size_workspace / std::max( (unsigned long long) 1, ((unsigned long long) dim_center_up ) * num_pairs * num_vec );
          assert( blocksize_beta > 0 ); // At least one full column should fit in the workspaces...
          unsigned int num_block_beta = dim_center_down / blocksize_beta;
          while ( blocksize_beta * num_block_beta < dim_center_down ){ num_block_beta++; }
@@ -645,44 +915,41 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
             const unsigned int start_center_down = block * blocksize_beta;
             const unsigned int  stop_center_down = std::min( ( block + 1 ) * blocksize_beta, dim_center_down );
             const unsigned int size_center = dim_center_up * ( stop_center_down - start_center_down );
+            const unsigned int size_stack  = size_center * num_vec;
             if ( size_center > 0 ){
 
-               // First build workbig1[ veccounter + size_center * pair ] = E_{i<=j} + ( 1 - delta_i==j ) E_{j>i} (irrep_center) | input >  */
+               // First build workbig1[ veccounter + size_center * ( vec + num_vec * pair ) ] = E_{i<=j} + ( 1 - delta_i==j ) E_{j>i} (irrep_center) | input[ vec ] >  */
                #pragma omp parallel for schedule(static)
                for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
-                  double * target_space   = HXVworkbig1 + size_center * pair;
+                  double * target_space   = workbig1 + ((unsigned long long) size_stack ) * pair;
                   const unsigned int crea = center_crea_orb[ pair ];
                   const unsigned int anni = center_anni_orb[ pair ];
                   const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
                   const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
                   const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
-                  for ( unsigned int count = 0; count < size_center; count++ ){ target_space[ count ] = 0.0; }
+                  for ( unsigned int count = 0; count < size_stack; count++ ){ target_space[ count ] = 0.0; }
 
-                  excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
-                                      input + zero_jumps[ irrep_zero_up ],
-                                      target_space,
-                                      lookup_sign_alpha[ irrep_center_up ][ crea + L * anni ],
-                                      lookup_cnt_alpha [ irrep_center_up ][ crea + L * anni ] );
+                  excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down, num_vec,
+                                      input + zero_jumps[ irrep_zero_up ], vecLength,
+                                      target_space, size_center,
+                                      irrep_center_up, crea + L * anni );
 
-                  excite_beta_first( dim_center_up, start_center_down, stop_center_down,
-                                     input + zero_jumps[ irrep_center_up ],
-                                     target_space,
-                                     lookup_sign_beta[ irrep_center_down ][ crea + L * anni ],
-                                     lookup_cnt_beta [ irrep_center_down ][ crea + L * anni ] );
+                  excite_beta_first( dim_center_up, start_center_down, stop_center_down, num_vec,
+                                     input + zero_jumps[ irrep_center_up ], vecLength,
+                                     target_space, size_center,
+                                     lookup_beta[ irrep_center_down ][ crea + L * anni ] );
 
                   if ( anni > crea ){
 
-                     excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
-                                         input + zero_jumps[ irrep_zero_up ],
-                                         target_space,
-                                         lookup_sign_alpha[ irrep_center_up ][ anni + L * crea ],
-                                         lookup_cnt_alpha [ irrep_center_up ][ anni + L * crea ] );
+                     excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down, num_vec,
+                                         input + zero_jumps[ irrep_zero_up ], vecLength,
+                                         target_space, size_center,
+                                         irrep_center_up, anni + L * crea );
 
-                     excite_beta_first( dim_center_up, start_center_down, stop_center_down,
-                                        input + zero_jumps[ irrep_center_up ],
-                                        target_space,
-                                        lookup_sign_beta[ irrep_center_down ][ anni + L * crea ],
-                                        lookup_cnt_beta [ irrep_center_down ][ anni + L * crea ] );
+                     excite_beta_first( dim_center_up, start_center_down, stop_center_down, num_vec,
+                                        input + zero_jumps[ irrep_center_up ], vecLength,
+                                        target_space, size_center,
+                                        lookup_beta[ irrep_center_down ][ anni + L * crea ] );
 
                   }
                }
@@ -697,11 +964,14 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
                   int mdim = size_center;
                   int kdim = num_pairs;
                   int ndim = 1;
-                  double * target = output + zero_jumps[ irrep_center_up ] + dim_center_up * start_center_down;
-                  dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &one, target, &mdim );
+                  int ldim = size_stack;
+                  for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+                     double * target = output + ((unsigned long long) vecLength ) * vec + zero_jumps[ irrep_center_up ] + dim_center_up * start_center_down;
+                     dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, workbig1 + size_center * vec, &ldim, HXVworksmall, &kdim, &one, target, &mdim );
+                  }
                }
 
-               // Now build workbig2[ veccounter + size_center * new_pair ] = 0.5 * ( new_pair | old_pair ) * workbig1[ veccounter + size_center * old_pair ]
+               // Now build workbig2[ veccounter + size_center * ( vec + num_vec * new_pair ) ] = 0.5 * ( new_pair | old_pair ) * workbig1[ veccounter + size_center * ( vec + num_vec * old_pair ) ]
                {
                   for ( unsigned int pair1 = 0; pair1 < num_pairs; pair1++ ){
                      for ( unsigned int pair2 = 0; pair2 < num_pairs; pair2++ ){
@@ -713,46 +983,42 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
                   char notrans = 'N';
                   double one = 1.0;
                   double set = 0.0;
-                  int mdim = size_center;
+                  int mdim = size_stack;
                   int kdim = num_pairs;
                   int ndim = num_pairs;
-                  dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &set, HXVworkbig2, &mdim );
+                  dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, workbig1, &mdim, HXVworksmall, &kdim, &set, workbig2, &mdim );
                }
 
-               // Finally do output <-- E_{i<=j} + (1 - delta_{i==j}) E_{j>i} workbig2[ veccounter + size_center * pair ]
+               // Finally do output[ vec ] <-- E_{i<=j} + (1 - delta_{i==j}) E_{j>i} workbig2[ veccounter + size_center * ( vec + num_vec * pair ) ]
                for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
-                  double * origin_space   = HXVworkbig2 + size_center * pair;
+                  double * origin_space   = workbig2 + ((unsigned long long) size_stack ) * pair;
                   const unsigned int crea = center_crea_orb[ pair ];
                   const unsigned int anni = center_anni_orb[ pair ];
                   const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
                   const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
                   const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
 
-                  excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
-                                           origin_space,
-                                           output + zero_jumps[ irrep_zero_up ],
-                                           lookup_sign_alpha[ irrep_center_up ][ anni + L * crea ],
-                                           lookup_cnt_alpha [ irrep_center_up ][ anni + L * crea ] );
+                  excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down, num_vec,
+                                           origin_space, size_center,
+                                           output + zero_jumps[ irrep_zero_up ], vecLength,
+                                           irrep_zero_up, crea + L * anni );
 
-                  excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
-                                          origin_space,
-                                          output + zero_jumps[ irrep_center_up ],
-                                          lookup_sign_beta[ irrep_center_down ][ anni + L * crea ],
-                                          lookup_cnt_beta [ irrep_center_down ][ anni + L * crea ] );
+                  excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down, num_vec,
+                                          origin_space, size_center,
+                                          output + zero_jumps[ irrep_center_up ], vecLength,
+                                          lookup_beta[ irrep_center_down ][ anni + L * crea ] );
 
                   if ( anni > crea ){
 
-                     excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
-                                              origin_space,
-                                              output + zero_jumps[ irrep_zero_up ],
-                                              lookup_sign_alpha[ irrep_center_up ][ crea + L * anni ],
-                                              lookup_cnt_alpha [ irrep_center_up ][ crea + L * anni ] );
+                     excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down, num_vec,
+                                              origin_space, size_center,
+                                              output + zero_jumps[ irrep_zero_up ], vecLength,
+                                              irrep_zero_up, anni + L * crea );
 
-                     excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
-                                             origin_space,
-                                             output + zero_jumps[ irrep_center_up ],
-                                             lookup_sign_beta[ irrep_center_down ][ crea + L * anni ],
-                                             lookup_cnt_beta [ irrep_center_down ][ crea + L * anni ] );
+                     excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down, num_vec,
+                                             origin_space, size_center,
+                                             output + zero_jumps[ irrep_center_up ], vecLength,
+                                             lookup_beta[ irrep_center_down ][ crea + L * anni ] );
 
                   }
                }
@@ -761,74 +1027,277 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
       }
    }
 
-   gettimeofday( &end, NULL );
-   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-   if ( FCIverbose >= 1 ){ cout << "FCI::matvec : Wall time = " << elapsed << " seconds" << endl; }
+}
+
+void CheMPS2::FCI::reduce_scatter_sector( double * sector, double * work, int * sizes, double * output ) const{
+
+   // output += the slice of this process of the sum over the processes of sector
+   (void) work; // Only used with MPI
+   #ifdef CHEMPS2_MPI_COMPILATION
+   const int num_procs = MPIchemps2::mpi_size();
+   if ( num_procs > 1 ){
+      MPIchemps2::reduce_scatter_array_double( sector, work, sizes );
+      FCIdaxpy( sizes[ MPIchemps2::mpi_rank() ], 1.0, work, output );
+      return;
+   }
+   #endif
+   FCIdaxpy( sizes[ 0 ], 1.0, sector, output );
 
 }
 
-void CheMPS2::FCI::apply_excitation( double * orig_vector, double * result_vector, const int crea, const int anni, const int orig_target_irrep ) const{
+void CheMPS2::FCI::matvec_distributed( double * input, double * output ) const{
 
-   const int    excitation_irrep = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
-   const int result_target_irrep = Irreps::directProd( excitation_irrep, orig_target_irrep );
-   const int   orig_irrep_center = Irreps::directProd( TargetIrrep,   orig_target_irrep );
-   const int result_irrep_center = Irreps::directProd( TargetIrrep, result_target_irrep );
+   struct timeval start, end;
+   gettimeofday( &start, NULL );
 
-   ClearVector( getVecLength( result_irrep_center ) , result_vector );
+   const int num_procs = MPIchemps2::mpi_size();
+   const int my_rank   = MPIchemps2::mpi_rank();
+   ClearVector( getLocalVecLength(), output );
+
+   unsigned int max_sector = 0;
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      max_sector = std::max( max_sector, irrep_center_jumps[ 0 ][ irrep_up + 1 ] - irrep_center_jumps[ 0 ][ irrep_up ] );
+   }
+   double * sector_in  = new double[ max_sector ];
+   double * sector_out = (( max_sector <= HXVsizeWorkspace ) ? NULL : new double[ max_sector ] );
+   int * sizes   = new int[ num_procs ];
+   int * offsets = new int[ num_procs ];
+
+   /* Same algorithm as matvec_pass, with the loops over irrep_center and irrep_center_up swapped. For a given irrep_center_up:
+       - The alpha excitations connect the beta strings of this process to themselves: local.
+       - The beta excitations read the full input sector irrep_center_up, which is gathered first.
+       - The beta excitations of each block of beta strings write to the whole output sector irrep_center_up. When a sector fits in
+         HXVworkbig1, which is free once the ERI GEMM of the block is done, these contributions are staged there and reduce-scattered
+         per block, so that only the input sector is held in full. Otherwise they are accumulated in sector_out and reduce-scattered
+         once per irrep_center_up. All processes work on the same number of blocks, so that they take part in every reduce-scatter. */
+   for ( unsigned int irrep_center_up = 0; irrep_center_up < num_irreps; irrep_center_up++ ){
+
+      const unsigned int dim_center_up = numPerIrrep_up[ irrep_center_up ];
+      const int irrep_sector_down = Irreps::directProd( TargetIrrep, irrep_center_up );
+      const unsigned int size_sector = dim_center_up * numPerIrrep_down[ irrep_sector_down ];
+      if ( size_sector == 0 ){ continue; }
+
+      for ( int rank = 0; rank < num_procs; rank++ ){
+         sizes  [ rank ] = dim_center_up * ( mpi_slice_down[ irrep_sector_down ][ rank + 1 ] - mpi_slice_down[ irrep_sector_down ][ rank ] );
+         offsets[ rank ] = dim_center_up * mpi_slice_down[ irrep_sector_down ][ rank ];
+      }
+      #ifdef CHEMPS2_MPI_COMPILATION
+      if ( num_procs > 1 ){ MPIchemps2::allgather_array_double( input + mpi_jumps[ irrep_center_up ], sector_in, sizes, offsets ); }
+      else { FCIdcopy( size_sector, input + mpi_jumps[ irrep_center_up ], sector_in ); }
+      #else
+      FCIdcopy( size_sector, input + mpi_jumps[ irrep_center_up ], sector_in );
+      #endif
+      const bool per_block = ( sector_out == NULL );
+      if ( !per_block ){ ClearVector( size_sector, sector_out ); }
+
+      for ( unsigned int irrep_center = 0; irrep_center < num_irreps; irrep_center++ ){
+
+         const int irrep_target_center = Irreps::directProd( TargetIrrep, irrep_center );
+         const int irrep_center_down   = Irreps::directProd( irrep_target_center, irrep_center_up );
+         const unsigned int num_pairs  = irrep_center_num[ irrep_center ];
+         const unsigned int * center_crea_orb = irrep_center_crea_orb[ irrep_center ];
+         const unsigned int * center_anni_orb = irrep_center_anni_orb[ irrep_center ];
+         const unsigned int my_start_down = mpi_slice_down[ irrep_center_down ][ my_rank ];
+         const unsigned int my_stop_down  = mpi_slice_down[ irrep_center_down ][ my_rank + 1 ];
+         const unsigned int blocksize_beta = HXVsizeWorkspace / std::max( (unsigned long long) 1, ((unsigned long long) dim_center_up ) * num_pairs );
+         assert( blocksize_beta > 0 ); // At least one full column should fit in the workspaces...
+         unsigned int max_slice_down = 0;
+         for ( int rank = 0; rank < num_procs; rank++ ){
+            max_slice_down = std::max( max_slice_down, mpi_slice_down[ irrep_center_down ][ rank + 1 ] - mpi_slice_down[ irrep_center_down ][ rank ] );
+         }
+         const unsigned int num_block_beta = ( max_slice_down + blocksize_beta - 1 ) / blocksize_beta;
 
-   for ( unsigned int result_irrep_up = 0; result_irrep_up < num_irreps; result_irrep_up++ ){
+         for ( unsigned int block = 0; block < num_block_beta; block++ ){
+            const unsigned int start_center_down = std::min( my_start_down + block * blocksize_beta, my_stop_down );
+            const unsigned int  stop_center_down = std::min( start_center_down + blocksize_beta, my_stop_down );
+            const unsigned int start_local_down = start_center_down - my_start_down;
+            const unsigned int  stop_local_down =  stop_center_down - my_start_down;
+            const unsigned int size_center = dim_center_up * ( stop_center_down - start_center_down );
+            if ( size_center > 0 ){
 
-      const int result_irrep_down = Irreps::directProd( result_irrep_up, result_target_irrep );
-      const int orig_irrep_up     = Irreps::directProd( excitation_irrep, result_irrep_up );
+               // First build HXVworkbig1[ veccounter + size_center * pair ] = E_{i<=j} + ( 1 - delta_i==j ) E_{j>i} (irrep_center) | input >
+               #pragma omp parallel for schedule(static)
+               for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
+                  double * target_space   = HXVworkbig1 + ((unsigned long long) size_center ) * pair;
+                  const unsigned int crea = center_crea_orb[ pair ];
+                  const unsigned int anni = center_anni_orb[ pair ];
+                  const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
+                  const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
+                  const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
+                  for ( unsigned int count = 0; count < size_center; count++ ){ target_space[ count ] = 0.0; }
 
-      excite_alpha_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_new_up
-                        numPerIrrep_up  [   orig_irrep_up   ], // dim_old_up
-                        numPerIrrep_down[ result_irrep_down ], // dim_down
-                        orig_vector   + irrep_center_jumps[   orig_irrep_center ][   orig_irrep_up ], // origin
-                        result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
-                        lookup_sign_alpha[ result_irrep_up ][ crea + L * anni ],   // signmap
-                        lookup_cnt_alpha [ result_irrep_up ][ crea + L * anni ] ); // countmap
+                  excite_alpha_first( dim_center_up, dim_zero_up, start_local_down, stop_local_down, 1,
+                                      input + mpi_jumps[ irrep_zero_up ], 0, target_space, 0,
+                                      irrep_center_up, crea + L * anni );
 
-      excite_beta_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_up
-                       numPerIrrep_down[ result_irrep_down ], // dim_new_down
-                       orig_vector   + irrep_center_jumps[   orig_irrep_center ][ result_irrep_up ], // origin
-                       result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
-                       lookup_sign_beta[ result_irrep_down ][ crea + L * anni ],   // signmap
-                       lookup_cnt_beta [ result_irrep_down ][ crea + L * anni ] ); // countmap
+                  excite_beta_first( dim_center_up, start_center_down, stop_center_down, 1,
+                                     sector_in, 0, target_space, 0,
+                                     lookup_beta[ irrep_center_down ][ crea + L * anni ] );
 
-   }
+                  if ( anni > crea ){
 
-}
+                     excite_alpha_first( dim_center_up, dim_zero_up, start_local_down, stop_local_down, 1,
+                                         input + mpi_jumps[ irrep_zero_up ], 0, target_space, 0,
+                                         irrep_center_up, anni + L * crea );
 
-double CheMPS2::FCI::Fill2RDM(double * vector, double * two_rdm) const{
+                     excite_beta_first( dim_center_up, start_center_down, stop_center_down, 1,
+                                        sector_in, 0, target_space, 0,
+                                        lookup_beta[ irrep_center_down ][ anni + L * crea ] );
 
-   assert( Nel_up + Nel_down >= 2 );
+                  }
+               }
 
-   struct timeval start, end;
-   gettimeofday(&start, NULL);
-   
-   ClearVector( L*L*L*L, two_rdm );
-   const unsigned int orig_length = getVecLength( 0 );
-   unsigned int max_length = 0;
-   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
-      if ( getVecLength( irrep ) > max_length ){ max_length = getVecLength( irrep ); }
-   }
-   double * workspace1 = new double[ max_length  ];
-   double * workspace2 = new double[ orig_length ];
-   
-   // Gamma_{ijkl} = < E_ik E_jl > - delta_jk < E_il >
-   for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){ // anni1 = l
-      for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){ // crea1 = j >= l
-      
-         const int irrep_center1 = Irreps::directProd( getOrb2Irrep( crea1 ), getOrb2Irrep( anni1 ) );
-         const int target_irrep1 = Irreps::directProd( TargetIrrep, irrep_center1 );
-         apply_excitation( vector, workspace1, crea1, anni1, TargetIrrep );
-         
-         if ( irrep_center1 == 0 ){
-            const double value = FCIddot( orig_length, workspace1, vector ); // < E_{crea1,anni1} >
-            for ( unsigned int jk = anni1; jk < L; jk++ ){
-               two_rdm[ crea1 + L * ( jk + L * ( jk + L * anni1 ) ) ] -= value;
-            }
+               // If irrep_center == 0, do the one-body terms
+               if ( irrep_center == 0 ){
+                  for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
+                     HXVworksmall[ pair ] = getGmat( center_crea_orb[ pair ], center_anni_orb[ pair ] );
+                  }
+                  char notrans = 'N';
+                  double one = 1.0;
+                  int mdim = size_center;
+                  int kdim = num_pairs;
+                  int ndim = 1;
+                  double * target = output + mpi_jumps[ irrep_center_up ] + dim_center_up * start_local_down;
+                  dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &one, target, &mdim );
+               }
+
+               // Now build HXVworkbig2[ veccounter + size_center * new_pair ] = 0.5 * ( new_pair | old_pair ) * HXVworkbig1[ veccounter + size_center * old_pair ]
+               {
+                  for ( unsigned int pair1 = 0; pair1 < num_pairs; pair1++ ){
+                     for ( unsigned int pair2 = 0; pair2 < num_pairs; pair2++ ){
+                        HXVworksmall[ pair1 + num_pairs * pair2 ]
+                           = 0.5 * getERI( center_crea_orb[ pair1 ], center_anni_orb[ pair1 ] ,
+                                           center_crea_orb[ pair2 ], center_anni_orb[ pair2 ] );
+                     }
+                  }
+                  char notrans = 'N';
+                  double one = 1.0;
+                  double set = 0.0;
+                  int mdim = size_center;
+                  int kdim = num_pairs;
+                  int ndim = num_pairs;
+                  dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &set, HXVworkbig2, &mdim );
+               }
+            }
+
+            // The beta contributions of this block are staged in HXVworkbig1, which is no longer needed
+            double * beta_out = (( per_block ) ? HXVworkbig1 : sector_out );
+            if ( per_block ){ ClearVector( size_sector, beta_out ); }
+
+            if ( size_center > 0 ){
+
+               // Finally do output <-- E_{i<=j} + (1 - delta_{i==j}) E_{j>i} HXVworkbig2[ veccounter + size_center * pair ]
+               for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
+                  double * origin_space   = HXVworkbig2 + ((unsigned long long) size_center ) * pair;
+                  const unsigned int crea = center_crea_orb[ pair ];
+                  const unsigned int anni = center_anni_orb[ pair ];
+                  const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
+                  const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
+                  const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
+
+                  excite_alpha_second_omp( dim_zero_up, dim_center_up, start_local_down, stop_local_down, 1,
+                                           origin_space, 0, output + mpi_jumps[ irrep_zero_up ], 0,
+                                           irrep_zero_up, crea + L * anni );
+
+                  excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down, 1,
+                                          origin_space, 0, beta_out, 0,
+                                          lookup_beta[ irrep_center_down ][ anni + L * crea ] );
+
+                  if ( anni > crea ){
+
+                     excite_alpha_second_omp( dim_zero_up, dim_center_up, start_local_down, stop_local_down, 1,
+                                              origin_space, 0, output + mpi_jumps[ irrep_zero_up ], 0,
+                                              irrep_zero_up, anni + L * crea );
+
+                     excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down, 1,
+                                             origin_space, 0, beta_out, 0,
+                                             lookup_beta[ irrep_center_down ][ crea + L * anni ] );
+
+                  }
+               }
+            }
+
+            // Add the beta contributions of this block of all processes to the output slices; HXVworkbig2 is free as well
+            if ( per_block ){ reduce_scatter_sector( beta_out, HXVworkbig2, sizes, output + mpi_jumps[ irrep_center_up ] ); }
+         }
+      }
+
+      // Add the beta contributions of all processes to the output slices; the input sector is no longer needed
+      if ( !per_block ){ reduce_scatter_sector( sector_out, sector_in, sizes, output + mpi_jumps[ irrep_center_up ] ); }
+
+   }
+
+   delete [] sector_in;
+   if ( sector_out != NULL ){ delete [] sector_out; }
+   delete [] sizes;
+   delete [] offsets;
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   if (( FCIverbose >= 1 ) && ( my_rank == 0 )){ cout << "FCI::matvec : Wall time = " << elapsed << " seconds on " << num_procs << " MPI processes" << endl; }
+
+}
+
+void CheMPS2::FCI::apply_excitation( double * orig_vector, double * result_vector, const int crea, const int anni, const int orig_target_irrep ) const{
+
+   const int    excitation_irrep = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
+   const int result_target_irrep = Irreps::directProd( excitation_irrep, orig_target_irrep );
+   const int   orig_irrep_center = Irreps::directProd( TargetIrrep,   orig_target_irrep );
+   const int result_irrep_center = Irreps::directProd( TargetIrrep, result_target_irrep );
+
+   ClearVector( getVecLength( result_irrep_center ) , result_vector );
+
+   for ( unsigned int result_irrep_up = 0; result_irrep_up < num_irreps; result_irrep_up++ ){
+
+      const int result_irrep_down = Irreps::directProd( result_irrep_up, result_target_irrep );
+      const int orig_irrep_up     = Irreps::directProd( excitation_irrep, result_irrep_up );
+
+      excite_alpha_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_new_up
+                        numPerIrrep_up  [   orig_irrep_up   ], // dim_old_up
+                        numPerIrrep_down[ result_irrep_down ], // dim_down
+                        orig_vector   + irrep_center_jumps[   orig_irrep_center ][   orig_irrep_up ], // origin
+                        result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
+                        lookup_alpha[ result_irrep_up ][ crea + L * anni ] );
+
+      excite_beta_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_up
+                       numPerIrrep_down[ result_irrep_down ], // dim_new_down
+                       orig_vector   + irrep_center_jumps[   orig_irrep_center ][ result_irrep_up ], // origin
+                       result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
+                       lookup_beta[ result_irrep_down ][ crea + L * anni ] );
+
+   }
+
+}
+
+double CheMPS2::FCI::Fill2RDM(double * vector, double * two_rdm) const{
+
+   assert( Nel_up + Nel_down >= 2 );
+
+   struct timeval start, end;
+   gettimeofday(&start, NULL);
+   
+   ClearVector( L*L*L*L, two_rdm );
+   const unsigned int orig_length = getVecLength( 0 );
+   unsigned int max_length = 0;
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+      if ( getVecLength( irrep ) > max_length ){ max_length = getVecLength( irrep ); }
+   }
+   double * workspace1 = new double[ max_length  ];
+   double * workspace2 = new double[ orig_length ];
+   
+   // Gamma_{ijkl} = < E_ik E_jl > - delta_jk < E_il >
+   for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){ // anni1 = l
+      for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){ // crea1 = j >= l
+      
+         const int irrep_center1 = Irreps::directProd( getOrb2Irrep( crea1 ), getOrb2Irrep( anni1 ) );
+         const int target_irrep1 = Irreps::directProd( TargetIrrep, irrep_center1 );
+         apply_excitation( vector, workspace1, crea1, anni1, TargetIrrep );
+         
+         if ( irrep_center1 == 0 ){
+            const double value = FCIddot( orig_length, workspace1, vector ); // < E_{crea1,anni1} >
+            for ( unsigned int jk = anni1; jk < L; jk++ ){
+               two_rdm[ crea1 + L * ( jk + L * ( jk + L * anni1 ) ) ] -= value;
+            }
          }
          
          for ( unsigned int crea2 = anni1; crea2 < L; crea2++ ){ // crea2 = i >= l
@@ -1415,37 +1884,37 @@ double CheMPS2::FCI::CalcSpinSquared(double * vector) const{
          const int count_down   = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) / numPerIrrep_up[ irrep_up ];
          
          // Diagonal terms
-         const int diff_ii = lookup_sign_alpha[ irrep_up   ][ orbi + L * orbi ][ count_up   ]
-                           - lookup_sign_beta [ irrep_down ][ orbi + L * orbi ][ count_down ]; //Signed integers so subtracting is OK
+         const int diff_ii = lookup_sign( lookup_alpha[ irrep_up   ][ orbi + L * orbi ][ count_up   ] )
+                           - lookup_sign( lookup_beta [ irrep_down ][ orbi + L * orbi ][ count_down ] ); //Signed integers so subtracting is OK
          const double vector_at_counter_squared = vector[ counter ] * vector[ counter ];
          result += 0.75 * diff_ii * diff_ii * vector_at_counter_squared;
          
          for ( unsigned int orbj = orbi+1; orbj < L; orbj++ ){
          
             // Sz Sz
-            const int diff_jj = lookup_sign_alpha[ irrep_up   ][ orbj + L * orbj ][ count_up   ]
-                              - lookup_sign_beta [ irrep_down ][ orbj + L * orbj ][ count_down ]; //Signed integers so subtracting is OK
+            const int diff_jj = lookup_sign( lookup_alpha[ irrep_up   ][ orbj + L * orbj ][ count_up   ] )
+                              - lookup_sign( lookup_beta [ irrep_down ][ orbj + L * orbj ][ count_down ] ); //Signed integers so subtracting is OK
             result += 0.5 * diff_ii * diff_jj * vector_at_counter_squared;
             
             const int irrep_up_bis = Irreps::directProd( irrep_up , Irreps::directProd( getOrb2Irrep( orbi ) , getOrb2Irrep( orbj ) ) );
             
             // - ( a_i,up^+ a_j,up )( a_j,down^+ a_i,down )
-            const int sign_down_ji  = lookup_sign_beta [ irrep_down ][ orbj + L * orbi ][ count_down ];
-            const int sign_up_ij    = lookup_sign_alpha[ irrep_up   ][ orbi + L * orbj ][ count_up ];
+            const int sign_down_ji  = lookup_sign( lookup_beta [ irrep_down ][ orbj + L * orbi ][ count_down ] );
+            const int sign_up_ij    = lookup_sign( lookup_alpha[ irrep_up   ][ orbi + L * orbj ][ count_up ] );
             const int sign_product1 = sign_up_ij * sign_down_ji;
             if ( sign_product1 != 0 ){
-               const int cnt_down_ji = lookup_cnt_beta [ irrep_down ][ orbj + L * orbi ][ count_down ];
-               const int cnt_up_ij   = lookup_cnt_alpha[ irrep_up   ][ orbi + L * orbj ][ count_up ];
+               const int cnt_down_ji = lookup_cnt( lookup_beta [ irrep_down ][ orbj + L * orbi ][ count_down ] );
+               const int cnt_up_ij   = lookup_cnt( lookup_alpha[ irrep_up   ][ orbi + L * orbj ][ count_up ] );
                result -= sign_product1 * vector[ irrep_center_jumps[ 0 ][ irrep_up_bis ] + cnt_up_ij + numPerIrrep_up[ irrep_up_bis ] * cnt_down_ji ] * vector[ counter ];
             }
 
             // - ( a_j,up^+ a_i,up )( a_i,down^+ a_j,down )
-            const int sign_down_ij  = lookup_sign_beta [ irrep_down ][ orbi + L * orbj ][ count_down ];
-            const int sign_up_ji    = lookup_sign_alpha[ irrep_up   ][ orbj + L * orbi ][ count_up ];
+            const int sign_down_ij  = lookup_sign( lookup_beta [ irrep_down ][ orbi + L * orbj ][ count_down ] );
+            const int sign_up_ji    = lookup_sign( lookup_alpha[ irrep_up   ][ orbj + L * orbi ][ count_up ] );
             const int sign_product2 = sign_up_ji * sign_down_ij;
             if ( sign_product2 != 0 ){
-               const int cnt_down_ij = lookup_cnt_beta [ irrep_down ][ orbi + L * orbj ][ count_down ];
-               const int cnt_up_ji   = lookup_cnt_alpha[ irrep_up   ][ orbj + L * orbi ][ count_up ];
+               const int cnt_down_ij = lookup_cnt( lookup_beta [ irrep_down ][ orbi + L * orbj ][ count_down ] );
+               const int cnt_up_ji   = lookup_cnt( lookup_alpha[ irrep_up   ][ orbj + L * orbi ][ count_up ] );
                result -= sign_product2 * vector[ irrep_center_jumps[ 0 ][ irrep_up_bis ] + cnt_up_ji + numPerIrrep_up[ irrep_up_bis ] * cnt_down_ij ] * vector[ counter ];
             }
          
@@ -1462,38 +1931,60 @@ double CheMPS2::FCI::CalcSpinSquared(double * vector) const{
 
 }
 
+double CheMPS2::FCI::DiagHamElement( const unsigned int string_up, const unsigned int string_down ) const{
+
+   /* With n_i the occupation of the spin orbitals:
+         < H > = sum_i n_i [ g_ii + 0.5 * sum_j (ij|ji) ] + 0.5 * sum_{i,j} n_i n_j (ii|jj) - 0.5 * sum_{i,j same spin} n_i n_j (ij|ji) */
+   double myResult = 0.0;
+   for ( unsigned int spin = 0; spin < 2; spin++ ){
+      const unsigned int string_same  = (( spin == 0 ) ? string_up : string_down );
+      const unsigned int string_other = (( spin == 0 ) ? string_down : string_up );
+      for ( unsigned int occ1 = string_same; occ1 != 0; occ1 &= ( occ1 - 1 ) ){
+         const int orb1 = lowest_bit( occ1 );
+         myResult += getGmat( orb1 , orb1 );
+         for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){ myResult += 0.5 * getERI( orb1 , orb2 , orb2 , orb1 ); }
+         for ( unsigned int occ2 = string_same; occ2 != 0; occ2 &= ( occ2 - 1 ) ){
+            const int orb2 = lowest_bit( occ2 );
+            myResult += 0.5 * ( getERI( orb1 , orb1 , orb2 , orb2 ) - getERI( orb1 , orb2 , orb2 , orb1 ) );
+         }
+         for ( unsigned int occ2 = string_other; occ2 != 0; occ2 &= ( occ2 - 1 ) ){
+            myResult += 0.5 * getERI( orb1 , orb1 , lowest_bit( occ2 ) , lowest_bit( occ2 ) );
+         }
+      }
+   }
+   return myResult;
+
+}
+
 void CheMPS2::FCI::DiagHam(double * diag) const{
 
    const unsigned int vecLength = getVecLength( 0 );
 
-   #pragma omp parallel
-   {
+   #pragma omp parallel for schedule(static)
+   for ( unsigned int counter = 0; counter < vecLength; counter++ ){
+      unsigned int string_up, string_down;
+      getStringsOfCounter( 0 , counter , string_up , string_down );
+      diag[ counter ] = DiagHamElement( string_up, string_down );
+   }
 
-      int * bits_up   = new int[ L ];
-      int * bits_down = new int[ L ];
-      
-      #pragma omp for schedule(static)
-      for ( unsigned int counter = 0; counter < vecLength; counter++ ){
-      
-         double myResult = 0.0;
-         getBitsOfCounter( 0 , counter , bits_up , bits_down ); // Fetch the corresponding bits
-         
-         for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){
-            const int n_tot_orb1 = bits_up[ orb1 ] + bits_down[ orb1 ];
-            myResult += n_tot_orb1 * getGmat( orb1 , orb1 );
-            for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){
-               myResult += 0.5 * n_tot_orb1 * ( bits_up[ orb2 ] + bits_down[ orb2 ] ) * getERI( orb1 , orb1 , orb2 , orb2 );
-               myResult += 0.5 * ( n_tot_orb1 - bits_up[ orb1 ] * bits_up[ orb2 ] - bits_down[ orb1 ] * bits_down[ orb2 ] ) * getERI( orb1 , orb2 , orb2 , orb1 );
-            }
-         }
-         
-         diag[ counter ] = myResult;
-         
+}
+
+void CheMPS2::FCI::DiagHamLocal(double * diag) const{
+
+   const int my_rank = MPIchemps2::mpi_rank();
+
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int irrep_down = Irreps::directProd( irrep_up, TargetIrrep );
+      const unsigned int dim_up = numPerIrrep_up[ irrep_up ];
+      const unsigned int offset = irrep_center_jumps[ 0 ][ irrep_up ] + dim_up * mpi_slice_down[ irrep_down ][ my_rank ];
+      const unsigned int num_local = mpi_jumps[ irrep_up + 1 ] - mpi_jumps[ irrep_up ];
+
+      #pragma omp parallel for schedule(static)
+      for ( unsigned int counter = 0; counter < num_local; counter++ ){
+         unsigned int string_up, string_down;
+         getStringsOfCounter( 0 , offset + counter , string_up , string_down );
+         diag[ mpi_jumps[ irrep_up ] + counter ] = DiagHamElement( string_up, string_down );
       }
-      
-      delete [] bits_up;
-      delete [] bits_down;
-      
    }
 
 }
@@ -1535,9 +2026,7 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
    #pragma omp parallel
    {
 
-      int * bits_up   = new int[ L ];
-      int * bits_down = new int[ L ];
-      
+      double * K_all      = new double[ L * L ]; // (ik|kj)
       double * Jmat       = new double[ L * L ]; // (ij|kk)( n_k,up + n_k,down )
       double * K_reg_up   = new double[ L * L ]; // (ik|kj)( n_k,up )
       double * K_reg_down = new double[ L * L ]; // (ik|kj)( n_k,down )
@@ -1557,10 +2046,21 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
          specific_orbs_irrep[ L + ( L + 1 ) * irrep ] = count;
       }
       
+      for ( unsigned int i = 0; i < L; i++ ){
+         for ( unsigned int j = 0; j < L; j++ ){
+            double value = 0.0;
+            for ( unsigned int k = 0; k < L; k++ ){ value += getERI(i,k,k,j); }
+            K_all[ i + L * j ] = value;
+         }
+      }
+      
+      const unsigned int full = ( 1U << L ) - 1;
+      
       #pragma omp for schedule(static)
       for (unsigned int counter = 0; counter < vecLength; counter++){
       
-         getBitsOfCounter( 0 , counter , bits_up , bits_down ); // Fetch the corresponding bits
+         unsigned int string_up, string_down;
+         getStringsOfCounter( 0 , counter , string_up , string_down ); // Fetch the corresponding strings
          
          // Construct the J and K matrices properly
          for ( unsigned int i = 0; i < L; i++ ){
@@ -1569,19 +2069,21 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
                double val_J        = 0.0;
                double val_KregUP   = 0.0;
                double val_KregDOWN = 0.0;
-               double val_KbarUP   = 0.0;
-               double val_KbarDOWN = 0.0;
                
                if ( getOrb2Irrep(i) == getOrb2Irrep(j) ){
-                  for ( unsigned int k = 0; k < L; k++ ){
-                     const double temp = getERI(i,k,k,j);
-                     val_J        += getERI(i,j,k,k) * ( bits_up[k] + bits_down[k] );
-                     val_KregUP   += temp * bits_up[k];
-                     val_KregDOWN += temp * bits_down[k];
-                     val_KbarUP   += temp * ( 1 - bits_up[k] );
-                     val_KbarDOWN += temp * ( 1 - bits_down[k] );
+                  for ( unsigned int occ = string_up; occ != 0; occ &= ( occ - 1 ) ){
+                     const int k = lowest_bit( occ );
+                     val_J      += getERI(i,j,k,k);
+                     val_KregUP += getERI(i,k,k,j);
+                  }
+                  for ( unsigned int occ = string_down; occ != 0; occ &= ( occ - 1 ) ){
+                     const int k = lowest_bit( occ );
+                     val_J        += getERI(i,j,k,k);
+                     val_KregDOWN += getERI(i,k,k,j);
                   }
                }
+               const double val_KbarUP   = (( getOrb2Irrep(i) == getOrb2Irrep(j) ) ? K_all[ i + L * j ] - val_KregUP   : 0.0 );
+               const double val_KbarDOWN = (( getOrb2Irrep(i) == getOrb2Irrep(j) ) ? K_all[ i + L * j ] - val_KregDOWN : 0.0 );
                
                Jmat[ i + L * j ] = val_J;
                Jmat[ j + L * i ] = val_J;
@@ -1599,10 +2101,13 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
          
          double temp = 0.0;
          // G[i,i] (n_i,up + n_i,down) + 0.5 * ( J[i,i] (n_i,up + n_i,down) + K_bar_up[i,i] * n_i,up + K_bar_down[i,i] * n_i,down )
-         for ( unsigned int i = 0; i < L; i++ ){
-            const int num_i = bits_up[i] + bits_down[i];
-            temp += getGmat(i, i) * num_i + 0.5 * ( Jmat[ i + L * i ] * num_i + K_bar_up[ i + L * i ]   * bits_up[i]
-                                                                              + K_bar_down[ i + L * i ] * bits_down[i] );
+         for ( unsigned int occ = string_up; occ != 0; occ &= ( occ - 1 ) ){
+            const int i = lowest_bit( occ );
+            temp += getGmat(i, i) + 0.5 * ( Jmat[ i + L * i ] + K_bar_up[ i + L * i ] );
+         }
+         for ( unsigned int occ = string_down; occ != 0; occ &= ( occ - 1 ) ){
+            const int i = lowest_bit( occ );
+            temp += getGmat(i, i) + 0.5 * ( Jmat[ i + L * i ] + K_bar_down[ i + L * i ] );
          }
          double myResult = temp*temp;
          
@@ -1610,10 +2115,12 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
             for ( unsigned int q = 0; q < L; q++ ){
                if ( getOrb2Irrep(p) == getOrb2Irrep(q) ){
             
-                  const int special_pq         = bits_up[p] * ( 1 - bits_up[q] ) + bits_down[p] * ( 1 - bits_down[q] );
+                  const int excite_pq_up       = occupation( string_up,   p ) * ( 1 - occupation( string_up,   q ) );
+                  const int excite_pq_down     = occupation( string_down, p ) * ( 1 - occupation( string_down, q ) );
+                  const int special_pq         = excite_pq_up + excite_pq_down;
                   const double GplusJ_pq       = getGmat(p, q) + Jmat[ p + L * q ];
-                  const double K_cross_pq_up   = ( K_bar_up[ p + L * q ] - K_reg_up[ p + L * q ]     ) * bits_up[p]   * ( 1 - bits_up[q]   );
-                  const double K_cross_pq_down = ( K_bar_down[ p + L * q ] - K_reg_down[ p + L * q ] ) * bits_down[p] * ( 1 - bits_down[q] );
+                  const double K_cross_pq_up   = ( K_bar_up[ p + L * q ] - K_reg_up[ p + L * q ]     ) * excite_pq_up;
+                  const double K_cross_pq_down = ( K_bar_down[ p + L * q ] - K_reg_down[ p + L * q ] ) * excite_pq_down;
                   
                   myResult += ( GplusJ_pq * ( special_pq * GplusJ_pq + K_cross_pq_up + K_cross_pq_down )
                               + 0.25 * ( K_cross_pq_up * K_cross_pq_up + K_cross_pq_down * K_cross_pq_down ) );
@@ -1631,41 +2138,41 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
             
                0.5 * (ak|ci) * (ak|ci) * [ n_a,up * (1-n_k,up) + n_a,down * (1-n_k,down) ] * [ n_c,up * (1-n_i,up) + n_c,down * (1-n_i,down) ]
              - 0.5 * (ak|ci) * (ai|ck) * [ n_a,up * n_c,up * (1-n_i,up) * (1-n_k,up) + n_a,down * n_c,down * (1-n_i,down) * (1-n_k,down) ]
+            
+            Only the orbitals k and i which are not doubly occupied, and the orbitals a which can be excited to k, contribute.
          
          */
-         for ( unsigned int k = 0; k < L; k++ ){
-            if ( bits_up[k] + bits_down[k] < 2 ){
-               for ( unsigned int a = 0; a < L; a++ ){
-               
-                  const int special_ak    = ( bits_up[a]   * ( 1 - bits_up[k]   )
-                                            + bits_down[a] * ( 1 - bits_down[k] ) );
-                  const int local_ak_up   = bits_up[a]   * ( 1 - bits_up[k]   );
-                  const int local_ak_down = bits_down[a] * ( 1 - bits_down[k] );
+         const unsigned int not_double = full & ( ~( string_up & string_down ) );
+         for ( unsigned int occ_k = not_double; occ_k != 0; occ_k &= ( occ_k - 1 ) ){
+            const int k = lowest_bit( occ_k );
+            const int bar_k_up   = 1 - occupation( string_up,   k );
+            const int bar_k_down = 1 - occupation( string_down, k );
+            const unsigned int excitable = (( bar_k_up ) ? string_up : 0 ) | (( bar_k_down ) ? string_down : 0 );
+            for ( unsigned int occ_a = excitable; occ_a != 0; occ_a &= ( occ_a - 1 ) ){
+               const int a = lowest_bit( occ_a );
                
-                  if ( ( special_ak > 0 ) || ( local_ak_up > 0 ) || ( local_ak_down > 0 ) ){
+               const int local_ak_up   = occupation( string_up,   a ) * bar_k_up;
+               const int local_ak_down = occupation( string_down, a ) * bar_k_down;
+               const int special_ak    = local_ak_up + local_ak_down;
+               const int irrep_ak      = Irreps::directProd( getOrb2Irrep(a), getOrb2Irrep(k) );
                   
-                     const int irrep_ak = Irreps::directProd( getOrb2Irrep(a), getOrb2Irrep(k) );
-                        
-                     for ( unsigned int i = 0; i < L; i++ ){
-                        if ( bits_up[i] + bits_down[i] < 2 ){
+               for ( unsigned int occ_i = not_double; occ_i != 0; occ_i &= ( occ_i - 1 ) ){
+                  const int i = lowest_bit( occ_i );
                   
-                           const int offset     = Irreps::directProd( irrep_ak, getOrb2Irrep(i) ) * ( L + 1 );
-                           const int bar_i_up   = 1 - bits_up[i];
-                           const int bar_i_down = 1 - bits_down[i];
-                           const int max_c_cnt  = specific_orbs_irrep[ L + offset ];
-                              
-                           for ( int c_cnt = 0; c_cnt < max_c_cnt; c_cnt++ ){
-                              const int c            = specific_orbs_irrep[ c_cnt + offset ];
-                              const int fact_ic_up   = bits_up[c]   * bar_i_up;
-                              const int fact_ic_down = bits_down[c] * bar_i_down;
-                              const int prefactor1   = ( fact_ic_up + fact_ic_down ) * special_ak;
-                              const int prefactor2   = local_ak_up * fact_ic_up + local_ak_down * fact_ic_down;
-                              const double eri_akci  = getERI(a, k, c, i);
-                              const double eri_aick  = getERI(a, i, c, k);
-                              myResult += 0.5 * eri_akci * ( prefactor1 * eri_akci - prefactor2 * eri_aick );
-                           }
-                        }
-                     }
+                  const int offset     = Irreps::directProd( irrep_ak, getOrb2Irrep(i) ) * ( L + 1 );
+                  const int bar_i_up   = 1 - occupation( string_up,   i );
+                  const int bar_i_down = 1 - occupation( string_down, i );
+                  const int max_c_cnt  = specific_orbs_irrep[ L + offset ];
+                     
+                  for ( int c_cnt = 0; c_cnt < max_c_cnt; c_cnt++ ){
+                     const int c            = specific_orbs_irrep[ c_cnt + offset ];
+                     const int fact_ic_up   = occupation( string_up,   c ) * bar_i_up;
+                     const int fact_ic_down = occupation( string_down, c ) * bar_i_down;
+                     const int prefactor1   = ( fact_ic_up + fact_ic_down ) * special_ak;
+                     const int prefactor2   = local_ak_up * fact_ic_up + local_ak_down * fact_ic_down;
+                     const double eri_akci  = getERI(a, k, c, i);
+                     const double eri_aick  = getERI(a, i, c, k);
+                     myResult += 0.5 * eri_akci * ( prefactor1 * eri_akci - prefactor2 * eri_aick );
                   }
                }
             }
@@ -1675,9 +2182,7 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
       
       }
       
-      delete [] bits_up;
-      delete [] bits_down;
-      
+      delete [] K_all;
       delete [] Jmat;
       delete [] K_reg_up;
       delete [] K_reg_down;
@@ -1717,149 +2222,77 @@ unsigned int CheMPS2::FCI::LowestEnergyDeterminant() const{
 
 }
 
-double CheMPS2::FCI::GetMatrixElement(int * bits_bra_up, int * bits_bra_down, int * bits_ket_up, int * bits_ket_down, int * work) const{
-   
-   int count_annih_up   = 0;
-   int count_creat_up   = 0;
-   int count_annih_down = 0;
-   int count_creat_down = 0;
-   
-   int * annih_up   = work;
-   int * creat_up   = work+2;
-   int * annih_down = work+4;
-   int * creat_down = work+6;
-   
-   // Find the differences between bra and ket, and store them in the arrays annih/creat
-   for (unsigned int orb = 0; orb < L; orb++){
-      if ( bits_bra_up[ orb ] != bits_ket_up[ orb ] ){
-         if ( bits_ket_up[ orb ] ){ // Electron is annihilated in the ket
-            if ( count_annih_up == 2 ){ return 0.0; }
-            annih_up[ count_annih_up ] = orb;
-            count_annih_up++;
-         } else { // Electron is created in the ket
-            if ( count_creat_up == 2 ){ return 0.0; }
-            creat_up[ count_creat_up ] = orb;
-            count_creat_up++;
-         }
-      }
-      if ( bits_bra_down[ orb ] != bits_ket_down[ orb ] ){
-         if ( bits_ket_down[ orb ] ){ // Electron is annihilated in the ket
-            if ( count_annih_down == 2 ){ return 0.0; }
-            annih_down[ count_annih_down ] = orb;
-            count_annih_down++;
-         } else { // Electron is created in the ket
-            if ( count_creat_down == 2 ){ return 0.0; }
-            creat_down[ count_creat_down ] = orb;
-            count_creat_down++;
-         }
-      }
-   }
-   
+double CheMPS2::FCI::GetMatrixElement(int * bits_bra_up, int * bits_bra_down, int * bits_ket_up, int * bits_ket_down, int * /*work*/) const{
+
+   return GetMatrixElement( bits2str( L, bits_bra_up ), bits2str( L, bits_bra_down ), bits2str( L, bits_ket_up ), bits2str( L, bits_ket_down ) );
+
+}
+
+double CheMPS2::FCI::GetMatrixElement(const unsigned int bra_up, const unsigned int bra_down, const unsigned int ket_up, const unsigned int ket_down) const{
+
+   // The electrons which are created (occupied in the bra only) and annihilated (occupied in the ket only)
+   const unsigned int creat_up   = bra_up   & ( ~ket_up   );
+   const unsigned int annih_up   = ket_up   & ( ~bra_up   );
+   const unsigned int creat_down = bra_down & ( ~ket_down );
+   const unsigned int annih_down = ket_down & ( ~bra_down );
+
+   const int count_annih_up   = popcount_str( annih_up   );
+   const int count_annih_down = popcount_str( annih_down );
+
    // Sanity check: spin symmetry
-   if ( count_annih_up   != count_creat_up   ){ return 0.0; }
-   if ( count_annih_down != count_creat_down ){ return 0.0; }
-   
+   if ( count_annih_up   != popcount_str( creat_up   ) ){ return 0.0; }
+   if ( count_annih_down != popcount_str( creat_down ) ){ return 0.0; }
+
    // Sanity check: At most 2 annihilators and 2 creators can connect the ket and bra
    if ( count_annih_up + count_annih_down > 2 ){ return 0.0; }
-   if ( count_creat_up + count_creat_down > 2 ){ return 0.0; }
-   
-   if (( count_annih_up == 0 ) && ( count_annih_down == 0 )){ // |bra> == |ket>  -->  copy from DiagHam( )
-   
-      double result = 0.0;
-      for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){
-         const int n_tot_orb1 = bits_ket_up[ orb1 ] + bits_ket_down[ orb1 ];
-         result += n_tot_orb1 * getGmat( orb1 , orb1 );
-         for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){
-            result += 0.5 * n_tot_orb1 * ( bits_ket_up[ orb2 ] + bits_ket_down[ orb2 ] ) * getERI( orb1 , orb1 , orb2 , orb2 )
-            + 0.5 * ( n_tot_orb1 - bits_ket_up[ orb1 ] * bits_ket_up[ orb2 ] - bits_ket_down[ orb1 ] * bits_ket_down[ orb2 ] ) * getERI( orb1 , orb2 , orb2 , orb1 );
-         }
-      }
-      return result;
-      
-   }
-   
-   if (( count_annih_up == 1 ) && ( count_annih_down == 0 )){ // |bra> = a^+_j,up a_l,up |ket>
-   
-      const int orbj = creat_up[ 0 ];
-      const int orbl = annih_up[ 0 ];
-   
+
+   if (( count_annih_up == 0 ) && ( count_annih_down == 0 )){ return DiagHamElement( ket_up, ket_down ); } // |bra> == |ket>
+
+   if ( count_annih_up + count_annih_down == 1 ){ // |bra> = a^+_j,s a_l,s |ket>
+
+      const bool is_up = ( count_annih_up == 1 );
+      const unsigned int ket_same  = (( is_up ) ? ket_up : ket_down );
+      const unsigned int ket_other = (( is_up ) ? ket_down : ket_up );
+      const int orbj = lowest_bit( ( is_up ) ? creat_up : creat_down );
+      const int orbl = lowest_bit( ( is_up ) ? annih_up : annih_down );
+
       double result = getGmat( orbj , orbl );
-      for (unsigned int orb1 = 0; orb1 < L; orb1++){
-         result += getERI(orbj, orb1, orb1, orbl) * ( 0.5 - bits_ket_up[ orb1 ] ) + getERI(orb1, orb1, orbj, orbl) * ( bits_ket_up[ orb1 ] + bits_ket_down[ orb1 ] );
+      for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){ result += 0.5 * getERI( orbj , orb1 , orb1 , orbl ); }
+      for ( unsigned int occ = ket_same; occ != 0; occ &= ( occ - 1 ) ){
+         const int orb1 = lowest_bit( occ );
+         result += getERI( orb1 , orb1 , orbj , orbl ) - getERI( orbj , orb1 , orb1 , orbl );
       }
-      int phase = 1;
-      if ( orbj < orbl ){ for (int orbital = orbj+1; orbital < orbl; orbital++){ if ( bits_ket_up[ orbital ] ){ phase *= -1; } } }
-      if ( orbl < orbj ){ for (int orbital = orbl+1; orbital < orbj; orbital++){ if ( bits_ket_up[ orbital ] ){ phase *= -1; } } }
-      return ( result * phase );
-   
-   }
-   
-   if (( count_annih_up == 0 ) && ( count_annih_down == 1 )){ // |bra> = a^+_j,down a_l,down |ket>
-   
-      const int orbj = creat_down[ 0 ];
-      const int orbl = annih_down[ 0 ];
-   
-      double result = getGmat( orbj , orbl );
-      for (unsigned int orb1 = 0; orb1 < L; orb1++){
-         result += getERI(orbj, orb1, orb1, orbl) * ( 0.5 - bits_ket_down[ orb1 ] ) + getERI(orb1, orb1, orbj, orbl) * ( bits_ket_up[ orb1 ] + bits_ket_down[ orb1 ] );
+      for ( unsigned int occ = ket_other; occ != 0; occ &= ( occ - 1 ) ){
+         const int orb1 = lowest_bit( occ );
+         result += getERI( orb1 , orb1 , orbj , orbl );
       }
-      int phase = 1;
-      if ( orbj < orbl ){ for (int orbital = orbj+1; orbital < orbl; orbital++){ if ( bits_ket_down[ orbital ] ){ phase *= -1; } } }
-      if ( orbl < orbj ){ for (int orbital = orbl+1; orbital < orbj; orbital++){ if ( bits_ket_down[ orbital ] ){ phase *= -1; } } }
-      return ( result * phase );
-   
-   }
-   
-   if (( count_annih_up == 2 ) && ( count_annih_down == 0 )){
-   
-      // creat and annih are filled in increasing orbital index
-      const int orbi = creat_up[ 0 ];
-      const int orbj = creat_up[ 1 ];
-      const int orbk = annih_up[ 0 ];
-      const int orbl = annih_up[ 1 ];
-      
-      double result = getERI(orbi, orbk, orbj, orbl) - getERI(orbi, orbl, orbj, orbk);
-      int phase = 1;
-      for (int orbital = orbk+1; orbital < orbl; orbital++){ if ( bits_ket_up[ orbital ] ){ phase *= -1; } } // Fermion phases orbk and orbl measured in the ket
-      for (int orbital = orbi+1; orbital < orbj; orbital++){ if ( bits_bra_up[ orbital ] ){ phase *= -1; } } // Fermion phases orbi and orbj measured in the bra
-      return ( result * phase );
-   
-   }
-   
-   if (( count_annih_up == 0 ) && ( count_annih_down == 2 )){
-   
-      // creat and annih are filled in increasing orbital index
-      const int orbi = creat_down[ 0 ];
-      const int orbj = creat_down[ 1 ];
-      const int orbk = annih_down[ 0 ];
-      const int orbl = annih_down[ 1 ];
-      
-      double result = getERI(orbi, orbk, orbj, orbl) - getERI(orbi, orbl, orbj, orbk);
-      int phase = 1;
-      for (int orbital = orbk+1; orbital < orbl; orbital++){ if ( bits_ket_down[ orbital ] ){ phase *= -1; } } // Fermion phases orbk and orbl measured in the ket
-      for (int orbital = orbi+1; orbital < orbj; orbital++){ if ( bits_bra_down[ orbital ] ){ phase *= -1; } } // Fermion phases orbi and orbj measured in the bra
-      return ( result * phase );
-   
+      return ( result * string_phase( ket_same, orbl, orbj ) );
+
    }
-   
+
    if (( count_annih_up == 1 ) && ( count_annih_down == 1 )){
-   
-      const int orbi = creat_up  [ 0 ];
-      const int orbj = creat_down[ 0 ];
-      const int orbk = annih_up  [ 0 ];
-      const int orbl = annih_down[ 0 ];
-      
-      double result = getERI(orbi, orbk, orbj, orbl);
-      int phase = 1;
-      if ( orbi < orbk ){ for (int orbital = orbi+1; orbital < orbk; orbital++){ if ( bits_ket_up  [ orbital ] ){ phase *= -1; } } }
-      if ( orbk < orbi ){ for (int orbital = orbk+1; orbital < orbi; orbital++){ if ( bits_ket_up  [ orbital ] ){ phase *= -1; } } }
-      if ( orbj < orbl ){ for (int orbital = orbj+1; orbital < orbl; orbital++){ if ( bits_ket_down[ orbital ] ){ phase *= -1; } } }
-      if ( orbl < orbj ){ for (int orbital = orbl+1; orbital < orbj; orbital++){ if ( bits_ket_down[ orbital ] ){ phase *= -1; } } }
-      return ( result * phase );
-   
+
+      const int orbi = lowest_bit( creat_up   );
+      const int orbj = lowest_bit( creat_down );
+      const int orbk = lowest_bit( annih_up   );
+      const int orbl = lowest_bit( annih_down );
+
+      return ( getERI( orbi , orbk , orbj , orbl ) * string_phase( ket_up, orbk, orbi ) * string_phase( ket_down, orbl, orbj ) );
+
    }
-   
-   return 0.0;
+
+   // Two electrons of the same spin: creat and annih in increasing orbital index
+   const unsigned int creat = (( count_annih_up == 2 ) ? creat_up : creat_down );
+   const unsigned int annih = (( count_annih_up == 2 ) ? annih_up : annih_down );
+   const int orbi = lowest_bit( creat );
+   const int orbj = lowest_bit( creat & ( creat - 1 ) );
+   const int orbk = lowest_bit( annih );
+   const int orbl = lowest_bit( annih & ( annih - 1 ) );
+
+   const double result = getERI( orbi , orbk , orbj , orbl ) - getERI( orbi , orbl , orbj , orbk );
+   const int phase = string_phase( (( count_annih_up == 2 ) ? ket_up : ket_down ), orbk, orbl )  // Fermion phases orbk and orbl measured in the ket
+                   * string_phase( (( count_annih_up == 2 ) ? bra_up : bra_down ), orbi, orbj ); // Fermion phases orbi and orbj measured in the bra
+   return ( result * phase );
 
 }
 
@@ -1915,29 +2348,43 @@ void CheMPS2::FCI::FillRandom(const unsigned int vecLength, double * vec){
 
 }
 
-double CheMPS2::FCI::GSDavidson(double * inoutput, const int DVDSN_NUM_VEC) const{
+double CheMPS2::FCI::GSDavidson(double * inoutput, const int DVDSN_NUM_VEC, const bool mpi_distributed, const double maxMemVecMB, const string tmpfolder) const{
 
-   const int veclength = getVecLength( 0 ); // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
+   const bool distributed = (( mpi_distributed ) && ( MPIchemps2::mpi_size() > 1 )); // The Davidson vectors are slices of getLocalVecLength() variables
+   const int veclength = (( distributed ) ? getLocalVecLength() : getVecLength( 0 )); // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
+   const double num_megabytes = ( 2.0 * DVDSN_NUM_VEC + 4.0 ) * veclength * sizeof(double) / 1048576.0;
+   const bool disk = ( num_megabytes > maxMemVecMB );
+   if (( disk ) && ( FCIverbose > 1 )){
+      cout << "FCI::GSDavidson : The Davidson vectors require " << num_megabytes << " MB > " << maxMemVecMB << " MB, so the subspace is kept on disk in " << tmpfolder << endl;
+   }
    Davidson deBoskabouter( veclength, DVDSN_NUM_VEC,
                                       CheMPS2::DAVIDSON_NUM_VEC_KEEP,
                                       CheMPS2::DAVIDSON_FCI_RTOL,
-                                      CheMPS2::DAVIDSON_PRECOND_CUTOFF, false ); // No debug printing for FCI
+                                      CheMPS2::DAVIDSON_PRECOND_CUTOFF, false, distributed, disk, tmpfolder ); // No debug printing for FCI
    double ** whichpointers = new double*[2];
 
    char instruction = deBoskabouter.FetchInstruction( whichpointers );
    assert( instruction == 'A' );
-   if ( inoutput != NULL ){ FCIdcopy( veclength, inoutput, whichpointers[0] ); }
+   if ( inoutput != NULL ){
+      if ( distributed ){ ScatterVector( inoutput, whichpointers[0] ); }
+      else { FCIdcopy( veclength, inoutput, whichpointers[0] ); }
+   }
    else { FillRandom( veclength, whichpointers[0] ); }
-   DiagHam( whichpointers[1] );
+   if ( distributed ){ DiagHamLocal( whichpointers[1] ); }
+   else { DiagHam( whichpointers[1] ); }
 
    instruction = deBoskabouter.FetchInstruction( whichpointers );
    while ( instruction == 'B' ){
-      matvec( whichpointers[0], whichpointers[1] );
+      if ( distributed ){ matvec_distributed( whichpointers[0], whichpointers[1] ); }
+      else { matvec( whichpointers[0], whichpointers[1] ); }
       instruction = deBoskabouter.FetchInstruction( whichpointers );
    }
 
    assert( instruction == 'C' );
-   if ( inoutput != NULL ){ FCIdcopy( veclength, whichpointers[0], inoutput ); }
+   if ( inoutput != NULL ){
+      if ( distributed ){ GatherVector( whichpointers[0], inoutput ); }
+      else { FCIdcopy( veclength, whichpointers[0], inoutput ); }
+   }
    const double FCIenergy = whichpointers[1][0] + getEconst();
    if ( FCIverbose > 1 ){ cout << "FCI::GSDavidson : Required number of matrix-vector multiplications = " << deBoskabouter.GetNumMultiplications() << endl; }
    if ( FCIverbose > 0 ){ cout << "FCI::GSDavidson : Converged ground state energy = " << FCIenergy << endl; }
@@ -1946,29 +2393,236 @@ double CheMPS2::FCI::GSDavidson(double * inoutput, const int DVDSN_NUM_VEC) cons
 
 }
 
-/*********************************************************************************
- *                                                                               *
- *   Below this block all functions are for the Green's function calculations.   *
- *                                                                               *
- *********************************************************************************/
-
-void CheMPS2::FCI::ActWithNumberOperator(const unsigned int orbIndex, double * resultVector, double * sourceVector) const{
+void CheMPS2::FCI::MultiRootDavidson(const int num_roots, double * energies, double * vectors, const int DVDSN_NUM_VEC) const{
 
-   assert( orbIndex<L );
+   /*
+      Block Davidson for the num_roots lowest eigenpairs of the FCI Hamiltonian. Each iteration adds the preconditioned
+      residuals of the unconverged roots to the subspace, and their Hamiltonian products are computed with one matvec_block.
+      When the subspace is full, it is collapsed onto the num_roots + DAVIDSON_NUM_VEC_KEEP lowest Ritz vectors.
+   */
 
-   int * bits_up    = new int[ L ];
-   int * bits_down  = new int[ L ];
+   assert( num_roots >= 1 );
+   assert( energies != NULL );
+   int veclength = getVecLength( 0 ); // Not const for the lapack calls
+   assert( num_roots <= veclength );
+   const int num_keep = std::min( num_roots + CheMPS2::DAVIDSON_NUM_VEC_KEEP, veclength );
+   const int max_vec  = std::min( std::max( DVDSN_NUM_VEC, num_keep + num_roots ), veclength );
+   const unsigned long long size = veclength; // To avoid integer overflow in the offsets
+
+   double * vecs  = new double[ size * max_vec ];
+   double * Hvecs = new double[ size * max_vec ];
+   double * ritz  = new double[ size * num_keep ];      // Ritz vectors; on deflation also for the collapsed subspace
+   double * Hritz = new double[ size * num_keep ];
+   double * diag  = new double[ veclength ];
+   double * mxM      = new double[ max_vec * max_vec ];
+   double * mxM_vecs = new double[ max_vec * max_vec ];
+   double * mxM_eigs = new double[ max_vec ];
+   int lwork = 3 * max_vec;
+   double * work = new double[ lwork ];
+   double * resnorms = new double[ num_roots ];
+   DiagHam( diag );
+
+   // At most num_roots vectors are multiplied at once: allocate the block workspaces once for the whole run
+   const unsigned long long size_work = block_workspace_size( num_roots );
+   double * work1 = (( size_work > HXVsizeWorkspace ) ? new double[ size_work ] : HXVworkbig1 );
+   double * work2 = (( size_work > HXVsizeWorkspace ) ? new double[ size_work ] : HXVworkbig2 );
+
+   // Initial guess: the input vectors, or the lowest Slater determinants for the zero ones
+   int num_vec = 0;
+   {
+      bool * used = new bool[ veclength ];
+      for ( int count = 0; count < veclength; count++ ){ used[ count ] = false; }
+      for ( int root = 0; root < num_roots; root++ ){
+         double * guess = vecs + size * num_vec;
+         const double norm = ( vectors != NULL ) ? FCIfrobeniusnorm( veclength, vectors + size * root ) : 0.0;
+         if ( norm > 0.0 ){
+            FCIdcopy( veclength, vectors + size * root, guess );
+         } else {
+            int minEindex = -1;
+            for ( int count = 0; count < veclength; count++ ){
+               if (( !used[ count ] ) && (( minEindex == -1 ) || ( diag[ count ] < diag[ minEindex ] ))){ minEindex = count; }
+            }
+            used[ minEindex ] = true;
+            ClearVector( veclength, guess );
+            guess[ minEindex ] = 1.0;
+         }
+         for ( int loop = 0; loop < 2; loop++ ){ // Gram-Schmidt twice
+            for ( int prev = 0; prev < num_vec; prev++ ){
+               FCIdaxpy( veclength, - FCIddot( veclength, vecs + size * prev, guess ), vecs + size * prev, guess );
+            }
+         }
+         const double new_norm = FCIfrobeniusnorm( veclength, guess );
+         if ( new_norm > CheMPS2::DAVIDSON_PRECOND_CUTOFF ){
+            FCIdscal( veclength, 1.0 / new_norm, guess );
+            num_vec++;
+         }
+      }
+      delete [] used;
+      assert( num_vec > 0 );
+   }
+
+   int num_new = num_vec;
+   int num_matvec = 0;
+   bool converged = false;
+   while ( !converged ){
+
+      // Hamiltonian times the new vectors, and the new part of the subspace matrix
+      const int first_new = num_vec - num_new;
+      matvec_block( num_new, vecs + size * first_new, Hvecs + size * first_new, size_work, work1, work2 );
+      num_matvec += num_new;
+      for ( int col = first_new; col < num_vec; col++ ){
+         for ( int row = 0; row <= col; row++ ){
+            const double value = FCIddot( veclength, vecs + size * row, Hvecs + size * col );
+            mxM[ row + max_vec * col ] = value;
+            mxM[ col + max_vec * row ] = value;
+         }
+      }
 
-   const unsigned int vecLength = getVecLength( 0 );
-   for (unsigned int counter = 0; counter < vecLength; counter++){
-      getBitsOfCounter( 0 , counter , bits_up , bits_down );
-      resultVector[ counter ] = ( bits_up[ orbIndex ] + bits_down[ orbIndex ] ) * sourceVector[ counter ];
-   }
-   
-   delete [] bits_up;
-   delete [] bits_down;
+      // Diagonalize the subspace matrix
+      for ( int col = 0; col < num_vec; col++ ){
+         for ( int row = 0; row < num_vec; row++ ){
+            mxM_vecs[ row + num_vec * col ] = mxM[ row + max_vec * col ];
+         }
+      }
+      {
+         char jobz = 'V';
+         char uplo = 'U';
+         int info;
+         dsyev_( &jobz, &uplo, &num_vec, mxM_vecs, &num_vec, mxM_eigs, work, &lwork, &info );
+      }
 
-}
+      // Ritz vectors and their residuals
+      int num_ritz = std::min( num_vec, num_keep );
+      {
+         char notrans = 'N';
+         double one = 1.0;
+         double set = 0.0;
+         dgemm_( &notrans, &notrans, &veclength, &num_ritz, &num_vec, &one,  vecs, &veclength, mxM_vecs, &num_vec, &set,  ritz, &veclength );
+         dgemm_( &notrans, &notrans, &veclength, &num_ritz, &num_vec, &one, Hvecs, &veclength, mxM_vecs, &num_vec, &set, Hritz, &veclength );
+      }
+      converged = true;
+      for ( int root = 0; root < num_roots; root++ ){
+         double * residual = Hritz + size * root;
+         if ( root < num_vec ){
+            FCIdaxpy( veclength, - mxM_eigs[ root ], ritz + size * root, residual ); // Hritz now contains the residual
+            resnorms[ root ] = FCIfrobeniusnorm( veclength, residual );
+         } else {
+            resnorms[ root ] = 1.0; // Not enough vectors yet
+         }
+         if ( resnorms[ root ] >= CheMPS2::DAVIDSON_FCI_RTOL ){ converged = false; }
+      }
+      if ( FCIverbose > 1 ){
+         cout << "FCI::MultiRootDavidson : subspace dimension = " << num_vec << " ; residual norms =";
+         for ( int root = 0; root < num_roots; root++ ){ cout << " " << resnorms[ root ]; }
+         cout << endl;
+      }
+      if (( converged ) || ( num_vec == veclength )){ converged = true; break; }
+
+      // New directions: preconditioned residuals of the unconverged roots (stored in Hritz)
+      num_new = 0;
+      for ( int root = 0; root < std::min( num_roots, num_vec ); root++ ){
+         if ( resnorms[ root ] >= CheMPS2::DAVIDSON_FCI_RTOL ){
+            double * target = Hritz + size * num_new;
+            if ( target != Hritz + size * root ){ FCIdcopy( veclength, Hritz + size * root, target ); }
+            for ( int count = 0; count < veclength; count++ ){
+               double denom = mxM_eigs[ root ] - diag[ count ];
+               if ( fabs( denom ) < CheMPS2::DAVIDSON_PRECOND_CUTOFF ){ denom = (( denom < 0.0 ) ? -1 : 1 ) * CheMPS2::DAVIDSON_PRECOND_CUTOFF; }
+               target[ count ] = target[ count ] / denom;
+            }
+            num_new++;
+         }
+      }
+
+      // Deflation: collapse the subspace onto the lowest Ritz vectors
+      if ( num_vec + num_new > max_vec ){
+         FCIdcopy( veclength * num_ritz, ritz, vecs );
+         int num_ritz_new = std::min( num_ritz, max_vec - num_new );
+         {
+            char notrans = 'N';
+            double one = 1.0;
+            double set = 0.0;
+            dgemm_( &notrans, &notrans, &veclength, &num_ritz_new, &num_vec, &one, Hvecs, &veclength, mxM_vecs, &num_vec, &set, ritz, &veclength );
+         }
+         FCIdcopy( veclength * num_ritz_new, ritz, Hvecs );
+         FCIdcopy( veclength * num_ritz_new, vecs, ritz );
+         for ( int col = 0; col < num_ritz_new; col++ ){
+            for ( int row = 0; row < num_ritz_new; row++ ){
+               mxM[ row + max_vec * col ] = (( row == col ) ? mxM_eigs[ row ] : 0.0 );
+            }
+         }
+         num_vec = num_ritz_new;
+      }
+
+      // Orthonormalize the new directions against the subspace and each other
+      const int num_candidates = num_new;
+      num_new = 0;
+      for ( int cand = 0; cand < num_candidates; cand++ ){
+         double * target = vecs + size * num_vec;
+         FCIdcopy( veclength, Hritz + size * cand, target );
+         const double norm_in = FCIfrobeniusnorm( veclength, target );
+         for ( int loop = 0; loop < 2; loop++ ){ // Gram-Schmidt twice
+            for ( int prev = 0; prev < num_vec; prev++ ){
+               FCIdaxpy( veclength, - FCIddot( veclength, vecs + size * prev, target ), vecs + size * prev, target );
+            }
+         }
+         const double norm_out = FCIfrobeniusnorm( veclength, target );
+         if ( norm_out > CheMPS2::DAVIDSON_PRECOND_CUTOFF * std::max( 1.0, norm_in ) ){
+            FCIdscal( veclength, 1.0 / norm_out, target );
+            num_vec++;
+            num_new++;
+         }
+      }
+      if ( num_new == 0 ){ converged = true; } // The subspace cannot be extended anymore
+
+   }
+
+   for ( int root = 0; root < num_roots; root++ ){
+      energies[ root ] = (( root < num_vec ) ? mxM_eigs[ root ] : 0.0 ) + getEconst();
+   }
+   if ( vectors != NULL ){ FCIdcopy( veclength * std::min( num_roots, num_vec ), ritz, vectors ); }
+
+   if ( FCIverbose > 1 ){ cout << "FCI::MultiRootDavidson : Required number of matrix-vector multiplications = " << num_matvec << endl; }
+   if ( FCIverbose > 0 ){
+      for ( int root = 0; root < num_roots; root++ ){
+         cout << "FCI::MultiRootDavidson : Converged energy of root " << root << " = " << energies[ root ] << endl;
+      }
+   }
+
+   delete [] vecs;
+   delete [] Hvecs;
+   delete [] ritz;
+   delete [] Hritz;
+   delete [] diag;
+   delete [] mxM;
+   delete [] mxM_vecs;
+   delete [] mxM_eigs;
+   delete [] work;
+   delete [] resnorms;
+   if ( size_work > HXVsizeWorkspace ){
+      delete [] work1;
+      delete [] work2;
+   }
+
+}
+
+/*********************************************************************************
+ *                                                                               *
+ *   Below this block all functions are for the Green's function calculations.   *
+ *                                                                               *
+ *********************************************************************************/
+
+void CheMPS2::FCI::ActWithNumberOperator(const unsigned int orbIndex, double * resultVector, double * sourceVector) const{
+
+   assert( orbIndex<L );
+
+   const unsigned int vecLength = getVecLength( 0 );
+   for (unsigned int counter = 0; counter < vecLength; counter++){
+      unsigned int string_up, string_down;
+      getStringsOfCounter( 0 , counter , string_up , string_down );
+      resultVector[ counter ] = ( ( ( string_up >> orbIndex ) & 1U ) + ( ( string_down >> orbIndex ) & 1U ) ) * sourceVector[ counter ];
+   }
+
+}
 
 void CheMPS2::FCI::ActWithSecondQuantizedOperator(const char whichOperator, const bool isUp, const unsigned int orbIndex, double * thisVector, const FCI * otherFCI, double * otherVector) const{
 
@@ -1983,81 +2637,30 @@ void CheMPS2::FCI::ActWithSecondQuantizedOperator(const char whichOperator, cons
       return;
    }
 
-   int * bits_up    = new int[ L ];
-   int * bits_down  = new int[ L ];
-   
-   if (( whichOperator=='C') && ( isUp )){
-      for (unsigned int counter = 0; counter < vecLength; counter++){
-         
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-         
-         if ( bits_up[ orbIndex ] == 1 ){ // Operator = creator_up
-            bits_up[ orbIndex ] = 0;
-            int phase = 1;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_up[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
-         }
-         
-      }
-   }
-   
-   if (( whichOperator=='C') && ( !(isUp) )){
-      const int startphase = (( Nel_up % 2 ) == 0) ? 1 : -1;
-      for (unsigned int counter = 0; counter < vecLength; counter++){
-
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
+   /* Creator:     the orbital is occupied in this FCI's determinant and empty in the otherFCI's determinant
+      Annihilator: the orbital is empty in this FCI's determinant and occupied in the otherFCI's determinant
+      The phase is the parity of the electrons in front of orbIndex, with all up electrons in front of the down electrons */
+   const unsigned int orb_mask   = 1U << orbIndex;
+   const unsigned int below_mask = orb_mask - 1;
+   const unsigned int occupied   = (( whichOperator=='C' ) ? orb_mask : 0 );
+   const int startphase = (( isUp ) || (( Nel_up % 2 ) == 0 )) ? 1 : -1;
 
-         if ( bits_down[ orbIndex ] == 1 ){ // Operator = creator_down
-            bits_down[ orbIndex ] = 0;
-            int phase = startphase;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_down[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
-         }
-
-      }
-   }
-   
-   if (( whichOperator=='A') && ( isUp )){
-      for (unsigned int counter = 0; counter < vecLength; counter++){
-
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-         
-         if ( bits_up[ orbIndex ] == 0 ){ // Operator = annihilator_up
-            bits_up[ orbIndex ] = 1;
-            int phase = 1;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_up[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
-         }
+   for (unsigned int counter = 0; counter < vecLength; counter++){
 
+      unsigned int string_up, string_down;
+      getStringsOfCounter( 0 , counter , string_up , string_down );
+      const unsigned int string = (( isUp ) ? string_up : string_down );
+
+      if ( ( string & orb_mask ) == occupied ){
+         const int phase = (( popcount_str( string & below_mask ) & 1 ) ? -startphase : startphase );
+         if ( isUp ){ string_up   ^= orb_mask; }
+         else {       string_down ^= orb_mask; }
+         thisVector[ counter ] = phase * otherFCI->getFCIcoeff( string_up , string_down , otherVector );
+      } else {
+         thisVector[ counter ] = 0.0;
       }
-   }
-   
-   if (( whichOperator=='A') && ( !(isUp) )){
-      const int startphase = (( Nel_up % 2 ) == 0) ? 1 : -1;
-      for (unsigned int counter = 0; counter < vecLength; counter++){
 
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-         
-         if ( bits_down[ orbIndex ] == 0 ){ // Operator = annihilator_down
-            bits_down[ orbIndex ] = 1;
-            int phase = startphase;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_down[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
-         }
-         
-      }
    }
-   
-   delete [] bits_up;
-   delete [] bits_down;
 
 }
 
@@ -2137,6 +2740,87 @@ void CheMPS2::FCI::CGSolveSystem(const double alpha, const double beta, const do
 
 }
 
+void CheMPS2::FCI::COCGSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol, const bool checkError) const{
+
+   const unsigned int vecLength = getVecLength( 0 );
+
+   assert( RealSol != NULL );
+   assert( ImagSol != NULL );
+   assert( fabs( eta ) > 0.0 );
+
+   /*
+         ( alpha + beta H + I eta ) Solution = RHS
+
+      is solved with the conjugate orthogonal conjugate gradient (COCG) method. The operator is complex symmetric, so the
+      condition number is not squared as in CGSolveSystem. Each iteration requires two matvecs: one for the real and one
+      for the imaginary part of the search direction. The preconditioner is 1 / diag( alpha + beta H + I eta ).
+   */
+
+   double * diag = new double[ vecLength ];
+   DiagHam( diag );
+   const double alpha_bis = alpha + beta * getEconst(); // DiagHam does not contain Econstant
+
+   double ** pointers = new double*[ 6 ];
+   double RMSerror = 0.0;
+   bool success = true;
+   {
+      COCG solver( vecLength, CheMPS2::CONJ_GRADIENT_RTOL, CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF, CheMPS2::FCI_GF_COCG_MAX_MATVEC, CheMPS2::FCI_GF_COCG_BREAKDOWN, false );
+      char instruction = solver.step( pointers );
+      assert( instruction == 'A' );
+      for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){
+         const double diag_re = alpha_bis + beta * diag[ cnt ];
+         const double modulus = diag_re * diag_re + eta * eta;
+         pointers[ 0 ][ cnt ] =   RHS[ cnt ] * diag_re / modulus; // Initial guess RHS / diag
+         pointers[ 1 ][ cnt ] = - RHS[ cnt ] * eta     / modulus;
+         pointers[ 2 ][ cnt ] = diag_re;                           // Diagonal of the operator
+         pointers[ 3 ][ cnt ] = eta;
+         pointers[ 4 ][ cnt ] = RHS[ cnt ];                        // RHS of the problem
+         pointers[ 5 ][ cnt ] = 0.0;
+      }
+      instruction = solver.step( pointers );
+      assert( instruction == 'B' );
+      while ( instruction == 'B' ){
+         CGAlphaPlusBetaHAM( alpha, beta, pointers[ 0 ], pointers[ 2 ] ); // Re{ out } = ( alpha + beta H ) Re{ in } - eta Im{ in }
+         CGAlphaPlusBetaHAM( alpha, beta, pointers[ 1 ], pointers[ 3 ] ); // Im{ out } = ( alpha + beta H ) Im{ in } + eta Re{ in }
+         FCIdaxpy( vecLength, -eta, pointers[ 1 ], pointers[ 2 ] );
+         FCIdaxpy( vecLength,  eta, pointers[ 0 ], pointers[ 3 ] );
+         instruction = solver.step( pointers );
+      }
+      if ( instruction == 'C' ){
+         FCIdcopy( vecLength, pointers[ 0 ], RealSol );
+         FCIdcopy( vecLength, pointers[ 1 ], ImagSol );
+         RMSerror = pointers[ 2 ][ 0 ];
+         if ( FCIverbose > 1 ){ cout << "FCI::COCGSolveSystem : Number of matvecs = " << 2 * solver.get_num_matvec() << endl; }
+      } else {
+         assert( instruction == 'D' );
+         success = false;
+      }
+   }
+   delete [] pointers;
+   delete [] diag;
+
+   if ( !success ){
+      if ( FCIverbose > 0 ){ cout << "FCI::COCGSolveSystem : Breakdown of COCG or no convergence within CheMPS2::FCI_GF_COCG_MAX_MATVEC; switching to CGSolveSystem" << endl; }
+      CGSolveSystem( alpha, beta, eta, RHS, RealSol, ImagSol, checkError );
+      return;
+   }
+
+   if (( checkError ) && ( FCIverbose > 0 )){
+      cout << "FCI::COCGSolveSystem : RMS error when checking the solution = " << RMSerror << endl;
+   }
+
+}
+
+void CheMPS2::FCI::GFSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol) const{
+
+   if ( CheMPS2::FCI_GF_COCG ){
+      COCGSolveSystem( alpha, beta, eta, RHS, RealSol, ImagSol );
+   } else {
+      CGSolveSystem( alpha, beta, eta, RHS, RealSol, ImagSol );
+   }
+
+}
+
 void CheMPS2::FCI::CGAlphaPlusBetaHAM(const double alpha, const double beta, double * in, double * out) const{
 
    matvec( in , out );
@@ -2186,6 +2870,170 @@ void CheMPS2::FCI::CGdiagonal(const double alpha, const double beta, const doubl
 
 }
 
+void CheMPS2::FCI::LanczosSpectrum(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, double * RHS, double ** LeftVecs, const unsigned int numLeft, double * RePartsGF, double * ImPartsGF) const{
+
+   /*
+      The Lanczos recursion H V_m = V_m T_m + b_m v_m e_{m-1}^T with v_0 = RHS / || RHS || gives for every alpha
+      
+         ( alpha + beta H + I eta )^{-1} RHS ~ || RHS || V_m ( alpha + beta T_m + I eta )^{-1} e_0
+         
+      Each tridiagonal system costs O(m), so the whole frequency grid costs a single Krylov space of one matvec per
+      iteration. The overlaps < LeftVecs[i] | v_k > are accumulated on the fly, so only three Lanczos vectors are stored.
+      When LeftVecs[i] = RHS, this is the continued fraction expansion of the diagonal Green's function.
+   */
+
+   assert( fabs( eta ) > 0.0 );
+   assert( RePartsGF != NULL );
+   assert( ImPartsGF != NULL );
+   for ( unsigned int counter = 0; counter < numLeft * numAlpha; counter++ ){
+      RePartsGF[ counter ] = 0.0;
+      ImPartsGF[ counter ] = 0.0;
+   }
+
+   const unsigned int vecLength = getVecLength( 0 );
+   const double RHSnorm = FCIfrobeniusnorm( vecLength, RHS );
+   if ( RHSnorm == 0.0 ){ return; }
+
+   const unsigned int maxKrylov = std::min( vecLength, (unsigned int) CheMPS2::FCI_LANCZOS_MAX_KRYLOV );
+   double * diag     = new double[ maxKrylov ];
+   double * offdiag  = new double[ maxKrylov ];
+   double * overlaps = new double[ numLeft * maxKrylov ];
+   double * RealSol  = new double[ maxKrylov ];
+   double * ImagSol  = new double[ maxKrylov ];
+   double * work     = new double[ 4 * maxKrylov ];
+   double * RePrev   = new double[ numLeft * numAlpha ];
+   double * ImPrev   = new double[ numLeft * numAlpha ];
+   double * vec_prev = new double[ vecLength ];
+   double * vec_curr = new double[ vecLength ];
+   double * vec_next = new double[ vecLength ];
+
+   FCIdcopy( vecLength, RHS, vec_curr );
+   FCIdscal( vecLength, 1.0 / RHSnorm, vec_curr );
+
+   unsigned int dim = 0;
+   bool evaluated = false;
+   bool converged = false;
+   bool truncated = false;
+   double change  = 0.0;
+   while ( !converged ){
+
+      for ( unsigned int left = 0; left < numLeft; left++ ){
+         overlaps[ left + numLeft * dim ] = ( LeftVecs[ left ] == NULL ) ? 0.0 : FCIddot( vecLength, LeftVecs[ left ], vec_curr );
+      }
+      matvec( vec_curr, vec_next );
+      const double a_k = FCIddot( vecLength, vec_curr, vec_next );
+      diag[ dim ] = a_k + getEconst(); // matvec does only the parts with second quantized operators
+      FCIdaxpy( vecLength, -a_k, vec_curr, vec_next );
+      if ( dim > 0 ){ FCIdaxpy( vecLength, -offdiag[ dim ], vec_prev, vec_next ); }
+      const double b_k = FCIfrobeniusnorm( vecLength, vec_next );
+      dim++;
+
+      truncated = (( b_k >= CheMPS2::FCI_LANCZOS_BREAKDOWN ) && ( dim == maxKrylov ));
+      const bool invariant = (( b_k < CheMPS2::FCI_LANCZOS_BREAKDOWN ) || ( dim == maxKrylov ));
+      if (( invariant ) || ( dim % CheMPS2::FCI_LANCZOS_CHECK == 0 )){
+         FCIdcopy( numLeft * numAlpha, RePartsGF, RePrev );
+         FCIdcopy( numLeft * numAlpha, ImPartsGF, ImPrev );
+         double maxabs = 0.0;
+         change = 0.0;
+         for ( unsigned int omega = 0; omega < numAlpha; omega++ ){
+            LanczosTridiagonal( dim, diag, offdiag, alphas[ omega ], beta, eta, RealSol, ImagSol, work );
+            for ( unsigned int left = 0; left < numLeft; left++ ){
+               const int index = left + numLeft * omega;
+               double RePart = 0.0;
+               double ImPart = 0.0;
+               for ( unsigned int k = 0; k < dim; k++ ){
+                  RePart += overlaps[ left + numLeft * k ] * RealSol[ k ];
+                  ImPart += overlaps[ left + numLeft * k ] * ImagSol[ k ];
+               }
+               RePartsGF[ index ] = RHSnorm * RePart;
+               ImPartsGF[ index ] = RHSnorm * ImPart;
+               maxabs = std::max( maxabs, sqrt( RePartsGF[ index ] * RePartsGF[ index ] + ImPartsGF[ index ] * ImPartsGF[ index ] ) );
+               const double diffRe = RePartsGF[ index ] - RePrev[ index ];
+               const double diffIm = ImPartsGF[ index ] - ImPrev[ index ];
+               change = std::max( change, sqrt( diffRe * diffRe + diffIm * diffIm ) );
+            }
+         }
+         if ( maxabs > 0.0 ){ change = change / maxabs; }
+         converged = (( invariant ) || (( evaluated ) && ( change < CheMPS2::FCI_LANCZOS_RTOL )));
+         evaluated = true;
+      }
+
+      if ( !converged ){
+         offdiag[ dim ] = b_k;
+         double * temp = vec_prev;
+         vec_prev = vec_curr;
+         vec_curr = vec_next;
+         vec_next = temp;
+         FCIdscal( vecLength, 1.0 / b_k, vec_curr );
+      }
+
+   }
+
+   if ( truncated ){
+      cout << "FCI::LanczosSpectrum : WARNING : The Krylov space dimension reached its maximum " << maxKrylov
+           << " before the Green's functions converged ; relative change of the spectrum in the last check = " << change << endl;
+   } else if ( FCIverbose > 0 ){
+      cout << "FCI::LanczosSpectrum : Krylov space dimension = " << dim << " ; relative change of the spectrum in the last check = " << change << endl;
+   }
+
+   delete [] diag;
+   delete [] offdiag;
+   delete [] overlaps;
+   delete [] RealSol;
+   delete [] ImagSol;
+   delete [] work;
+   delete [] RePrev;
+   delete [] ImPrev;
+   delete [] vec_prev;
+   delete [] vec_curr;
+   delete [] vec_next;
+
+}
+
+void CheMPS2::FCI::LanczosTridiagonal(const unsigned int dim, double * diag, double * offdiag, const double alpha, const double beta, const double eta, double * RealSol, double * ImagSol, double * work){
+
+   /*
+      Thomas algorithm for ( alpha + beta T + I eta ) Solution = e_0. The pivots are the partial continued fractions
+         pivot_k = alpha + beta diag[k] + I eta - ( beta offdiag[k] )^2 / pivot_{k-1}
+      and their imaginary parts all have the sign of eta with a magnitude of at least | eta |, so no pivoting is required.
+   */
+
+   double * upper_re = work;
+   double * upper_im = work +     dim;
+   double * rhs_re   = work + 2 * dim;
+   double * rhs_im   = work + 3 * dim;
+
+   for ( unsigned int k = 0; k < dim; k++ ){
+      double pivot_re = alpha + beta * diag[ k ];
+      double pivot_im = eta;
+      double num_re   = (( k == 0 ) ? 1.0 : 0.0 );
+      double num_im   = 0.0;
+      if ( k > 0 ){
+         const double coupling = beta * offdiag[ k ];
+         pivot_re -= coupling * upper_re[ k - 1 ];
+         pivot_im -= coupling * upper_im[ k - 1 ];
+         num_re   -= coupling * rhs_re[ k - 1 ];
+         num_im   -= coupling * rhs_im[ k - 1 ];
+      }
+      const double inv_norm = 1.0 / ( pivot_re * pivot_re + pivot_im * pivot_im );
+      const double inv_re   =   pivot_re * inv_norm; // 1 / pivot
+      const double inv_im   = - pivot_im * inv_norm;
+      const double coupling_next = ( k + 1 < dim ) ? beta * offdiag[ k + 1 ] : 0.0;
+      upper_re[ k ] = coupling_next * inv_re;
+      upper_im[ k ] = coupling_next * inv_im;
+      rhs_re[ k ]   = num_re * inv_re - num_im * inv_im;
+      rhs_im[ k ]   = num_re * inv_im + num_im * inv_re;
+   }
+
+   RealSol[ dim - 1 ] = rhs_re[ dim - 1 ];
+   ImagSol[ dim - 1 ] = rhs_im[ dim - 1 ];
+   for ( int k = dim - 2; k >= 0; k-- ){
+      RealSol[ k ] = rhs_re[ k ] - ( upper_re[ k ] * RealSol[ k + 1 ] - upper_im[ k ] * ImagSol[ k + 1 ] );
+      ImagSol[ k ] = rhs_im[ k ] - ( upper_re[ k ] * ImagSol[ k + 1 ] + upper_im[ k ] * RealSol[ k + 1 ] );
+   }
+
+}
+
 void CheMPS2::FCI::RetardedGF(const double omega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const bool isUp, const double GSenergy, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartGF, double * ImPartGF) const{
 
    assert( RePartGF != NULL );
@@ -2258,7 +3106,7 @@ void CheMPS2::FCI::GFmatrix_addition(const double alpha, const double beta, cons
          
          double * RealPartSolution = new double[ addVecLength ];
          double * ImagPartSolution = new double[ addVecLength ];
-         additionFCI.CGSolveSystem( alpha, beta, eta, addVector, RealPartSolution, ImagPartSolution );
+         additionFCI.GFSolveSystem( alpha, beta, eta, addVector, RealPartSolution, ImagPartSolution );
          
          if ( TwoRDMreal != NULL ){ additionFCI.Fill2RDM( RealPartSolution, TwoRDMreal[ cnt_right ] ); }
          if ( TwoRDMimag != NULL ){ additionFCI.Fill2RDM( ImagPartSolution, TwoRDMimag[ cnt_right ] ); }
@@ -2349,7 +3197,7 @@ void CheMPS2::FCI::GFmatrix_removal(const double alpha, const double beta, const
          
          double * RealPartSolution = new double[ removeVecLength ];
          double * ImagPartSolution = new double[ removeVecLength ];
-         removalFCI.CGSolveSystem( alpha, beta, eta, removeVector, RealPartSolution, ImagPartSolution );
+         removalFCI.GFSolveSystem( alpha, beta, eta, removeVector, RealPartSolution, ImagPartSolution );
          
          if ( TwoRDMreal != NULL ){ removalFCI.Fill2RDM( RealPartSolution, TwoRDMreal[ cnt_right ] ); }
          if ( TwoRDMimag != NULL ){ removalFCI.Fill2RDM( ImagPartSolution, TwoRDMimag[ cnt_right ] ); }
@@ -2439,7 +3287,7 @@ void CheMPS2::FCI::DensityResponseGF_forward(const double omega, const double et
 
    double * RealPartSolution = new double[ vecLength ];
    double * ImagPartSolution = new double[ vecLength ];
-   CGSolveSystem( omega + GSenergy , -1.0 , eta , densityBetaVector , RealPartSolution , ImagPartSolution );
+   GFSolveSystem( omega + GSenergy , -1.0 , eta , densityBetaVector , RealPartSolution , ImagPartSolution );
    if ( TwoRDMreal != NULL ){ Fill2RDM( RealPartSolution , TwoRDMreal ); } // Sets the TwoRDMreal
    RePartGF[0] = FCIddot( vecLength , densityAlphaVector , RealPartSolution );
    delete [] RealPartSolution;
@@ -2475,7 +3323,7 @@ void CheMPS2::FCI::DensityResponseGF_backward(const double omega, const double e
 
    double * RealPartSolution = new double[ vecLength ];
    double * ImagPartSolution = new double[ vecLength ];
-   CGSolveSystem( omega - GSenergy , 1.0 , eta , densityAlphaVector , RealPartSolution , ImagPartSolution );
+   GFSolveSystem( omega - GSenergy , 1.0 , eta , densityAlphaVector , RealPartSolution , ImagPartSolution );
    if ( TwoRDMreal != NULL ){ Fill2RDM( RealPartSolution , TwoRDMreal ); } // Sets the TwoRDMreal
    RePartGF[0] = FCIddot( vecLength , densityBetaVector , RealPartSolution );
    delete [] RealPartSolution;
@@ -2490,3 +3338,252 @@ void CheMPS2::FCI::DensityResponseGF_backward(const double omega, const double e
 }
 
 
+void CheMPS2::FCI::RetardedGF_spectral(const double * omegas, const unsigned int numOmega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const bool isUp, const double GSenergy, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartGF, double * ImPartGF) const{
+
+   assert( RePartGF != NULL );
+   assert( ImPartGF != NULL );
+
+   // G( omega, alpha, beta, eta ) = < 0 | a_{alpha,spin}  [ omega - Ham + E_0 + I*eta ]^{-1} a^+_{beta,spin} | 0 > (addition amplitude)
+   //                              + < 0 | a^+_{beta,spin} [ omega + Ham - E_0 + I*eta ]^{-1} a_{alpha,spin}  | 0 > (removal  amplitude)
+
+   double * alphas   = new double[ numOmega ];
+   double * Realpart = new double[ numOmega ];
+   double * Imagpart = new double[ numOmega ];
+   int orb_left;
+   int orb_right;
+
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){ alphas[ omega ] = omegas[ omega ] + GSenergy; }
+   orb_left  = orb_alpha;
+   orb_right = orb_beta;
+   GFmatrix_addition_spectral( alphas, numOmega, -1.0, eta, &orb_left, 1, &orb_right, 1, isUp, GSvector, Ham, Realpart, Imagpart );
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){
+      RePartGF[ omega ] = Realpart[ omega ]; // Set
+      ImPartGF[ omega ] = Imagpart[ omega ]; // Set
+   }
+
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){ alphas[ omega ] = omegas[ omega ] - GSenergy; }
+   orb_left  = orb_beta;
+   orb_right = orb_alpha;
+   GFmatrix_removal_spectral( alphas, numOmega, 1.0, eta, &orb_left, 1, &orb_right, 1, isUp, GSvector, Ham, Realpart, Imagpart );
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){
+      RePartGF[ omega ] += Realpart[ omega ]; // Add
+      ImPartGF[ omega ] += Imagpart[ omega ];
+   }
+
+   delete [] alphas;
+   delete [] Realpart;
+   delete [] Imagpart;
+
+   if ( FCIverbose>1 ){
+      for ( unsigned int omega = 0; omega < numOmega; omega++ ){
+         cout << "FCI::RetardedGF_spectral : G( omega = " << omegas[ omega ] << " ; eta = " << eta << " ; i = " << orb_alpha << " ; j = " << orb_beta << " ) = " << RePartGF[ omega ] << " + I * " << ImPartGF[ omega ] << endl;
+      }
+   }
+
+}
+
+void CheMPS2::FCI::GFmatrix_addition_spectral(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF) const{
+
+   /*
+                                                                                       1
+       GF[i + numLeft * ( j + numRight * w ) ] = < 0 | a_{orbsLeft[i], spin} ------------------------------------ a^+_{orbsRight[j], spin} | 0 >
+                                                                              [ alphas[w] + beta * Ham + I*eta ]
+   */
+
+   // Check whether some stuff is OK
+   assert( numLeft  > 0 );
+   assert( numRight > 0 );
+   for (unsigned int cnt = 0; cnt < numLeft;  cnt++){ int orbl = orbsLeft[  cnt ]; assert((orbl < L) && (orbl >= 0)); }
+   for (unsigned int cnt = 0; cnt < numRight; cnt++){ int orbr = orbsRight[ cnt ]; assert((orbr < L) && (orbr >= 0)); }
+   assert( RePartsGF != NULL );
+   assert( ImPartsGF != NULL );
+   for ( unsigned int counter = 0; counter < numLeft * numRight * numAlpha; counter++ ){
+       RePartsGF[ counter ] = 0.0;
+       ImPartsGF[ counter ] = 0.0;
+   }
+
+   double ** leftVectors = new double*[ numLeft ];
+   double * RealParts = new double[ numLeft * numAlpha ];
+   double * ImagParts = new double[ numLeft * numAlpha ];
+
+   const bool isOK = ( isUp ) ? ( getNel_up() < L ) : ( getNel_down() < L ); // The electron can be added
+   for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+
+      const int orbitalRight = orbsRight[ cnt_right ];
+      bool matchingIrrep = false;
+      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+         if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+      }
+
+      if ( isOK && matchingIrrep ){
+
+         const unsigned int addNelUP   = getNel_up()   + ((isUp) ? 1 : 0);
+         const unsigned int addNelDOWN = getNel_down() + ((isUp) ? 0 : 1);
+         const int addIrrep = Irreps::directProd( getTargetIrrep(), getOrb2Irrep( orbitalRight ) );
+
+         CheMPS2::FCI additionFCI( Ham, addNelUP, addNelDOWN, addIrrep, maxMemWorkMB, FCIverbose );
+         const unsigned int addVecLength = additionFCI.getVecLength( 0 );
+         double * addVector = new double[ addVecLength ];
+         additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalRight, addVector, this, GSvector ); // | addVector > = a^+_right,spin | GSvector >
+
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            const int orbitalLeft = orbsLeft[ cnt_left ];
+            leftVectors[ cnt_left ] = NULL;
+            if ( getOrb2Irrep( orbitalLeft ) == getOrb2Irrep( orbitalRight ) ){
+               leftVectors[ cnt_left ] = new double[ addVecLength ];
+               additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalLeft, leftVectors[ cnt_left ], this, GSvector ); // | leftVector > = a^+_left,spin | GSvector >
+            }
+         }
+
+         additionFCI.LanczosSpectrum( alphas, numAlpha, beta, eta, addVector, leftVectors, numLeft, RealParts, ImagParts );
+
+         for ( unsigned int omega = 0; omega < numAlpha; omega++ ){
+            for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+               RePartsGF[ cnt_left + numLeft * ( cnt_right + numRight * omega ) ] = RealParts[ cnt_left + numLeft * omega ];
+               ImPartsGF[ cnt_left + numLeft * ( cnt_right + numRight * omega ) ] = ImagParts[ cnt_left + numLeft * omega ];
+            }
+         }
+
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            if ( leftVectors[ cnt_left ] != NULL ){ delete [] leftVectors[ cnt_left ]; }
+         }
+         delete [] addVector;
+
+      }
+   }
+
+   delete [] leftVectors;
+   delete [] RealParts;
+   delete [] ImagParts;
+
+}
+
+void CheMPS2::FCI::GFmatrix_removal_spectral(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF) const{
+
+   /*
+                                                                                         1
+       GF[i + numLeft * ( j + numRight * w ) ] = < 0 | a^+_{orbsLeft[i], spin} ------------------------------------ a_{orbsRight[j], spin} | 0 >
+                                                                                [ alphas[w] + beta * Ham + I*eta ]
+   */
+
+   // Check whether some stuff is OK
+   assert( numLeft  > 0 );
+   assert( numRight > 0 );
+   for (unsigned int cnt = 0; cnt < numLeft;  cnt++){ int orbl = orbsLeft [ cnt ]; assert((orbl < L) && (orbl >= 0)); }
+   for (unsigned int cnt = 0; cnt < numRight; cnt++){ int orbr = orbsRight[ cnt ]; assert((orbr < L) && (orbr >= 0)); }
+   assert( RePartsGF != NULL );
+   assert( ImPartsGF != NULL );
+   for ( unsigned int counter = 0; counter < numLeft * numRight * numAlpha; counter++ ){
+       RePartsGF[ counter ] = 0.0;
+       ImPartsGF[ counter ] = 0.0;
+   }
+
+   double ** leftVectors = new double*[ numLeft ];
+   double * RealParts = new double[ numLeft * numAlpha ];
+   double * ImagParts = new double[ numLeft * numAlpha ];
+
+   const bool isOK = ( isUp ) ? ( getNel_up() > 0 ) : ( getNel_down() > 0 ); // The electron can be removed
+   for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+
+      const int orbitalRight = orbsRight[ cnt_right ];
+      bool matchingIrrep = false;
+      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+         if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+      }
+
+      if ( isOK && matchingIrrep ){
+
+         const unsigned int removeNelUP   = getNel_up()   - ((isUp) ? 1 : 0);
+         const unsigned int removeNelDOWN = getNel_down() - ((isUp) ? 0 : 1);
+         const int removeIrrep = Irreps::directProd( getTargetIrrep(), getOrb2Irrep( orbitalRight ) );
+
+         CheMPS2::FCI removalFCI( Ham, removeNelUP, removeNelDOWN, removeIrrep, maxMemWorkMB, FCIverbose );
+         const unsigned int removeVecLength = removalFCI.getVecLength( 0 );
+         double * removeVector = new double[ removeVecLength ];
+         removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalRight, removeVector, this, GSvector ); // | removeVector > = a_right,spin | GSvector >
+
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            const int orbitalLeft = orbsLeft[ cnt_left ];
+            leftVectors[ cnt_left ] = NULL;
+            if ( getOrb2Irrep( orbitalLeft ) == getOrb2Irrep( orbitalRight ) ){
+               leftVectors[ cnt_left ] = new double[ removeVecLength ];
+               removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalLeft, leftVectors[ cnt_left ], this, GSvector ); // | leftVector > = a_left,spin | GSvector >
+            }
+         }
+
+         removalFCI.LanczosSpectrum( alphas, numAlpha, beta, eta, removeVector, leftVectors, numLeft, RealParts, ImagParts );
+
+         for ( unsigned int omega = 0; omega < numAlpha; omega++ ){
+            for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+               RePartsGF[ cnt_left + numLeft * ( cnt_right + numRight * omega ) ] = RealParts[ cnt_left + numLeft * omega ];
+               ImPartsGF[ cnt_left + numLeft * ( cnt_right + numRight * omega ) ] = ImagParts[ cnt_left + numLeft * omega ];
+            }
+         }
+
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            if ( leftVectors[ cnt_left ] != NULL ){ delete [] leftVectors[ cnt_left ]; }
+         }
+         delete [] removeVector;
+
+      }
+   }
+
+   delete [] leftVectors;
+   delete [] RealParts;
+   delete [] ImagParts;
+
+}
+
+void CheMPS2::FCI::DensityResponseGF_spectral(const double * omegas, const unsigned int numOmega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const double GSenergy, double * GSvector, double * RePartGF, double * ImPartGF) const{
+
+   // X( omega, alpha, beta, eta ) = < 0 | ( n_alpha - <0| n_alpha |0> ) [ omega - Ham + E_0 + I*eta ]^{-1} ( n_beta  - <0| n_beta  |0> ) | 0 > (forward  amplitude)
+   //                              - < 0 | ( n_beta  - <0| n_beta  |0> ) [ omega + Ham - E_0 + I*eta ]^{-1} ( n_alpha - <0| n_alpha |0> ) | 0 > (backward amplitude)
+
+   assert( ( orb_alpha<L ) && ( orb_beta<L ) ); // Orbital indices within bound
+   assert( RePartGF != NULL );
+   assert( ImPartGF != NULL );
+
+   const unsigned int vecLength = getVecLength( 0 );
+   double * densityAlphaVector = new double[ vecLength ];
+   double * densityBetaVector  = ( orb_alpha == orb_beta ) ? densityAlphaVector : new double[ vecLength ];
+   ActWithNumberOperator( orb_alpha , densityAlphaVector , GSvector );             // densityAlphaVector = n_alpha |0>
+   const double n_alpha_0 = FCIddot( vecLength , densityAlphaVector , GSvector );  // <0| n_alpha |0>
+   FCIdaxpy( vecLength , -n_alpha_0 , GSvector , densityAlphaVector );             // densityAlphaVector = ( n_alpha - <0| n_alpha |0> ) |0>
+   if ( orb_alpha != orb_beta ){
+      ActWithNumberOperator( orb_beta , densityBetaVector , GSvector );            // densityBetaVector = n_beta |0>
+      const double n_beta_0 = FCIddot( vecLength , densityBetaVector , GSvector ); // <0| n_beta |0>
+      FCIdaxpy( vecLength , -n_beta_0 , GSvector , densityBetaVector );            // densityBetaVector = ( n_beta - <0| n_beta |0> ) |0>
+   }
+
+   double * alphas   = new double[ numOmega ];
+   double * Realpart = new double[ numOmega ];
+   double * Imagpart = new double[ numOmega ];
+
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){ alphas[ omega ] = omegas[ omega ] + GSenergy; }
+   LanczosSpectrum( alphas, numOmega, -1.0, eta, densityBetaVector, &densityAlphaVector, 1, Realpart, Imagpart );
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){
+      RePartGF[ omega ] = Realpart[ omega ]; // Set
+      ImPartGF[ omega ] = Imagpart[ omega ]; // Set
+   }
+
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){ alphas[ omega ] = omegas[ omega ] - GSenergy; }
+   LanczosSpectrum( alphas, numOmega, 1.0, eta, densityAlphaVector, &densityBetaVector, 1, Realpart, Imagpart );
+   for ( unsigned int omega = 0; omega < numOmega; omega++ ){
+      RePartGF[ omega ] -= Realpart[ omega ]; // Subtract !!!
+      ImPartGF[ omega ] -= Imagpart[ omega ]; // Subtract !!!
+   }
+
+   delete [] alphas;
+   delete [] Realpart;
+   delete [] Imagpart;
+   if ( orb_alpha != orb_beta ){ delete [] densityBetaVector; }
+   delete [] densityAlphaVector;
+
+   if ( FCIverbose>1 ){
+      for ( unsigned int omega = 0; omega < numOmega; omega++ ){
+         cout << "FCI::DensityResponseGF_spectral : X( omega = " << omegas[ omega ] << " ; eta = " << eta << " ; i = " << orb_alpha << " ; j = " << orb_beta << " ) = " << RePartGF[ omega ] << " + I * " << ImPartGF[ omega ] << endl;
+      }
+   }
+
+}
+
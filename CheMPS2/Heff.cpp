@@ -40,7 +40,7 @@ CheMPS2::Heff::~Heff(){
 
 }
 
-void CheMPS2::Heff::makeHeff(double * memS, double * memHeff, const Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
+void CheMPS2::Heff::makeHeff(double * memS, double * memHeff, double * memSum, const Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
 
    const int indexS = denS->gIndex();
    const bool atLeft  = (indexS==0)?true:false;
@@ -48,6 +48,33 @@ void CheMPS2::Heff::makeHeff(double * memS, double * memHeff, const Sobject * de
    const int DIM = std::max(denBK->gMaxDimAtBound(indexS), denBK->gMaxDimAtBound(indexS+2));
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
+   
+   /* Split the slices of the MPI processes into chunks of consecutive sectors with
+      approximately equal memory. As soon as a chunk is done, its reduction to the
+      owner of the slice is started. */
+   const int num_procs = MPIchemps2::mpi_size();
+   int * sector_start = new int[num_procs+1];
+   distribute_sectors(denS, sector_start);
+   const int veclength = denS->gKappa2index(denS->gNKappa());
+   const int target = std::max(1, veclength / CheMPS2::HEFF_MPI_numReduceChunks);
+   int * chunk_start = new int[denS->gNKappa()+1];
+   int * chunk_root  = new int[std::max(1, denS->gNKappa())];
+   int num_chunks = 0;
+   chunk_start[0] = 0;
+   for (int proc=0; proc<num_procs; proc++){
+      for (int ikappa=sector_start[proc]; ikappa<sector_start[proc+1]; ikappa++){
+         if (( denS->gKappa2index(ikappa+1) - denS->gKappa2index(chunk_start[num_chunks]) >= target ) || ( ikappa+1 == sector_start[proc+1] )){
+            chunk_root[num_chunks] = proc;
+            num_chunks++;
+            chunk_start[num_chunks] = ikappa+1;
+         }
+      }
+   }
+   MPI_Request * requests = new MPI_Request[std::max(1, num_chunks)];
+   #else
+   (void) memSum; // Only used with MPI
+   const int num_chunks = 1;
+   const int chunk_start[] = { 0, denS->gNKappa() };
    #endif
    
    //PARALLEL
@@ -57,193 +84,217 @@ void CheMPS2::Heff::makeHeff(double * memS, double * memHeff, const Sobject * de
       double * temp  = new double[DIM*DIM];
       double * temp2 = new double[DIM*DIM];
    
-      #pragma omp for schedule(dynamic)
-      for (int ikappaBIS=0; ikappaBIS<denS->gNKappa(); ikappaBIS++){
+      for (int chunk=0; chunk<num_chunks; chunk++){
       
-         const int ikappa = denS->gReorder(ikappaBIS);
-         for (int cnt=denS->gKappa2index(ikappa); cnt<denS->gKappa2index(ikappa+1); cnt++){ memHeff[cnt] = 0.0; }
-         
-         #ifdef CHEMPS2_MPI_COMPILATION
-         if ( MPIchemps2::owner_1cd2d3eh() == MPIRANK )
-         #endif
-         {
-            addDiagram1C(ikappa, memS,memHeff,denS,Prob->gMxElement(indexS,indexS,indexS,indexS));
-            addDiagram1D(ikappa, memS,memHeff,denS,Prob->gMxElement(indexS+1,indexS+1,indexS+1,indexS+1));
-            addDiagram2dall(ikappa, memS, memHeff, denS);
-            addDiagram3Eand3H(ikappa, memS, memHeff, denS);
-         }
-         addDiagramExcitations(ikappa, memS, memHeff, denS, nLower, VeffTilde); //The MPI check occurs in this function
+         #pragma omp for schedule(dynamic)
+         for (int ikappaBIS=chunk_start[chunk]; ikappaBIS<chunk_start[chunk+1]; ikappaBIS++){
+      
+            const int ikappa = ( num_chunks == 1 ) ? denS->gReorder(ikappaBIS) : ikappaBIS; // Chunks consist of consecutive sectors
+            for (int cnt=denS->gKappa2index(ikappa); cnt<denS->gKappa2index(ikappa+1); cnt++){ memHeff[cnt] = 0.0; }
          
-         if (!atLeft){
-
-            /*********************
-            *  Diagrams group 1  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_x() == MPIRANK )
-            #endif
-            {  addDiagram1A(ikappa, memS, memHeff, denS, Xtensors[indexS-1]); }
-
-            /*********************
-            *  Diagrams group 2  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_absigma( indexS, indexS ) == MPIRANK )
-            #endif
-            {  addDiagram2b1and2b2(ikappa, memS, memHeff, denS, Atensors[indexS-1][0][0]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_absigma( indexS+1, indexS+1 ) == MPIRANK )
-            #endif
-            { addDiagram2c1and2c2(ikappa, memS, memHeff, denS, Atensors[indexS-1][0][1]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS ) == MPIRANK )
-            #endif
-            {  addDiagram2b3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1][0][0]);
-               addDiagram2b3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1][0][0]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_cdf( Prob->gL(), indexS+1, indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram2c3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1][0][1]);
-               addDiagram2c3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1][0][1]); }
-
-            /*********************
-            *  Diagrams group 3  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_q( Prob->gL(), indexS ) == MPIRANK )
-            #endif
-            {  addDiagram3Aand3D(ikappa, memS, memHeff, denS, Qtensors[indexS-1][0], Ltensors[indexS-1], temp); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_q( Prob->gL(), indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram3Band3I(ikappa, memS, memHeff, denS, Qtensors[indexS-1][1], Ltensors[indexS-1], temp); }
-
-            /*********************
-            *  Diagrams group 4  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_absigma( indexS, indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram4A1and4A2spin0(ikappa, memS, memHeff, denS, Atensors[indexS-1][1][0]);
-               addDiagram4A1and4A2spin1(ikappa, memS, memHeff, denS, Btensors[indexS-1][1][0]); }
             #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS+1 ) == MPIRANK )
+            if ( MPIchemps2::owner_1cd2d3eh() == MPIRANK )
             #endif
-            {  addDiagram4A3and4A4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1][1][0]);
-               addDiagram4A3and4A4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1][1][0]); }
-            addDiagram4D(ikappa, memS, memHeff, denS, Ltensors[indexS-1], temp); //The MPI check occurs in this function
-            addDiagram4I(ikappa, memS, memHeff, denS, Ltensors[indexS-1], temp); //The MPI check occurs in this function
-
-         }
+            {
+               addDiagram1C(ikappa, memS,memHeff,denS,Prob->gMxElement(indexS,indexS,indexS,indexS));
+               addDiagram1D(ikappa, memS,memHeff,denS,Prob->gMxElement(indexS+1,indexS+1,indexS+1,indexS+1));
+               addDiagram2dall(ikappa, memS, memHeff, denS);
+               addDiagram3Eand3H(ikappa, memS, memHeff, denS);
+            }
+            addDiagramExcitations(ikappa, memS, memHeff, denS, nLower, VeffTilde); //The MPI check occurs in this function
          
-         if (!atRight){
-
-            /*********************
-            *  Diagrams group 1  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_x() == MPIRANK )
-            #endif
-            {  addDiagram1B(ikappa, memS, memHeff, denS, Xtensors[indexS+1]); }
-
-            /*********************
-            *  Diagrams group 2  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_absigma( indexS, indexS ) == MPIRANK )
-            #endif
-            {  addDiagram2e1and2e2(ikappa, memS, memHeff, denS, Atensors[indexS+1][0][1]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_absigma( indexS+1, indexS+1 ) == MPIRANK )
-            #endif
-            { addDiagram2f1and2f2(ikappa, memS, memHeff, denS, Atensors[indexS+1][0][0]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS ) == MPIRANK )
-            #endif
-            {  addDiagram2e3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS+1][0][1]);
-               addDiagram2e3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS+1][0][1]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_cdf( Prob->gL(), indexS+1, indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram2f3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS+1][0][0]);
-               addDiagram2f3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS+1][0][0]); }
-
-            /*********************
-            *  Diagrams group 3  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_q( Prob->gL(), indexS ) == MPIRANK )
-            #endif
-            {  addDiagram3Kand3F(ikappa, memS, memHeff, denS, Qtensors[indexS+1][1], Ltensors[indexS+1], temp); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_q( Prob->gL(), indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram3Land3G(ikappa, memS, memHeff, denS, Qtensors[indexS+1][0], Ltensors[indexS+1], temp); }
-
-            /*********************
-            *  Diagrams group 4  *
-            *********************/
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_absigma( indexS, indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram4J1and4J2spin0(ikappa, memS, memHeff, denS, Atensors[indexS+1][1][0]);
-               addDiagram4J1and4J2spin1(ikappa, memS, memHeff, denS, Btensors[indexS+1][1][0]); }
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS+1 ) == MPIRANK )
-            #endif
-            {  addDiagram4J3and4J4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS+1][1][0]);
-               addDiagram4J3and4J4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS+1][1][0]); }
-            addDiagram4F(ikappa, memS, memHeff, denS, Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4G(ikappa, memS, memHeff, denS, Ltensors[indexS+1], temp); //The MPI check occurs in this function
-
-         }
+            if (!atLeft){
+
+               /*********************
+               *  Diagrams group 1  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_x() == MPIRANK )
+               #endif
+               {  addDiagram1A(ikappa, memS, memHeff, denS, Xtensors[indexS-1]); }
+
+               /*********************
+               *  Diagrams group 2  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_absigma( indexS, indexS ) == MPIRANK )
+               #endif
+               {  addDiagram2b1and2b2(ikappa, memS, memHeff, denS, Atensors[indexS-1][0][0]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_absigma( indexS+1, indexS+1 ) == MPIRANK )
+               #endif
+               { addDiagram2c1and2c2(ikappa, memS, memHeff, denS, Atensors[indexS-1][0][1]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS ) == MPIRANK )
+               #endif
+               {  addDiagram2b3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1][0][0]);
+                  addDiagram2b3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1][0][0]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_cdf( Prob->gL(), indexS+1, indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram2c3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1][0][1]);
+                  addDiagram2c3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1][0][1]); }
+
+               /*********************
+               *  Diagrams group 3  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_q( Prob->gL(), indexS ) == MPIRANK )
+               #endif
+               {  addDiagram3Aand3D(ikappa, memS, memHeff, denS, Qtensors[indexS-1][0], Ltensors[indexS-1], temp); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_q( Prob->gL(), indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram3Band3I(ikappa, memS, memHeff, denS, Qtensors[indexS-1][1], Ltensors[indexS-1], temp); }
+
+               /*********************
+               *  Diagrams group 4  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_absigma( indexS, indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram4A1and4A2spin0(ikappa, memS, memHeff, denS, Atensors[indexS-1][1][0]);
+                  addDiagram4A1and4A2spin1(ikappa, memS, memHeff, denS, Btensors[indexS-1][1][0]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram4A3and4A4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1][1][0]);
+                  addDiagram4A3and4A4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1][1][0]); }
+               addDiagram4D(ikappa, memS, memHeff, denS, Ltensors[indexS-1], temp); //The MPI check occurs in this function
+               addDiagram4I(ikappa, memS, memHeff, denS, Ltensors[indexS-1], temp); //The MPI check occurs in this function
+
+            }
+         
+            if (!atRight){
+
+               /*********************
+               *  Diagrams group 1  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_x() == MPIRANK )
+               #endif
+               {  addDiagram1B(ikappa, memS, memHeff, denS, Xtensors[indexS+1]); }
+
+               /*********************
+               *  Diagrams group 2  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_absigma( indexS, indexS ) == MPIRANK )
+               #endif
+               {  addDiagram2e1and2e2(ikappa, memS, memHeff, denS, Atensors[indexS+1][0][1]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_absigma( indexS+1, indexS+1 ) == MPIRANK )
+               #endif
+               { addDiagram2f1and2f2(ikappa, memS, memHeff, denS, Atensors[indexS+1][0][0]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS ) == MPIRANK )
+               #endif
+               {  addDiagram2e3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS+1][0][1]);
+                  addDiagram2e3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS+1][0][1]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_cdf( Prob->gL(), indexS+1, indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram2f3spin0(ikappa, memS, memHeff, denS, Ctensors[indexS+1][0][0]);
+                  addDiagram2f3spin1(ikappa, memS, memHeff, denS, Dtensors[indexS+1][0][0]); }
+
+               /*********************
+               *  Diagrams group 3  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_q( Prob->gL(), indexS ) == MPIRANK )
+               #endif
+               {  addDiagram3Kand3F(ikappa, memS, memHeff, denS, Qtensors[indexS+1][1], Ltensors[indexS+1], temp); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_q( Prob->gL(), indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram3Land3G(ikappa, memS, memHeff, denS, Qtensors[indexS+1][0], Ltensors[indexS+1], temp); }
+
+               /*********************
+               *  Diagrams group 4  *
+               *********************/
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_absigma( indexS, indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram4J1and4J2spin0(ikappa, memS, memHeff, denS, Atensors[indexS+1][1][0]);
+                  addDiagram4J1and4J2spin1(ikappa, memS, memHeff, denS, Btensors[indexS+1][1][0]); }
+               #ifdef CHEMPS2_MPI_COMPILATION
+               if ( MPIchemps2::owner_cdf( Prob->gL(), indexS, indexS+1 ) == MPIRANK )
+               #endif
+               {  addDiagram4J3and4J4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS+1][1][0]);
+                  addDiagram4J3and4J4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS+1][1][0]); }
+               addDiagram4F(ikappa, memS, memHeff, denS, Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4G(ikappa, memS, memHeff, denS, Ltensors[indexS+1], temp); //The MPI check occurs in this function
+
+            }
          
-         if ((!atLeft) && (!atRight)){
+            if ((!atLeft) && (!atRight)){
          
-            addDiagram2a1spin0(ikappa, memS, memHeff, denS, Atensors, S0tensors, temp); //The MPI check occurs in this function
-            addDiagram2a2spin0(ikappa, memS, memHeff, denS, Atensors, S0tensors, temp); //The MPI check occurs in this function
-            addDiagram2a1spin1(ikappa, memS, memHeff, denS, Btensors, S1tensors, temp); //The MPI check occurs in this function
-            addDiagram2a2spin1(ikappa, memS, memHeff, denS, Btensors, S1tensors, temp); //The MPI check occurs in this function
-            addDiagram2a3spin0(ikappa, memS, memHeff, denS, Ctensors, F0tensors, temp); //The MPI check occurs in this function
-            addDiagram2a3spin1(ikappa, memS, memHeff, denS, Dtensors, F1tensors, temp); //The MPI check occurs in this function
+               addDiagram2a1spin0(ikappa, memS, memHeff, denS, Atensors, S0tensors, temp); //The MPI check occurs in this function
+               addDiagram2a2spin0(ikappa, memS, memHeff, denS, Atensors, S0tensors, temp); //The MPI check occurs in this function
+               addDiagram2a1spin1(ikappa, memS, memHeff, denS, Btensors, S1tensors, temp); //The MPI check occurs in this function
+               addDiagram2a2spin1(ikappa, memS, memHeff, denS, Btensors, S1tensors, temp); //The MPI check occurs in this function
+               addDiagram2a3spin0(ikappa, memS, memHeff, denS, Ctensors, F0tensors, temp); //The MPI check occurs in this function
+               addDiagram2a3spin1(ikappa, memS, memHeff, denS, Dtensors, F1tensors, temp); //The MPI check occurs in this function
             
-            addDiagram3C(ikappa, memS, memHeff, denS, Qtensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram3J(ikappa, memS, memHeff, denS, Qtensors[indexS+1], Ltensors[indexS-1], temp); //The MPI check occurs in this function
+               addDiagram3C(ikappa, memS, memHeff, denS, Qtensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram3J(ikappa, memS, memHeff, denS, Qtensors[indexS+1], Ltensors[indexS-1], temp); //The MPI check occurs in this function
             
-            addDiagram4B1and4B2spin0(ikappa, memS, memHeff, denS, Atensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4B1and4B2spin1(ikappa, memS, memHeff, denS, Btensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4B3and4B4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4B3and4B4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4C1and4C2spin0(ikappa, memS, memHeff, denS, Atensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4C1and4C2spin1(ikappa, memS, memHeff, denS, Btensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4C3and4C4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4C3and4C4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4E(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram4H(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram4K1and4K2spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Atensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4L1and4L2spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Atensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4K1and4K2spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Btensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4L1and4L2spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Btensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4K3and4K4spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ctensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4L3and4L4spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ctensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4K3and4K4spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Dtensors[indexS+1], temp); //The MPI check occurs in this function
-            addDiagram4L3and4L4spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Dtensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4B1and4B2spin0(ikappa, memS, memHeff, denS, Atensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4B1and4B2spin1(ikappa, memS, memHeff, denS, Btensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4B3and4B4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4B3and4B4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4C1and4C2spin0(ikappa, memS, memHeff, denS, Atensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4C1and4C2spin1(ikappa, memS, memHeff, denS, Btensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4C3and4C4spin0(ikappa, memS, memHeff, denS, Ctensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4C3and4C4spin1(ikappa, memS, memHeff, denS, Dtensors[indexS-1], Ltensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4E(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram4H(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram4K1and4K2spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Atensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4L1and4L2spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Atensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4K1and4K2spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Btensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4L1and4L2spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Btensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4K3and4K4spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ctensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4L3and4L4spin0(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ctensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4K3and4K4spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Dtensors[indexS+1], temp); //The MPI check occurs in this function
+               addDiagram4L3and4L4spin1(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Dtensors[indexS+1], temp); //The MPI check occurs in this function
             
-            addDiagram5A(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram5B(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram5C(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram5D(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram5E(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
-            addDiagram5F(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram5A(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram5B(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram5C(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram5D(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram5E(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
+               addDiagram5F(ikappa, memS, memHeff, denS, Ltensors[indexS-1], Ltensors[indexS+1], temp, temp2); //The MPI check occurs in this function
                   
+            }
+         
          }
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         #pragma omp master
+         { // The implicit barrier of omp for guarantees that the chunk is complete: start its reduction while the next chunk is calculated
+            const int root   = chunk_root[chunk];
+            const int offset = denS->gKappa2index(chunk_start[chunk]);
+            const int length = denS->gKappa2index(chunk_start[chunk+1]) - offset;
+            double * result  = ( root == MPIRANK ) ? memSum + offset - denS->gKappa2index(sector_start[root]) : NULL;
+            MPIchemps2::ireduce_array_double(memHeff + offset, result, length, root, requests + chunk);
+            MPIchemps2::test_all(chunk+1, requests);
+         }
+         #endif
+      
       }
       
       delete [] temp;
       delete [] temp2;
    
    }
+   
+   #ifdef CHEMPS2_MPI_COMPILATION
+   MPIchemps2::wait_all(num_chunks, requests);
+   delete [] requests;
+   delete [] chunk_start;
+   delete [] chunk_root;
+   delete [] sector_start;
+   #endif
 
 }
 
@@ -314,107 +365,103 @@ void CheMPS2::Heff::fillHeffDiag(double * memHeffDiag, const Sobject * denS, Ten
    
 }
 
-double CheMPS2::Heff::SolveDAVIDSON(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
-
-   #ifdef CHEMPS2_MPI_COMPILATION
-   if ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER ){
-      return SolveDAVIDSON_main(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
-   } else {
-      return SolveDAVIDSON_help(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::Heff::distribute_sectors(const Sobject * denS, int * sector_start) const{
+
+   const int num_procs = MPIchemps2::mpi_size();
+   const long long veclength = denS->gKappa2index(denS->gNKappa());
+   int ikappa = 0;
+   sector_start[0] = 0;
+   for (int proc=0; proc<num_procs; proc++){
+      const long long target = ( veclength * ( proc + 1 ) ) / num_procs;
+      // A sector belongs to the first process whose target lies beyond the middle of the sector
+      while (( ikappa < denS->gNKappa() ) && ( denS->gKappa2index(ikappa) + denS->gKappa2index(ikappa+1) <= 2 * target )){ ikappa++; }
+      sector_start[proc+1] = ikappa;
    }
-   #else
-      return SolveDAVIDSON_main(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
-   #endif
+   sector_start[num_procs] = denS->gNKappa();
 
 }
+#endif
 
-double CheMPS2::Heff::SolveDAVIDSON_main(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
+double CheMPS2::Heff::SolveDAVIDSON(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
+
+   /* With MPI, each process runs the Davidson algorithm for its slice of the
+      vectors (consecutive sectors of denS). The inner products are summed over
+      all processes inside the Davidson class. For the matrix-vector product,
+      the slices are gathered in the storage of denS, and the result is reduced
+      and scattered back to the slices. */
 
    int inc1 = 1;
-   int veclength = denS->gKappa2index( denS->gNKappa() );
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const int num_procs = MPIchemps2::mpi_size();
+      const int MPIRANK   = MPIchemps2::mpi_rank();
+      const bool am_i_master = ( MPIRANK == MPI_CHEMPS2_MASTER );
+      int * sector_start = new int[ num_procs + 1 ];
+      int * sizes        = new int[ num_procs ];
+      int * offsets      = new int[ num_procs ];
+      distribute_sectors( denS, sector_start );
+      for ( int proc = 0; proc < num_procs; proc++ ){
+         offsets[ proc ] = denS->gKappa2index( sector_start[ proc ] );
+         sizes[ proc ]   = denS->gKappa2index( sector_start[ proc + 1 ] ) - offsets[ proc ];
+      }
+      int veclength = sizes[ MPIRANK ];
+      const bool distributed = true;
+   #else
+      const bool am_i_master = true;
+      int veclength = denS->gKappa2index( denS->gNKappa() );
+      const bool distributed = false;
+   #endif
 
    Davidson deBoskabouter( veclength, CheMPS2::DAVIDSON_NUM_VEC,
                                       CheMPS2::DAVIDSON_NUM_VEC_KEEP,
                                       // CheMPS2::DAVIDSON_DMRG_RTOL,
                                       dvdson_rtol,
-                                      CheMPS2::DAVIDSON_PRECOND_CUTOFF, CheMPS2::HEFF_debugPrint );
+                                      CheMPS2::DAVIDSON_PRECOND_CUTOFF, CheMPS2::HEFF_debugPrint && am_i_master, distributed );
    double ** whichpointers = new double*[2];
 
    char instruction = deBoskabouter.FetchInstruction( whichpointers );
    assert( instruction == 'A' );
    denS->prog2symm(); // Convert mem of Sobject to symmetric conventions
-   dcopy_(&veclength, denS->gStorage(), &inc1, whichpointers[0], &inc1); // Starting vector for Davidson is the current state of the Sobject in symmetric conventions
    #ifdef CHEMPS2_MPI_COMPILATION
-      double * workspace = new double[ veclength ];
+      dcopy_(&veclength, denS->gStorage() + offsets[ MPIRANK ], &inc1, whichpointers[0], &inc1); // Starting vector for Davidson is the current state of the Sobject in symmetric conventions
+      double * workspace = new double[ denS->gKappa2index( denS->gNKappa() ) ];
       fillHeffDiag(workspace, denS, Ctensors, Dtensors, F0tensors, F1tensors, Xtensors, nLower, VeffTilde);
-      MPIchemps2::reduce_array_double( workspace, whichpointers[1], veclength, MPI_CHEMPS2_MASTER );
+      MPIchemps2::reduce_scatter_array_double( workspace, whichpointers[1], sizes );
    #else
+      dcopy_(&veclength, denS->gStorage(), &inc1, whichpointers[0], &inc1); // Starting vector for Davidson is the current state of the Sobject in symmetric conventions
       fillHeffDiag(whichpointers[1], denS, Ctensors, Dtensors, F0tensors, F1tensors, Xtensors, nLower, VeffTilde);
    #endif
 
    instruction = deBoskabouter.FetchInstruction( whichpointers );
    while ( instruction == 'B' ){
-   
       #ifdef CHEMPS2_MPI_COMPILATION
-      {
-         int mpi_instruction = 2;
-         MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
-         MPIchemps2::broadcast_array_double( whichpointers[0], veclength, MPI_CHEMPS2_MASTER );
-         makeHeff(whichpointers[0], workspace, denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
-         MPIchemps2::reduce_array_double( workspace, whichpointers[1], veclength, MPI_CHEMPS2_MASTER );
-      }
+         MPIchemps2::allgather_array_double( whichpointers[0], denS->gStorage(), sizes, offsets ); // The storage of denS is used for the full vector
+         makeHeff(denS->gStorage(), workspace, whichpointers[1], denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
       #else
-         makeHeff(whichpointers[0], whichpointers[1], denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
+         makeHeff(whichpointers[0], whichpointers[1], NULL, denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
       #endif
       instruction = deBoskabouter.FetchInstruction( whichpointers );
    }
 
    assert( instruction == 'C' );
-   dcopy_( &veclength, whichpointers[0], &inc1, denS->gStorage(), &inc1 ); // Copy the solution in symmetric conventions back
+   #ifdef CHEMPS2_MPI_COMPILATION
+      MPIchemps2::allgather_array_double( whichpointers[0], denS->gStorage(), sizes, offsets ); // Copy the solution in symmetric conventions back
+   #else
+      dcopy_( &veclength, whichpointers[0], &inc1, denS->gStorage(), &inc1 ); // Copy the solution in symmetric conventions back
+   #endif
    denS->symm2prog(); // Convert mem of Sobject to program conventions
    double eigenvalue = whichpointers[1][0];
-   if (CheMPS2::HEFF_debugPrint){ std::cout << "   Stats: nIt(DAVIDSON) = " << deBoskabouter.GetNumMultiplications() << std::endl; }
+   if (( CheMPS2::HEFF_debugPrint ) && ( am_i_master )){ std::cout << "   Stats: nIt(DAVIDSON) = " << deBoskabouter.GetNumMultiplications() << std::endl; }
    delete [] whichpointers;
    #ifdef CHEMPS2_MPI_COMPILATION
       delete [] workspace;
-      int mpi_instruction = 3;
-      MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
-      MPIchemps2::broadcast_array_double( &eigenvalue, 1, MPI_CHEMPS2_MASTER );
+      delete [] sector_start;
+      delete [] sizes;
+      delete [] offsets;
    #endif
-   return eigenvalue;
+   return eigenvalue; // The eigenvalue and denS are correct on each process
 
 }
 
-#ifdef CHEMPS2_MPI_COMPILATION
-double CheMPS2::Heff::SolveDAVIDSON_help(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
-
-   int veclength = denS->gKappa2index( denS->gNKappa() );
-   double * vecin  = new double[ veclength ];
-   double * vecout = new double[ veclength ];
-   int mpi_instruction = -1;
-   
-   fillHeffDiag( vecout, denS, Ctensors, Dtensors, F0tensors, F1tensors, Xtensors, nLower, VeffTilde );
-   MPIchemps2::reduce_array_double( vecout, vecin, veclength, MPI_CHEMPS2_MASTER );
-   MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
-   
-   while ( mpi_instruction == 2 ){ // Mat Vec
-   
-      MPIchemps2::broadcast_array_double( vecin, veclength, MPI_CHEMPS2_MASTER );
-      makeHeff(vecin, vecout, denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
-      MPIchemps2::reduce_array_double( vecout, vecin, veclength, MPI_CHEMPS2_MASTER );
-      MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
-   
-   }
-   
-   assert( mpi_instruction == 3 ); // Receive energy
-   double eigenvalue = 0.0;
-   MPIchemps2::broadcast_array_double( &eigenvalue, 1, MPI_CHEMPS2_MASTER );
-   delete [] vecin;
-   delete [] vecout;
-   
-   return eigenvalue; // The eigenvalue is correct on each process, denS not
-
-}
-#endif
 
 
@@ -49,7 +49,13 @@ CheMPS2::Problem::~Problem(){
       delete [] f2;
    }
    
-   if ( mx_elem != NULL ){ delete [] mx_elem; }
+   if ( mx_elem != NULL ){
+      #ifdef CHEMPS2_MPI_COMPILATION
+         MPIchemps2::free_node_shared( &mx_elem_window, &mx_elem_node_comm );
+      #else
+         delete [] mx_elem;
+      #endif
+   }
 
 }
 
@@ -355,30 +361,53 @@ double CheMPS2::Problem::gMxElement(const int alpha, const int beta, const int g
 
 void CheMPS2::Problem::setMxElement(const int alpha, const int beta, const int gamma, const int delta, const double value){
 
-   mx_elem[ alpha + L * ( beta + L * ( gamma + L * delta ) ) ] = value;
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( MPIchemps2::node_rank( mx_elem_node_comm ) == 0 )
+   #endif
+   { mx_elem[ alpha + L * ( beta + L * ( gamma + L * delta ) ) ] = value; }
+
+}
+
+void CheMPS2::Problem::sync_mxelem(){
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mx_elem != NULL ){ MPIchemps2::sync_node_shared( mx_elem_window ); }
+   #endif
 
 }
 
 void CheMPS2::Problem::construct_mxelem(){
 
-   if ( mx_elem == NULL ){ mx_elem = new double[ L*L*L*L ]; }
+   const long long size = ((long long) L ) * L * L * L;
+   #ifdef CHEMPS2_MPI_COMPILATION
+      // One copy per node: the processes on a node share the table, and each fills a different part of it
+      if ( mx_elem == NULL ){ mx_elem = MPIchemps2::allocate_node_shared_double( size, &mx_elem_window, &mx_elem_node_comm ); }
+      const int num_parts = MPIchemps2::node_size( mx_elem_node_comm );
+      const int my_part   = MPIchemps2::node_rank( mx_elem_node_comm );
+   #else
+      if ( mx_elem == NULL ){ mx_elem = new double[ size ]; }
+      const int num_parts = 1;
+      const int my_part   = 0;
+   #endif
    const double prefact = 1.0/(N-1);
    
-   for (int orb1 = 0; orb1 < L; orb1++){
-      const int map1 = (( !bReorder ) ? orb1 : f2[ orb1 ]);
-      for (int orb2 = 0; orb2 < L; orb2++){
-         const int map2 = (( !bReorder ) ? orb2 : f2[ orb2 ]);
-         for (int orb3 = 0; orb3 < L; orb3++){
-            const int map3 = (( !bReorder ) ? orb3 : f2[ orb3 ]);
-            for (int orb4 = 0; orb4 < L; orb4++){
-               const int map4 = (( !bReorder ) ? orb4 : f2[ orb4 ]);
-               setMxElement( orb1, orb2, orb3, orb4, Ham->getVmat(map1,map2,map3,map4)
-                                                     + prefact*((orb1==orb3)?Ham->getTmat(map2,map4):0)
-                                                     + prefact*((orb2==orb4)?Ham->getTmat(map1,map3):0) );
+   for (int orb4 = my_part; orb4 < L; orb4 += num_parts){
+      const int map4 = (( !bReorder ) ? orb4 : f2[ orb4 ]);
+      for (int orb3 = 0; orb3 < L; orb3++){
+         const int map3 = (( !bReorder ) ? orb3 : f2[ orb3 ]);
+         for (int orb2 = 0; orb2 < L; orb2++){
+            const int map2 = (( !bReorder ) ? orb2 : f2[ orb2 ]);
+            for (int orb1 = 0; orb1 < L; orb1++){
+               const int map1 = (( !bReorder ) ? orb1 : f2[ orb1 ]);
+               mx_elem[ orb1 + L * ( orb2 + L * ( orb3 + L * orb4 ) ) ] = Ham->getVmat(map1,map2,map3,map4)
+                                                                        + prefact*((orb1==orb3)?Ham->getTmat(map2,map4):0)
+                                                                        + prefact*((orb2==orb4)?Ham->getTmat(map1,map3):0);
             }
          }
       }
    }
+   
+   sync_mxelem();
 
 }
 
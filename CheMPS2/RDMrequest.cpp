@@ -0,0 +1,119 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2016 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "RDMrequest.h"
+
+CheMPS2::RDMrequest::RDMrequest( const int L ){
+
+   assert( L > 0 );
+   this->L          = L;
+   do_3rdm          = false;
+   disk_3rdm        = CheMPS2::THREE_RDM_storeOnDisk;
+   distributed_3rdm = false;
+   do_correlations  = true;
+   orbitals         = new bool[ L ];
+   for ( int orb = 0; orb < L; orb++ ){ orbitals[ orb ] = true; }
+
+}
+
+CheMPS2::RDMrequest::RDMrequest( const RDMrequest & tocopy ){
+
+   L        = tocopy.gL();
+   orbitals = new bool[ L ];
+   copy_settings( tocopy );
+
+}
+
+CheMPS2::RDMrequest & CheMPS2::RDMrequest::operator=( const RDMrequest & tocopy ){
+
+   if ( this != &tocopy ){
+      if ( L != tocopy.gL() ){
+         delete [] orbitals;
+         L        = tocopy.gL();
+         orbitals = new bool[ L ];
+      }
+      copy_settings( tocopy );
+   }
+   return *this;
+
+}
+
+void CheMPS2::RDMrequest::copy_settings( const RDMrequest & tocopy ){
+
+   do_3rdm          = tocopy.get_3rdm();
+   disk_3rdm        = tocopy.get_3rdm_disk();
+   distributed_3rdm = tocopy.get_3rdm_distributed();
+   do_correlations  = tocopy.get_correlations();
+   for ( int orb = 0; orb < L; orb++ ){ orbitals[ orb ] = tocopy.get_orbital( orb ); }
+
+}
+
+CheMPS2::RDMrequest::~RDMrequest(){
+
+   delete [] orbitals;
+
+}
+
+int CheMPS2::RDMrequest::gL() const{ return L; }
+
+void CheMPS2::RDMrequest::set_3rdm( const bool do_3rdm, const bool disk_3rdm ){
+
+   this->do_3rdm   = do_3rdm;
+   this->disk_3rdm = disk_3rdm;
+
+}
+
+bool CheMPS2::RDMrequest::get_3rdm() const{ return do_3rdm; }
+
+bool CheMPS2::RDMrequest::get_3rdm_disk() const{ return disk_3rdm; }
+
+void CheMPS2::RDMrequest::set_3rdm_distributed( const bool distributed_3rdm ){ this->distributed_3rdm = distributed_3rdm; }
+
+bool CheMPS2::RDMrequest::get_3rdm_distributed() const{ return distributed_3rdm; }
+
+void CheMPS2::RDMrequest::set_correlations( const bool do_correlations ){ this->do_correlations = do_correlations; }
+
+bool CheMPS2::RDMrequest::get_correlations() const{ return do_correlations; }
+
+void CheMPS2::RDMrequest::set_orbital( const int ham_orb, const bool include ){
+
+   assert( ( ham_orb >= 0 ) && ( ham_orb < L ) );
+   orbitals[ ham_orb ] = include;
+
+}
+
+bool CheMPS2::RDMrequest::get_orbital( const int ham_orb ) const{
+
+   assert( ( ham_orb >= 0 ) && ( ham_orb < L ) );
+   return orbitals[ ham_orb ];
+
+}
+
+bool CheMPS2::RDMrequest::all_orbitals() const{
+
+   for ( int orb = 0; orb < L; orb++ ){
+      if ( orbitals[ orb ] == false ){ return false; }
+   }
+   return true;
+
+}
+
@@ -0,0 +1,810 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2016 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include <iostream>
+#include <algorithm>
+#include <sys/time.h>
+
+#include "SelectedCI.h"
+#include "Irreps.h"
+#include "Davidson.h"
+#include "Lapack.h"
+
+using std::cout;
+using std::endl;
+
+static int popcount_mask( const unsigned long long mask ){ return __builtin_popcountll( mask ); }
+
+static int lowest_bit( const unsigned long long mask ){ return __builtin_ctzll( mask ); }
+
+// The phase of a^+_r a_p on the string, with p occupied and r empty: the parity of the number of electrons strictly between p and r
+static double excitation_phase( const unsigned long long string, const int p, const int r ){
+
+   const int low  = (( p < r ) ? p : r );
+   const int high = (( p < r ) ? r : p );
+   const unsigned long long between = ( ( 1ULL << high ) - 1 ) & ( ~( ( 2ULL << low ) - 1 ) );
+   return (( popcount_mask( string & between ) & 1 ) ? -1.0 : 1.0 );
+
+}
+
+CheMPS2::SelectedCI::SelectedCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigned int theNel_down, const int TargetIrrep_in, const int SCIverbose_in){
+
+   L = Ham->getL();
+   Nel_up      = theNel_up;
+   Nel_down    = theNel_down;
+   TargetIrrep = TargetIrrep_in;
+   SCIverbose  = SCIverbose_in;
+   num_irreps  = Irreps::getNumberOfIrreps( Ham->getNGroup() );
+
+   assert( L <= 64 ); // The determinants are pairs of 64-bit masks
+   assert( Nel_up   <= (unsigned int) L );
+   assert( Nel_down <= (unsigned int) L );
+   assert( ( TargetIrrep >= 0 ) && ( TargetIrrep < num_irreps ) );
+
+   orb2irrep = new int[ L ];
+   for ( int orb = 0; orb < L; orb++ ){ orb2irrep[ orb ] = Ham->getOrbitalIrrep( orb ); }
+
+   Econstant = Ham->getEconst();
+   Tmat = new double[ L * L ];
+   ERI  = new double[ L * L * L * L ];
+   for ( int orb1 = 0; orb1 < L; orb1++ ){
+      for ( int orb2 = 0; orb2 < L; orb2++ ){
+         Tmat[ orb1 + L * orb2 ] = Ham->getTmat( orb1, orb2 );
+         for ( int orb3 = 0; orb3 < L; orb3++ ){
+            for ( int orb4 = 0; orb4 < L; orb4++ ){
+               ERI[ orb1 + L * ( orb2 + L * ( orb3 + L * orb4 ) ) ] = Ham->getVmat( orb1, orb3, orb2, orb4 );
+            }
+         }
+      }
+   }
+
+   StartupHeatBath();
+
+   num_det  = 0;
+   det_up   = NULL;
+   det_down = NULL;
+   coef     = NULL;
+   Energy   = 0.0;
+   ham_diag = NULL;
+   ham_row  = NULL;
+   ham_col  = NULL;
+   ham_val  = NULL;
+
+   StartupReference();
+
+   if ( SCIverbose > 0 ){
+      cout << "SelectedCI::SelectedCI : Number of orbitals = " << L << " ; number of up (alpha) electrons = " << Nel_up << " ; number of down (beta) electrons = " << Nel_down << " ; target irrep = " << TargetIrrep << endl;
+      cout << "SelectedCI::SelectedCI : Reference determinant energy = " << DiagonalElement( det_up[ 0 ], det_down[ 0 ] ) + Econstant << endl;
+   }
+
+}
+
+CheMPS2::SelectedCI::~SelectedCI(){
+
+   delete [] orb2irrep;
+   delete [] Tmat;
+   delete [] ERI;
+   delete [] hb_same_start;
+   delete [] hb_same;
+   delete [] hb_opp_start;
+   delete [] hb_opp;
+   delete [] det_up;
+   delete [] det_down;
+   delete [] coef;
+   ClearHamiltonian();
+
+}
+
+bool CheMPS2::SelectedCI::EntryLess(const Entry & first, const Entry & second){
+
+   if ( first.up != second.up ){ return ( first.up < second.up ); }
+   return ( first.down < second.down );
+
+}
+
+bool CheMPS2::SelectedCI::HeatBathGreater(const HeatBath & first, const HeatBath & second){ return ( first.value > second.value ); }
+
+void CheMPS2::SelectedCI::AddEntry(Entry ** list, long long * num, long long * size, const unsigned long long up, const unsigned long long down, const double value){
+
+   if ( *num == *size ){
+      const long long new_size = (( *size == 0 ) ? 1024 : 2 * ( *size ));
+      Entry * larger = new Entry[ new_size ];
+      for ( long long cnt = 0; cnt < *num; cnt++ ){ larger[ cnt ] = (*list)[ cnt ]; }
+      if ( *list != NULL ){ delete [] (*list); }
+      *list = larger;
+      *size = new_size;
+   }
+   (*list)[ *num ].up    = up;
+   (*list)[ *num ].down  = down;
+   (*list)[ *num ].value = value;
+   (*num)++;
+
+}
+
+long long CheMPS2::SelectedCI::SortAndMerge(Entry * list, const long long num){
+
+   if ( num == 0 ){ return 0; }
+   std::sort( list, list + num, EntryLess );
+   long long unique = 1;
+   for ( long long cnt = 1; cnt < num; cnt++ ){
+      if (( list[ cnt ].up == list[ unique - 1 ].up ) && ( list[ cnt ].down == list[ unique - 1 ].down )){
+         list[ unique - 1 ].value += list[ cnt ].value;
+      } else {
+         list[ unique ] = list[ cnt ];
+         unique++;
+      }
+   }
+   return unique;
+
+}
+
+void CheMPS2::SelectedCI::StartupHeatBath(){
+
+   /* Two passes over the symmetry-allowed orbital quadruples: count the nonzero integrals per occupied pair,
+      and fill the lists. Afterwards each list is sorted by decreasing magnitude. */
+   hb_same_start = new long long[ L * L + 1 ];
+   hb_opp_start  = new long long[ L * L + 1 ];
+   hb_same = NULL;
+   hb_opp  = NULL;
+
+   for ( int pass = 0; pass < 2; pass++ ){
+      long long num_same = 0;
+      long long num_opp  = 0;
+      for ( int q = 0; q < L; q++ ){
+         for ( int p = 0; p < L; p++ ){
+            const int irrep_pq = Irreps::directProd( orb2irrep[ p ], orb2irrep[ q ] );
+            hb_same_start[ p + L * q ] = num_same;
+            hb_opp_start[ p + L * q ]  = num_opp;
+            for ( int s = 0; s < L; s++ ){
+               for ( int r = 0; r < L; r++ ){
+                  if ( Irreps::directProd( orb2irrep[ r ], orb2irrep[ s ] ) == irrep_pq ){
+                     const double coulomb = ERI[ p + L * ( r + L * ( q + L * s ) ) ];
+                     if (( p != r ) && ( q != s ) && ( coulomb != 0.0 )){
+                        if ( pass == 1 ){
+                           hb_opp[ num_opp ].value = fabs( coulomb );
+                           hb_opp[ num_opp ].rs    = r + L * s;
+                        }
+                        num_opp++;
+                     }
+                     if (( p < q ) && ( r < s ) && ( r != p ) && ( r != q ) && ( s != p ) && ( s != q )){
+                        const double antisym = coulomb - ERI[ p + L * ( s + L * ( q + L * r ) ) ];
+                        if ( antisym != 0.0 ){
+                           if ( pass == 1 ){
+                              hb_same[ num_same ].value = fabs( antisym );
+                              hb_same[ num_same ].rs    = r + L * s;
+                           }
+                           num_same++;
+                        }
+                     }
+                  }
+               }
+            }
+         }
+      }
+      hb_same_start[ L * L ] = num_same;
+      hb_opp_start[ L * L ]  = num_opp;
+      if ( pass == 0 ){
+         hb_same = new HeatBath[ num_same ];
+         hb_opp  = new HeatBath[ num_opp ];
+      }
+   }
+
+   #pragma omp parallel for schedule(dynamic)
+   for ( int pq = 0; pq < L * L; pq++ ){
+      std::sort( hb_same + hb_same_start[ pq ], hb_same + hb_same_start[ pq + 1 ], HeatBathGreater );
+      std::sort( hb_opp  + hb_opp_start[ pq ],  hb_opp  + hb_opp_start[ pq + 1 ],  HeatBathGreater );
+   }
+
+}
+
+void CheMPS2::SelectedCI::StartupReference(){
+
+   // Order the orbitals by their one-electron energy
+   int * order = new int[ L ];
+   for ( int orb = 0; orb < L; orb++ ){ order[ orb ] = orb; }
+   for ( int orb1 = 0; orb1 < L; orb1++ ){
+      for ( int orb2 = orb1 + 1; orb2 < L; orb2++ ){
+         if ( Tmat[ order[ orb2 ] * ( L + 1 ) ] < Tmat[ order[ orb1 ] * ( L + 1 ) ] ){
+            const int temp = order[ orb1 ];
+            order[ orb1 ] = order[ orb2 ];
+            order[ orb2 ] = temp;
+         }
+      }
+   }
+
+   // Candidate strings: the aufbau string and its single excitations
+   const unsigned int num_el[ 2 ] = { Nel_up, Nel_down };
+   unsigned long long * candidates[ 2 ];
+   int num_cand[ 2 ];
+   for ( int spin = 0; spin < 2; spin++ ){
+      unsigned long long aufbau = 0;
+      for ( unsigned int el = 0; el < num_el[ spin ]; el++ ){ aufbau |= ( 1ULL << order[ el ] ); }
+      candidates[ spin ] = new unsigned long long[ 1 + num_el[ spin ] * ( L - num_el[ spin ] ) ];
+      candidates[ spin ][ 0 ] = aufbau;
+      num_cand[ spin ] = 1;
+      for ( int p = 0; p < L; p++ ){
+         for ( int r = 0; r < L; r++ ){
+            if ( ( ( aufbau >> p ) & 1 ) && ( !( ( aufbau >> r ) & 1 ) ) ){
+               candidates[ spin ][ num_cand[ spin ] ] = aufbau ^ ( 1ULL << p ) ^ ( 1ULL << r );
+               num_cand[ spin ]++;
+            }
+         }
+      }
+   }
+   delete [] order;
+
+   bool found = false;
+   double lowest = 0.0;
+   unsigned long long best_up   = 0;
+   unsigned long long best_down = 0;
+   for ( int cnt_up = 0; cnt_up < num_cand[ 0 ]; cnt_up++ ){
+      for ( int cnt_down = 0; cnt_down < num_cand[ 1 ]; cnt_down++ ){
+         const unsigned long long up   = candidates[ 0 ][ cnt_up ];
+         const unsigned long long down = candidates[ 1 ][ cnt_down ];
+         int irrep = 0;
+         for ( int orb = 0; orb < L; orb++ ){
+            if ( ( ( up   >> orb ) & 1 ) ){ irrep = Irreps::directProd( irrep, orb2irrep[ orb ] ); }
+            if ( ( ( down >> orb ) & 1 ) ){ irrep = Irreps::directProd( irrep, orb2irrep[ orb ] ); }
+         }
+         if ( irrep == TargetIrrep ){
+            const double energy = DiagonalElement( up, down );
+            if (( found == false ) || ( energy < lowest )){
+               found     = true;
+               lowest    = energy;
+               best_up   = up;
+               best_down = down;
+            }
+         }
+      }
+   }
+   delete [] candidates[ 0 ];
+   delete [] candidates[ 1 ];
+
+   if ( found == false ){
+      cout << "SelectedCI::StartupReference : No determinant of irrep " << TargetIrrep << " among the aufbau determinant and its single excitations." << endl;
+      assert( found );
+   }
+
+   num_det     = 1;
+   det_up      = new unsigned long long[ 1 ];
+   det_down    = new unsigned long long[ 1 ];
+   coef        = new double[ 1 ];
+   det_up[ 0 ]   = best_up;
+   det_down[ 0 ] = best_down;
+   coef[ 0 ]     = 1.0;
+   Energy      = lowest + Econstant;
+
+}
+
+unsigned long long CheMPS2::SelectedCI::bits2mask(int * bits) const{
+
+   unsigned long long mask = 0;
+   for ( int orb = 0; orb < L; orb++ ){ if ( bits[ orb ] ){ mask |= ( 1ULL << orb ); } }
+   return mask;
+
+}
+
+void CheMPS2::SelectedCI::mask2bits(const unsigned long long mask, int * bits) const{
+
+   for ( int orb = 0; orb < L; orb++ ){ bits[ orb ] = (( mask >> orb ) & 1 ); }
+
+}
+
+int CheMPS2::SelectedCI::FindDeterminant(const unsigned long long up, const unsigned long long down) const{
+
+   int start = 0;
+   int stop  = num_det;
+   while ( start < stop ){
+      const int middle = start + ( stop - start ) / 2;
+      if (( det_up[ middle ] < up ) || (( det_up[ middle ] == up ) && ( det_down[ middle ] < down ))){
+         start = middle + 1;
+      } else {
+         stop = middle;
+      }
+   }
+   if (( start < num_det ) && ( det_up[ start ] == up ) && ( det_down[ start ] == down )){ return start; }
+   return -1;
+
+}
+
+void CheMPS2::SelectedCI::getDeterminant(const int index, int * bits_up, int * bits_down) const{
+
+   assert( ( index >= 0 ) && ( index < num_det ) );
+   mask2bits( det_up[ index ],   bits_up   );
+   mask2bits( det_down[ index ], bits_down );
+
+}
+
+double CheMPS2::SelectedCI::getSCIcoeff(int * bits_up, int * bits_down) const{
+
+   const int index = FindDeterminant( bits2mask( bits_up ), bits2mask( bits_down ) );
+   return (( index == -1 ) ? 0.0 : coef[ index ] );
+
+}
+
+double CheMPS2::SelectedCI::GetMatrixElement(int * bits_bra_up, int * bits_bra_down, int * bits_ket_up, int * bits_ket_down) const{
+
+   return MatrixElement( bits2mask( bits_bra_up ), bits2mask( bits_bra_down ), bits2mask( bits_ket_up ), bits2mask( bits_ket_down ) );
+
+}
+
+double CheMPS2::SelectedCI::DiagonalElement(const unsigned long long up, const unsigned long long down) const{
+
+   double result = 0.0;
+   for ( unsigned long long mask_p = up; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+      const int p = lowest_bit( mask_p );
+      result += Tmat[ p * ( L + 1 ) ];
+      for ( unsigned long long mask_q = mask_p & ( mask_p - 1 ); mask_q != 0; mask_q &= ( mask_q - 1 ) ){ // q > p with spin up
+         const int q = lowest_bit( mask_q );
+         result += ERI[ p + L * ( p + L * ( q + L * q ) ) ] - ERI[ p + L * ( q + L * ( q + L * p ) ) ];
+      }
+      for ( unsigned long long mask_q = down; mask_q != 0; mask_q &= ( mask_q - 1 ) ){
+         const int q = lowest_bit( mask_q );
+         result += ERI[ p + L * ( p + L * ( q + L * q ) ) ];
+      }
+   }
+   for ( unsigned long long mask_p = down; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+      const int p = lowest_bit( mask_p );
+      result += Tmat[ p * ( L + 1 ) ];
+      for ( unsigned long long mask_q = mask_p & ( mask_p - 1 ); mask_q != 0; mask_q &= ( mask_q - 1 ) ){ // q > p with spin down
+         const int q = lowest_bit( mask_q );
+         result += ERI[ p + L * ( p + L * ( q + L * q ) ) ] - ERI[ p + L * ( q + L * ( q + L * p ) ) ];
+      }
+   }
+   return result;
+
+}
+
+double CheMPS2::SelectedCI::SingleExcitation(const unsigned long long ket_same, const unsigned long long ket_other, const int p, const int r) const{
+
+   double result = Tmat[ p + L * r ];
+   for ( unsigned long long mask_q = ket_same & ( ~( 1ULL << p ) ); mask_q != 0; mask_q &= ( mask_q - 1 ) ){
+      const int q = lowest_bit( mask_q );
+      result += ERI[ p + L * ( r + L * ( q + L * q ) ) ] - ERI[ p + L * ( q + L * ( q + L * r ) ) ];
+   }
+   for ( unsigned long long mask_q = ket_other; mask_q != 0; mask_q &= ( mask_q - 1 ) ){
+      const int q = lowest_bit( mask_q );
+      result += ERI[ p + L * ( r + L * ( q + L * q ) ) ];
+   }
+   return excitation_phase( ket_same, p, r ) * result;
+
+}
+
+double CheMPS2::SelectedCI::MatrixElement(const unsigned long long bra_up, const unsigned long long bra_down, const unsigned long long ket_up, const unsigned long long ket_down) const{
+
+   const unsigned long long diff_up   = bra_up   ^ ket_up;
+   const unsigned long long diff_down = bra_down ^ ket_down;
+   const int num_up   = popcount_mask( diff_up );
+   const int num_down = popcount_mask( diff_down );
+
+   if ( num_up + num_down > 4 ){ return 0.0; }
+   if ( num_up + num_down == 0 ){ return DiagonalElement( ket_up, ket_down ); }
+
+   if (( num_up == 2 ) && ( num_down == 0 )){ return SingleExcitation( ket_up,   ket_down, lowest_bit( ket_up   & diff_up   ), lowest_bit( bra_up   & diff_up   ) ); }
+   if (( num_up == 0 ) && ( num_down == 2 )){ return SingleExcitation( ket_down, ket_up,   lowest_bit( ket_down & diff_down ), lowest_bit( bra_down & diff_down ) ); }
+
+   if (( num_up == 2 ) && ( num_down == 2 )){
+      const int p = lowest_bit( ket_up   & diff_up   );
+      const int r = lowest_bit( bra_up   & diff_up   );
+      const int q = lowest_bit( ket_down & diff_down );
+      const int s = lowest_bit( bra_down & diff_down );
+      return excitation_phase( ket_up, p, r ) * excitation_phase( ket_down, q, s ) * ERI[ p + L * ( r + L * ( q + L * s ) ) ];
+   }
+
+   // Double excitation p < q --> r < s within one spin string
+   const unsigned long long ket  = (( num_up == 4 ) ? ket_up  : ket_down  );
+   const unsigned long long diff = (( num_up == 4 ) ? diff_up : diff_down );
+   const unsigned long long anni = ket & diff;
+   const unsigned long long crea = diff & ( ~ket );
+   const int p = lowest_bit( anni );
+   const int q = lowest_bit( anni & ( anni - 1 ) );
+   const int r = lowest_bit( crea );
+   const int s = lowest_bit( crea & ( crea - 1 ) );
+   const double phase = excitation_phase( ket, p, r ) * excitation_phase( ket ^ ( 1ULL << p ) ^ ( 1ULL << r ), q, s );
+   return phase * ( ERI[ p + L * ( r + L * ( q + L * s ) ) ] - ERI[ p + L * ( s + L * ( q + L * r ) ) ] );
+
+}
+
+void CheMPS2::SelectedCI::Connections(const unsigned long long up, const unsigned long long down, const double value, const double epsilon, const bool only_new, Entry ** list, long long * num, long long * size) const{
+
+   const double abs_value = fabs( value );
+   for ( int spin = 0; spin < 2; spin++ ){
+      const unsigned long long same  = (( spin == 0 ) ? up   : down );
+      const unsigned long long other = (( spin == 0 ) ? down : up   );
+
+      // Single excitations p --> r: the elements are evaluated for all symmetry-allowed pairs
+      for ( unsigned long long mask_p = same; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+         const int p = lowest_bit( mask_p );
+         for ( int r = 0; r < L; r++ ){
+            if (( orb2irrep[ r ] == orb2irrep[ p ] ) && ( ( ( same >> r ) & 1 ) == 0 )){
+               const double element = value * SingleExcitation( same, other, p, r );
+               if ( fabs( element ) > epsilon ){
+                  const unsigned long long new_same = same ^ ( 1ULL << p ) ^ ( 1ULL << r );
+                  const unsigned long long new_up   = (( spin == 0 ) ? new_same : up   );
+                  const unsigned long long new_down = (( spin == 0 ) ? down : new_same );
+                  if (( only_new == false ) || ( FindDeterminant( new_up, new_down ) == -1 )){ AddEntry( list, num, size, new_up, new_down, element ); }
+               }
+            }
+         }
+      }
+
+      // Double excitations p < q --> r < s of equal spin: the heat-bath list of ( p, q ) is cut off at epsilon / | value |
+      for ( unsigned long long mask_p = same; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+         const int p = lowest_bit( mask_p );
+         for ( unsigned long long mask_q = mask_p & ( mask_p - 1 ); mask_q != 0; mask_q &= ( mask_q - 1 ) ){
+            const int q = lowest_bit( mask_q );
+            for ( long long entry = hb_same_start[ p + L * q ]; entry < hb_same_start[ p + L * q + 1 ]; entry++ ){
+               if ( hb_same[ entry ].value * abs_value <= epsilon ){ break; }
+               const int r = hb_same[ entry ].rs % L;
+               const int s = hb_same[ entry ].rs / L;
+               if ( ( ( same >> r ) & 1 ) || ( ( same >> s ) & 1 ) ){ continue; }
+               const unsigned long long half     = same ^ ( 1ULL << p ) ^ ( 1ULL << r );
+               const double phase                = excitation_phase( same, p, r ) * excitation_phase( half, q, s );
+               const double element              = value * phase * ( ERI[ p + L * ( r + L * ( q + L * s ) ) ] - ERI[ p + L * ( s + L * ( q + L * r ) ) ] );
+               const unsigned long long new_same = half ^ ( 1ULL << q ) ^ ( 1ULL << s );
+               const unsigned long long new_up   = (( spin == 0 ) ? new_same : up   );
+               const unsigned long long new_down = (( spin == 0 ) ? down : new_same );
+               if (( only_new == false ) || ( FindDeterminant( new_up, new_down ) == -1 )){ AddEntry( list, num, size, new_up, new_down, element ); }
+            }
+         }
+      }
+   }
+
+   // Double excitations p --> r (up) and q --> s (down)
+   for ( unsigned long long mask_p = up; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+      const int p = lowest_bit( mask_p );
+      for ( unsigned long long mask_q = down; mask_q != 0; mask_q &= ( mask_q - 1 ) ){
+         const int q = lowest_bit( mask_q );
+         for ( long long entry = hb_opp_start[ p + L * q ]; entry < hb_opp_start[ p + L * q + 1 ]; entry++ ){
+            if ( hb_opp[ entry ].value * abs_value <= epsilon ){ break; }
+            const int r = hb_opp[ entry ].rs % L;
+            const int s = hb_opp[ entry ].rs / L;
+            if ( ( ( up >> r ) & 1 ) || ( ( down >> s ) & 1 ) ){ continue; }
+            const double element = value * excitation_phase( up, p, r ) * excitation_phase( down, q, s ) * ERI[ p + L * ( r + L * ( q + L * s ) ) ];
+            const unsigned long long new_up   = up   ^ ( 1ULL << p ) ^ ( 1ULL << r );
+            const unsigned long long new_down = down ^ ( 1ULL << q ) ^ ( 1ULL << s );
+            if (( only_new == false ) || ( FindDeterminant( new_up, new_down ) == -1 )){ AddEntry( list, num, size, new_up, new_down, element ); }
+         }
+      }
+   }
+
+}
+
+int CheMPS2::SelectedCI::Extend(const double epsilon){
+
+   // Generate the new determinants per chunk of selected determinants
+   const int num_chunks = ( num_det + CheMPS2::SCI_CHUNK_SIZE - 1 ) / CheMPS2::SCI_CHUNK_SIZE;
+   Entry ** lists = new Entry*[ num_chunks ];
+   long long * nums  = new long long[ num_chunks ];
+   long long * sizes = new long long[ num_chunks ];
+
+   #pragma omp parallel for schedule(dynamic)
+   for ( int chunk = 0; chunk < num_chunks; chunk++ ){
+      lists[ chunk ] = NULL;
+      nums[ chunk ]  = 0;
+      sizes[ chunk ] = 0;
+      const int stop = std::min( ( chunk + 1 ) * CheMPS2::SCI_CHUNK_SIZE, num_det );
+      for ( int det = chunk * CheMPS2::SCI_CHUNK_SIZE; det < stop; det++ ){
+         Connections( det_up[ det ], det_down[ det ], coef[ det ], epsilon, true, lists + chunk, nums + chunk, sizes + chunk );
+      }
+      nums[ chunk ] = SortAndMerge( lists[ chunk ], nums[ chunk ] );
+   }
+
+   long long num_new = 0;
+   for ( int chunk = 0; chunk < num_chunks; chunk++ ){ num_new += nums[ chunk ]; }
+   Entry * all = new Entry[ num_det + num_new ];
+   num_new = 0;
+   for ( int chunk = 0; chunk < num_chunks; chunk++ ){
+      for ( long long cnt = 0; cnt < nums[ chunk ]; cnt++ ){
+         all[ num_new ] = lists[ chunk ][ cnt ];
+         all[ num_new ].value = 0.0; // Initial guess for the Davidson algorithm
+         num_new++;
+      }
+      if ( lists[ chunk ] != NULL ){ delete [] lists[ chunk ]; }
+   }
+   delete [] lists;
+   delete [] nums;
+   delete [] sizes;
+   num_new = SortAndMerge( all, num_new );
+
+   // Merge the new determinants with the selected ones
+   if ( num_new > 0 ){
+      for ( int det = 0; det < num_det; det++ ){
+         all[ num_new + det ].up    = det_up[ det ];
+         all[ num_new + det ].down  = det_down[ det ];
+         all[ num_new + det ].value = coef[ det ];
+      }
+      num_det += num_new;
+      std::sort( all, all + num_det, EntryLess );
+      delete [] det_up;
+      delete [] det_down;
+      delete [] coef;
+      det_up   = new unsigned long long[ num_det ];
+      det_down = new unsigned long long[ num_det ];
+      coef     = new double[ num_det ];
+      for ( int det = 0; det < num_det; det++ ){
+         det_up[ det ]   = all[ det ].up;
+         det_down[ det ] = all[ det ].down;
+         coef[ det ]     = all[ det ].value;
+      }
+   }
+   delete [] all;
+   return num_new;
+
+}
+
+void CheMPS2::SelectedCI::ClearHamiltonian(){
+
+   if ( ham_diag != NULL ){ delete [] ham_diag; ham_diag = NULL; }
+   if ( ham_row  != NULL ){ delete [] ham_row;  ham_row  = NULL; }
+   if ( ham_col  != NULL ){ delete [] ham_col;  ham_col  = NULL; }
+   if ( ham_val  != NULL ){ delete [] ham_val;  ham_val  = NULL; }
+
+}
+
+int CheMPS2::SelectedCI::ConnectRow(const int row, const Entry * by_down, const Entry * buckets, const long long num_buckets, int * cols) const{
+
+   const unsigned long long up   = det_up[ row ];
+   const unsigned long long down = det_down[ row ];
+   int num = 0;
+
+   // Equal up string, single or double excitation of the down string: a contiguous range of the selected determinants
+   int start = row;
+   while (( start > 0 ) && ( det_up[ start - 1 ] == up )){ start--; }
+   for ( int col = start; ( col < num_det ) && ( det_up[ col ] == up ); col++ ){
+      if (( col != row ) && ( popcount_mask( down ^ det_down[ col ] ) <= 4 )){
+         if ( cols != NULL ){ cols[ num ] = col; }
+         num++;
+      }
+   }
+
+   // Equal down string, double excitation of the up string
+   Entry probe;
+   probe.up    = down;
+   probe.down  = 0;
+   probe.value = 0.0;
+   for ( const Entry * iter = std::lower_bound( by_down, by_down + num_det, probe, EntryLess ); ( iter < by_down + num_det ) && ( iter->up == down ); iter++ ){
+      const int col = ( int )( iter->down );
+      if ( popcount_mask( up ^ det_up[ col ] ) == 4 ){
+         if ( cols != NULL ){ cols[ num ] = col; }
+         num++;
+      }
+   }
+
+   /* Single excitation of the up string, with at most a single excitation of the down string: both up strings
+      have exactly one ( Nel_up - 1 )-electron substring in common, which is used as key in the buckets */
+   for ( unsigned long long mask_p = up; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+      probe.up = up ^ ( 1ULL << lowest_bit( mask_p ) );
+      for ( const Entry * iter = std::lower_bound( buckets, buckets + num_buckets, probe, EntryLess ); ( iter < buckets + num_buckets ) && ( iter->up == probe.up ); iter++ ){
+         const int col = ( int )( iter->down );
+         if (( det_up[ col ] != up ) && ( popcount_mask( down ^ det_down[ col ] ) <= 2 )){
+            if ( cols != NULL ){ cols[ num ] = col; }
+            num++;
+         }
+      }
+   }
+
+   return num;
+
+}
+
+void CheMPS2::SelectedCI::BuildHamiltonian(){
+
+   ClearHamiltonian();
+
+   // The selected determinants ordered by ( down, index ), and the up strings with one electron removed ordered by ( substring, index )
+   Entry * by_down = new Entry[ num_det ];
+   const long long num_buckets = ( ( long long ) num_det ) * Nel_up;
+   Entry * buckets = new Entry[ num_buckets ];
+   #pragma omp parallel for schedule(static)
+   for ( int det = 0; det < num_det; det++ ){
+      by_down[ det ].up    = det_down[ det ];
+      by_down[ det ].down  = det;
+      by_down[ det ].value = 0.0;
+      long long bucket = ( ( long long ) det ) * Nel_up;
+      for ( unsigned long long mask_p = det_up[ det ]; mask_p != 0; mask_p &= ( mask_p - 1 ) ){
+         buckets[ bucket ].up    = det_up[ det ] ^ ( 1ULL << lowest_bit( mask_p ) );
+         buckets[ bucket ].down  = det;
+         buckets[ bucket ].value = 0.0;
+         bucket++;
+      }
+   }
+   std::sort( by_down, by_down + num_det, EntryLess );
+   std::sort( buckets, buckets + num_buckets, EntryLess );
+
+   // Compressed sparse row format: count the connections per row, and fill them
+   ham_diag = new double[ num_det ];
+   ham_row  = new long long[ num_det + 1 ];
+   #pragma omp parallel for schedule(dynamic, CheMPS2::SCI_CHUNK_SIZE)
+   for ( int row = 0; row < num_det; row++ ){
+      ham_diag[ row ]    = DiagonalElement( det_up[ row ], det_down[ row ] );
+      ham_row[ row + 1 ] = ConnectRow( row, by_down, buckets, num_buckets, NULL );
+   }
+   ham_row[ 0 ] = 0;
+   for ( int row = 0; row < num_det; row++ ){ ham_row[ row + 1 ] += ham_row[ row ]; }
+   ham_col = new int[ ham_row[ num_det ] ];
+   ham_val = new double[ ham_row[ num_det ] ];
+   #pragma omp parallel for schedule(dynamic, CheMPS2::SCI_CHUNK_SIZE)
+   for ( int row = 0; row < num_det; row++ ){
+      ConnectRow( row, by_down, buckets, num_buckets, ham_col + ham_row[ row ] );
+      for ( long long elem = ham_row[ row ]; elem < ham_row[ row + 1 ]; elem++ ){
+         const int col = ham_col[ elem ];
+         ham_val[ elem ] = MatrixElement( det_up[ row ], det_down[ row ], det_up[ col ], det_down[ col ] );
+      }
+   }
+
+   delete [] by_down;
+   delete [] buckets;
+
+}
+
+void CheMPS2::SelectedCI::matvec(double * input, double * output) const{
+
+   #pragma omp parallel for schedule(dynamic, CheMPS2::SCI_CHUNK_SIZE)
+   for ( int row = 0; row < num_det; row++ ){
+      double value = ham_diag[ row ] * input[ row ];
+      for ( long long elem = ham_row[ row ]; elem < ham_row[ row + 1 ]; elem++ ){ value += ham_val[ elem ] * input[ ham_col[ elem ] ]; }
+      output[ row ] = value;
+   }
+
+}
+
+double CheMPS2::SelectedCI::Diagonalize(){
+
+   if ( num_det <= CheMPS2::DAVIDSON_NUM_VEC ){ // Too small for Davidson's algorithm: dense diagonalization
+
+      double * dense = new double[ num_det * num_det ];
+      for ( int cnt = 0; cnt < num_det * num_det; cnt++ ){ dense[ cnt ] = 0.0; }
+      for ( int row = 0; row < num_det; row++ ){
+         dense[ row * ( num_det + 1 ) ] = ham_diag[ row ];
+         for ( long long elem = ham_row[ row ]; elem < ham_row[ row + 1 ]; elem++ ){ dense[ row + num_det * ham_col[ elem ] ] = ham_val[ elem ]; }
+      }
+      char jobz = 'V';
+      char uplo = 'U';
+      int lwork = 3 * num_det;
+      int info;
+      double * eigs = new double[ num_det ];
+      double * work = new double[ lwork ];
+      dsyev_( &jobz, &uplo, &num_det, dense, &num_det, eigs, work, &lwork, &info ); // Ascending order of eigenvalues
+      for ( int det = 0; det < num_det; det++ ){ coef[ det ] = dense[ det ]; }
+      const double lowest = eigs[ 0 ];
+      delete [] dense;
+      delete [] eigs;
+      delete [] work;
+      return lowest;
+
+   }
+
+   Davidson deBoskabouter( num_det, CheMPS2::DAVIDSON_NUM_VEC,
+                                    CheMPS2::DAVIDSON_NUM_VEC_KEEP,
+                                    CheMPS2::DAVIDSON_FCI_RTOL,
+                                    CheMPS2::DAVIDSON_PRECOND_CUTOFF, false ); // No debug printing
+   double ** whichpointers = new double*[ 2 ];
+
+   char instruction = deBoskabouter.FetchInstruction( whichpointers );
+   assert( instruction == 'A' );
+   for ( int det = 0; det < num_det; det++ ){
+      whichpointers[ 0 ][ det ] = coef[ det ]; // Wavefunction of the previous iteration
+      whichpointers[ 1 ][ det ] = ham_diag[ det ];
+   }
+
+   instruction = deBoskabouter.FetchInstruction( whichpointers );
+   while ( instruction == 'B' ){
+      matvec( whichpointers[ 0 ], whichpointers[ 1 ] );
+      instruction = deBoskabouter.FetchInstruction( whichpointers );
+   }
+
+   assert( instruction == 'C' );
+   for ( int det = 0; det < num_det; det++ ){ coef[ det ] = whichpointers[ 0 ][ det ]; }
+   const double lowest = whichpointers[ 1 ][ 0 ];
+   if ( SCIverbose > 1 ){ cout << "SelectedCI::Diagonalize : Required number of matrix-vector multiplications = " << deBoskabouter.GetNumMultiplications() << endl; }
+   delete [] whichpointers;
+   return lowest;
+
+}
+
+double CheMPS2::SelectedCI::Solve(const double epsilon, const int max_iter){
+
+   struct timeval start, end;
+   gettimeofday( &start, NULL );
+
+   BuildHamiltonian();
+   Energy = Diagonalize() + Econstant;
+   if ( SCIverbose > 1 ){ cout << "SelectedCI::Solve : Number of determinants = " << num_det << " ; nonzero off-diagonal elements = " << ham_row[ num_det ] << " ; energy = " << Energy << endl; }
+
+   for ( int iter = 0; iter < max_iter; iter++ ){
+      const int num_old = num_det;
+      const int num_new = Extend( epsilon );
+      if ( num_new == 0 ){ break; }
+      BuildHamiltonian();
+      Energy = Diagonalize() + Econstant;
+      if ( SCIverbose > 1 ){ cout << "SelectedCI::Solve : Number of determinants = " << num_det << " ; nonzero off-diagonal elements = " << ham_row[ num_det ] << " ; energy = " << Energy << endl; }
+      if ( num_new < CheMPS2::SCI_CONV_FRACTION * num_old ){ break; }
+   }
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   if ( SCIverbose > 0 ){
+      cout << "SelectedCI::Solve : Heat-bath threshold = " << epsilon << " ; number of determinants = " << num_det << " ; time = " << elapsed << " seconds" << endl;
+      cout << "SelectedCI::Solve : Variational energy = " << Energy << endl;
+   }
+   return Energy;
+
+}
+
+double CheMPS2::SelectedCI::EpsteinNesbetPT2(const double epsilon) const{
+
+   struct timeval start, end;
+   gettimeofday( &start, NULL );
+
+   // Accumulate sum_i H_ai c_i per chunk of selected determinants, for the determinants a outside the selected space
+   const int num_chunks = ( num_det + CheMPS2::SCI_CHUNK_SIZE - 1 ) / CheMPS2::SCI_CHUNK_SIZE;
+   Entry ** lists = new Entry*[ num_chunks ];
+   long long * nums  = new long long[ num_chunks ];
+   long long * sizes = new long long[ num_chunks ];
+
+   #pragma omp parallel for schedule(dynamic)
+   for ( int chunk = 0; chunk < num_chunks; chunk++ ){
+      lists[ chunk ] = NULL;
+      nums[ chunk ]  = 0;
+      sizes[ chunk ] = 0;
+      const int stop = std::min( ( chunk + 1 ) * CheMPS2::SCI_CHUNK_SIZE, num_det );
+      for ( int det = chunk * CheMPS2::SCI_CHUNK_SIZE; det < stop; det++ ){
+         Connections( det_up[ det ], det_down[ det ], coef[ det ], epsilon, true, lists + chunk, nums + chunk, sizes + chunk );
+      }
+      nums[ chunk ] = SortAndMerge( lists[ chunk ], nums[ chunk ] );
+   }
+
+   long long num_ext = 0;
+   for ( int chunk = 0; chunk < num_chunks; chunk++ ){ num_ext += nums[ chunk ]; }
+   Entry * all = new Entry[ num_ext ];
+   num_ext = 0;
+   for ( int chunk = 0; chunk < num_chunks; chunk++ ){
+      for ( long long cnt = 0; cnt < nums[ chunk ]; cnt++ ){
+         all[ num_ext ] = lists[ chunk ][ cnt ];
+         num_ext++;
+      }
+      if ( lists[ chunk ] != NULL ){ delete [] lists[ chunk ]; }
+   }
+   delete [] lists;
+   delete [] nums;
+   delete [] sizes;
+   num_ext = SortAndMerge( all, num_ext );
+
+   const double E0 = Energy - Econstant;
+   double E2 = 0.0;
+   #pragma omp parallel for schedule(static) reduction(+:E2)
+   for ( long long ext = 0; ext < num_ext; ext++ ){
+      E2 += all[ ext ].value * all[ ext ].value / ( E0 - DiagonalElement( all[ ext ].up, all[ ext ].down ) );
+   }
+   delete [] all;
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   if ( SCIverbose > 0 ){
+      cout << "SelectedCI::EpsteinNesbetPT2 : Heat-bath threshold = " << epsilon << " ; number of external determinants = " << num_ext << " ; time = " << elapsed << " seconds" << endl;
+      cout << "SelectedCI::EpsteinNesbetPT2 : Second order energy correction = " << E2 << " ; total energy = " << Energy + E2 << endl;
+   }
+   return E2;
+
+}
+
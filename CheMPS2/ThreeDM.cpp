@@ -23,6 +23,11 @@
 #include <math.h>
 #include <algorithm>
 #include <assert.h>
+#include <climits>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "ThreeDM.h"
 #include "Lapack.h"
@@ -36,54 +41,234 @@ using std::max;
 using std::cout;
 using std::endl;
 
-CheMPS2::ThreeDM::ThreeDM(const SyBookkeeper * book_in, const Problem * prob_in){
+#ifdef CHEMPS2_MPI_COMPILATION
+/* Allocate the temporary duplicates of F_mn and S_mn at site orb_i on the processes which do not own them, and post
+   their broadcasts from the owners. The four requests should be completed with MPIchemps2::wait_all before the tensors are used. */
+static void ibroadcast_mn_duplicates( const int L, const int orb_i, const int orb_m, const int orb_n, const CheMPS2::SyBookkeeper * book,
+                                      CheMPS2::TensorF0 **** F0tensors, CheMPS2::TensorF1 **** F1tensors, CheMPS2::TensorS0 **** S0tensors, CheMPS2::TensorS1 **** S1tensors, MPI_Request * requests ){
+
+   const int MPIRANK  = CheMPS2::MPIchemps2::mpi_rank();
+   const int irrep_mn = CheMPS2::Irreps::directProd( book->gIrrep( orb_m ), book->gIrrep( orb_n ) );
+   const int own_S_mn = CheMPS2::MPIchemps2::owner_absigma( orb_m, orb_n );
+   const int own_F_mn = CheMPS2::MPIchemps2::owner_cdf(  L, orb_m, orb_n );
+   if ( MPIRANK != own_F_mn ){ F0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new CheMPS2::TensorF0( orb_i+1, irrep_mn, false, book );
+                               F1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new CheMPS2::TensorF1( orb_i+1, irrep_mn, false, book ); }
+   if ( MPIRANK != own_S_mn ){ S0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new CheMPS2::TensorS0( orb_i+1, irrep_mn, false, book );
+        if ( orb_m != orb_n ){ S1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new CheMPS2::TensorS1( orb_i+1, irrep_mn, false, book ); }}
+   for ( int cnt = 0; cnt < 4; cnt++ ){ requests[ cnt ] = MPI_REQUEST_NULL; }
+                          CheMPS2::MPIchemps2::ibroadcast_tensor( F0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_F_mn, requests + 0 );
+                          CheMPS2::MPIchemps2::ibroadcast_tensor( F1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_F_mn, requests + 1 );
+                          CheMPS2::MPIchemps2::ibroadcast_tensor( S0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_S_mn, requests + 2 );
+   if ( orb_m != orb_n ){ CheMPS2::MPIchemps2::ibroadcast_tensor( S1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_S_mn, requests + 3 ); }
+
+}
+#endif
+
+CheMPS2::ThreeDM::ThreeDM(const SyBookkeeper * book_in, const Problem * prob_in, const bool disk_in, const string tmpfolder){
 
    book = book_in;
    prob = prob_in;
    L = book->gL();
-   const long long size = (((long long) L ) * ((long long) L ) * ((long long) L )
-                         * ((long long) L ) * ((long long) L ) * ((long long) L ));
-   assert( INT_MAX >= size );
-   elements = new double[ size ];
-   for (int cnt = 0; cnt < size; cnt++){ elements[ cnt ] = 0.0; }
+   num_irreps = book->getNumberOfIrreps();
+   
+   // Order the orbital pairs ( orb1, orb2 ) per irrep I_orb1 x I_orb2
+   pair_rank   = new int[ L * L ];
+   pair_irrep  = new int[ L * L ];
+   irrep_start = new int[ num_irreps + 1 ];
+   irrep_start[ 0 ] = 0;
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+      int rank = irrep_start[ irrep ];
+      for ( int orb2 = 0; orb2 < L; orb2++ ){
+         for ( int orb1 = 0; orb1 < L; orb1++ ){
+            if ( Irreps::directProd( book->gIrrep( orb1 ), book->gIrrep( orb2 ) ) == irrep ){
+               pair_rank[ orb1 + L * orb2 ] = rank;
+               pair_irrep[ rank ] = irrep;
+               rank++;
+            }
+         }
+      }
+      irrep_start[ irrep + 1 ] = rank;
+   }
+   
+   /* The sorted pair triples rank1 <= rank2 <= rank3 have sorted irreps g1 <= g2 <= g3 = g1 x g2. Either
+        - g1 = g2 = g3 = 0 : n0 * ( n0 + 1 ) * ( n0 + 2 ) / 6 elements
+        - g1 = 0 < g2 = g3 : n0 * n2 * ( n2 + 1 ) / 2 elements
+        - g1 < g2 < g3     : n1 * n2 * n3 elements */
+   block_offset = new long long[ num_irreps * num_irreps ];
+   size = 0;
+   for ( int g2 = 0; g2 < num_irreps; g2++ ){
+      for ( int g1 = 0; g1 < num_irreps; g1++ ){
+         const int g3 = Irreps::directProd( g1, g2 );
+         block_offset[ g1 + num_irreps * g2 ] = -1;
+         if (( g1 <= g2 ) && ( g2 <= g3 )){
+            block_offset[ g1 + num_irreps * g2 ] = size;
+            const long long n1 = irrep_start[ g1 + 1 ] - irrep_start[ g1 ];
+            const long long n2 = irrep_start[ g2 + 1 ] - irrep_start[ g2 ];
+            const long long n3 = irrep_start[ g3 + 1 ] - irrep_start[ g3 ];
+            if ( g1 == g3 ){ size += ( n1 * ( n1 + 1 ) * ( n1 + 2 ) ) / 6; }
+            else if ( g2 == g3 ){ size += ( n1 * n2 * ( n2 + 1 ) ) / 2; }
+            else { size += n1 * n2 * n3; }
+         }
+      }
+   }
+   
+   disk = (( disk_in ) && ( size > 0 ));
+   if ( disk ){
+      elements = allocate_mapped_array( size, tmpfolder );
+   } else {
+      elements = new double[ size ];
+      for ( long long cnt = 0; cnt < size; cnt++ ){ elements[ cnt ] = 0.0; }
+   }
+   distributed = false;
+   slab_start  = 0;
+   slab_size   = size;
+   subset      = NULL;
+
+}
+
+double * CheMPS2::ThreeDM::allocate_mapped_array( const long long num, const string tmpfolder ){
+
+   /* The array lives in a file-backed shared mapping: dirty pages are written back and evicted by the
+      operating system, so resident memory does not scale with the array size. The file is unlinked right
+      away and disappears when the mapping is released. A newly extended file reads as zero. */
+   const string name = tmpfolder + "/" + CheMPS2::THREE_RDM_storage_prefix + "XXXXXX";
+   char * filename = new char[ name.size() + 1 ];
+   strcpy( filename, name.c_str() );
+   const int fd = mkstemp( filename );
+   if ( fd == -1 ){
+      cout << "ThreeDM::allocate_mapped_array : Could not create the file " << name << " : " << strerror( errno ) << endl;
+      abort();
+   }
+   unlink( filename );
+   delete [] filename;
+   const int truncated = ftruncate( fd, ( off_t )( num * sizeof(double) ) );
+   void * mapping = (( truncated == 0 ) ? mmap( NULL, num * sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) : MAP_FAILED );
+   const int error = errno;
+   close( fd );
+   if ( mapping == MAP_FAILED ){
+      cout << "ThreeDM::allocate_mapped_array : Could not map " << num * sizeof(double) << " bytes in the folder " << tmpfolder << " : " << strerror( error ) << endl;
+      abort();
+   }
+   return ( double * ) mapping;
+
+}
+
+void CheMPS2::ThreeDM::free_mapped_array( double * array, const long long num ){
+
+   munmap( array, num * sizeof(double) );
 
 }
 
 CheMPS2::ThreeDM::~ThreeDM(){
 
-   delete [] elements;
+   if ( disk ){ free_mapped_array( elements, size ); }
+   else { delete [] elements; }
+   delete [] block_offset;
+   delete [] irrep_start;
+   delete [] pair_irrep;
+   delete [] pair_rank;
+   if ( subset != NULL ){ delete [] subset; }
+
+}
+
+void CheMPS2::ThreeDM::set_orbital_subset( const bool * dmrg_mask ){
+
+   if ( subset != NULL ){ delete [] subset; subset = NULL; }
+   if ( dmrg_mask != NULL ){
+      subset = new bool[ L ];
+      for ( int orb = 0; orb < L; orb++ ){ subset[ orb ] = dmrg_mask[ orb ]; }
+   }
 
 }
 
 #ifdef CHEMPS2_MPI_COMPILATION
 void CheMPS2::ThreeDM::mpi_allreduce(){
 
-   const int size = L*L*L*L*L*L; // L^6 fits in integer (tested in constructor)
-   double * temp = new double[ size ];
-   MPIchemps2::allreduce_array_double( elements, temp, size );
-   for (int cnt = 0; cnt < size; cnt++){ elements[ cnt ] = temp[ cnt ]; }
-   delete [] temp;
+   assert( !distributed );
+
+   // The packed size can exceed INT_MAX: reduce in place in chunks
+   const long long chunk = std::min( size, ( long long ) INT_MAX );
+   for ( long long start = 0; start < size; start += chunk ){
+      const int num = ( int )( std::min( chunk, size - start ) );
+      MPIchemps2::allreduce_array_double_inplace( elements + start, num );
+   }
+
+}
+
+void CheMPS2::ThreeDM::mpi_distribute( const bool reduce ){
+
+   assert( !distributed );
+   const int num_procs = MPIchemps2::mpi_size();
+   const int my_rank   = MPIchemps2::mpi_rank();
+
+   // Contiguous slabs of the packed array with (almost) equal numbers of elements
+   long long * starts = new long long[ num_procs + 1 ];
+   long long max_slab = 0;
+   for ( int proc = 0; proc <= num_procs; proc++ ){ starts[ proc ] = ( size * proc ) / num_procs; }
+   for ( int proc = 0; proc <  num_procs; proc++ ){ max_slab = std::max( max_slab, starts[ proc + 1 ] - starts[ proc ] ); }
+   slab_start = starts[ my_rank ];
+   slab_size  = starts[ my_rank + 1 ] - starts[ my_rank ];
+   double * slab = new double[ std::max( slab_size, 1LL ) ];
+
+   if ( reduce ){
+      /* Each slab is reduced straight from the full array to its owner, in chunks
+         because the MPI counts are int, so no packed copy of the array is needed */
+      const long long chunk = std::max( 1LL, std::min( max_slab, ( long long ) INT_MAX ) );
+      for ( int proc = 0; proc < num_procs; proc++ ){
+         const long long proc_size = starts[ proc + 1 ] - starts[ proc ];
+         for ( long long shift = 0; shift < proc_size; shift += chunk ){
+            const int num = ( int )( std::min( chunk, proc_size - shift ) );
+            MPIchemps2::reduce_array_double( elements + starts[ proc ] + shift, slab + (( proc == my_rank ) ? shift : 0 ), num, proc );
+         }
+      }
+   } else {
+      for ( long long cnt = 0; cnt < slab_size; cnt++ ){ slab[ cnt ] = elements[ slab_start + cnt ]; }
+   }
+   delete [] starts;
+
+   // Release the full array; the slab lives in memory
+   if ( disk ){ free_mapped_array( elements, size ); }
+   else { delete [] elements; }
+   elements    = slab;
+   disk        = false;
+   distributed = true;
 
 }
 #endif
 
+long long CheMPS2::ThreeDM::pack_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const{
+
+   // Simultaneous permutation of the pairs ( cnt1, cnt4 ), ( cnt2, cnt5 ) and ( cnt3, cnt6 ) leaves the 3-RDM invariant
+   int rank1 = pair_rank[ cnt1 + L * cnt4 ];
+   int rank2 = pair_rank[ cnt2 + L * cnt5 ];
+   int rank3 = pair_rank[ cnt3 + L * cnt6 ];
+   if ( rank1 > rank2 ){ std::swap( rank1, rank2 ); }
+   if ( rank2 > rank3 ){ std::swap( rank2, rank3 ); }
+   if ( rank1 > rank2 ){ std::swap( rank1, rank2 ); }
+   
+   const int g1 = pair_irrep[ rank1 ];
+   const int g2 = pair_irrep[ rank2 ];
+   const int g3 = pair_irrep[ rank3 ];
+   const long long loc1 = rank1 - irrep_start[ g1 ];
+   const long long loc2 = rank2 - irrep_start[ g2 ];
+   const long long loc3 = rank3 - irrep_start[ g3 ];
+   const long long n1   = irrep_start[ g1 + 1 ] - irrep_start[ g1 ];
+   const long long offset = block_offset[ g1 + num_irreps * g2 ];
+   
+   if ( g1 == g3 ){ return offset + loc1 + ( loc2 * ( loc2 + 1 ) ) / 2 + ( loc3 * ( loc3 + 1 ) * ( loc3 + 2 ) ) / 6; }
+   if ( g2 == g3 ){ return offset + loc1 + n1 * ( loc2 + ( loc3 * ( loc3 + 1 ) ) / 2 ); }
+   const long long n2 = irrep_start[ g2 + 1 ] - irrep_start[ g2 ];
+   return offset + loc1 + n1 * ( loc2 + n2 * loc3 );
+
+}
+
 void CheMPS2::ThreeDM::set_dmrg_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6, const double value){
 
    //Prob assumes you use DMRG orbs...
    //Irrep sanity checks are performed in ThreeDM::fill_site
-   elements[ cnt1 + L * ( cnt2 + L * ( cnt3 + L * ( cnt4 + L * ( cnt5 + L * cnt6 ) ) ) ) ] = value;
-   elements[ cnt2 + L * ( cnt3 + L * ( cnt1 + L * ( cnt5 + L * ( cnt6 + L * cnt4 ) ) ) ) ] = value;
-   elements[ cnt3 + L * ( cnt1 + L * ( cnt2 + L * ( cnt6 + L * ( cnt4 + L * cnt5 ) ) ) ) ] = value;
-   elements[ cnt2 + L * ( cnt1 + L * ( cnt3 + L * ( cnt5 + L * ( cnt4 + L * cnt6 ) ) ) ) ] = value;
-   elements[ cnt3 + L * ( cnt2 + L * ( cnt1 + L * ( cnt6 + L * ( cnt5 + L * cnt4 ) ) ) ) ] = value;
-   elements[ cnt1 + L * ( cnt3 + L * ( cnt2 + L * ( cnt4 + L * ( cnt6 + L * cnt5 ) ) ) ) ] = value;
-   
-   elements[ cnt4 + L * ( cnt5 + L * ( cnt6 + L * ( cnt1 + L * ( cnt2 + L * cnt3 ) ) ) ) ] = value;
-   elements[ cnt5 + L * ( cnt6 + L * ( cnt4 + L * ( cnt2 + L * ( cnt3 + L * cnt1 ) ) ) ) ] = value;
-   elements[ cnt6 + L * ( cnt4 + L * ( cnt5 + L * ( cnt3 + L * ( cnt1 + L * cnt2 ) ) ) ) ] = value;
-   elements[ cnt5 + L * ( cnt4 + L * ( cnt6 + L * ( cnt2 + L * ( cnt1 + L * cnt3 ) ) ) ) ] = value;
-   elements[ cnt6 + L * ( cnt5 + L * ( cnt4 + L * ( cnt3 + L * ( cnt2 + L * cnt1 ) ) ) ) ] = value;
-   elements[ cnt4 + L * ( cnt6 + L * ( cnt5 + L * ( cnt1 + L * ( cnt3 + L * cnt2 ) ) ) ) ] = value;
+   //The six simultaneous pair permutations share one packed element; the hermitian conjugate is stored separately
+   elements[ pack_index( cnt1, cnt2, cnt3, cnt4, cnt5, cnt6 ) ] = value;
+   elements[ pack_index( cnt4, cnt5, cnt6, cnt1, cnt2, cnt3 ) ] = value;
 
 }
 
@@ -97,7 +282,26 @@ double CheMPS2::ThreeDM::get_dmrg_index(const int cnt1, const int cnt2, const in
    const int irrep5 = prob->gIrrep(cnt5);
    const int irrep6 = prob->gIrrep(cnt6);
    if ( Irreps::directProd(Irreps::directProd(irrep1, irrep2), irrep3) == Irreps::directProd(Irreps::directProd(irrep4, irrep5), irrep6) ){
-      return elements[ cnt1 + L * ( cnt2 + L * ( cnt3 + L * ( cnt4 + L * ( cnt5 + L * cnt6 ) ) ) ) ];
+      const long long pack = pack_index( cnt1, cnt2, cnt3, cnt4, cnt5, cnt6 ) - slab_start;
+      assert( ( pack >= 0 ) && ( pack < slab_size ) ); // With distributed storage, only the own slab is available
+      return elements[ pack ];
+   }
+   
+   return 0.0;
+
+}
+
+double CheMPS2::ThreeDM::get_slab_dmrg_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const{
+
+   const int irrep1 = prob->gIrrep(cnt1);
+   const int irrep2 = prob->gIrrep(cnt2);
+   const int irrep3 = prob->gIrrep(cnt3);
+   const int irrep4 = prob->gIrrep(cnt4);
+   const int irrep5 = prob->gIrrep(cnt5);
+   const int irrep6 = prob->gIrrep(cnt6);
+   if ( Irreps::directProd(Irreps::directProd(irrep1, irrep2), irrep3) == Irreps::directProd(Irreps::directProd(irrep4, irrep5), irrep6) ){
+      const long long pack = pack_index( cnt1, cnt2, cnt3, cnt4, cnt5, cnt6 ) - slab_start;
+      if (( pack >= 0 ) && ( pack < slab_size )){ return elements[ pack ]; }
    }
    
    return 0.0;
@@ -114,29 +318,123 @@ double CheMPS2::ThreeDM::get_ham_index(const int cnt1, const int cnt2, const int
 
 }
 
+double CheMPS2::ThreeDM::get_slab_ham_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const{
+
+   if ( prob->gReorder() ){
+      return get_slab_dmrg_index( prob->gf1(cnt1), prob->gf1(cnt2), prob->gf1(cnt3), prob->gf1(cnt4), prob->gf1(cnt5), prob->gf1(cnt6) );
+   }
+   return get_slab_dmrg_index( cnt1, cnt2, cnt3, cnt4, cnt5, cnt6 );
+
+}
+
+void CheMPS2::ThreeDM::fill_ham_block(double * output, const int n_start, const int n_num) const{
+
+   // Sequential in the output, so that consumers can stream the 3-RDM in blocks of L^5 * n_num doubles
+   if ( !distributed ){
+      long long counter = 0;
+      for ( int n = n_start; n < n_start + n_num; n++ ){
+         for ( int m = 0; m < L; m++ ){
+            for ( int l = 0; l < L; l++ ){
+               for ( int k = 0; k < L; k++ ){
+                  for ( int j = 0; j < L; j++ ){
+                     for ( int i = 0; i < L; i++ ){
+                        output[ counter ] = get_ham_index( i, j, k, l, m, n );
+                        counter++;
+                     }
+                  }
+               }
+            }
+         }
+      }
+      return;
+   }
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   // Every packed element belongs to exactly one slab: each process fills its own elements, and the block is summed
+   int * ham2dmrg = new int[ L ];
+   for ( int orb = 0; orb < L; orb++ ){ ham2dmrg[ orb ] = (( prob->gReorder() ) ? prob->gf1( orb ) : orb ); }
+   long long counter = 0;
+   for ( int n = n_start; n < n_start + n_num; n++ ){
+      for ( int m = 0; m < L; m++ ){
+         for ( int l = 0; l < L; l++ ){
+            for ( int k = 0; k < L; k++ ){
+               for ( int j = 0; j < L; j++ ){
+                  for ( int i = 0; i < L; i++ ){
+                     output[ counter ] = get_slab_dmrg_index( ham2dmrg[ i ], ham2dmrg[ j ], ham2dmrg[ k ], ham2dmrg[ l ], ham2dmrg[ m ], ham2dmrg[ n ] );
+                     counter++;
+                  }
+               }
+            }
+         }
+      }
+   }
+   delete [] ham2dmrg;
+   const long long chunk = std::max( 1LL, std::min( counter, ( long long ) INT_MAX ) );
+   for ( long long start = 0; start < counter; start += chunk ){
+      const int num = ( int )( std::min( chunk, counter - start ) );
+      MPIchemps2::allreduce_array_double_inplace( output + start, num );
+   }
+   #endif
+
+}
+
 double CheMPS2::ThreeDM::trace() const{
 
    double value = 0.0;
    for (int cnt1=0; cnt1<L; cnt1++){
       for (int cnt2=0; cnt2<L; cnt2++){
          for (int cnt3=0; cnt3<L; cnt3++){
-            value += get_dmrg_index( cnt1, cnt2, cnt3, cnt1, cnt2, cnt3 );
+            value += get_slab_dmrg_index( cnt1, cnt2, cnt3, cnt1, cnt2, cnt3 );
          }
       }
    }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed ){
+      double total = 0.0;
+      MPIchemps2::allreduce_array_double( &value, &total, 1 );
+      value = total;
+   }
+   #endif
    return value;
 
 }
 
 void CheMPS2::ThreeDM::save() const{
 
-   hid_t file_id = H5Fcreate(CheMPS2::THREE_RDM_storagename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-      hid_t group_id = H5Gcreate(file_id, "three_rdm", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed ){ // The processes write their slabs in turn into the same file
+      const int num_procs = MPIchemps2::mpi_size();
+      const int my_rank   = MPIchemps2::mpi_rank();
+      for ( int proc = 0; proc < num_procs; proc++ ){
+         if ( proc == my_rank ){ save_slab( proc == 0 ); }
+         MPIchemps2::barrier();
+      }
+      return;
+   }
+   #endif
+   save_slab( true );
+
+}
+
+void CheMPS2::ThreeDM::save_slab( const bool create ) const{
+
+   hid_t file_id  = (( create ) ? H5Fcreate(CheMPS2::THREE_RDM_storagename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)
+                                : H5Fopen(CheMPS2::THREE_RDM_storagename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT));
+      hid_t group_id = (( create ) ? H5Gcreate(file_id, "three_rdm", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)
+                                   : H5Gopen(file_id, "three_rdm", H5P_DEFAULT));
 
-         hsize_t dimarray       = L*L*L*L*L*L;
+         hsize_t dimarray       = size;
          hid_t dataspace_id     = H5Screate_simple(1, &dimarray, NULL);
-         hid_t dataset_id       = H5Dcreate(group_id, "elements", H5T_IEEE_F64LE, dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-         H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, elements);
+         hid_t dataset_id       = (( create ) ? H5Dcreate(group_id, "elements", H5T_IEEE_F64LE, dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)
+                                              : H5Dopen(group_id, "elements", H5P_DEFAULT));
+         if ( slab_size > 0 ){
+            hsize_t start_h5 = slab_start;
+            hsize_t count_h5 = slab_size;
+            H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, &start_h5, NULL, &count_h5, NULL);
+            hid_t memspace_id = H5Screate_simple(1, &count_h5, NULL);
+            H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, memspace_id, dataspace_id, H5P_DEFAULT, elements);
+            H5Sclose(memspace_id);
+         }
 
          H5Dclose(dataset_id);
          H5Sclose(dataspace_id);
@@ -152,7 +450,16 @@ void CheMPS2::ThreeDM::read(){
       hid_t group_id = H5Gopen(file_id, "three_rdm", H5P_DEFAULT);
 
          hid_t dataset_id = H5Dopen(group_id, "elements", H5P_DEFAULT);
-         H5Dread(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, elements);
+         if ( slab_size > 0 ){ // Only the own slab when distributed
+            hid_t dataspace_id = H5Dget_space(dataset_id);
+            hsize_t start_h5 = slab_start;
+            hsize_t count_h5 = slab_size;
+            H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, &start_h5, NULL, &count_h5, NULL);
+            hid_t memspace_id = H5Screate_simple(1, &count_h5, NULL);
+            H5Dread(dataset_id, H5T_NATIVE_DOUBLE, memspace_id, dataspace_id, H5P_DEFAULT, elements);
+            H5Sclose(memspace_id);
+            H5Sclose(dataspace_id);
+         }
          H5Dclose(dataset_id);
 
       H5Gclose(group_id);
@@ -173,9 +480,29 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
    #endif
 
    const int orb_i = denT->gIndex();
+   if ( !requested( orb_i, orb_i, orb_i ) ){ return; } // Every element of this site contains orb_i
    const int DIM = max(book->gMaxDimAtBound( orb_i ), book->gMaxDimAtBound( orb_i+1 ));
    const double sq3 = sqrt( 3.0 );
 
+   #ifdef CHEMPS2_MPI_COMPILATION
+   /* The (m,n) for which all processes need a duplicate of S_mn and F_mn. The broadcasts of these duplicates
+      are posted one (m,n) ahead, so that they are in flight while the diagrams of the current (m,n) are computed. */
+   int num_dupl = 0;
+   int * dupl_m = new int[ ( L * ( L + 1 ) ) / 2 + 1 ];
+   int * dupl_n = new int[ ( L * ( L + 1 ) ) / 2 + 1 ];
+   for ( int orb_m = orb_i + 2; orb_m < L; orb_m++ ){ // All processes own Fx/Sx[ index ][ n - m ][ m - i - 1 == 0 ]
+      for ( int orb_n = orb_m; orb_n < L; orb_n++ ){
+         if ( requested( orb_m, orb_n, orb_i ) ){
+            dupl_m[ num_dupl ] = orb_m;
+            dupl_n[ num_dupl ] = orb_n;
+            num_dupl++;
+         }
+      }
+   }
+   MPI_Request requests[ 8 ]; // Two sets of four: the current and the next (m,n)
+   if ( num_dupl > 0 ){ ibroadcast_mn_duplicates( L, orb_i, dupl_m[ 0 ], dupl_n[ 0 ], book, F0tensors, F1tensors, S0tensors, S1tensors, requests ); }
+   #endif
+
    #pragma omp parallel
    {
 
@@ -193,7 +520,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          Special::invert_triangle_two( global, jkl );
          const int orb_j = jkl[ 0 ];
          const int orb_k = jkl[ 1 ];
-         if ( book->gIrrep( orb_j ) == book->gIrrep( orb_k )){
+         if (( book->gIrrep( orb_j ) == book->gIrrep( orb_k ) ) && ( requested( orb_j, orb_k, orb_i ) )){
             #ifdef CHEMPS2_MPI_COMPILATION
             if ( MPIRANK == MPIchemps2::owner_cdf( L, orb_j, orb_k ) )
             #endif
@@ -216,7 +543,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          Special::invert_triangle_two( global, jkl );
          const int orb_j = L - 1 - jkl[ 1 ];
          const int orb_k = orb_j + jkl[ 0 ];
-         if ( book->gIrrep( orb_j ) == book->gIrrep( orb_k )){
+         if (( book->gIrrep( orb_j ) == book->gIrrep( orb_k ) ) && ( requested( orb_j, orb_k, orb_i ) )){
             #ifdef CHEMPS2_MPI_COMPILATION
             if ( MPIRANK == MPIchemps2::owner_cdf( L, orb_j, orb_k ) )
             #endif
@@ -241,7 +568,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          const int orb_l = jkl[ 2 ];
          const int recalculate_global = orb_j + ( orb_k * ( orb_k + 1 ) ) / 2 + ( orb_l * ( orb_l + 1 ) * ( orb_l + 2 ) ) / 6;
          assert( global == recalculate_global );
-         if ( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ) == Irreps::directProd( book->gIrrep( orb_l ), book->gIrrep( orb_i ) ) ){
+         if (( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ) == Irreps::directProd( book->gIrrep( orb_l ), book->gIrrep( orb_i ) ) ) && ( requested( orb_j, orb_k, orb_l ) )){
             #ifdef CHEMPS2_MPI_COMPILATION
             if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
             #endif
@@ -286,7 +613,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          const int orb_l = orb_i + 1 + ( combined / upperbound1 );
          const int orb_j = jkl[ 0 ];
          const int orb_k = jkl[ 1 ];
-         if ( Irreps::directProd(book->gIrrep( orb_j ), book->gIrrep( orb_k )) == Irreps::directProd(book->gIrrep( orb_l ), book->gIrrep( orb_i )) ){
+         if (( Irreps::directProd(book->gIrrep( orb_j ), book->gIrrep( orb_k )) == Irreps::directProd(book->gIrrep( orb_l ), book->gIrrep( orb_i )) ) && ( requested( orb_j, orb_k, orb_l ) )){
             #ifdef CHEMPS2_MPI_COMPILATION
             if ( MPIRANK == MPIchemps2::owner_absigma( orb_j, orb_k ) )
             #endif
@@ -333,7 +660,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          Special::invert_triangle_two( global, jkl );
          const int orb_m = L - 1 - jkl[ 1 ];
          const int orb_n = orb_m + jkl[ 0 ];
-         if ( Irreps::directProd(book->gIrrep( orb_j ), book->gIrrep( orb_i )) == Irreps::directProd(book->gIrrep( orb_m ), book->gIrrep( orb_n )) ){
+         if (( Irreps::directProd(book->gIrrep( orb_j ), book->gIrrep( orb_i )) == Irreps::directProd(book->gIrrep( orb_m ), book->gIrrep( orb_n )) ) && ( requested( orb_j, orb_m, orb_n ) )){
             #ifdef CHEMPS2_MPI_COMPILATION
             if ( MPIRANK == MPIchemps2::owner_absigma( orb_m, orb_n ) )
             #endif
@@ -368,6 +695,9 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          }
       }
       
+      #ifdef CHEMPS2_MPI_COMPILATION
+      int dupl_cnt = 0; // Same value on all threads
+      #endif
       for ( int orb_m = orb_i+1; orb_m < L; orb_m++ ){
          for ( int orb_n = orb_m; orb_n < L; orb_n++ ){
          
@@ -376,8 +706,11 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
              *   - owner of left renormalized operator is going to calculate
              *   - outer loop is (m,n)
              *   - in (m,n) loop make a temporary duplicate of S_mn & F_mn
+             *   - the broadcast of the duplicates of the next (m,n) overlaps with the work of the current (m,n)
             */
             
+            if ( !requested( orb_m, orb_n, orb_i ) ){ continue; } // Same decision on all threads and processes
+            
             const int irrep_mn  = Irreps::directProd( book->gIrrep( orb_m ), book->gIrrep( orb_n ) );
             const int irrep_imn = Irreps::directProd( book->gIrrep( orb_i ), irrep_mn );
             
@@ -385,19 +718,14 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
              *  Make sure every process has the relevant S_mn and F_mn  *
              ************************************************************/
             #ifdef CHEMPS2_MPI_COMPILATION
-            #pragma omp barrier // Everyone needs to be done before tensors are created and communicated
+            const bool duplicate = ( orb_m > orb_i + 1 ); // All processes own Fx/Sx[ index ][ n - m ][ m - i - 1 == 0 ]
+            #pragma omp barrier // Everyone needs to be done before the next tensors are created and communicated
             #pragma omp single
-            if ( orb_m > orb_i + 1 ){ // All processes own Fx/Sx[ index ][ n - m ][ m - i - 1 == 0 ]
-               const int own_S_mn = MPIchemps2::owner_absigma( orb_m, orb_n );
-               const int own_F_mn = MPIchemps2::owner_cdf(  L, orb_m, orb_n );
-               if ( MPIRANK != own_F_mn ){ F0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new TensorF0( orb_i+1, irrep_mn, false, book );
-                                           F1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new TensorF1( orb_i+1, irrep_mn, false, book ); }
-               if ( MPIRANK != own_S_mn ){ S0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new TensorS0( orb_i+1, irrep_mn, false, book );
-                    if ( orb_m != orb_n ){ S1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = new TensorS1( orb_i+1, irrep_mn, false, book ); }}
-                                      MPIchemps2::broadcast_tensor( F0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_F_mn );
-                                      MPIchemps2::broadcast_tensor( F1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_F_mn );
-                                      MPIchemps2::broadcast_tensor( S0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_S_mn );
-               if ( orb_m != orb_n ){ MPIchemps2::broadcast_tensor( S1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i], own_S_mn ); }
+            if ( duplicate ){
+               MPIchemps2::wait_all( 4, requests + 4 * ( dupl_cnt % 2 ) );
+               if ( dupl_cnt + 1 < num_dupl ){
+                  ibroadcast_mn_duplicates( L, orb_i, dupl_m[ dupl_cnt + 1 ], dupl_n[ dupl_cnt + 1 ], book, F0tensors, F1tensors, S0tensors, S1tensors, requests + 4 * ( ( dupl_cnt + 1 ) % 2 ) );
+               }
             }
             #endif
             
@@ -411,7 +739,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                const int orb_j = jkl[ 0 ];
                const int orb_k = jkl[ 1 ];
                const int irrep_jk = Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) );
-               if ( irrep_jk == irrep_mn ){
+               if (( irrep_jk == irrep_mn ) && ( requested( orb_j, orb_k, orb_i ) )){
                   #ifdef CHEMPS2_MPI_COMPILATION
                   if ( MPIRANK == MPIchemps2::owner_absigma( orb_j, orb_k ) ){ counter_Sjk++; }
                   if ( MPIRANK == MPIchemps2::owner_cdf(  L, orb_j, orb_k ) ){ counter_Fjk++; }
@@ -449,7 +777,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_j = jkl[ 0 ];
                   const int orb_k = jkl[ 1 ];
                   const int irrep_jk = Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) );
-                  if ( irrep_jk == irrep_mn ){
+                  if (( irrep_jk == irrep_mn ) && ( requested( orb_j, orb_k, orb_i ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIRANK == MPIchemps2::owner_cdf( L, orb_j, orb_k ) )
                      #endif
@@ -516,7 +844,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_j = jkl[ 0 ];
                   const int orb_k = jkl[ 1 ];
                   const int irrep_jk = Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) );
-                  if ( irrep_jk == irrep_mn ){
+                  if (( irrep_jk == irrep_mn ) && ( requested( orb_j, orb_k, orb_i ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIRANK == MPIchemps2::owner_cdf( L, orb_j, orb_k ) )
                      #endif
@@ -568,7 +896,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_j = jkl[ 0 ];
                   const int orb_k = jkl[ 1 ];
                   const int irrep_jk = Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) );
-                  if ( irrep_jk == irrep_mn ){
+                  if (( irrep_jk == irrep_mn ) && ( requested( orb_j, orb_k, orb_i ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIRANK == MPIchemps2::owner_absigma( orb_j, orb_k ) )
                      #endif
@@ -624,7 +952,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_j = jkl[ 0 ];
                   const int orb_k = jkl[ 1 ];
                   const int irrep_jk = Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) );
-                  if ( irrep_jk == irrep_mn ){
+                  if (( irrep_jk == irrep_mn ) && ( requested( orb_j, orb_k, orb_i ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIRANK == MPIchemps2::owner_absigma( orb_j, orb_k ) )
                      #endif
@@ -663,7 +991,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                const int orb_k = jkl[ 1 ];
                const int orb_l = jkl[ 2 ];
                const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-               if ( irrep_jkl == irrep_imn ){
+               if (( irrep_jkl == irrep_imn ) && ( requested( orb_j, orb_k, orb_l ) )){
                   #ifdef CHEMPS2_MPI_COMPILATION
                   if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK ){ counter_jkl++; }
                   #else
@@ -694,7 +1022,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_k = jkl[ 1 ];
                   const int orb_l = jkl[ 2 ];
                   const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-                  if ( irrep_jkl == irrep_imn ){
+                  if (( irrep_jkl == irrep_imn ) && ( requested( orb_j, orb_k, orb_l ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
                      #endif
@@ -747,7 +1075,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_k = jkl[ 1 ];
                   const int orb_l = jkl[ 2 ];
                   const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-                  if ( irrep_jkl == irrep_imn ){
+                  if (( irrep_jkl == irrep_imn ) && ( requested( orb_j, orb_k, orb_l ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
                      #endif
@@ -825,7 +1153,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_k = jkl[ 1 ];
                   const int orb_l = jkl[ 2 ];
                   const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-                  if ( irrep_jkl == irrep_imn ){
+                  if (( irrep_jkl == irrep_imn ) && ( requested( orb_j, orb_k, orb_l ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
                      #endif
@@ -903,7 +1231,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                   const int orb_k = jkl[ 1 ];
                   const int orb_l = jkl[ 2 ];
                   const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-                  if ( irrep_jkl == irrep_imn ){
+                  if (( irrep_jkl == irrep_imn ) && ( requested( orb_j, orb_k, orb_l ) )){
                      #ifdef CHEMPS2_MPI_COMPILATION
                      if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
                      #endif
@@ -965,7 +1293,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
             #ifdef CHEMPS2_MPI_COMPILATION
             #pragma omp barrier // Everyone needs to be done before tensors are deleted
             #pragma omp single
-            if ( orb_m > orb_i + 1 ){ // All processes own Fx/Sx[ index ][ n - m ][ m - i - 1 == 0 ]
+            if ( duplicate ){
                const int own_S_mn = MPIchemps2::owner_absigma( orb_m, orb_n );
                const int own_F_mn = MPIchemps2::owner_cdf(  L, orb_m, orb_n );
                if ( MPIRANK != own_F_mn ){ delete F0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i]; F0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = NULL;
@@ -973,6 +1301,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                if ( MPIRANK != own_S_mn ){ delete S0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i]; S0tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = NULL;
                     if ( orb_m != orb_n ){ delete S1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i]; S1tensors[orb_i][orb_n-orb_m][orb_m-1-orb_i] = NULL; } }
             }
+            if ( duplicate ){ dupl_cnt++; }
             #endif
             
          }
@@ -980,6 +1309,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
       
       for ( int orb_m = orb_i+1; orb_m < L; orb_m++ ){
       
+         if ( !requested( orb_m, orb_m, orb_i ) ){ continue; }
          const int irrep_m = book->gIrrep( orb_m );
       
          /**************************************************************
@@ -992,7 +1322,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
             const int orb_k = jkl[ 1 ];
             const int orb_l = jkl[ 2 ];
             const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-            if ( irrep_jkl == irrep_m ){
+            if (( irrep_jkl == irrep_m ) && ( requested( orb_j, orb_k, orb_l ) )){
                #ifdef CHEMPS2_MPI_COMPILATION
                if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK ){ counter_jkl++; }
                #else
@@ -1022,7 +1352,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                const int orb_k = jkl[ 1 ];
                const int orb_l = jkl[ 2 ];
                const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-               if ( irrep_jkl == irrep_m ){
+               if (( irrep_jkl == irrep_m ) && ( requested( orb_j, orb_k, orb_l ) )){
                   #ifdef CHEMPS2_MPI_COMPILATION
                   if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
                   #endif
@@ -1071,7 +1401,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
          int counter_j = 0;
          for ( int orb_j = 0; orb_j < orb_i; orb_j++ ){
             const int irrep_j = book->gIrrep( orb_j );
-            if ( irrep_j == irrep_m ){
+            if (( irrep_j == irrep_m ) && ( requested( orb_j, orb_m, orb_i ) )){
                #ifdef CHEMPS2_MPI_COMPILATION
                if ( MPIRANK == MPIchemps2::owner_q( L, orb_j ) ){ counter_j++; }
                #else
@@ -1107,7 +1437,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
             #endif
             for ( int orb_j = 0; orb_j < orb_i; orb_j++ ){
                const int irrep_j = book->gIrrep( orb_j );
-               if ( irrep_j == irrep_m ){
+               if (( irrep_j == irrep_m ) && ( requested( orb_j, orb_m, orb_i ) )){
                   #ifdef CHEMPS2_MPI_COMPILATION
                   if ( MPIRANK == MPIchemps2::owner_q( L, orb_j ) ) //Everyone owns the L-tensors --> task division based on Q-tensor ownership
                   #endif
@@ -1130,7 +1460,7 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
                const int orb_k = jkl[ 1 ];
                const int orb_l = jkl[ 2 ];
                const int irrep_jkl = Irreps::directProd( Irreps::directProd( book->gIrrep( orb_j ), book->gIrrep( orb_k ) ), book->gIrrep( orb_l ) );
-               if ( irrep_jkl == irrep_m ){
+               if (( irrep_jkl == irrep_m ) && ( requested( orb_j, orb_k, orb_l ) )){
                   #ifdef CHEMPS2_MPI_COMPILATION
                   if ( MPIchemps2::owner_3rdm_diagram( L, orb_j, orb_k, orb_l ) == MPIRANK )
                   #endif
@@ -1211,6 +1541,10 @@ void CheMPS2::ThreeDM::fill_site( TensorT * denT, TensorL *** Ltensors, TensorF0
       delete [] workmem2;
    
    }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   delete [] dupl_m;
+   delete [] dupl_n;
+   #endif
 
 }
 
@@ -1218,9 +1552,12 @@ void CheMPS2::ThreeDM::correct_higher_multiplicities(){
 
    if ( prob->gTwoS() != 0 ){
       double alpha = 1.0 / ( prob->gTwoS() + 1.0 );
-      int length   = L*L*L*L*L*L;
       int inc      = 1;
-      dscal_( &length, &alpha, elements, &inc );
+      const long long chunk = INT_MAX;
+      for ( long long start = 0; start < slab_size; start += chunk ){
+         int length = ( int )( std::min( chunk, slab_size - start ) );
+         dscal_( &length, &alpha, elements + start, &inc );
+      }
    }
    
 }
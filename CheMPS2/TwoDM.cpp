@@ -414,179 +414,282 @@ void CheMPS2::TwoDM::FillSite(TensorT * denT, TensorL *** Ltens, TensorF0 **** F
    const int theindex = denT->gIndex();
    const int DIM = max(denBK->gMaxDimAtBound(theindex), denBK->gMaxDimAtBound(theindex+1));
    
-   #ifdef CHEMPS2_MPI_COMPILATION
-   if ( MPIRANK == MPI_CHEMPS2_MASTER )
-   #endif
-   {
-      //Diagram 1
-      const double d1 = doD1(denT);
-      set_2rdm_A_DMRG(theindex,theindex,theindex,theindex, 2*d1);
-      set_2rdm_B_DMRG(theindex,theindex,theindex,theindex,-2*d1);
-   }
-   
-   #pragma omp parallel
-   {
+   /* Task list: only the orbital combinations with the correct symmetry and owned by this MPI process are kept,
+      so that they can be distributed dynamically over the threads. Every task sets its own 2-RDM elements.
+      The most expensive diagrams are listed first, the cheap ones fill up the threads at the end. */
+   const int dimTriangle = L - theindex - 1;
+   const int upperboundTriangle = ( dimTriangle * ( dimTriangle + 1 ) ) / 2;
+   const int max_num_tasks = 2 * theindex * upperboundTriangle + theindex * dimTriangle + 2 * upperboundTriangle + dimTriangle + theindex + 1;
+   int * tasks = new int[ 4 * max_num_tasks ]; // ( type, g_index, j_index, k_index )
+   int num_tasks = 0;
+   int result[ 2 ];
    
-      double * workmem  = new double[DIM*DIM];
-      double * workmem2 = new double[DIM*DIM];
-      
-      #pragma omp for schedule(static) nowait
-      for (int j_index=theindex+1; j_index<L; j_index++){
-         if (denBK->gIrrep(j_index) == denBK->gIrrep(theindex)){
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIRANK == MPIchemps2::owner_q( L, j_index ) ) //Everyone owns the L-tensors --> task division based on Q-tensor ownership
-            #endif
-            {
-               //Diagram 2
-               const double d2 = doD2(denT, Ltens[theindex][j_index-theindex-1], workmem);
-               set_2rdm_A_DMRG(theindex,j_index,theindex,theindex, 2*d2);
-               set_2rdm_B_DMRG(theindex,j_index,theindex,theindex,-2*d2);
-            }
-         }
-      }
-      
-      const int dimTriangle = L - theindex - 1;
-      const int upperboundTriangle = ( dimTriangle * ( dimTriangle + 1 ) ) / 2;
-      int result[ 2 ];
-      #pragma omp for schedule(static) nowait
+   for ( int type = 0; type < 2; type++ ){ // type 0: diagrams 17-24, type 1: diagrams 13-16
       for ( int global = 0; global < upperboundTriangle; global++ ){
          Special::invert_triangle_two( global, result );
          const int j_index = L - 1 - result[ 1 ];
          const int k_index = j_index + result[ 0 ];
-         if ( denBK->gIrrep( j_index ) == denBK->gIrrep( k_index )){
-
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIRANK == MPIchemps2::owner_absigma( j_index, k_index ) )
-            #endif
-            {
-               //Diagram 3
-               const double d3 = doD3(denT, S0tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
-               set_2rdm_A_DMRG(theindex,theindex,j_index,k_index, 2*d3);
-               set_2rdm_B_DMRG(theindex,theindex,j_index,k_index,-2*d3);
-            }
-
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIRANK == MPIchemps2::owner_cdf( L, j_index, k_index ) )
-            #endif
-            {
-               //Diagrams 4,5 & 6
-               const double d4 = doD4(denT, F0tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
-               const double d5 = doD5(denT, F0tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
-               const double d6 = doD6(denT, F1tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
-               set_2rdm_A_DMRG(theindex,j_index,k_index,theindex, -2*d4 - 2*d5 - 3*d6);
-               set_2rdm_B_DMRG(theindex,j_index,k_index,theindex, -2*d4 - 2*d5 +   d6);
-               set_2rdm_A_DMRG(theindex,j_index,theindex,k_index,  4*d4 + 4*d5);
-               set_2rdm_B_DMRG(theindex,j_index,theindex,k_index,  2*d6);
-            }
-         }
-      }
-
-      #pragma omp for schedule(static) nowait
-      for (int g_index=0; g_index<theindex; g_index++){
-         if (denBK->gIrrep(g_index) == denBK->gIrrep(theindex)){
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIRANK == MPIchemps2::owner_q( L, g_index ) ) //Everyone owns the L-tensors --> task division based on Q-tensor ownership
-            #endif
-            {
-               //Diagram 7
-               const double d7 = doD7(denT, Ltens[theindex-1][theindex-g_index-1], workmem);
-               set_2rdm_A_DMRG(g_index,theindex,theindex,theindex, 2*d7);
-               set_2rdm_B_DMRG(g_index,theindex,theindex,theindex,-2*d7);
+         for ( int g_index = 0; g_index < theindex; g_index++ ){
+            if (Irreps::directProd(denBK->gIrrep(g_index), denBK->gIrrep(theindex)) == Irreps::directProd(denBK->gIrrep(j_index), denBK->gIrrep(k_index))){
+               #ifdef CHEMPS2_MPI_COMPILATION
+               const int owner = (( type == 0 ) ? MPIchemps2::owner_cdf( L, j_index, k_index ) : MPIchemps2::owner_absigma( j_index, k_index ));
+               if ( MPIRANK == owner )
+               #endif
+               {
+                  tasks[ 4 * num_tasks + 0 ] = type;
+                  tasks[ 4 * num_tasks + 1 ] = g_index;
+                  tasks[ 4 * num_tasks + 2 ] = j_index;
+                  tasks[ 4 * num_tasks + 3 ] = k_index;
+                  num_tasks++;
+               }
             }
          }
       }
-
-      const int globalsize8to12 = theindex * ( L - 1 - theindex );
-      #pragma omp for schedule(static) nowait
-      for (int gj_index=0; gj_index<globalsize8to12; gj_index++){
-         const int g_index = gj_index % theindex;
-         const int j_index = ( gj_index / theindex ) + theindex + 1;
-         const int I_g = denBK->gIrrep(g_index);
+   }
+   
+   for ( int j_index = theindex + 1; j_index < L; j_index++ ){ // type 2: diagrams 8-12
+      for ( int g_index = 0; g_index < theindex; g_index++ ){
          if (denBK->gIrrep(g_index) == denBK->gIrrep(j_index)){
             #ifdef CHEMPS2_MPI_COMPILATION
             if ( MPIRANK == MPIchemps2::owner_absigma( g_index, j_index ) ) //Everyone owns the L-tensors --> task division based on ABSigma-tensor ownership
             #endif
             {
-               //Diagrams 8,9,10 & 11
-               const double d8 = doD8(denT, Ltens[theindex-1][theindex-g_index-1], Ltens[theindex][j_index-theindex-1], workmem, workmem2, I_g);
-               double d9, d10, d11;
-               doD9andD10andD11(denT, Ltens[theindex-1][theindex-g_index-1], Ltens[theindex][j_index-theindex-1], workmem, workmem2, &d9, &d10, &d11, I_g);
-               set_2rdm_A_DMRG(g_index,theindex,j_index,theindex, -4*d8-d9);
-               set_2rdm_A_DMRG(g_index,theindex,theindex,j_index, 2*d8 + d11);
-               set_2rdm_B_DMRG(g_index,theindex,j_index,theindex, d9 - 2*d10);
-               set_2rdm_B_DMRG(g_index,theindex,theindex,j_index, 2*d8 + 2*d10 - d11);
-               
-               //Diagram 12
-               const double d12 = doD12(denT, Ltens[theindex-1][theindex-g_index-1], Ltens[theindex][j_index-theindex-1], workmem, workmem2, I_g);
-               set_2rdm_A_DMRG(g_index,j_index,theindex,theindex, 2*d12);
-               set_2rdm_B_DMRG(g_index,j_index,theindex,theindex,-2*d12);
+               tasks[ 4 * num_tasks + 0 ] = 2;
+               tasks[ 4 * num_tasks + 1 ] = g_index;
+               tasks[ 4 * num_tasks + 2 ] = j_index;
+               tasks[ 4 * num_tasks + 3 ] = -1;
+               num_tasks++;
             }
          }
       }
-
-      const int globalsize = theindex * upperboundTriangle;
-      #pragma omp for schedule(static) nowait
-      for ( int gjk_index = 0; gjk_index < globalsize; gjk_index++ ){
-         const int g_index = gjk_index % theindex;
-         const int global  = gjk_index / theindex;
+   }
+   
+   for ( int type = 3; type < 5; type++ ){ // type 3: diagrams 4-6, type 4: diagram 3
+      for ( int global = 0; global < upperboundTriangle; global++ ){
          Special::invert_triangle_two( global, result );
          const int j_index = L - 1 - result[ 1 ];
          const int k_index = j_index + result[ 0 ];
-         const int I_g = denBK->gIrrep( g_index );
-         const int cnt1 = k_index - j_index;
-         const int cnt2 = j_index - theindex - 1;
-
-         if (Irreps::directProd(I_g, denBK->gIrrep(theindex)) == Irreps::directProd(denBK->gIrrep(j_index), denBK->gIrrep(k_index))){
+         if ( denBK->gIrrep( j_index ) == denBK->gIrrep( k_index )){
             #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIRANK == MPIchemps2::owner_absigma( j_index, k_index ) )
+            const int owner = (( type == 3 ) ? MPIchemps2::owner_cdf( L, j_index, k_index ) : MPIchemps2::owner_absigma( j_index, k_index ));
+            if ( MPIRANK == owner )
             #endif
             {
-               //Diagrams 13,14,15 & 16
-               const double d13 = doD13(denT, Ltens[theindex-1][theindex-g_index-1], S0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
-               const double d14 = doD14(denT, Ltens[theindex-1][theindex-g_index-1], S0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
-               double d15 = 0.0;
-               double d16 = 0.0;
-               if (k_index>j_index){
-                  d15 = doD15(denT, Ltens[theindex-1][theindex-g_index-1], S1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
-                  d16 = doD16(denT, Ltens[theindex-1][theindex-g_index-1], S1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
-               }
-               set_2rdm_A_DMRG(g_index,theindex,j_index,k_index, 2*d13 + 2*d14 + 3*d15 + 3*d16);
-               set_2rdm_A_DMRG(g_index,theindex,k_index,j_index, 2*d13 + 2*d14 - 3*d15 - 3*d16);
-               set_2rdm_B_DMRG(g_index,theindex,j_index,k_index,-2*d13 - 2*d14 +   d15 +   d16);
-               set_2rdm_B_DMRG(g_index,theindex,k_index,j_index,-2*d13 - 2*d14 -   d15 -   d16);
+               tasks[ 4 * num_tasks + 0 ] = type;
+               tasks[ 4 * num_tasks + 1 ] = -1;
+               tasks[ 4 * num_tasks + 2 ] = j_index;
+               tasks[ 4 * num_tasks + 3 ] = k_index;
+               num_tasks++;
             }
+         }
+      }
+   }
+   
+   for ( int j_index = theindex + 1; j_index < L; j_index++ ){ // type 5: diagram 2
+      if (denBK->gIrrep(j_index) == denBK->gIrrep(theindex)){
+         #ifdef CHEMPS2_MPI_COMPILATION
+         if ( MPIRANK == MPIchemps2::owner_q( L, j_index ) ) //Everyone owns the L-tensors --> task division based on Q-tensor ownership
+         #endif
+         {
+            tasks[ 4 * num_tasks + 0 ] = 5;
+            tasks[ 4 * num_tasks + 1 ] = -1;
+            tasks[ 4 * num_tasks + 2 ] = j_index;
+            tasks[ 4 * num_tasks + 3 ] = -1;
+            num_tasks++;
+         }
+      }
+   }
+   
+   for ( int g_index = 0; g_index < theindex; g_index++ ){ // type 6: diagram 7
+      if (denBK->gIrrep(g_index) == denBK->gIrrep(theindex)){
+         #ifdef CHEMPS2_MPI_COMPILATION
+         if ( MPIRANK == MPIchemps2::owner_q( L, g_index ) ) //Everyone owns the L-tensors --> task division based on Q-tensor ownership
+         #endif
+         {
+            tasks[ 4 * num_tasks + 0 ] = 6;
+            tasks[ 4 * num_tasks + 1 ] = g_index;
+            tasks[ 4 * num_tasks + 2 ] = -1;
+            tasks[ 4 * num_tasks + 3 ] = -1;
+            num_tasks++;
+         }
+      }
+   }
+   
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( MPIRANK == MPI_CHEMPS2_MASTER )
+   #endif
+   { // type 7: diagram 1
+      tasks[ 4 * num_tasks + 0 ] = 7;
+      tasks[ 4 * num_tasks + 1 ] = -1;
+      tasks[ 4 * num_tasks + 2 ] = -1;
+      tasks[ 4 * num_tasks + 3 ] = -1;
+      num_tasks++;
+   }
+   assert( num_tasks <= max_num_tasks );
+   
+   #pragma omp parallel
+   {
+   
+      double * workmem  = new double[DIM*DIM];
+      double * workmem2 = new double[DIM*DIM];
+      
+      #pragma omp for schedule(dynamic)
+      for ( int task = 0; task < num_tasks; task++ ){
+      
+         const int type    = tasks[ 4 * task + 0 ];
+         const int g_index = tasks[ 4 * task + 1 ];
+         const int j_index = tasks[ 4 * task + 2 ];
+         const int k_index = tasks[ 4 * task + 3 ];
+         
+         if ( type == 0 ){
+            const int I_g = denBK->gIrrep( g_index );
+            const int cnt1 = k_index - j_index;
+            const int cnt2 = j_index - theindex - 1;
             
-            #ifdef CHEMPS2_MPI_COMPILATION
-            if ( MPIRANK == MPIchemps2::owner_cdf( L, j_index, k_index ) )
-            #endif
-            {
-               //Diagrams 17,18,19 & 20
-               const double d17 = doD17orD21(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
-               const double d18 = doD18orD22(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
-               const double d19 = doD19orD23(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
-               const double d20 = doD20orD24(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
-               set_2rdm_A_DMRG(g_index,j_index,k_index,theindex, -2*d17 - 2*d18 - 3*d19 - 3*d20);
-               set_2rdm_A_DMRG(g_index,j_index,theindex,k_index,  4*d17 + 4*d18                );
-               set_2rdm_B_DMRG(g_index,j_index,k_index,theindex, -2*d17 - 2*d18 +   d19 +   d20);
-               set_2rdm_B_DMRG(g_index,j_index,theindex,k_index,                  2*d19 + 2*d20);
-               
-               //Diagrams 21,22,23 & 24
-               const double d21 = doD17orD21(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
-               const double d22 = doD18orD22(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
-               const double d23 = doD19orD23(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
-               const double d24 = doD20orD24(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
-               set_2rdm_A_DMRG(g_index,k_index,j_index,theindex, -2*d21 - 2*d22 - 3*d23 - 3*d24);
-               set_2rdm_A_DMRG(g_index,k_index,theindex,j_index,  4*d21 + 4*d22                );
-               set_2rdm_B_DMRG(g_index,k_index,j_index,theindex, -2*d21 - 2*d22 +   d23 +   d24);
-               set_2rdm_B_DMRG(g_index,k_index,theindex,j_index,                  2*d23 + 2*d24);
+            //Diagrams 17,18,19 & 20
+            const double d17 = doD17orD21(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
+            const double d18 = doD18orD22(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
+            const double d19 = doD19orD23(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
+            const double d20 = doD20orD24(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, true);
+            set_2rdm_A_DMRG(g_index,j_index,k_index,theindex, -2*d17 - 2*d18 - 3*d19 - 3*d20);
+            set_2rdm_A_DMRG(g_index,j_index,theindex,k_index,  4*d17 + 4*d18                );
+            set_2rdm_B_DMRG(g_index,j_index,k_index,theindex, -2*d17 - 2*d18 +   d19 +   d20);
+            set_2rdm_B_DMRG(g_index,j_index,theindex,k_index,                  2*d19 + 2*d20);
+            
+            //Diagrams 21,22,23 & 24
+            const double d21 = doD17orD21(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
+            const double d22 = doD18orD22(denT, Ltens[theindex-1][theindex-g_index-1], F0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
+            const double d23 = doD19orD23(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
+            const double d24 = doD20orD24(denT, Ltens[theindex-1][theindex-g_index-1], F1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g, false);
+            set_2rdm_A_DMRG(g_index,k_index,j_index,theindex, -2*d21 - 2*d22 - 3*d23 - 3*d24);
+            set_2rdm_A_DMRG(g_index,k_index,theindex,j_index,  4*d21 + 4*d22                );
+            set_2rdm_B_DMRG(g_index,k_index,j_index,theindex, -2*d21 - 2*d22 +   d23 +   d24);
+            set_2rdm_B_DMRG(g_index,k_index,theindex,j_index,                  2*d23 + 2*d24);
+         }
+         
+         if ( type == 1 ){
+            const int I_g = denBK->gIrrep( g_index );
+            const int cnt1 = k_index - j_index;
+            const int cnt2 = j_index - theindex - 1;
+            
+            //Diagrams 13,14,15 & 16
+            const double d13 = doD13(denT, Ltens[theindex-1][theindex-g_index-1], S0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
+            const double d14 = doD14(denT, Ltens[theindex-1][theindex-g_index-1], S0tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
+            double d15 = 0.0;
+            double d16 = 0.0;
+            if (k_index>j_index){
+               d15 = doD15(denT, Ltens[theindex-1][theindex-g_index-1], S1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
+               d16 = doD16(denT, Ltens[theindex-1][theindex-g_index-1], S1tens[theindex][cnt1][cnt2], workmem, workmem2, I_g);
             }
+            set_2rdm_A_DMRG(g_index,theindex,j_index,k_index, 2*d13 + 2*d14 + 3*d15 + 3*d16);
+            set_2rdm_A_DMRG(g_index,theindex,k_index,j_index, 2*d13 + 2*d14 - 3*d15 - 3*d16);
+            set_2rdm_B_DMRG(g_index,theindex,j_index,k_index,-2*d13 - 2*d14 +   d15 +   d16);
+            set_2rdm_B_DMRG(g_index,theindex,k_index,j_index,-2*d13 - 2*d14 -   d15 -   d16);
+         }
+         
+         if ( type == 2 ){
+            const int I_g = denBK->gIrrep( g_index );
+            
+            //Diagrams 8,9,10 & 11
+            const double d8 = doD8(denT, Ltens[theindex-1][theindex-g_index-1], Ltens[theindex][j_index-theindex-1], workmem, workmem2, I_g);
+            double d9, d10, d11;
+            doD9andD10andD11(denT, Ltens[theindex-1][theindex-g_index-1], Ltens[theindex][j_index-theindex-1], workmem, workmem2, &d9, &d10, &d11, I_g);
+            set_2rdm_A_DMRG(g_index,theindex,j_index,theindex, -4*d8-d9);
+            set_2rdm_A_DMRG(g_index,theindex,theindex,j_index, 2*d8 + d11);
+            set_2rdm_B_DMRG(g_index,theindex,j_index,theindex, d9 - 2*d10);
+            set_2rdm_B_DMRG(g_index,theindex,theindex,j_index, 2*d8 + 2*d10 - d11);
+            
+            //Diagram 12
+            const double d12 = doD12(denT, Ltens[theindex-1][theindex-g_index-1], Ltens[theindex][j_index-theindex-1], workmem, workmem2, I_g);
+            set_2rdm_A_DMRG(g_index,j_index,theindex,theindex, 2*d12);
+            set_2rdm_B_DMRG(g_index,j_index,theindex,theindex,-2*d12);
+         }
+         
+         if ( type == 3 ){
+            //Diagrams 4,5 & 6
+            const double d4 = doD4(denBK, denT, F0tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
+            const double d5 = doD5(denBK, denT, F0tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
+            const double d6 = doD6(denBK, denT, F1tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
+            set_2rdm_A_DMRG(theindex,j_index,k_index,theindex, -2*d4 - 2*d5 - 3*d6);
+            set_2rdm_B_DMRG(theindex,j_index,k_index,theindex, -2*d4 - 2*d5 +   d6);
+            set_2rdm_A_DMRG(theindex,j_index,theindex,k_index,  4*d4 + 4*d5);
+            set_2rdm_B_DMRG(theindex,j_index,theindex,k_index,  2*d6);
+         }
+         
+         if ( type == 4 ){
+            //Diagram 3
+            const double d3 = doD3(denBK, denT, S0tens[theindex][k_index-j_index][j_index-theindex-1], workmem);
+            set_2rdm_A_DMRG(theindex,theindex,j_index,k_index, 2*d3);
+            set_2rdm_B_DMRG(theindex,theindex,j_index,k_index,-2*d3);
+         }
+         
+         if ( type == 5 ){
+            //Diagram 2
+            const double d2 = doD2(denT, Ltens[theindex][j_index-theindex-1], workmem);
+            set_2rdm_A_DMRG(theindex,j_index,theindex,theindex, 2*d2);
+            set_2rdm_B_DMRG(theindex,j_index,theindex,theindex,-2*d2);
+         }
+         
+         if ( type == 6 ){
+            //Diagram 7
+            const double d7 = doD7(denT, Ltens[theindex-1][theindex-g_index-1], workmem);
+            set_2rdm_A_DMRG(g_index,theindex,theindex,theindex, 2*d7);
+            set_2rdm_B_DMRG(g_index,theindex,theindex,theindex,-2*d7);
+         }
+         
+         if ( type == 7 ){
+            //Diagram 1
+            const double d1 = doD1(denBK, denT);
+            set_2rdm_A_DMRG(theindex,theindex,theindex,theindex, 2*d1);
+            set_2rdm_B_DMRG(theindex,theindex,theindex,theindex,-2*d1);
          }
       }
-
+      
       delete [] workmem;
       delete [] workmem2;
    
    }
+   
+   delete [] tasks;
+
+}
+
+void CheMPS2::TwoDM::FillSitePairs(const SyBookkeeper * denBK, TensorT * denT, TensorF0 ** F0diag, TensorF1 ** F1diag, TensorS0 ** S0diag, double * pairs){
+
+   const int L = denBK->gL();
+   const int theindex = denT->gIndex();
+   const int DIM = max(denBK->gMaxDimAtBound(theindex), denBK->gMaxDimAtBound(theindex+1));
+   
+   //Diagram 1
+   const double d1 = doD1(denBK, denT);
+   pairs[ theindex + L * ( theindex + L * 0 ) ] =  2*d1;
+   pairs[ theindex + L * ( theindex + L * 1 ) ] = -2*d1;
+   pairs[ theindex + L * ( theindex + L * 2 ) ] =  2*d1;
+   pairs[ theindex + L * ( theindex + L * 3 ) ] = -2*d1;
+   pairs[ theindex + L * ( theindex + L * 4 ) ] =  2*d1;
+   
+   #pragma omp parallel
+   {
+   
+      double * workmem = new double[DIM*DIM];
+      
+      #pragma omp for schedule(static)
+      for (int j_index=theindex+1; j_index<L; j_index++){
+         //Diagrams 3,4,5 & 6 with j_index == k_index
+         const double d3 = doD3(denBK, denT, S0diag[j_index-theindex-1], workmem);
+         const double d4 = doD4(denBK, denT, F0diag[j_index-theindex-1], workmem);
+         const double d5 = doD5(denBK, denT, F0diag[j_index-theindex-1], workmem);
+         const double d6 = doD6(denBK, denT, F1diag[j_index-theindex-1], workmem);
+         const double values[] = { 4*d4 + 4*d5, 2*d6, -2*d4 - 2*d5 - 3*d6, -2*d4 - 2*d5 + d6, 2*d3 };
+         for (int type = 0; type < 5; type++){
+            pairs[ theindex + L * ( j_index + L * type ) ] = values[ type ];
+            pairs[ j_index + L * ( theindex + L * type ) ] = values[ type ];
+         }
+      }
+      
+      delete [] workmem;
+   
+   }
 
 }
 
@@ -602,7 +705,7 @@ void CheMPS2::TwoDM::correct_higher_multiplicities(){
 
 }
 
-double CheMPS2::TwoDM::doD1(TensorT * denT){
+double CheMPS2::TwoDM::doD1(const SyBookkeeper * denBK, TensorT * denT){
 
    int theindex = denT->gIndex();
    
@@ -676,7 +779,7 @@ double CheMPS2::TwoDM::doD2(TensorT * denT, TensorL * Lright, double * workmem){
 
 }
 
-double CheMPS2::TwoDM::doD3(TensorT * denT, TensorS0 * S0right, double * workmem){
+double CheMPS2::TwoDM::doD3(const SyBookkeeper * denBK, TensorT * denT, TensorS0 * S0right, double * workmem){
 
    int theindex = denT->gIndex();
    
@@ -716,7 +819,7 @@ double CheMPS2::TwoDM::doD3(TensorT * denT, TensorS0 * S0right, double * workmem
 
 }
 
-double CheMPS2::TwoDM::doD4(TensorT * denT, TensorF0 * F0right, double * workmem){
+double CheMPS2::TwoDM::doD4(const SyBookkeeper * denBK, TensorT * denT, TensorF0 * F0right, double * workmem){
 
    int theindex = denT->gIndex();
    
@@ -754,7 +857,7 @@ double CheMPS2::TwoDM::doD4(TensorT * denT, TensorF0 * F0right, double * workmem
 
 }
 
-double CheMPS2::TwoDM::doD5(TensorT * denT, TensorF0 * F0right, double * workmem){
+double CheMPS2::TwoDM::doD5(const SyBookkeeper * denBK, TensorT * denT, TensorF0 * F0right, double * workmem){
 
    int theindex = denT->gIndex();
    
@@ -795,7 +898,7 @@ double CheMPS2::TwoDM::doD5(TensorT * denT, TensorF0 * F0right, double * workmem
 
 }
 
-double CheMPS2::TwoDM::doD6(TensorT * denT, TensorF1 * F1right, double * workmem){
+double CheMPS2::TwoDM::doD6(const SyBookkeeper * denBK, TensorT * denT, TensorF1 * F1right, double * workmem){
 
    int theindex = denT->gIndex();
    
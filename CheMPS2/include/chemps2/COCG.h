@@ -0,0 +1,98 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2016 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+
+#ifndef COCG_CHEMPS2_H
+#define COCG_CHEMPS2_H
+
+namespace CheMPS2{
+/** COCG class.
+
+    The COCG class implements the conjugate orthogonal conjugate gradient algorithm to solve the complex symmetric linear problem \n
+
+        \f$ operator * x = b \f$, \n
+
+    with \f$ operator^T = operator \f$ (but not Hermitian), for example \f$ operator = \alpha + \beta H + i \eta \f$. COCG is conjugate gradient with the bilinear form \f$ x^T y \f$ instead of the inner product \f$ x^\dagger y \f$. In contrast to conjugate gradient on the normal equations, the operator is not squared, so the condition number is not squared either. Complex vectors are passed around as separate real and imaginary parts. \n
+
+    The problem is preconditioned with precon = 1 / diag( operator ), which is complex symmetric as well.
+*/
+   class COCG{
+
+      public:
+
+         //! Constructor
+         /** \param veclength_in Linear dimension of the complex symmetric matrix
+             \param RTOL_in The tolerance for the two-norm of the residual
+             \param DIAG_CUTOFF_in The cutoff to truncate the modulus of the diagonal elements of operator
+             \param MAX_MATVEC_in The maximum number of matrix vector multiplications; when it is reached before convergence, the algorithm breaks down
+             \param BREAKDOWN_in The algorithm breaks down when a bilinear form \f$ x^T y \f$ in the denominator of a step is smaller in modulus than BREAKDOWN_in * || x || * || y ||
+             \param print_in Whether or not to print */
+         COCG(const int veclength_in, const double RTOL_in, const double DIAG_CUTOFF_in, const int MAX_MATVEC_in, const double BREAKDOWN_in, const bool print_in);
+
+         //! Destructor
+         virtual ~COCG();
+
+         //! The iterator to converge the solution vector
+         /** \param pointers Array of double* of length 6 to return pointers to vectors to the caller
+             \return Instruction character. 'A' means copy the real and imaginary parts of the initial guess to pointers[0] and pointers[1], of the diagonal of the complex symmetric matrix to pointers[2] and pointers[3], and of the right-hand side of the problem to pointers[4] and pointers[5]. 'B' means calculate pointers[2] + I * pointers[3] = complex symmetric matrix times ( pointers[0] + I * pointers[1] ). 'C' means that the converged solution can be copied back from pointers[0] (real part) and pointers[1] (imaginary part), and the residual norm from pointers[2][0]. 'D' means that the algorithm broke down or that the maximum number of matrix vector multiplications was reached; the current approximation to the solution can be copied back from pointers[0] and pointers[1]. */
+         char step( double ** pointers );
+
+         //! Get the number of matrix vector multiplications which have been performed
+         /** \return The number of matrix vector multiplications which have been performed */
+         int get_num_matvec() const;
+
+      private:
+
+         int veclength;
+         double RTOL;
+         double DIAG_CUTOFF;
+         int MAX_MATVEC;
+         double BREAKDOWN;
+         bool print;
+
+         char state;     // Current state of the algorithm
+         int num_matvec; // Current number of matvec multiplications
+
+         // Helper arrays: real and imaginary parts
+         double * XVEC[2];
+         double * PRECON[2];
+         double * RHS[2];
+         double * RESID[2];
+         double * ZVEC[2];
+         double * PVEC[2];
+         double * OPVEC[2];
+
+         // Helper variables
+         double rnorm;
+         double rdotz[2];
+         double rdotz_scale; // || RESID || * || ZVEC || when rdotz was set
+
+         // Internal functions to hop between states
+         void stepG2H();
+         void stepJ2K();
+         bool stepL2K();
+         void stepY2Z();
+         void bilinear( double ** vector, double ** othervector, double * result ) const;
+         double norm( double ** vector ) const;
+         void apply_precon( double ** vector, double ** result ) const;
+
+   };
+}
+
+#endif
@@ -105,6 +105,12 @@ namespace CheMPS2{
              \param the2DMin The 2-RDM of the active space */
          Correlations(const SyBookkeeper * denBKIn, const Problem * ProbIn, TwoDM * the2DMin);
          
+         //! Constructor from the two-orbital terms of the 2-RDM only
+         /** \param denBKIn Symmetry sector bookkeeper
+             \param ProbIn The problem to be solved
+             \param pairsIn The two-orbital 2-RDM terms of the active space, with the layout of TwoDM::FillSitePairs and the prefactor for higher multiplicities applied */
+         Correlations(const SyBookkeeper * denBKIn, const Problem * ProbIn, const double * pairsIn);
+         
          //! Destructor
          virtual ~Correlations();
          
@@ -168,6 +174,16 @@ namespace CheMPS2{
              \return the desired value */
          double getMutualInformation_HAM(const int row, const int col) const;
          
+         //! Get the (diagonal) single-orbital RDM for a certain site, using the DMRG indices
+         /** \param index The DMRG index
+             \param rdm Array of size 4 to store the probabilities of an empty, spin-up, spin-down, and doubly occupied orbital */
+         void SingleOrbitalRDM_DMRG(const int index, double * rdm) const;
+         
+         //! Get the (diagonal) single-orbital RDM for a certain site, using the HAM indices
+         /** \param index The HAM index
+             \param rdm Array of size 4 to store the probabilities of an empty, spin-up, spin-down, and doubly occupied orbital */
+         void SingleOrbitalRDM_HAM(const int index, double * rdm) const;
+         
          //! Get the single-orbital entropy for a certain site, using the DMRG indices
          /** \param index The DMRG index
              \return The single-orbital entropy for this site */
@@ -192,6 +208,10 @@ namespace CheMPS2{
              \return \f$ Idistance(power) = sum_{ij} I(i,j) * \mid i-j \mid^{power} \f$ */
          double MutualInformationDistance(const double power) const;
          
+         //! Write the single-orbital entropies (diagonal) and the two-orbital mutual information (off-diagonal) to a file, using the HAM indices
+         /** \param filename Where to write the entropies to */
+         void writeEntropiesFile(const string filename) const;
+         
          //! Print the correlation functions and two-orbital mutual information
          /** \param precision The number of digits to be printed
              \param columnsPerLine Rarara: The number of columns per line */
@@ -208,8 +228,11 @@ namespace CheMPS2{
          //The problem containing orbital reshuffling and symmetry information
          const Problem * Prob;
          
-         //The 2-RDM of the active space
-         TwoDM * the2DM;
+         //The two-orbital terms of the 2-RDM of the active space, with the layout of TwoDM::FillSitePairs
+         double * pairs;
+         
+         //The diagonal of the 1-RDM of the active space
+         double * OneRDM;
          
          //The number of active space orbitals
          int L;
@@ -229,6 +252,9 @@ namespace CheMPS2{
          //The two-orbital mutual information
          double * MutInfo;
          
+         //Helper function: allocates the tables and calls FillSpinDensSpinflip
+         void Initialize();
+         
          //Helper function: fills Cspin, Cdens, Cspinflip, and Cdirad (the latter only partially)
          void FillSpinDensSpinflip();
          
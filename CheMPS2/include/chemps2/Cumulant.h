@@ -136,7 +136,7 @@ namespace CheMPS2{
              \return the desired value */
          static double gamma4_ham(const Problem * prob, const ThreeDM * the3DM, const TwoDM * the2DM, const int i, const int j, const int k, const int l, const int p, const int q, const int r, const int s);
          
-         //! Contract the CASPT2 Fock operator with the cumulant approximation of \f$ \Gamma^4 \f$ in \f$ \mathcal{O}(L^7) \f$ time, using HAM indices
+         //! Contract the CASPT2 Fock operator with the cumulant approximation of \f$ \Gamma^4 \f$ in \f$ \mathcal{O}(L^7) \f$ time with irrep-blocked GEMMs, using HAM indices; the 3-RDM is read one \f$ L^5 \f$ slab at a time
          /** \param prob Pointer to the DMRG problem
              \param the3DM Pointer to the DMRG 3-RDM
              \param the2DM Pointer to the DMRG 2-RDM
@@ -149,6 +149,13 @@ namespace CheMPS2{
          // Get the second order cumulant \f$ \Lambda^2_{ijpq} \f$, using HAM indices
          static double lambda2_ham(const TwoDM * the2DM, const int i, const int j, const int p, const int q);
          
+         // output += alpha * ( tensor with the index at position slot contracted with the second index of the block diagonal matrix ), for dense L^5 tensors
+         static void mode_product(double * tensor, double * matrix, double * output, const int L, const int slot, double alpha, const int num_irreps, const int * irrep_start);
+         
+         // result += alpha * A * B, contracted over one index ls of the dense L^4 tensors A and B, with the free indices scattered into the dense L^6 result
+         static void contract_pair(double * result, double alpha, double * A, const int a_ls, const int * a_out, double * B, const int * b_out, const int L,
+                                   const int num_irreps, const int * irrep_start, const int * trip_start, const int * trip_list);
+         
    };
 }
 
@@ -44,6 +44,7 @@
 #include "Heff.h"
 #include "Sobject.h"
 #include "ConvergenceScheme.h"
+#include "RDMrequest.h"
 #include "MyHDF5.h"
 
 //For the timings of the different parts of DMRG
@@ -104,8 +105,24 @@ namespace CheMPS2{
          void calc2DMandCorrelations(){ calc_rdms_and_correlations(false); }
          
          //! Calculate the reduced density matrices and correlations. Afterwards the MPS is again in LLLLLLLC gauge.
-         /** \param do_3rdm Whether or not to calculate the 3-RDM */
-         void calc_rdms_and_correlations(const bool do_3rdm);
+         /** \param do_3rdm Whether or not to calculate the 3-RDM
+             \param disk_3rdm Whether or not to keep the 3-RDM in a memory-mapped file in the tmp folder */
+         void calc_rdms_and_correlations(const bool do_3rdm, const bool disk_3rdm=CheMPS2::THREE_RDM_storeOnDisk);
+         
+         //! Calculate the reduced density matrices and correlations which are requested. Afterwards the MPS is again in LLLLLLLC gauge.
+         /** \param request Which reduced density matrices and correlations to calculate; the renormalized operators which are not needed for them are not constructed */
+         void calc_rdms_and_correlations(const RDMrequest * request);
+         
+         //! Calculate the single-orbital entropies, the two-orbital mutual information, and the correlation functions from the two-orbital terms of the 2-RDM only (for instance to select an active space after a low bond dimension calculation). The full 2-RDM is not calculated, and only the renormalized operators with one orbital index are constructed, at a cost O(L^2 D^3). The MPS and the renormalized operators of the sweeps are not changed. Afterwards the Correlations can be obtained with getCorrelations().
+         void calc_orbital_entropies();
+         
+         //! Accumulate the 2-RDM (and 3-RDM) during the last right sweep of Solve(). In the last instruction, once a left sweep changes the energy by less than the convergence threshold (or when the last allowed sweep is reached), the following right sweep accumulates the RDMs and ends the instruction. A subsequent calc_rdms_and_correlations then skips its own passes of renormalized operator updates. The contribution of each site is evaluated with the MPS at that step of the sweep, so that the RDMs deviate from the ones of the final MPS to first order in the change of the wavefunction during that sweep (whereas the energy changes to second order only).
+         /** \param do_3rdm Whether or not to accumulate the 3-RDM as well
+             \param disk_3rdm Whether or not to keep the 3-RDM in a memory-mapped file in the tmp folder */
+         void activateFusedRDMs(const bool do_3rdm, const bool disk_3rdm=CheMPS2::THREE_RDM_storeOnDisk);
+         
+         //! Let calc_rdms_and_correlations perform its own passes again, and discard the RDMs which were accumulated during the last right sweep
+         void deactivateFusedRDMs(){ fused_rdms_active = false; fused_rdms_valid = false; }
          
          //! Get the pointer to the 2-RDM
          /** \return The 2-RDM. Returns a NULL pointer if not yet calculated. */
@@ -121,9 +138,16 @@ namespace CheMPS2{
              \param ham_orb2  The Hamiltonian index of the second fixed orbital.
              \param last_case If true, everything will be set up to allow to continue sweeping. */
          void Symm4RDM( double * output, const int ham_orb1, const int ham_orb2, const bool last_case );
+         
+         //! Obtain the contraction of the symmetrized 4-RDM with the Fock operator for all orbital pairs at once, after the 3-RDM has been calculated. With MPI and CheMPS2::DMRG_MPI_symm4rdmRankGroups > 1, the orbital pairs are distributed over that many rank groups; by default all processes work on each pair together.
+         /** \param contract  Array to store the contraction in Hamiltonian index notation: contract[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r )))) ] = 0.5 * sum_{YZ} fock[ Y + L * Z ] * Gamma4_ijkY,pqrZ.
+             \param fock      The Fock operator in Hamiltonian index notation; only the blocks within an irrep are used.
+             \param diagonal  If true, only the diagonal elements of the Fock operator are used (pseudocanonical orbitals).
+             \param last_case If true, everything will be set up to allow to continue sweeping. */
+         void Symm4RDM_fock( double * contract, const double * fock, const bool diagonal, const bool last_case );
 
          //! Get the pointer to the Correlations
-         /** \return The Correlations. Returns a NULL pointer if not yet calculated. */
+         /** \return The Correlations. Returns a NULL pointer if not yet calculated, or if they were not requested. */
          Correlations * getCorrelations(){ return theCorr; }
          
          //! Get a specific FCI coefficient. The array coeff contains the occupation numbers of the L Hamiltonian orbitals. It is assumed that the unpaired electrons are all alpha electrons, and that this number equals twice the total targeted spin.
@@ -202,6 +226,12 @@ namespace CheMPS2{
          //The Correlations
          Correlations * theCorr;
          
+         //The DMRG orbitals for which the 3-RDM is calculated (NULL means all orbitals)
+         bool * rdm_orbitals;
+         
+         //Whether the 3-RDM is calculated for the DMRG orbitals orb_j, orb_k, and orb_l
+         bool rdm_orbitals_requested(const int orb_j, const int orb_k, const int orb_l) const{ return (( rdm_orbitals == NULL ) || (( rdm_orbitals[ orb_j ] ) && ( rdm_orbitals[ orb_k ] ) && ( rdm_orbitals[ orb_l ] ))); }
+         
          //Whether or not allocated
          int * isAllocated;
          
@@ -255,7 +285,7 @@ namespace CheMPS2{
 
          // Sweeps
          double sweepleft(  const bool change, const int instruction, const bool am_i_master );
-         double sweepright( const bool change, const int instruction, const bool am_i_master );
+         double sweepright( const bool change, const int instruction, const bool am_i_master, const bool fuse_rdms=false );
          double solve_site( const int index, const double dvdson_rtol, const double noise_level, const int virtual_dimension, const bool am_i_master, const bool moving_right, const bool change );
 
          //Load and save functions
@@ -275,12 +305,20 @@ namespace CheMPS2{
          void deleteTensors(const int index, const bool movingRight);
          void allocateTensors(const int index, const bool movingRight);
          void updateMovingRightSafe(const int cnt);
+         void updateMovingRightSafeDisk(const int cnt);
          void updateMovingRightSafeFirstTime(const int cnt);
          void updateMovingRightSafe2DM(const int cnt);
          void updateMovingLeftSafe(const int cnt);
          void updateMovingLeftSafeFirstTime(const int cnt);
          void updateMovingLeftSafe2DM(const int cnt);
          void deleteAllBoundaryOperators();
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //Cost-balanced MPI ownership of the boundary operators
+         bool owners_balanced;
+         void balance_owners( const bool rebuild_operators );
+         double block_cost( const int boundary, const int delta_N, const int irrep_op ) const;
+         #endif
 
          // Helper functions for making the 3-RDM boundary operators
          void update_safe_3rdm_operators( const int boundary );
@@ -297,6 +335,19 @@ namespace CheMPS2{
 
          //Helper functions for making the Correlations boundary operators
          void update_correlations_tensors(const int siteindex);
+         void fill_correlations_moving_right(const bool am_i_master);
+         
+         // RDM accumulation during the last right sweep of Solve()
+         bool fused_rdms_active;
+         bool fused_rdms_3rdm;
+         bool fused_rdms_disk;
+         bool fused_rdms_valid;
+         void fused_rdms_begin( const bool am_i_master );
+         void fused_rdms_step( const int index );
+         void fused_rdms_end( const bool am_i_master );
+         void fused_rdms_fill( const int siteindex );
+         void allocate_3rdm_arrays();
+         void delete_3rdm_arrays();
 
          //The storage and functions to handle excited states
          int nStates;
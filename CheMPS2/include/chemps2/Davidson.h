@@ -20,6 +20,8 @@
 #ifndef DAVIDSON_CHEMPS2_H
 #define DAVIDSON_CHEMPS2_H
 
+#include "Options.h"
+
 namespace CheMPS2{
 /** Davidson class.
     \author Sebastian Wouters <sebastianwouters@gmail.com>
@@ -41,8 +43,11 @@ namespace CheMPS2{
              \param NUM_VEC_KEEP_in The number of vectors to keep on deflation
              \param RTOL_in The tolerance for the two-norm of the residual (for convergence)
              \param DIAG_CUTOFF_in Cutoff value for the diagonal preconditioner
-             \param debugPrint_in Whether or not to debug print */
-         Davidson(const int veclength_in, const int MAX_NUM_VEC_in, const int NUM_VEC_KEEP_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool debugPrint_in);
+             \param debugPrint_in Whether or not to debug print
+             \param mpi_distributed_in Whether each MPI process only holds a slice of the vectors (of length veclength_in). In this case all MPI processes should call FetchInstruction simultaneously.
+             \param disk_in Whether the subspace vectors and their matrix vector products are kept in a file in tmpfolder. Only four vectors and a block of rows are then kept in memory.
+             \param tmpfolder The folder in which the file is created (only used when disk_in == true) */
+         Davidson(const int veclength_in, const int MAX_NUM_VEC_in, const int NUM_VEC_KEEP_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool debugPrint_in, const bool mpi_distributed_in=false, const bool disk_in=false, const std::string tmpfolder=CheMPS2::defaultTMPpath);
          
          //! Destructor
          virtual ~Davidson();
@@ -58,7 +63,8 @@ namespace CheMPS2{
          
       private:
       
-         int veclength; // The vector length
+         int veclength; // The vector length (of the slice on this MPI process when mpi_distributed)
+         bool mpi_distributed; // Whether the vectors are distributed over the MPI processes
          int nMultiplications; // Current number of requested matrix-vector multiplications
          char state; // Current state of the algorithm --> based on this parameter the next instruction is given
          bool debugPrint;
@@ -75,6 +81,15 @@ namespace CheMPS2{
          double ** Hvecs;
          int num_allocated;
          
+         // Out-of-core storage: slot i holds vecs[i], slot MAX_NUM_VEC + i holds Hvecs[i]
+         bool disk;
+         int disk_fd;
+         int disk_pending; // Slot of Hvecs which should be copied from u_vec to the file at the next FetchInstruction, or -1
+         int disk_block_rows;
+         double * disk_block;
+         void disk_read(double * data, const int slot, const int start, const int num) const;
+         void disk_write(const double * data, const int slot, const int start, const int num) const;
+         
          // The effective diagonalization problem
          double * mxM;
          double * mxM_eigs;
@@ -94,12 +109,18 @@ namespace CheMPS2{
          double * Reortho_Overlap;
          double * Reortho_Eigenvecs;
          
+         // Inner product and norm of (distributed) vectors
+         double inprod(double * vec1, double * vec2) const;
+         double frobenius(double * vec) const;
+         
          // Control script functions
          void SafetyCheckGuess();
          void AddNewVec();
          double DiagonalizeSmallMatrixAndCalcResidual(); // Returns the residual norm
          void CalculateNewVec();
          void Deflation();
+         void DeflationDisk();
+         void CalculateLowdin();
          void MxMafterDeflation();
          
    };
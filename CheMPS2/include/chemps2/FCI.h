@@ -45,6 +45,10 @@ namespace CheMPS2{
          //! Destructor
          virtual ~FCI();
          
+         //! Replace the matrix elements by those of another Hamiltonian with the same orbitals and orbital irreps (e.g. the next CASSCF macro-iteration). The string and lookup tables and the workspaces are kept.
+         /** \param Ham The new Hamiltonian matrix elements */
+         void setHamiltonian(CheMPS2::Hamiltonian * Ham);
+         
 //==========> Getters of basic information: all these variables are set by the constructor
          
          //! Getter for the number of orbitals
@@ -64,6 +68,20 @@ namespace CheMPS2{
              \return The number of variables in the corresponding vector */
          unsigned int getVecLength(const int irrep_center) const{ return irrep_center_jumps[ irrep_center ][ num_irreps ]; }
          
+         //! Getter for the number of variables of the FCI vector (irrep_center = 0) which are stored on this MPI process in the distributed FCI (getVecLength(0) without MPI)
+         /** \return The number of variables in the slice of this MPI process */
+         unsigned int getLocalVecLength() const{ return mpi_jumps[ num_irreps ]; }
+         
+         //! Copy the slice of this MPI process out of an FCI vector; the slice contains per up (alpha) irrep the down (beta) strings of this process, see mpi_slice_down
+         /** \param full The FCI vector with getVecLength(0) variables
+             \param local On exit the slice with getLocalVecLength() variables */
+         void ScatterVector( double * full, double * local ) const;
+         
+         //! Gather the slices of all MPI processes into an FCI vector on all processes (collective call)
+         /** \param local The slice of this process with getLocalVecLength() variables
+             \param full On exit the FCI vector with getVecLength(0) variables */
+         void GatherVector( double * local, double * full ) const;
+         
          //! Get the target irrep
          /** \return The target irrep */
          int getTargetIrrep() const{ return TargetIrrep; }
@@ -91,13 +109,36 @@ namespace CheMPS2{
          /** \return The nuclear repulsion energy */
          double getEconst() const{ return Econstant; }
          
+         //! Select the kernel for the alpha excitations in the matrix vector products; the constructor selects the widest one which the CPU supports
+         /** \param kernel CheMPS2::FCI_KERNEL_SCALAR, CheMPS2::FCI_KERNEL_AVX2, or CheMPS2::FCI_KERNEL_AVX512; when the CPU does not support it, the next narrower supported kernel is used */
+         void setKernel(const int kernel);
+         
+         //! Get the kernel for the alpha excitations in the matrix vector products
+         /** \return CheMPS2::FCI_KERNEL_SCALAR, CheMPS2::FCI_KERNEL_AVX2, or CheMPS2::FCI_KERNEL_AVX512 */
+         int getKernel() const;
+         
+         //! Whether the CPU (and the compiler) support a kernel for the alpha excitations
+         /** \param kernel CheMPS2::FCI_KERNEL_SCALAR, CheMPS2::FCI_KERNEL_AVX2, or CheMPS2::FCI_KERNEL_AVX512
+             \return Whether the kernel can be used; the scalar kernel is always supported */
+         static bool KernelSupported(const int kernel);
+         
 //==========> The core routines for users
          
          //! Calculates the FCI ground state with Davidson's algorithm
          /** \param inoutput If inoutput!=NULL, vector with getVecLength(0) variables which contains the initial guess at the start, and on exit the solution of the FCI calculation
              \param DVDSN_NUM_VEC The maximum number of vectors to use in Davidson's algorithm; adjustable in case memory becomes an issue
+             \param mpi_distributed Whether the Davidson vectors and the matrix vector products are distributed over the MPI processes by slices of down (beta) strings. In this case all MPI processes should call GSDavidson simultaneously with the same inoutput.
+             \param maxMemVecMB Memory budget in MB for the Davidson vectors (per MPI process when mpi_distributed). When 2 * DVDSN_NUM_VEC + 4 vectors do not fit, the subspace and its matrix vector products are kept in a file in tmpfolder.
+             \param tmpfolder The folder for the out-of-core Davidson subspace
              \return The ground state energy */
-         double GSDavidson(double * inoutput=NULL, const int DVDSN_NUM_VEC=CheMPS2::DAVIDSON_NUM_VEC) const;
+         double GSDavidson(double * inoutput=NULL, const int DVDSN_NUM_VEC=CheMPS2::DAVIDSON_NUM_VEC, const bool mpi_distributed=false, const double maxMemVecMB=CheMPS2::DAVIDSON_FCI_maxMemVecMB, const string tmpfolder=CheMPS2::defaultTMPpath) const;
+         
+         //! Calculates the lowest num_roots FCI eigenstates with a block Davidson algorithm, of which the Hamiltonian products are done with matvec_block
+         /** \param num_roots The number of roots
+             \param energies Array of length num_roots which contains on exit the energies of the roots (in ascending order)
+             \param vectors If vectors!=NULL, array of num_roots * getVecLength(0) variables, with root r stored at vectors + r * getVecLength(0). At the start, it contains the initial guesses: when a guess is zero, the unit vector of a low-energy Slater determinant is used instead. On exit it contains the roots.
+             \param DVDSN_NUM_VEC The maximum number of vectors to use in the Davidson subspace; at least num_roots + CheMPS2::DAVIDSON_NUM_VEC_KEEP + num_roots are used */
+         void MultiRootDavidson(const int num_roots, double * energies, double * vectors=NULL, const int DVDSN_NUM_VEC=CheMPS2::DAVIDSON_NUM_VEC) const;
          
          //! Return the global counter of the Slater determinant with the lowest energy
          /** \return The global counter of the Slater determinant with the lowest energy */
@@ -270,6 +311,64 @@ namespace CheMPS2{
              \param TwoRDMdens If not NULL, on exit the 2-RDM of ( n_alpha - <GSvector| n_alpha |GSvector> ) |GSvector> */
          void DensityResponseGF_backward(const double omega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const double GSenergy, double * GSvector, double * RePartGF, double * ImPartGF, double * TwoRDMreal=NULL, double * TwoRDMimag=NULL, double * TwoRDMdens=NULL) const;
          
+         //! Calculate the retarded Green's function (= addition + removal amplitude) on a frequency grid, with one Lanczos Krylov space for each amplitude
+         /** \param omegas The frequency values
+             \param numOmega The number of frequency values
+             \param eta The regularization parameter (... + I*eta in the denominator)
+             \param orb_alpha The first orbital index
+             \param orb_beta The second orbital index
+             \param isUp If true, the spin projection value of the second quantized operators is up, otherwise it will be down
+             \param GSenergy The ground state energy returned by GSDavidson
+             \param GSvector The ground state vector as calculated by GSDavidson
+             \param Ham The Hamiltonian, which contains the matrix elements
+             \param RePartGF On exit RePartGF[w] contains the real part of the retarded Green's function at omegas[w]
+             \param ImPartGF On exit ImPartGF[w] contains the imaginary part of the retarded Green's function at omegas[w] */
+         void RetardedGF_spectral(const double * omegas, const unsigned int numOmega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const bool isUp, const double GSenergy, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartGF, double * ImPartGF) const;
+         
+         //! Calculate the addition Green's function for several values of alpha: GF[i+numLeft*(j+numRight*w)] = <GSvector| a_{orbsLeft[i], spin} [ alphas[w] + beta * Ham + I*eta ]^{-1} a^+_{orbsRight[j], spin} |GSvector>, with one Lanczos Krylov space for each orbsRight[j]
+         /** \param alphas The constant parameters in the resolvent
+             \param numAlpha The number of constant parameters in the resolvent
+             \param beta Prefector of the Hamiltonian in the resolvent
+             \param eta The regularization parameter
+             \param orbsLeft The left orbital indices
+             \param numLeft The number of left orbital indices
+             \param orbsRight The right orbital indices
+             \param numRight The number of right orbital indices
+             \param isUp If true, the spin projection value of the second quantized operators is up, otherwise it will be down
+             \param GSvector The ground state vector as calculated by GSDavidson
+             \param Ham The Hamiltonian, which contains the matrix elements
+             \param RePartsGF On exit RePartsGF[i+numLeft*(j+numRight*w)] contains the real part of the addition Green's function
+             \param ImPartsGF On exit ImPartsGF[i+numLeft*(j+numRight*w)] contains the imaginary part of the addition Green's function */
+         void GFmatrix_addition_spectral(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF) const;
+         
+         //! Calculate the removal Green's function for several values of alpha: GF[i+numLeft*(j+numRight*w)] = <GSvector| a^+_{orbsLeft[i], spin} [ alphas[w] + beta * Ham + I*eta ]^{-1} a_{orbsRight[j], spin} |GSvector>, with one Lanczos Krylov space for each orbsRight[j]
+         /** \param alphas The constant parameters in the resolvent
+             \param numAlpha The number of constant parameters in the resolvent
+             \param beta Prefector of the Hamiltonian in the resolvent
+             \param eta The regularization parameter
+             \param orbsLeft The left orbital indices
+             \param numLeft The number of left orbital indices
+             \param orbsRight The right orbital indices
+             \param numRight The number of right orbital indices
+             \param isUp If true, the spin projection value of the second quantized operators is up, otherwise it will be down
+             \param GSvector The ground state vector as calculated by GSDavidson
+             \param Ham The Hamiltonian, which contains the matrix elements
+             \param RePartsGF On exit RePartsGF[i+numLeft*(j+numRight*w)] contains the real part of the removal Green's function
+             \param ImPartsGF On exit ImPartsGF[i+numLeft*(j+numRight*w)] contains the imaginary part of the removal Green's function */
+         void GFmatrix_removal_spectral(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF) const;
+         
+         //! Calculate the density response Green's function (= forward - backward propagating part) on a frequency grid, with one Lanczos Krylov space for each part
+         /** \param omegas The frequency values
+             \param numOmega The number of frequency values
+             \param eta The regularization parameter (... + I*eta in the denominator)
+             \param orb_alpha The first orbital index
+             \param orb_beta The second orbital index
+             \param GSenergy The ground state energy returned by GSDavidson
+             \param GSvector The ground state vector as calculated by GSDavidson
+             \param RePartGF On exit RePartGF[w] contains the real part of the density response Green's function at omegas[w]
+             \param ImPartGF On exit ImPartGF[w] contains the imaginary part of the density response Green's function at omegas[w] */
+         void DensityResponseGF_spectral(const double * omegas, const unsigned int numOmega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const double GSenergy, double * GSvector, double * RePartGF, double * ImPartGF) const;
+         
          //! Calculate the solution of the equation ( alpha + beta * Hamiltonian + I * eta ) Solution = RHS with conjugate gradient
          /** \param alpha The real part of the scalar in the operator
              \param beta The real-valued prefactor of the Hamiltonian in the operator
@@ -280,6 +379,28 @@ namespace CheMPS2{
              \param checkError If true, the RMS error without preconditioner will be calculated and printed after convergence */
          void CGSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol, const bool checkError=true) const;
          
+         //! Calculate the solution of the equation ( alpha + beta * Hamiltonian + I * eta ) Solution = RHS with conjugate orthogonal conjugate gradient (COCG), which does not square the operator; falls back to CGSolveSystem if COCG breaks down
+         /** \param alpha The real part of the scalar in the operator
+             \param beta The real-valued prefactor of the Hamiltonian in the operator
+             \param eta The imaginary part of the scalar in the operator
+             \param RHS The real-valued right-hand side of the equation with length getVecLength(0)
+             \param RealSol On exit this array of length getVecLength(0) contains the real part of the solution
+             \param ImagSol On exit this array of length getVecLength(0) contains the imaginary part of the solution
+             \param checkError If true, the RMS error will be printed after convergence */
+         void COCGSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol, const bool checkError=true) const;
+         
+         //! Calculate GF[i+numLeft*w] = < LeftVecs[i] | ( alphas[w] + beta * Hamiltonian + I * eta )^{-1} | RHS > for all alphas from a single Lanczos Krylov space. A warning is printed when the Krylov space reaches CheMPS2::FCI_LANCZOS_MAX_KRYLOV before convergence.
+         /** \param alphas The real parts of the scalar in the operator
+             \param numAlpha The number of real parts of the scalar in the operator
+             \param beta The real-valued prefactor of the Hamiltonian in the operator
+             \param eta The imaginary part of the scalar in the operator
+             \param RHS The real-valued right-hand side of the equation with length getVecLength(0)
+             \param LeftVecs Array of numLeft real-valued vectors of length getVecLength(0) to project on; a NULL pointer yields zero
+             \param numLeft The number of vectors to project on
+             \param RePartsGF On exit RePartsGF[i+numLeft*w] contains the real part of GF[i+numLeft*w]
+             \param ImPartsGF On exit ImPartsGF[i+numLeft*w] contains the imaginary part of GF[i+numLeft*w] */
+         void LanczosSpectrum(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, double * RHS, double ** LeftVecs, const unsigned int numLeft, double * RePartsGF, double * ImPartsGF) const;
+         
          //void CheckHamDEBUG() const;
          
          //! Function which returns a FCI coefficient
@@ -306,12 +427,30 @@ namespace CheMPS2{
              \param output Vector of length getVecLength(0) which contains on exit the Hamiltonian times input */
          void matvec( double * input, double * output ) const;
          
+         //! Perform the Hamiltonian times Vector product (without Econstant!!) for a block of vectors, with one pass over the lookup tables and one ERI GEMM for all vectors
+         /** \param num_vec The number of vectors in the block
+             \param input The vectors on which the Hamiltonian should act: vector vec is stored at input + vec * getVecLength(0)
+             \param output Contains on exit the Hamiltonian times the vectors: vector vec is stored at output + vec * getVecLength(0)
+             \param size_work The number of doubles in work1 and work2, at least the size of HXVworkbig1 (see block_workspace_size)
+             \param work1 Workspace to reuse over several calls; if NULL, the workspaces are HXVworkbig1 and HXVworkbig2, or are allocated for this call when the block fits in larger ones
+             \param work2 Workspace to reuse over several calls, of the same size as work1 */
+         void matvec_block( const unsigned int num_vec, double * input, double * output, const unsigned long long size_work=0, double * work1=NULL, double * work2=NULL ) const;
+         
+         //! Perform the Hamiltonian times Vector product (without Econstant!!) on vectors which are distributed over the MPI processes (collective call). Per up (alpha) irrep the full input sector is gathered for the beta excitations, and the beta contributions to the output sector are reduce-scattered per block of beta strings from the workspace HXVworkbig1 (or once per sector from a separate buffer when a sector does not fit in it); the alpha excitations are local.
+         /** \param input The slice of this process with getLocalVecLength() variables of the vector on which the Hamiltonian should act
+             \param output The slice of this process with getLocalVecLength() variables which contains on exit the Hamiltonian times input */
+         void matvec_distributed( double * input, double * output ) const;
+         
+         //! Function which returns the diagonal elements of the FCI Hamiltonian (without Econstant!!) for the slice of this MPI process
+         /** \param diag Vector with getLocalVecLength() variables which contains on exit the diagonal elements of the FCI Hamiltonian */
+         void DiagHamLocal(double * diag) const;
+         
          //! Sandwich the Hamiltonian between two Slater determinants (return a specific element) (without Econstant!!)
          /** \param bits_bra_up Bit representation of the <bra| Slater determinant of the up (alpha) electrons (length L)
              \param bits_bra_down Bit representation of the <bra| Slater determinant of the down (beta) electrons (length L)
              \param bits_ket_up Bit representation of the |ket> Slater determinant of the up (alpha) electrons (length L)
              \param bits_ket_down Bit representation of the |ket> Slater determinant of the down (beta) electrons (length L)
-             \param work Work array of length 8
+             \param work Unused; the excitations between bra and ket are found with bit operations on the strings
              \return The FCI Hamiltonian element which connects the given two Slater determinants */
          double GetMatrixElement(int * bits_bra_up, int * bits_bra_down, int * bits_ket_up, int * bits_ket_down, int * work) const;
          
@@ -324,6 +463,18 @@ namespace CheMPS2{
              \param bits_down Array of length L to store the bit representation of the down (beta) electrons in */
          void getBitsOfCounter(const int irrep_center, const unsigned int counter, int * bits_up, int * bits_down) const;
          
+         //! Find the bit strings of a global counter corresponding to " E_ij | FCI vector > " ; where irrep_center = I_i x I_j
+         /** \param irrep_center The single electron excitation irrep I_i x I_j
+             \param counter The given global counter corresponding to " E_ij | FCI vector > "
+             \param string_up On exit the bit string of the up (alpha) electrons
+             \param string_down On exit the bit string of the down (beta) electrons */
+         void getStringsOfCounter(const int irrep_center, const unsigned int counter, unsigned int & string_up, unsigned int & string_down) const;
+         
+         //! Find the irrep of a same spin-projection Slater determinant
+         /** \param string The bit string of the Slater determinant
+             \return The direct product of the irreps of the occupied orbitals */
+         int getIrrepOfString(const unsigned int string) const;
+         
          //! Convertor between two representations of a same spin-projection Slater determinant
          /** \param Lvalue The number of orbitals
              \param bitstring The input integer, whos bits are the occupation numbers of the orbitals
@@ -406,6 +557,15 @@ namespace CheMPS2{
              \param temp2 Workspace of size getVecLength(0) */
          void CGCoreSolver(const double alpha, const double beta, const double eta, double * precon, double * Sol, double * RESID, double * PVEC, double * OxPVEC, double * temp, double * temp2) const;
 
+         //! Solve ( alpha + beta * Hamiltonian + I * eta ) Solution = RHS for the Green's functions, with COCGSolveSystem or CGSolveSystem depending on CheMPS2::FCI_GF_COCG
+         /** \param alpha The real part of the scalar in the operator
+             \param beta The real-valued prefactor of the Hamiltonian in the operator
+             \param eta The imaginary part of the scalar in the operator
+             \param RHS The real-valued right-hand side of the equation with length getVecLength(0)
+             \param RealSol On exit this array of length getVecLength(0) contains the real part of the solution
+             \param ImagSol On exit this array of length getVecLength(0) contains the imaginary part of the solution */
+         void GFSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol) const;
+         
          //! Calculate out = (alpha + beta * Hamiltonian) * in (Econstant is taken into account!!)
          /** \param alpha The parameter alpha of the operator
              \param beta The parameter beta of the operator
@@ -430,6 +590,18 @@ namespace CheMPS2{
              \param workspace Workspace of size getVecLength(0) */
          void CGdiagonal(const double alpha, const double beta, const double eta, double * diagonal, double * workspace) const;
          
+         //! Solve the tridiagonal system ( alpha + beta * T + I * eta ) Solution = e_0 of a Lanczos Krylov space
+         /** \param dim The dimension of the Krylov space
+             \param diag The diagonal of T
+             \param offdiag The off-diagonal of T: offdiag[k] couples Lanczos vectors k-1 and k (offdiag[0] is not used)
+             \param alpha The real part of the scalar in the operator
+             \param beta The real-valued prefactor of T in the operator
+             \param eta The imaginary part of the scalar in the operator
+             \param RealSol On exit this array of length dim contains the real part of the solution
+             \param ImagSol On exit this array of length dim contains the imaginary part of the solution
+             \param work Workspace of size 4 * dim */
+         static void LanczosTridiagonal(const unsigned int dim, double * diag, double * offdiag, const double alpha, const double beta, const double eta, double * RealSol, double * ImagSol, double * work);
+         
 //==========> Protected functions regarding the higher order RDMs
 
          //! Apply E_{crea,anni} to |orig_vector> and store the result in |result_vector>
@@ -493,17 +665,35 @@ namespace CheMPS2{
          //! For irrep "irrep" and counter of the down (beta) Slater determinant "counter" (0 <= counter < numPerIrrep_down[ irrep ]) cnt2str_down[ irrep ][ counter ] returns the bitstring representation of the corresponding down (beta) Slater determinant
          unsigned int ** cnt2str_down;
          
-         //! For irrep "irrep_result" and up (alpha) Slater determinant counter "result" lookup_cnt_alpha[ irrep_result ][ i + L * ( j + L * result ) ] returns the counter "origin" which corresponds to | result > = +/- E^{alpha}_ij | origin > or | origin > = +/- E^{alpha}_ji | result >
-         int *** lookup_cnt_alpha;
+         //! For irrep "irrep_result" and up (alpha) Slater determinant counter "result" lookup_alpha[ irrep_result ][ i + L * j ][ result ] packs the counter "origin" and the sign s which correspond to | result > = s * E^{alpha}_ij | origin > as 4 * origin + ( s == 1 ? 1 : 3 ), or is 0 if no such origin exists
+         unsigned int *** lookup_alpha;
+         
+         //! For irrep "irrep_result" and down (beta) Slater determinant counter "result" lookup_beta[ irrep_result ][ i + L * j ][ result ] packs the counter "origin" and the sign s which correspond to | result > = s * E^{beta}_ij | origin > as 4 * origin + ( s == 1 ? 1 : 3 ), or is 0 if no such origin exists
+         unsigned int *** lookup_beta;
+         
+         //! Get the sign of a lookup table entry (0 when E_ij | result > vanishes)
+         static int lookup_sign( const unsigned int entry ){ return ((int)( entry & 1 )) - ((int)( entry & 2 )); }
          
-         //! For irrep "irrep_result" and down (beta) Slater determinant counter "result" lookup_cnt_beta[ irrep_result ][ i + L * ( j + L * result ) ] returns the counter "origin" which corresponds to | result > = +/- E^{beta}_ij | origin > or | origin > = +/- E^{beta}_ji | result >
-         int *** lookup_cnt_beta;
+         //! Get the origin counter of a lookup table entry (0 when E_ij | result > vanishes, so that it can always be used as index)
+         static unsigned int lookup_cnt( const unsigned int entry ){ return entry >> 2; }
          
-         //! For irrep "irrep_result" and up (alpha) Slater determinant counter "result" lookup_sign_alpha[ irrep_result ][ i + L * ( j + L * result ) ] returns the sign s which corresponds to | result > = s * E^{alpha}_ij | origin >
-         int *** lookup_sign_alpha;
+         //! The non-zero entries of lookup_alpha[ irrep ][ ij ] are stored from position alpha_conn_start[ irrep ][ ij ], a multiple of 8, in alpha_conn_new, alpha_conn_old, and alpha_conn_sign
+         unsigned int ** alpha_conn_start;
          
-         //! For irrep "irrep_result" and down (beta) Slater determinant counter "result" lookup_sign_beta[ irrep_result ][ i + L * ( j + L * result ) ] returns the sign s which corresponds to | result > = s * E^{beta}_ij | origin >
-         int *** lookup_sign_beta;
+         //! The number of non-zero entries of lookup_alpha[ irrep ][ ij ] is alpha_conn_size[ irrep ][ ij ]
+         unsigned int ** alpha_conn_size;
+         
+         //! The new (result) up (alpha) counters of the non-zero entries of the alpha lookup tables
+         unsigned int ** alpha_conn_new;
+         
+         //! The old (origin) up (alpha) counters of the non-zero entries of the alpha lookup tables
+         unsigned int ** alpha_conn_old;
+         
+         //! The signs of the non-zero entries of the alpha lookup tables, packed per 8 entries in one byte: bit ( elem % 8 ) of alpha_conn_sign[ irrep ][ elem / 8 ] is set when the sign of entry elem is negative
+         unsigned char ** alpha_conn_sign;
+         
+         //! The alpha excitation kernel which is used: CheMPS2::FCI_KERNEL_SCALAR, CheMPS2::FCI_KERNEL_AVX2, or CheMPS2::FCI_KERNEL_AVX512
+         int alpha_kernel;
          
          //! For irrep_center = irrep_creator x irrep_annihilator the number of corresponding excitation pairs E_{creator <= annihilator} is given by irrep_center_num[ irrep_center ]
          unsigned int * irrep_center_num;
@@ -529,27 +719,61 @@ namespace CheMPS2{
          //! Work space of size HXVsizeWorkspace
          double * HXVworkbig2;
          
+         //! The down (beta) strings with irrep "irrep" which belong to MPI process "rank" are mpi_slice_down[ irrep ][ rank ] <= counter < mpi_slice_down[ irrep ][ rank + 1 ]
+         unsigned int ** mpi_slice_down;
+         
+         //! The slice of the sector with up (alpha) irrep "irrep_up" starts at mpi_jumps[ irrep_up ] in the vectors of this MPI process, and mpi_jumps[ num_irreps ] is the length of these vectors
+         unsigned int * mpi_jumps;
+         
+         //! Sandwich the Hamiltonian with a single Slater determinant, given by its up and down bit strings (without Econstant!!)
+         double DiagHamElement( const unsigned int string_up, const unsigned int string_down ) const;
+         
+         //! Sandwich the Hamiltonian between two Slater determinants, given by their up and down bit strings (without Econstant!!); Slater-Condon rules with XOR, popcount, and count trailing zeros
+         double GetMatrixElement(const unsigned int bra_up, const unsigned int bra_down, const unsigned int ket_up, const unsigned int ket_down) const;
+         
+         //! The FCI coefficient of the Slater determinant with up and down bit strings string_up and string_down; 0.0 if they do not form a valid FCI determinant
+         double getFCIcoeff(const unsigned int string_up, const unsigned int string_down, double * vector) const;
+         
+         //! Copy the matrix elements of Ham into Econstant, Gmat, and ERI
+         void StartupIntegrals(CheMPS2::Hamiltonian * Ham);
+         
          //! Initialize a part of the private variables
          void StartupCountersVsBitstrings();
          
          //! Initialize a part of the private variables
          void StartupLookupTables();
          
+         //! Fill the lookup table entries of all excitations E_ij acting on the bit string "string" with irrep "irrep" and counter "cnt_new"
+         void fill_lookup( const unsigned int string, const int irrep, int ** str2cnt, unsigned int ** lookup, const unsigned int cnt_new ) const;
+         
          //! Initialize a part of the private variables
          void StartupIrrepCenter();
          
+         //! Initialize the distribution of the FCI vectors over the MPI processes
+         void StartupDistribution();
+         
+         //! The number of doubles in each of the two workspaces of matvec_block for num_vec vectors: up to num_vec times HXVsizeWorkspace, as long as both fit in maxMemWorkMB
+         unsigned long long block_workspace_size( const unsigned int num_vec ) const;
+         
+         //! Add to output the slice of this MPI process of the sum over the processes of sector (collective call); sizes[ rank ] is the slice length of process rank, and work holds at least sizes[ mpi_rank() ] doubles
+         void reduce_scatter_sector( double * sector, double * work, int * sizes, double * output ) const;
+         
+         //! Actual routine used by matvec_block, for num_vec vectors which fit together in the workspaces
+         void matvec_pass( const unsigned int num_vec, double * input, double * output, const unsigned long long size_workspace, double * workbig1, double * workbig2 ) const;
+         
          //! Actual routine used by Fill3RDM, Fock4RDM, Diag4RDM
          double Driver3RDM(double * vector, double * output, double * three_rdm, double * fock, const unsigned int orbz) const;
 
-         //! Alpha excitation kernels
-         static void excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
+         //! Alpha excitation kernels; excite_alpha_first and excite_alpha_second_omp apply the non-zero entries of lookup_alpha[ irrep ][ ij ] with the kernel alpha_kernel
+         static void excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, unsigned int * lookup );
+         void excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, const int irrep, const unsigned int ij ) const;
+         void excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, const int irrep, const unsigned int ij ) const;
+         void excite_alpha_column( const int irrep, const unsigned int ij, double * origin, double * result ) const;
 
          //! Beta excitation kernels
-         static void excite_beta_omp( const unsigned int dim_up, const unsigned int dim_new_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
+         static void excite_beta_omp( const unsigned int dim_up, const unsigned int dim_new_down, double * origin, double * result, unsigned int * lookup );
+         static void excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, unsigned int * lookup );
+         static void excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, const unsigned int num_vec, double * origin, const unsigned int origin_stride, double * result, const unsigned int result_stride, unsigned int * lookup );
 
    };
 
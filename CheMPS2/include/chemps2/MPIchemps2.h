@@ -26,6 +26,9 @@
 
    #include <mpi.h>
    #include <assert.h>
+   #include <iostream>
+   #include <algorithm>
+   #include <utility>
    #include "Tensor.h"
 
    #define MPI_CHEMPS2_MASTER   0
@@ -119,7 +122,7 @@ namespace CheMPS2{
          static int mpi_size(){
             #ifdef CHEMPS2_MPI_COMPILATION
                int size;
-               MPI_Comm_size( MPI_COMM_WORLD, &size );
+               MPI_Comm_size( communicator(), &size );
                return size;
             #else
                return 1;
@@ -131,7 +134,7 @@ namespace CheMPS2{
          static int mpi_rank(){
             #ifdef CHEMPS2_MPI_COMPILATION
                int rank;
-               MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+               MPI_Comm_rank( communicator(), &rank );
                return rank;
             #else
                return 0;
@@ -142,17 +145,59 @@ namespace CheMPS2{
          //! Initialize MPI
          static void mpi_init(){
             int zero = 0;
-            MPI_Init( &zero, NULL );
+            int provided;
+            MPI_Init_thread( &zero, NULL, MPI_THREAD_SERIALIZED, &provided ); // MPI calls in omp master and omp single blocks
+            if ( provided < MPI_THREAD_SERIALIZED ){
+               std::cerr << "MPIchemps2::mpi_init : The MPI library provides thread support level " << provided
+                         << ", while MPI_THREAD_SERIALIZED ( " << MPI_THREAD_SERIALIZED << " ) is required." << std::endl;
+               MPI_Abort( MPI_COMM_WORLD, 1 );
+            }
          }
          #endif
          
          #ifdef CHEMPS2_MPI_COMPILATION
          //! Finalize MPI
          static void mpi_finalize(){
+            release_rank_groups();
             MPI_Finalize();
          }
          #endif
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the communicator over which the DMRG and 2-RDM work is distributed (MPI_COMM_WORLD unless split into rank groups)
+         /** \return Reference to the communicator of this MPI process */
+         static MPI_Comm & communicator(){
+            static MPI_Comm comm = MPI_COMM_WORLD;
+            return comm;
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Split the MPI processes into consecutive rank groups, each of which works independently on its own DMRG object (e.g. the orbital pairs of DMRG::Symm4RDM_fock). Collective call over MPI_COMM_WORLD. Can only be called when no renormalized operators are allocated and the ownership tables are not in use.
+         /** \param num_groups The number of rank groups; at most the number of MPI processes
+             \return The index of the rank group of this MPI process; mpi_size() and mpi_rank() hereafter refer to this group */
+         static int split_rank_groups(const int num_groups){
+            release_rank_groups();
+            int world_size, world_rank;
+            MPI_Comm_size( MPI_COMM_WORLD, &world_size );
+            MPI_Comm_rank( MPI_COMM_WORLD, &world_rank );
+            assert( ( num_groups >= 1 ) && ( num_groups <= world_size ) );
+            const int group = ( world_rank * num_groups ) / world_size;
+            MPI_Comm_split( MPI_COMM_WORLD, group, world_rank, &communicator() );
+            return group;
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Undo split_rank_groups, so that all MPI processes work together again. Collective call over MPI_COMM_WORLD when rank groups were set.
+         static void release_rank_groups(){
+            if ( communicator() != MPI_COMM_WORLD ){
+               MPI_Comm_free( &communicator() );
+               communicator() = MPI_COMM_WORLD;
+            }
+         }
+         #endif
+         
          #ifdef CHEMPS2_MPI_COMPILATION
          //! Get the owner of the X-tensors
          static int owner_x(){ return MPI_CHEMPS2_MASTER; }
@@ -165,6 +210,8 @@ namespace CheMPS2{
              \return The owner rank */
          static int owner_absigma(const int index1, const int index2){ // 1 <= proc < 1 + L*(L+1)/2
             assert( index1 <= index2 );
+            const owner_tables & table = tables();
+            if (( table.num_users > 0 ) && ( index2 < table.L )){ return table.absigma[ index1 + (index2*(index2+1))/2 ]; }
             return ( 1 + index1 + (index2*(index2+1))/2 ) % mpi_size();
          }
          #endif
@@ -177,6 +224,8 @@ namespace CheMPS2{
              \return The owner rank */
          static int owner_cdf(const int L, const int index1, const int index2){ // 1 + L*(L+1)/2 <= proc < 1 + L*(L+1)
             assert( index1 <= index2 );
+            const owner_tables & table = tables();
+            if (( table.num_users > 0 ) && ( index2 < table.L )){ return table.cdf[ index1 + (index2*(index2+1))/2 ]; }
             return ( 1 + (L*(L+1))/2 + index1 + (index2*(index2+1))/2 ) % mpi_size();
          }
          #endif
@@ -187,6 +236,8 @@ namespace CheMPS2{
              \param index The DMRG lattice index of the tensor
              \return The owner rank */
          static int owner_q(const int L, const int index){ // 1 + L*(L+1) <= proc < 1 + L*(L+2)
+            const owner_tables & table = tables();
+            if (( table.num_users > 0 ) && ( index < table.L )){ return table.q[ index ]; }
             return ( 1 + L*(L+1) + index ) % mpi_size();
          }
          #endif
@@ -201,10 +252,73 @@ namespace CheMPS2{
          static int owner_3rdm_diagram(const int L, const int index1, const int index2, const int index3){ // 1 + L*(L+1) <= proc < 1 + L*(L+1) + L*(L+1)*(L+2)/6
             assert( index1 <= index2 );
             assert( index2 <= index3 );
+            const owner_tables & table = tables();
+            if (( table.num_users > 0 ) && ( index3 < table.L )){ return table.three[ index1 + (index2*(index2+1))/2 + (index3*(index3+1)*(index3+2))/6 ]; }
             return ( 1 + L*(L+1) + index1 + (index2*(index2+1))/2 + (index3*(index3+1)*(index3+2))/6 ) % mpi_size();
          }
          #endif
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Start using cost-balanced ownership tables for the {A,B,Sigma0,Sigma1}-, {C,D,F0,F1}-, Q-, and 3-RDM tensors instead of the round-robin distribution. All processes should call this function with identical costs. If tables are already in use (by another DMRG object), these are shared and the costs are ignored.
+         /** \param L The number of active space orbitals
+             \param cost_absigma The cost of the {A,B,Sigma0,Sigma1}-tensors of orbital pair (index1 <= index2) at index1 + index2*(index2+1)/2
+             \param cost_cdf The cost of the {C,D,F0,F1}-tensors of orbital pair (index1 <= index2) at index1 + index2*(index2+1)/2
+             \param cost_q The cost of the Q-tensors of orbital index
+             \param cost_3rdm The cost of the 3-index tensors for the 3-RDM (index1 <= index2 <= index3) at index1 + index2*(index2+1)/2 + index3*(index3+1)*(index3+2)/6
+             \param cost_master The cost of the work which is always done by MPI_CHEMPS2_MASTER */
+         static void acquire_owner_tables(const int L, const double * cost_absigma, const double * cost_cdf, const double * cost_q, const double * cost_3rdm, const double cost_master){
+            owner_tables & table = tables();
+            if ( table.num_users == 0 ){
+               table.L       = L;
+               table.absigma = new int[ ( L * ( L + 1 ) ) / 2 ];
+               table.cdf     = new int[ ( L * ( L + 1 ) ) / 2 ];
+               table.q       = new int[ L ];
+               table.three   = new int[ ( L * ( L + 1 ) * ( L + 2 ) ) / 6 ];
+               fill_owner_tables( cost_absigma, cost_cdf, cost_q, cost_3rdm, cost_master );
+            }
+            table.num_users++;
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Recalculate the ownership tables with new costs. This is only allowed when there is a single user of the tables, and when the renormalized operators are rebuilt afterwards.
+         /** \param L The number of active space orbitals
+             \param cost_absigma The cost of the {A,B,Sigma0,Sigma1}-tensors
+             \param cost_cdf The cost of the {C,D,F0,F1}-tensors
+             \param cost_q The cost of the Q-tensors
+             \param cost_3rdm The cost of the 3-index tensors for the 3-RDM
+             \param cost_master The cost of the work which is always done by MPI_CHEMPS2_MASTER
+             \return Whether the ownership tables have been recalculated */
+         static bool rebalance_owner_tables(const int L, const double * cost_absigma, const double * cost_cdf, const double * cost_q, const double * cost_3rdm, const double cost_master){
+            owner_tables & table = tables();
+            if (( table.num_users != 1 ) || ( table.L != L )){ return false; }
+            fill_owner_tables( cost_absigma, cost_cdf, cost_q, cost_3rdm, cost_master );
+            return true;
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Stop using the ownership tables. When there are no users left, the round-robin distribution is used again.
+         static void release_owner_tables(){
+            owner_tables & table = tables();
+            assert( table.num_users > 0 );
+            table.num_users--;
+            if ( table.num_users == 0 ){
+               delete [] table.absigma;
+               delete [] table.cdf;
+               delete [] table.q;
+               delete [] table.three;
+               table.L = 0;
+            }
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the number of users of the ownership tables
+         /** \return The number of DMRG objects which currently use the ownership tables */
+         static int owner_tables_users(){ return tables().num_users; }
+         #endif
+         
          #ifdef CHEMPS2_MPI_COMPILATION
          //! Get the owner of the 1c, 1d, 2d, 3e, and 3h diagrams of the effective Hamiltonian
          /** \return The owner rank */
@@ -237,7 +351,18 @@ namespace CheMPS2{
              \param ROOT The MPI process which should broadcast */
          static void broadcast_tensor(Tensor * object, int ROOT){
             int arraysize = object->gKappa2index(object->gNKappa());
-            MPI_Bcast(object->gStorage(), arraysize, MPI_DOUBLE, ROOT, MPI_COMM_WORLD);
+            MPI_Bcast(object->gStorage(), arraysize, MPI_DOUBLE, ROOT, communicator());
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Broadcast a tensor without blocking
+         /** \param object The tensor to be broadcasted
+             \param ROOT The MPI process which should broadcast
+             \param request The request which should be completed with wait_all before the tensor is used */
+         static void ibroadcast_tensor(Tensor * object, int ROOT, MPI_Request * request){
+            int arraysize = object->gKappa2index(object->gNKappa());
+            MPI_Ibcast(object->gStorage(), arraysize, MPI_DOUBLE, ROOT, communicator(), request);
          }
          #endif
          
@@ -247,7 +372,7 @@ namespace CheMPS2{
              \param length The length of the array
              \param ROOT The MPI process which should broadcast */
          static void broadcast_array_double(double * array, int length, int ROOT){
-               MPI_Bcast(array, length, MPI_DOUBLE, ROOT, MPI_COMM_WORLD);
+               MPI_Bcast(array, length, MPI_DOUBLE, ROOT, communicator());
          }
          #endif
          
@@ -257,7 +382,7 @@ namespace CheMPS2{
              \param length The length of the array
              \param ROOT The MPI process which should broadcast */
          static void broadcast_array_int(int * array, int length, int ROOT){
-            MPI_Bcast(array, length, MPI_INT, ROOT, MPI_COMM_WORLD);
+            MPI_Bcast(array, length, MPI_INT, ROOT, communicator());
          }
          #endif
          
@@ -268,7 +393,7 @@ namespace CheMPS2{
          static bool all_booleans_equal(const bool mybool){
             int my_value = ( mybool ) ? 1 : 0 ;
             int tot_value;
-            MPI_Allreduce(&my_value, &tot_value, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(&my_value, &tot_value, 1, MPI_INT, MPI_SUM, communicator());
             return ( my_value * MPIchemps2::mpi_size() == tot_value ); // Only true if mybool is the same for all processes
          }
          #endif
@@ -284,11 +409,11 @@ namespace CheMPS2{
                const int MPIRANK = mpi_rank();
                if ( SENDER == MPIRANK ){
                   int arraysize = object->gKappa2index(object->gNKappa());
-                  MPI_Send(object->gStorage(), arraysize, MPI_DOUBLE, RECEIVER, tag, MPI_COMM_WORLD);
+                  MPI_Send(object->gStorage(), arraysize, MPI_DOUBLE, RECEIVER, tag, communicator());
                }
                if ( RECEIVER == MPIRANK ){
                   int arraysize = object->gKappa2index(object->gNKappa());
-                  MPI_Recv(object->gStorage(), arraysize, MPI_DOUBLE, SENDER, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                  MPI_Recv(object->gStorage(), arraysize, MPI_DOUBLE, SENDER, tag, communicator(), MPI_STATUS_IGNORE);
                }
             }
          }
@@ -301,7 +426,89 @@ namespace CheMPS2{
              \param size The size of the array
              \param ROOT The MPI process which should have the result vector */
          static void reduce_array_double(double * vec_in, double * vec_out, int size, int ROOT){
-            MPI_Reduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, ROOT, MPI_COMM_WORLD);
+            MPI_Reduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, ROOT, communicator());
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Send a tensor from one process to another without blocking
+         /** \param object The tensor to be sent
+             \param SENDER The MPI process which should send the tensor
+             \param RECEIVER The MPI process which should receive the tensor
+             \param tag A tag which should be the same for the sender and receiver to make sure that the communication is desired
+             \param request The request which should be completed with wait_all before the tensor is reused; MPI_REQUEST_NULL if this process is not involved */
+         static void isendreceive_tensor(Tensor * object, int SENDER, int RECEIVER, int tag, MPI_Request * request){
+            *request = MPI_REQUEST_NULL;
+            if ( SENDER != RECEIVER ){
+               const int MPIRANK = mpi_rank();
+               if ( SENDER == MPIRANK ){
+                  int arraysize = object->gKappa2index(object->gNKappa());
+                  MPI_Isend(object->gStorage(), arraysize, MPI_DOUBLE, RECEIVER, tag, communicator(), request);
+               }
+               if ( RECEIVER == MPIRANK ){
+                  int arraysize = object->gKappa2index(object->gNKappa());
+                  MPI_Irecv(object->gStorage(), arraysize, MPI_DOUBLE, SENDER, tag, communicator(), request);
+               }
+            }
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Add arrays of all processes and give result to ROOT without blocking
+         /** \param vec_in The array which should be added
+             \param vec_out The array where the result should be stored (only significant at ROOT)
+             \param size The size of the array
+             \param ROOT The MPI process which should have the result vector
+             \param request The request which should be completed with wait_all before vec_in or vec_out are reused */
+         static void ireduce_array_double(double * vec_in, double * vec_out, int size, int ROOT, MPI_Request * request){
+            MPI_Ireduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, ROOT, communicator(), request);
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Make progress on non-blocking communication without waiting for it
+         /** \param number The number of requests
+             \param requests The requests */
+         static void test_all(int number, MPI_Request * requests){
+            int flag;
+            MPI_Testall(number, requests, &flag, MPI_STATUSES_IGNORE);
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Wait until non-blocking communication has finished
+         /** \param number The number of requests
+             \param requests The requests */
+         static void wait_all(int number, MPI_Request * requests){
+            MPI_Waitall(number, requests, MPI_STATUSES_IGNORE);
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Add arrays of all processes and give each process its slice of the result
+         /** \param vec_in The array which should be added (full length)
+             \param vec_out The array where the slice of the result of this process should be stored
+             \param sizes The sizes of the slices of all processes, which are consecutive in vec_in */
+         static void reduce_scatter_array_double(double * vec_in, double * vec_out, int * sizes){
+            MPI_Reduce_scatter(vec_in, vec_out, sizes, MPI_DOUBLE, MPI_SUM, communicator());
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Gather the slices of all processes and give everyone the full array
+         /** \param vec_in The slice of this process
+             \param vec_out The array where the full array should be stored
+             \param sizes The sizes of the slices of all processes
+             \param offsets The offsets of the slices of all processes in vec_out */
+         static void allgather_array_double(double * vec_in, double * vec_out, int * sizes, int * offsets){
+            MPI_Allgatherv(vec_in, sizes[ mpi_rank() ], MPI_DOUBLE, vec_out, sizes, offsets, MPI_DOUBLE, communicator());
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Wait until all processes have reached this point
+         static void barrier(){
+            MPI_Barrier( communicator() );
          }
          #endif
          
@@ -311,7 +518,144 @@ namespace CheMPS2{
              \param vec_out The array where the result should be stored
              \param size The size of the array */
          static void allreduce_array_double(double * vec_in, double * vec_out, int size){
-            MPI_Allreduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, communicator());
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Add arrays of all processes in place and give everyone the result
+         /** \param vec The array which should be added, and where the result is stored
+             \param size The size of the array */
+         static void allreduce_array_double_inplace(double * vec, int size){
+            MPI_Allreduce(MPI_IN_PLACE, vec, size, MPI_DOUBLE, MPI_SUM, communicator());
+         }
+         #endif
+
+      private:
+      
+         #ifdef CHEMPS2_MPI_COMPILATION
+         // Ownership tables which replace the round-robin distribution when num_users > 0
+         struct owner_tables{
+            int L;
+            int num_users;
+            int * absigma;
+            int * cdf;
+            int * q;
+            int * three;
+         };
+         
+         // The ownership tables: a single instance per program
+         static owner_tables & tables(){
+            static owner_tables the_tables = { 0, 0, NULL, NULL, NULL, NULL };
+            return the_tables;
+         }
+         
+         // Assign the tasks to the processes with the longest processing time first rule: descending cost, each to the least loaded process
+         static void assign_greedy(const int num, const double * cost, int * owner, double * load){
+            const int size = mpi_size();
+            std::pair<double, int> * tasks = new std::pair<double, int>[ num ];
+            for ( int task = 0; task < num; task++ ){ tasks[ task ] = std::pair<double, int>( cost[ task ], task ); }
+            std::sort( tasks, tasks + num ); // Ascending cost and then ascending task number: identical for all processes
+            for ( int task = num - 1; task >= 0; task-- ){
+               int proc = 0;
+               for ( int other = 1; other < size; other++ ){ if ( load[ other ] < load[ proc ] ){ proc = other; } }
+               owner[ tasks[ task ].second ] = proc;
+               load[ proc ] += tasks[ task ].first;
+            }
+            delete [] tasks;
+         }
+         
+         // Fill the ownership tables
+         static void fill_owner_tables(const double * cost_absigma, const double * cost_cdf, const double * cost_q, const double * cost_3rdm, const double cost_master){
+            owner_tables & table = tables();
+            const int L = table.L;
+            const int size = mpi_size();
+            const int num_pairs = ( L * ( L + 1 ) ) / 2;
+            const int num_trios = ( L * ( L + 1 ) * ( L + 2 ) ) / 6;
+            double * load = new double[ size ];
+            for ( int proc = 0; proc < size; proc++ ){ load[ proc ] = 0.0; }
+            load[ MPI_CHEMPS2_MASTER ] = cost_master;
+            // The {A,B,Sigma0,Sigma1}-, {C,D,F0,F1}-, and Q-tensors are all needed during the sweeps
+            double * cost_sweep = new double[ 2 * num_pairs + L ];
+            int * owner_sweep = new int[ 2 * num_pairs + L ];
+            for ( int pair = 0; pair < num_pairs; pair++ ){ cost_sweep[             pair ] = cost_absigma[ pair ]; }
+            for ( int pair = 0; pair < num_pairs; pair++ ){ cost_sweep[ num_pairs + pair ] = cost_cdf[ pair ];     }
+            for ( int orb  = 0; orb  < L;         orb++  ){ cost_sweep[ 2 * num_pairs + orb ] = cost_q[ orb ];     }
+            assign_greedy( 2 * num_pairs + L, cost_sweep, owner_sweep, load );
+            for ( int pair = 0; pair < num_pairs; pair++ ){ table.absigma[ pair ] = owner_sweep[             pair ]; }
+            for ( int pair = 0; pair < num_pairs; pair++ ){ table.cdf[ pair ]     = owner_sweep[ num_pairs + pair ]; }
+            for ( int orb  = 0; orb  < L;         orb++  ){ table.q[ orb ]        = owner_sweep[ 2 * num_pairs + orb ]; }
+            delete [] cost_sweep;
+            delete [] owner_sweep;
+            // The 3-RDM tensors are only needed after the sweeps
+            for ( int proc = 0; proc < size; proc++ ){ load[ proc ] = 0.0; }
+            assign_greedy( num_trios, cost_3rdm, table.three, load );
+            delete [] load;
+         }
+         #endif
+         
+      public:
+      
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Allocate an array of doubles which is shared by all MPI processes on the same node (MPI-3 shared memory window). Collective call.
+         /** \param size The size of the array
+             \param window On exit, the MPI window which holds the shared memory
+             \param node_comm On exit, the communicator of the MPI processes on the same node
+             \return Pointer to the node-shared array; each process on the node sees the same memory */
+         static double * allocate_node_shared_double(const long long size, MPI_Win * window, MPI_Comm * node_comm){
+            MPI_Comm_split_type( communicator(), MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, node_comm );
+            int node_rank;
+            MPI_Comm_rank( *node_comm, &node_rank );
+            const MPI_Aint num_bytes = (( node_rank == 0 ) ? size * sizeof(double) : 0 );
+            double * array = NULL;
+            MPI_Win_allocate_shared( num_bytes, sizeof(double), MPI_INFO_NULL, *node_comm, &array, window );
+            if ( node_rank != 0 ){
+               MPI_Aint size_node_master;
+               int disp_unit;
+               MPI_Win_shared_query( *window, 0, &size_node_master, &disp_unit, &array );
+            }
+            MPI_Win_fence( 0, *window );
+            return array;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the rank of this MPI process within its node
+         /** \param node_comm The communicator of the MPI processes on the same node
+             \return The rank of this MPI process within node_comm */
+         static int node_rank(MPI_Comm node_comm){
+            int rank;
+            MPI_Comm_rank( node_comm, &rank );
+            return rank;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the number of MPI processes on this node
+         /** \param node_comm The communicator of the MPI processes on the same node
+             \return The number of MPI processes in node_comm */
+         static int node_size(MPI_Comm node_comm){
+            int size;
+            MPI_Comm_size( node_comm, &size );
+            return size;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Synchronize a node-shared array: all stores before the call are visible to all processes on the node after the call. Collective call.
+         /** \param window The MPI window which holds the shared memory */
+         static void sync_node_shared(MPI_Win window){
+            MPI_Win_fence( 0, window );
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Free a node-shared array. Collective call.
+         /** \param window The MPI window which holds the shared memory
+             \param node_comm The communicator of the MPI processes on the same node */
+         static void free_node_shared(MPI_Win * window, MPI_Comm * node_comm){
+            MPI_Win_free( window );
+            MPI_Comm_free( node_comm );
          }
          #endif
 
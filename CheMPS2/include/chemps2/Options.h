@@ -50,12 +50,26 @@ namespace CheMPS2{
 
    const double CONJ_GRADIENT_RTOL            = 1e-10;
    const double CONJ_GRADIENT_PRECOND_CUTOFF  = 1e-12;
+   const bool   FCI_GF_COCG                   = false;  // Solve the FCI Green's function systems with COCG instead of CG on the squared operator
+   const int    FCI_GF_COCG_MAX_MATVEC        = 2000;   // Maximum number of complex matvecs in COCG before falling back to CG on the squared operator
+   const double FCI_GF_COCG_BREAKDOWN         = 1e-14;  // COCG breaks down when a bilinear form is smaller than this fraction of the product of the vector norms
+   const int    FCI_KERNEL_SCALAR             = 0;      // Portable alpha excitation kernel of the FCI matrix vector product
+   const int    FCI_KERNEL_AVX2               = 1;      // Alpha excitation kernel with AVX2 gathers, selected at runtime (see FCI::setKernel)
+   const int    FCI_KERNEL_AVX512             = 2;      // Alpha excitation kernel with AVX-512 gathers, masked signs, and scatters, selected at runtime
+
+   const double FCI_LANCZOS_RTOL              = 1e-10;  // Maximum change of the Green's functions on the frequency grid, relative to their maximum, at convergence
+   const int    FCI_LANCZOS_MAX_KRYLOV        = 1000;   // Maximum dimension of the Krylov space of the spectral Green's functions
+   const int    FCI_LANCZOS_CHECK             = 10;     // Number of Lanczos iterations between the convergence checks on the frequency grid
+   const double FCI_LANCZOS_BREAKDOWN         = 1e-12;  // Norm of the new Lanczos vector below which the Krylov space is considered to be invariant
 
    const string defaultTMPpath                = "/tmp";
    const bool   DMRG_storeRenormOptrOnDisk    = true;
    const bool   DMRG_storeMpsOnDisk           = false;
    const string DMRG_MPS_storage_prefix       = "CheMPS2_MPS";
    const string DMRG_OPERATOR_storage_prefix  = "CheMPS2_Operators_";
+   const bool   DMRG_MPI_balanceOwners        = true;   // Cost-balanced MPI ownership of the boundary operators
+   const bool   DMRG_MPI_rebalanceOwners      = false;  // Rebalance the MPI ownership at the start of each instruction
+   const int    DMRG_MPI_symm4rdmRankGroups   = 1;      // Number of MPI rank groups which work on different orbital pairs in DMRG::Symm4RDM_fock; at most one per process
 
    const bool   HAMILTONIAN_debugPrint        = false;
    const string HAMILTONIAN_TmatStorageName   = "CheMPS2_Ham_Tmat.h5";
@@ -64,13 +78,24 @@ namespace CheMPS2{
 
    const string TWO_RDM_storagename           = "CheMPS2_2DM.h5";
    const string THREE_RDM_storagename         = "CheMPS2_3DM.h5";
+   const bool   THREE_RDM_storeOnDisk         = false;  // Keep the DMRG 3-RDM in a memory-mapped file in the tmp folder
+   const string THREE_RDM_storage_prefix      = "CheMPS2_3RDM_";
 
    const bool   HEFF_debugPrint               = true;
+   const int    HEFF_MPI_numReduceChunks      = 8;      // Number of chunks of sectors which are reduced as soon as they are calculated
    const int    DAVIDSON_NUM_VEC              = 32;
    const int    DAVIDSON_NUM_VEC_KEEP         = 3;
    const double DAVIDSON_PRECOND_CUTOFF       = 1e-12;
    const double DAVIDSON_FCI_RTOL             = 1e-10;  // Base value for FCI and augmented Hessian diagonalization
    const double DAVIDSON_DMRG_RTOL            = 1e-5;   // Block's Davidson tolerance would correspond to HEFF_DAVIDSON_DMRG_RTOL^2
+   const string DAVIDSON_storage_prefix       = "CheMPS2_Davidson_";
+   const double DAVIDSON_FCI_maxMemVecMB      = 8192.0; // Memory budget for the FCI Davidson vectors; a larger subspace is kept on disk in the tmp folder
+
+   const double SCI_EPSILON_VAR               = 1e-4;   // Heat-bath threshold for the variational selection in SelectedCI::Solve
+   const double SCI_EPSILON_PT2               = 1e-6;   // Heat-bath threshold for the terms of SelectedCI::EpsteinNesbetPT2
+   const int    SCI_MAX_ITER                  = 20;     // Maximum number of selection iterations in SelectedCI::Solve
+   const double SCI_CONV_FRACTION             = 1e-3;   // The selection stops when it adds fewer determinants than this fraction of the selected space
+   const int    SCI_CHUNK_SIZE                = 128;    // Number of determinants per OpenMP task in the SelectedCI class
 
    const int    SYBK_dimensionCutoff          = 262144;
 
@@ -22,6 +22,10 @@
 
 #include "Hamiltonian.h"
 
+#ifdef CHEMPS2_MPI_COMPILATION
+   #include <mpi.h>
+#endif
+
 namespace CheMPS2{
 /** Problem class.
     \author Sebastian Wouters <sebastianwouters@gmail.com>
@@ -83,7 +87,7 @@ namespace CheMPS2{
              \return \f$ h_{\alpha \beta ; \gamma \delta} = \left(\alpha \beta \mid V \mid \gamma \delta \right) + \frac{1}{N-1} \left( \left( \alpha \mid T \mid \gamma \right) \delta_{\beta \delta} + \delta_{\alpha \gamma} \left( \beta \mid T \mid \delta \right) \right) \f$ */
          double gMxElement(const int alpha, const int beta, const int gamma, const int delta) const;
          
-         //! Set the matrix elements: Note that each time you create a DMRG object, they will be overwritten with the eightfold permutation symmetric Hamiltonian again!!!
+         //! Set the matrix elements: Note that each time you create a DMRG object, they will be overwritten with the eightfold permutation symmetric Hamiltonian again!!! With MPI, only the first process on each node writes to the node-shared table; all processes should call this function with the same values.
          /** \param alpha The first index (0 <= alpha < L)
              \param beta The second index
              \param gamma The third index
@@ -91,9 +95,12 @@ namespace CheMPS2{
              \param value The value to set the matrix element to */
          void setMxElement(const int alpha, const int beta, const int gamma, const int delta, const double value);
          
-         //! Construct a table with the h-matrix elements (two-body augmented with one-body). Remember to recall this function each time you change the Hamiltonian!
+         //! Construct a table with the h-matrix elements (two-body augmented with one-body). Remember to recall this function each time you change the Hamiltonian! With MPI, the table is shared by all processes on the same node, and this is a collective call.
          void construct_mxelem();
          
+         //! With MPI, make the changes from setMxElement visible to all processes on the same node. Collective call, which is performed in DMRG::PreSolve(). Without MPI, nothing happens.
+         void sync_mxelem();
+         
          //! Check whether the given parameters L, N, and TwoS are not inconsistent and whether 0<=Irrep<nIrreps. A more thorough test will be done when the FCI virtual dimensions are constructed.
          /** \return True if consistent, else false */
          bool checkConsistency() const;
@@ -156,6 +163,12 @@ namespace CheMPS2{
          //Matrix element table
          double * mx_elem;
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //The node-shared memory window and the node communicator which own mx_elem
+         MPI_Win  mx_elem_window;
+         MPI_Comm mx_elem_node_comm;
+         #endif
+         
    };
 }
 
@@ -0,0 +1,127 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2016 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef RDMREQUEST_CHEMPS2_H
+#define RDMREQUEST_CHEMPS2_H
+
+#include "Options.h"
+
+namespace CheMPS2{
+/** RDMrequest class.
+
+    The RDMrequest class describes which reduced density matrices DMRG::calc_rdms_and_correlations should compute:\n
+    (1) the spin-summed 2-RDM, from which the 1-RDM, the energy, and the NOON follow, is always computed\n
+    (2) the Correlations (spin, density, spin-flip, and singlet diradical correlation functions, and the two-orbital mutual information) can be switched off\n
+    (3) the 3-RDM can be switched on, optionally for a subset of the orbitals only, and optionally distributed over the MPI processes\n
+    \n
+    The renormalized operators which are not needed for the requested quantities are never allocated or updated. When an orbital subset is specified, only the 3-RDM elements \f$ \Gamma_{ijk;lmn} \f$ of which all six orbitals belong to the subset are computed; the other elements are zero. The orbitals are specified in the Hamiltonian index order. */
+   class RDMrequest{
+
+      public:
+
+         //! Constructor: 2-RDM and Correlations, no 3-RDM, all orbitals
+         /** \param L the number of orbitals */
+         RDMrequest(const int L);
+
+         //! Copy constructor
+         /** \param tocopy The RDMrequest to be copied */
+         RDMrequest(const RDMrequest & tocopy);
+
+         //! Assignment operator
+         /** \param tocopy The RDMrequest to be copied
+             \return this RDMrequest */
+         RDMrequest & operator=(const RDMrequest & tocopy);
+
+         //! Destructor
+         virtual ~RDMrequest();
+
+         //! Get the number of orbitals
+         /** \return the number of orbitals */
+         int gL() const;
+
+         //! Set whether the 3-RDM should be computed
+         /** \param do_3rdm Whether or not to calculate the 3-RDM
+             \param disk_3rdm Whether or not to keep the 3-RDM in a memory-mapped file in the tmp folder */
+         void set_3rdm(const bool do_3rdm, const bool disk_3rdm=CheMPS2::THREE_RDM_storeOnDisk);
+
+         //! Get whether the 3-RDM should be computed
+         /** \return whether the 3-RDM should be computed */
+         bool get_3rdm() const;
+
+         //! Get whether the 3-RDM should be kept in a memory-mapped file
+         /** \return whether the 3-RDM should be kept in a memory-mapped file in the tmp folder */
+         bool get_3rdm_disk() const;
+
+         //! Set whether the 3-RDM should be distributed over the MPI processes (no effect without MPI). DMRG::Symm4RDM_fock, ThreeDM::fill_ham_block, ThreeDM::trace and ThreeDM::save work with distributed storage; the element getters then only see the own slab.
+         /** \param distributed_3rdm Whether each MPI process should only keep its own slab of the 3-RDM (see ThreeDM::mpi_distribute) instead of a full copy */
+         void set_3rdm_distributed(const bool distributed_3rdm);
+
+         //! Get whether the 3-RDM should be distributed over the MPI processes
+         /** \return whether each MPI process should only keep its own slab of the 3-RDM */
+         bool get_3rdm_distributed() const;
+
+         //! Set whether the Correlations should be computed
+         /** \param do_correlations Whether or not to calculate the Correlations */
+         void set_correlations(const bool do_correlations);
+
+         //! Get whether the Correlations should be computed
+         /** \return whether the Correlations should be computed */
+         bool get_correlations() const;
+
+         //! Include or exclude an orbital from the subset for which the 3-RDM is computed
+         /** \param ham_orb the orbital in the Hamiltonian index order
+             \param include whether or not the orbital belongs to the subset */
+         void set_orbital(const int ham_orb, const bool include);
+
+         //! Get whether an orbital belongs to the subset for which the 3-RDM is computed
+         /** \param ham_orb the orbital in the Hamiltonian index order
+             \return whether the orbital belongs to the subset */
+         bool get_orbital(const int ham_orb) const;
+
+         //! Get whether all orbitals belong to the subset for which the 3-RDM is computed
+         /** \return whether all orbitals belong to the subset */
+         bool all_orbitals() const;
+
+      private:
+
+         //The number of orbitals
+         int L;
+
+         //Whether the 3-RDM is computed
+         bool do_3rdm;
+
+         //Whether the 3-RDM is kept in a memory-mapped file
+         bool disk_3rdm;
+
+         //Whether the 3-RDM is distributed over the MPI processes
+         bool distributed_3rdm;
+
+         //Whether the Correlations are computed
+         bool do_correlations;
+
+         //Whether an orbital (Hamiltonian index order) belongs to the subset for the 3-RDM
+         bool * orbitals;
+
+         //Copy all settings except the number of orbitals, which should already agree
+         void copy_settings(const RDMrequest & tocopy);
+
+   };
+}
+
+#endif
@@ -0,0 +1,226 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2016 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SELECTEDCI_CHEMPS2_H
+#define SELECTEDCI_CHEMPS2_H
+
+#include "Hamiltonian.h"
+#include "Options.h"
+
+namespace CheMPS2{
+/** SelectedCI class.
+
+    The SelectedCI class performs a heat-bath selected configuration interaction (HCI) calculation in a given particle number, irrep, and spin projection sector of a given Hamiltonian. Information can be found in \n
+
+     [1] A.A. Holmes, N.M. Tubman and C.J. Umrigar, J. Chem. Theory Comput. 12, 3674-3680 (2016). http://dx.doi.org/10.1021/acs.jctc.6b00407 \n
+
+    Starting from the Slater determinant with the lowest diagonal energy, the variational space is repeatedly extended with the determinants \f$ a \f$ for which \f$ | H_{ai} c_i | > \epsilon_1 \f$ for at least one selected determinant \f$ i \f$. The double excitations are screened with lists of the two-electron integrals per pair of occupied orbitals, sorted by magnitude, so that only the connections above the threshold are generated. After each extension, the Hamiltonian in the selected space is stored in compressed sparse row format and diagonalized with Davidson's algorithm. The Epstein-Nesbet second order energy correction \f$ \sum_a ( \sum_i H_{ai} c_i )^2 / ( E_0 - H_{aa} ) \f$ can be added, with the terms screened by \f$ | H_{ai} c_i | > \epsilon_2 \f$. \n
+    \n
+    The Slater determinants are stored as a pair of 64-bit masks (up and down electrons), so that the number of orbitals is limited to 64. The selection, the construction of the sparse Hamiltonian, and its matrix vector product use OpenMP.
+*/
+   class SelectedCI{
+
+      public:
+
+         //! Constructor
+         /** \param Ham The Hamiltonian matrix elements
+             \param Nel_up The number of up (alpha) electrons
+             \param Nel_down The number of down (beta) electrons
+             \param TargetIrrep The targeted point group irrep
+             \param SCIverbose The verbose level: 0 print nothing, 1 print start and final info, 2 print per iteration info */
+         SelectedCI(CheMPS2::Hamiltonian * Ham, const unsigned int Nel_up, const unsigned int Nel_down, const int TargetIrrep, const int SCIverbose=2);
+
+         //! Destructor
+         virtual ~SelectedCI();
+
+         //! Get the number of orbitals
+         /** \return The number of orbitals */
+         int getL() const{ return L; }
+
+         //! Get the number of up (alpha) electrons
+         /** \return The number of up (alpha) electrons */
+         unsigned int getNel_up() const{ return Nel_up; }
+
+         //! Get the number of down (beta) electrons
+         /** \return The number of down (beta) electrons */
+         unsigned int getNel_down() const{ return Nel_down; }
+
+         //! Get the targeted irrep
+         /** \return The targeted irrep */
+         int getTargetIrrep() const{ return TargetIrrep; }
+
+         //! Perform the heat-bath selection and diagonalize the Hamiltonian in the selected space
+         /** \param epsilon The threshold \f$ \epsilon_1 \f$ for the selection of new determinants
+             \param max_iter The maximum number of selection iterations
+             \return The variational energy in the selected space */
+         double Solve(const double epsilon=CheMPS2::SCI_EPSILON_VAR, const int max_iter=CheMPS2::SCI_MAX_ITER);
+
+         //! Calculate the Epstein-Nesbet second order energy correction to the variational wavefunction from Solve
+         /** \param epsilon The threshold \f$ \epsilon_2 \f$ for the terms \f$ H_{ai} c_i \f$
+             \return The second order energy correction */
+         double EpsteinNesbetPT2(const double epsilon=CheMPS2::SCI_EPSILON_PT2) const;
+
+         //! Get the variational energy from Solve
+         /** \return The variational energy */
+         double getEnergy() const{ return Energy; }
+
+         //! Get the number of selected Slater determinants
+         /** \return The number of selected Slater determinants */
+         int getNumDeterminants() const{ return num_det; }
+
+         //! Get a selected Slater determinant
+         /** \param index The index of the determinant (0 <= index < getNumDeterminants())
+             \param bits_up Array of length L to store the occupation numbers of the up (alpha) orbitals in
+             \param bits_down Array of length L to store the occupation numbers of the down (beta) orbitals in */
+         void getDeterminant(const int index, int * bits_up, int * bits_down) const;
+
+         //! Get the coefficient of a selected Slater determinant in the variational wavefunction
+         /** \param index The index of the determinant (0 <= index < getNumDeterminants())
+             \return The coefficient */
+         double getCoefficient(const int index) const{ return coef[ index ]; }
+
+         //! Get the coefficient of a Slater determinant in the variational wavefunction; in the same convention as FCI::getFCIcoeff
+         /** \param bits_up Array of length L with the occupation numbers of the up (alpha) orbitals
+             \param bits_down Array of length L with the occupation numbers of the down (beta) orbitals
+             \return The coefficient (zero for determinants which are not selected) */
+         double getSCIcoeff(int * bits_up, int * bits_down) const;
+
+         //! Get the Hamiltonian matrix element between two Slater determinants, without the nuclear repulsion energy
+         /** \param bits_bra_up Array of length L with the occupation numbers of the up (alpha) orbitals of the bra
+             \param bits_bra_down Array of length L with the occupation numbers of the down (beta) orbitals of the bra
+             \param bits_ket_up Array of length L with the occupation numbers of the up (alpha) orbitals of the ket
+             \param bits_ket_down Array of length L with the occupation numbers of the down (beta) orbitals of the ket
+             \return The Hamiltonian matrix element */
+         double GetMatrixElement(int * bits_bra_up, int * bits_bra_down, int * bits_ket_up, int * bits_ket_down) const;
+
+      private:
+
+         // A determinant with a value, for the growable lists of the selection and the perturbation theory
+         struct Entry{
+            unsigned long long up;
+            unsigned long long down;
+            double value;
+         };
+
+         // Comparison of entries by ( up, down )
+         static bool EntryLess(const Entry & first, const Entry & second);
+
+         // A virtual orbital pair r + L * s with the magnitude of its two-electron integral, for the heat-bath lists
+         struct HeatBath{
+            double value;
+            int rs;
+         };
+
+         // Comparison of heat-bath entries by decreasing value
+         static bool HeatBathGreater(const HeatBath & first, const HeatBath & second);
+
+         // Append an entry to a growable list
+         static void AddEntry(Entry ** list, long long * num, long long * size, const unsigned long long up, const unsigned long long down, const double value);
+
+         // Sort a list by ( up, down ) and merge the entries of the same determinant by adding their values; returns the new number of entries
+         static long long SortAndMerge(Entry * list, const long long num);
+
+         // The number of orbitals
+         int L;
+
+         // The number of up (alpha) and down (beta) electrons
+         unsigned int Nel_up;
+         unsigned int Nel_down;
+
+         // The targeted irrep and the orbital irreps
+         int TargetIrrep;
+         int num_irreps;
+         int * orb2irrep;
+
+         // The verbose level
+         int SCIverbose;
+
+         // The nuclear repulsion energy, the one-electron integrals Tmat[ i + L * j ], and the electron repulsion integrals ERI[ i + L * ( j + L * ( k + L * l ) ) ] = ( ij | kl ) in chemists' notation
+         double Econstant;
+         double * Tmat;
+         double * ERI;
+
+         // Heat-bath lists: for the occupied pair ( p < q ) of equal spin, the entries hb_same_start[ p + L * q ] <= k < hb_same_start[ p + L * q + 1 ] of hb_same contain the virtual pairs ( r < s ) with value | ( pr | qs ) - ( ps | qr ) |, in decreasing order
+         long long * hb_same_start;
+         HeatBath * hb_same;
+
+         // Heat-bath lists: for the occupied pair ( p up, q down ), the entries hb_opp_start[ p + L * q ] <= k < hb_opp_start[ p + L * q + 1 ] of hb_opp contain the virtual pairs ( r up, s down ) with value | ( pr | qs ) |, in decreasing order
+         long long * hb_opp_start;
+         HeatBath * hb_opp;
+
+         // The selected determinants, in increasing order of ( det_up, det_down ), and their coefficients
+         int num_det;
+         unsigned long long * det_up;
+         unsigned long long * det_down;
+         double * coef;
+         double Energy;
+
+         // The Hamiltonian in the selected space: diagonal elements and the off-diagonal elements in compressed sparse row format
+         double * ham_diag;
+         long long * ham_row;
+         int * ham_col;
+         double * ham_val;
+
+         // Set up the heat-bath lists
+         void StartupHeatBath();
+
+         // Find the determinant with the lowest diagonal energy from the aufbau determinant and its single excitations
+         void StartupReference();
+
+         // Conversions between the bit masks and int arrays
+         unsigned long long bits2mask(int * bits) const;
+         void mask2bits(const unsigned long long mask, int * bits) const;
+
+         // Index of a determinant in the selected space, or -1 if it is not selected
+         int FindDeterminant(const unsigned long long up, const unsigned long long down) const;
+
+         // Diagonal Hamiltonian element of a determinant, without Econstant
+         double DiagonalElement(const unsigned long long up, const unsigned long long down) const;
+
+         // Slater-Condon rules with bit masks: the Hamiltonian element between two determinants, without Econstant
+         double MatrixElement(const unsigned long long bra_up, const unsigned long long bra_down, const unsigned long long ket_up, const unsigned long long ket_down) const;
+
+         // Hamiltonian element of a single excitation p -> r in the string ket_same (other string ket_other)
+         double SingleExcitation(const unsigned long long ket_same, const unsigned long long ket_other, const int p, const int r) const;
+
+         // Generate the connections a of determinant ( up, down ) with | H_ai value | > epsilon; when only_new, the selected determinants are skipped
+         void Connections(const unsigned long long up, const unsigned long long down, const double value, const double epsilon, const bool only_new, Entry ** list, long long * num, long long * size) const;
+
+         // Build the Hamiltonian in the selected space
+         void BuildHamiltonian();
+
+         // The columns of the off-diagonal Hamiltonian elements of row, found with the determinants ordered by down string (by_down) and the up strings with one electron removed (buckets); cols is only filled if it is not NULL; returns the number of columns
+         int ConnectRow(const int row, const Entry * by_down, const Entry * buckets, const long long num_buckets, int * cols) const;
+
+         // Diagonalize the Hamiltonian in the selected space with Davidson's algorithm; returns the lowest eigenvalue without Econstant
+         double Diagonalize();
+
+         // Sparse matrix vector product with the Hamiltonian in the selected space
+         void matvec(double * input, double * output) const;
+
+         // Extend the selected space; returns the number of added determinants
+         int Extend(const double epsilon);
+
+         // Clear the Hamiltonian in the selected space
+         void ClearHamiltonian();
+
+   };
+}
+
+#endif
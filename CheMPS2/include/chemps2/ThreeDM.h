@@ -28,6 +28,7 @@
 #include "TensorS1.h"
 #include "Tensor3RDM.h"
 #include "SyBookkeeper.h"
+#include "Options.h"
 
 namespace CheMPS2{
 /** ThreeDM class.
@@ -36,7 +37,9 @@ namespace CheMPS2{
     
     The ThreeDM class stores the spin-summed three-particle reduced density matrix (3-RDM) of a converged DMRG calculation: \n
     \f$ \Gamma_{ijk;lmn} = \sum_{\sigma \tau s} \braket{ a^{\dagger}_{i \sigma} a^{\dagger}_{j \tau} a^{\dagger}_{k s} a_{n s} a_{m \tau} a_{l \sigma}} \f$\n
-    Because the wave-function belongs to a certain Abelian irrep, \f$ I_{i} \otimes I_{j} \otimes I_{k} = I_{l} \otimes I_{m} \otimes I_{n} \f$ must be valid before the corresponding element \f$ \Gamma_{ijk;lmn} \f$ is non-zero.
+    Because the wave-function belongs to a certain Abelian irrep, \f$ I_{i} \otimes I_{j} \otimes I_{k} = I_{l} \otimes I_{m} \otimes I_{n} \f$ must be valid before the corresponding element \f$ \Gamma_{ijk;lmn} \f$ is non-zero.\n
+    \n
+    Only the symmetry-allowed elements which are unique under the simultaneous permutation of the index pairs \f$ (il), (jm), (kn) \f$ are stored. The pairs are grouped per irrep \f$ I_{i} \otimes I_{l} \f$, and the sorted pair triples are packed irrep block by irrep block with 64-bit offsets. This requires roughly \f$ L^6 / ( 6 N_{irreps}^2 ) \f$ doubles instead of \f$ L^6 \f$.
 */
    class ThreeDM{
 
@@ -44,13 +47,15 @@ namespace CheMPS2{
       
          //! Constructor
          /** \param book_in Symmetry sector bookkeeper
-             \param prob_in The problem to be solved */
-         ThreeDM(const SyBookkeeper * book_in, const Problem * prob_in);
+             \param prob_in The problem to be solved
+             \param disk_in Whether to keep the 3-RDM elements in a memory-mapped file instead of in memory; the operating system then pages them in and out
+             \param tmpfolder The folder in which the memory-mapped file is created (only used when disk_in == true) */
+         ThreeDM(const SyBookkeeper * book_in, const Problem * prob_in, const bool disk_in=CheMPS2::THREE_RDM_storeOnDisk, const string tmpfolder=CheMPS2::defaultTMPpath);
          
          //! Destructor
          virtual ~ThreeDM();
          
-         //! Get a 3-RDM term, using the DMRG indices
+         //! Get a 3-RDM term, using the DMRG indices. With distributed storage, only the elements in the slab of this MPI process are available.
          /** \param cnt1 the first index
              \param cnt2 the second index
              \param cnt3 the third index
@@ -60,7 +65,7 @@ namespace CheMPS2{
              \return the desired value */
          double get_dmrg_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const;
          
-         //! Get a 3-RDM, using the HAM indices
+         //! Get a 3-RDM, using the HAM indices. With distributed storage, only the elements in the slab of this MPI process are available.
          /** \param cnt1 the first index
              \param cnt2 the second index
              \param cnt3 the third index
@@ -70,6 +75,22 @@ namespace CheMPS2{
              \return the desired value */
          double get_ham_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const;
          
+         //! Get the part of a 3-RDM term in the slab of this MPI process, using the HAM indices. Summed over the MPI processes, these parts give the 3-RDM term. Without distributed storage, this is get_ham_index.
+         /** \param cnt1 the first index
+             \param cnt2 the second index
+             \param cnt3 the third index
+             \param cnt4 the fourth index
+             \param cnt5 the fifth index
+             \param cnt6 the sixth index
+             \return the desired value, or zero when it is not in the slab of this process */
+         double get_slab_ham_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const;
+         
+         //! Copy a block of the 3-RDM, using the HAM indices: output[ i + L * ( j + L * ( k + L * ( l + L * ( m + L * ( n - n_start ) ) ) ) ) ] for n_start <= n < n_start + n_num. With distributed storage, all MPI processes should call this function, and each receives the whole block.
+         /** \param output Array of size L^5 * n_num to which the block is copied
+             \param n_start The first sixth HAM index of the block
+             \param n_num The number of sixth HAM indices in the block */
+         void fill_ham_block(double * output, const int n_start, const int n_num) const;
+         
          //! Fill the 3-RDM terms corresponding to site denT->gIndex()
          /** \param denT DMRG site-matrices
              \param Ltens Ltensors
@@ -98,19 +119,42 @@ namespace CheMPS2{
          //! After the whole 3-RDM is filled, a prefactor for higher multiplicities should be applied
          void correct_higher_multiplicities();
              
-         //! Return the trace (should be N(N-1)(N-2))
+         //! Return the trace (should be N(N-1)(N-2)). With distributed storage, all MPI processes should call this function.
          /** \return Trace of the 3-RDM */
          double trace() const;
          
-         //! Save the 3-RDM to disk
+         //! Save the 3-RDM to disk. With distributed storage, all MPI processes should call this function, and they write their slabs in turn.
          void save() const;
          
-         //! Load the 3-RDM from disk
+         //! Load the 3-RDM from disk. With distributed storage, each MPI process reads its own slab.
          void read();
          
          //! Add the 3-RDM elements of all MPI processes
          void mpi_allreduce();
          
+         //! Switch to distributed storage: each MPI process keeps only its own slab of the packed 3-RDM elements, and the rest of the array is released
+         /** \param reduce Whether the partial 3-RDMs of the MPI processes should be added into the slabs (each slab is reduced straight to its owner), or whether they are already equal */
+         void mpi_distribute(const bool reduce);
+         
+         //! Get whether the 3-RDM elements are distributed over the MPI processes
+         /** \return Whether each MPI process only keeps its own slab */
+         bool is_distributed() const{ return distributed; }
+         
+         //! Allocate an array of doubles in a memory-mapped file in a folder; the file is unlinked right away and the array reads as zero. Prints an error and aborts when the file cannot be created or mapped.
+         /** \param num The number of doubles
+             \param tmpfolder The folder in which the file is created
+             \return Pointer to the mapped array, to be released with free_mapped_array */
+         static double * allocate_mapped_array(const long long num, const string tmpfolder);
+         
+         //! Release an array from allocate_mapped_array
+         /** \param array The mapped array
+             \param num The number of doubles */
+         static void free_mapped_array(double * array, const long long num);
+         
+         //! Restrict fill_site to the elements of which all six orbitals belong to a subset; the other elements remain zero
+         /** \param dmrg_mask Array of length L with dmrg_mask[ orb ] == true when DMRG orbital orb belongs to the subset, or NULL for all orbitals */
+         void set_orbital_subset(const bool * dmrg_mask);
+         
       private:
       
          //The BK containing all the irrep information
@@ -122,10 +166,55 @@ namespace CheMPS2{
          //The DMRG chain length
          int L;
          
-         //The 3-RDM elements (L*L*L*L*L*L array of doubles)
+         //The number of irreps
+         int num_irreps;
+         
+         //The packed position of the pair ( orb1, orb2 ) is pair_rank[ orb1 + L * orb2 ]; the pairs are ordered per irrep
+         int * pair_rank;
+         
+         //The irrep of the pair with packed position rank is pair_irrep[ rank ]
+         int * pair_irrep;
+         
+         //The pairs with irrep g have packed positions irrep_start[ g ] <= rank < irrep_start[ g + 1 ]
+         int * irrep_start;
+         
+         //The offset of the block with sorted pair irreps ( g1, g2, g1 x g2 ) is block_offset[ g1 + num_irreps * g2 ]
+         long long * block_offset;
+         
+         //The number of stored 3-RDM elements
+         long long size;
+         
+         //The 3-RDM elements (packed array of size doubles)
          double * elements;
          
-         //Set all twelve-fold permutation symmetric 3-RDM elements, using the DMRG indices.
+         //Whether the elements are memory-mapped from a file
+         bool disk;
+         
+         //Whether each MPI process only keeps the slab slab_start <= packed position < slab_start + slab_size
+         bool distributed;
+         
+         //The first packed position kept by this process (0 when not distributed)
+         long long slab_start;
+         
+         //The number of packed positions kept by this process (size when not distributed)
+         long long slab_size;
+         
+         //Write the slab of this process to the 3-RDM file; create the file when create == true
+         void save_slab(const bool create) const;
+         
+         //Get a 3-RDM term, using the DMRG indices; zero when it is not in the slab of this process
+         double get_slab_dmrg_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const;
+         
+         //The DMRG orbitals for which fill_site computes elements (NULL means all orbitals)
+         bool * subset;
+         
+         //Whether the orbitals orb1, orb2, and orb3 all belong to the subset
+         bool requested(const int orb1, const int orb2, const int orb3) const{ return (( subset == NULL ) || (( subset[ orb1 ] ) && ( subset[ orb2 ] ) && ( subset[ orb3 ] ))); }
+         
+         //Get the packed position of a symmetry-allowed 3-RDM element, using the DMRG indices
+         long long pack_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6) const;
+         
+         //Set a 3-RDM element and its hermitian conjugate in the packed storage, using the DMRG indices; the six simultaneous pair permutations share one packed element
          void set_dmrg_index(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const int cnt5, const int cnt6, const double value);
          
          //Partitioning 2-4-0
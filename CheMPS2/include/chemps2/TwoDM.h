@@ -124,6 +124,15 @@ namespace CheMPS2{
              \param S1tens S1tensors*/
          void FillSite(TensorT * denT, TensorL *** Ltens, TensorF0 **** F0tens, TensorF1 **** F1tens, TensorS0 **** S0tens, TensorS1 **** S1tens);
          
+         //! Fill the two-orbital 2DM terms between the site denT->gIndex() and the sites to its right, without the full 2DM
+         /** \param denBK Symmetry sector bookkeeper
+             \param denT DMRG site-matrices (orthogonality center)
+             \param F0diag F0tensors[ denT->gIndex() ][ 0 ], moving left, for the sites j > denT->gIndex()
+             \param F1diag F1tensors[ denT->gIndex() ][ 0 ], moving left, for the sites j > denT->gIndex()
+             \param S0diag S0tensors[ denT->gIndex() ][ 0 ], moving left, for the sites j > denT->gIndex()
+             \param pairs Array of size 5 * L * L, with DMRG indices pairs[ i + L * ( j + L * type ) ] = 2DM-A_{ij;ij}, 2DM-B_{ij;ij}, 2DM-A_{ij;ji}, 2DM-B_{ij;ji}, and 2DM-A_{ii;jj} for type = 0, 1, 2, 3, and 4. The prefactor for higher multiplicities is not applied. */
+         static void FillSitePairs(const SyBookkeeper * denBK, TensorT * denT, TensorF0 ** F0diag, TensorF1 ** F1diag, TensorS0 ** S0diag, double * pairs);
+         
          //! After the whole 2-RDM is filled, a prefactor for higher multiplicities should be applied
          void correct_higher_multiplicities();
              
@@ -171,12 +180,12 @@ namespace CheMPS2{
          void set_2rdm_B_DMRG(const int cnt1, const int cnt2, const int cnt3, const int cnt4, const double value);
          
          //Helper functions
-         double doD1(TensorT * denT);
+         static double doD1(const SyBookkeeper * denBK, TensorT * denT);
          double doD2(TensorT * denT, TensorL * Lright, double * workmem);
-         double doD3(TensorT * denT, TensorS0 * S0right, double * workmem);
-         double doD4(TensorT * denT, TensorF0 * F0right, double * workmem);
-         double doD5(TensorT * denT, TensorF0 * F0right, double * workmem);
-         double doD6(TensorT * denT, TensorF1 * F1right, double * workmem);
+         static double doD3(const SyBookkeeper * denBK, TensorT * denT, TensorS0 * S0right, double * workmem);
+         static double doD4(const SyBookkeeper * denBK, TensorT * denT, TensorF0 * F0right, double * workmem);
+         static double doD5(const SyBookkeeper * denBK, TensorT * denT, TensorF0 * F0right, double * workmem);
+         static double doD6(const SyBookkeeper * denBK, TensorT * denT, TensorF1 * F1right, double * workmem);
          double doD7(TensorT * denT, TensorL * Lleft, double * workmem);
          double doD8(TensorT * denT, TensorL * Lleft, TensorL * Lright, double * workmem, double * workmem2, int Irrep_g);
          void doD9andD10andD11(TensorT * denT, TensorL * Lleft, TensorL * Lright, double * workmem, double * workmem2, double * d9, double * d10, double * d11, int Irrep_g);
@@ -32,6 +32,7 @@ cdef extern from "chemps2/DMRG.h" namespace "CheMPS2":
         void PreSolve()
         void calc2DMandCorrelations()
         void calc_rdms_and_correlations(const bool do_3rdm)
+        void calc_orbital_entropies()
         void Symm4RDM(double * output, const int ham_orb1, const int ham_orb2, const bool last_case)
         TwoRDM.TwoDM * get2DM()
         ThreeRDM.ThreeDM * get3DM()
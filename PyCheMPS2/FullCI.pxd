@@ -43,4 +43,8 @@ cdef extern from "chemps2/FCI.h" namespace "CheMPS2":
         void DensityResponseGF(const double, const double, const unsigned int, const unsigned int, const double, double *, double *, double *)
         void DensityResponseGF_forward(const double, const double, const unsigned int, const unsigned int, const double, double *, double *, double *, double *, double *, double *)
         void DensityResponseGF_backward(const double, const double, const unsigned int, const unsigned int, const double, double *, double *, double *, double *, double *, double *)
+        void RetardedGF_spectral(const double *, const unsigned int, const double, const unsigned int, const unsigned int, const bool, const double, double *, Ham.Hamiltonian *, double *, double *)
+        void GFmatrix_addition_spectral(const double *, const unsigned int, const double, const double, int *, const unsigned int, int *, const unsigned int, const bool, double *, Ham.Hamiltonian *, double *, double *)
+        void GFmatrix_removal_spectral(const double *, const unsigned int, const double, const double, int *, const unsigned int, int *, const unsigned int, const bool, double *, Ham.Hamiltonian *, double *, double *)
+        void DensityResponseGF_spectral(const double *, const unsigned int, const double, const unsigned int, const unsigned int, const double, double *, double *, double *)
 
@@ -142,6 +142,8 @@ cdef class PyDMRG:
         self.thisptr.calc2DMandCorrelations()
     def calc_rdms_and_correlations(self, bool do_3rdm):
         self.thisptr.calc_rdms_and_correlations( do_3rdm )
+    def calc_orbital_entropies(self):
+        self.thisptr.calc_orbital_entropies()
     def deleteStoredMPS(self):
         self.thisptr.deleteStoredMPS()
     def deleteStoredOperators(self):
@@ -382,5 +384,45 @@ cdef class PyFCI:
         assert Dens2RDM.flags['C_CONTIGUOUS']
         self.thisptr.DensityResponseGF_backward(omega, eta, orb_alpha, orb_beta, GSenergy, &GSvector[0], &RePart[0], &ImPart[0], &Re2RDM[0], &Im2RDM[0], &Dens2RDM[0])
         return (RePart[0], ImPart[0])
+    def RetardedGF_spectral(self, np.ndarray[double, ndim=1, mode="c"] omegas not None, double eta, int orb_alpha, int orb_beta, bool isUp, double GSenergy, np.ndarray[double, ndim=1, mode="c"] GSvector not None, PyHamiltonian Hami):
+        cdef np.ndarray[double, ndim=1, mode="c"] RePart = np.zeros([len(omegas)])
+        cdef np.ndarray[double, ndim=1, mode="c"] ImPart = np.zeros([len(omegas)])
+        assert   omegas.flags['C_CONTIGUOUS']
+        assert GSvector.flags['C_CONTIGUOUS']
+        assert   RePart.flags['C_CONTIGUOUS']
+        assert   ImPart.flags['C_CONTIGUOUS']
+        self.thisptr.RetardedGF_spectral(&omegas[0], len(omegas), eta, orb_alpha, orb_beta, isUp, GSenergy, &GSvector[0], Hami.thisptr, &RePart[0], &ImPart[0])
+        return ( RePart, ImPart )
+    def GFmatrix_add_spectral(self, np.ndarray[double, ndim=1, mode="c"] alphas not None, double beta, double eta, np.ndarray[int, ndim=1, mode="c"] orbsLeft not None, np.ndarray[int, ndim=1, mode="c"] orbsRight not None, bool isUp, np.ndarray[double, ndim=1, mode="c"] GSvector not None, PyHamiltonian Hami):
+        cdef np.ndarray[double, ndim=1, mode="c"] RePart = np.zeros([len(orbsLeft)*len(orbsRight)*len(alphas)])
+        cdef np.ndarray[double, ndim=1, mode="c"] ImPart = np.zeros([len(orbsLeft)*len(orbsRight)*len(alphas)])
+        assert    alphas.flags['C_CONTIGUOUS']
+        assert  GSvector.flags['C_CONTIGUOUS']
+        assert    RePart.flags['C_CONTIGUOUS']
+        assert    ImPart.flags['C_CONTIGUOUS']
+        assert  orbsLeft.flags['C_CONTIGUOUS']
+        assert orbsRight.flags['C_CONTIGUOUS']
+        self.thisptr.GFmatrix_addition_spectral(&alphas[0], len(alphas), beta, eta, &orbsLeft[0], len(orbsLeft), &orbsRight[0], len(orbsRight), isUp, &GSvector[0], Hami.thisptr, &RePart[0], &ImPart[0])
+        return ( RePart, ImPart )
+    def GFmatrix_rem_spectral(self, np.ndarray[double, ndim=1, mode="c"] alphas not None, double beta, double eta, np.ndarray[int, ndim=1, mode="c"] orbsLeft not None, np.ndarray[int, ndim=1, mode="c"] orbsRight not None, bool isUp, np.ndarray[double, ndim=1, mode="c"] GSvector not None, PyHamiltonian Hami):
+        cdef np.ndarray[double, ndim=1, mode="c"] RePart = np.zeros([len(orbsLeft)*len(orbsRight)*len(alphas)])
+        cdef np.ndarray[double, ndim=1, mode="c"] ImPart = np.zeros([len(orbsLeft)*len(orbsRight)*len(alphas)])
+        assert    alphas.flags['C_CONTIGUOUS']
+        assert  GSvector.flags['C_CONTIGUOUS']
+        assert    RePart.flags['C_CONTIGUOUS']
+        assert    ImPart.flags['C_CONTIGUOUS']
+        assert  orbsLeft.flags['C_CONTIGUOUS']
+        assert orbsRight.flags['C_CONTIGUOUS']
+        self.thisptr.GFmatrix_removal_spectral(&alphas[0], len(alphas), beta, eta, &orbsLeft[0], len(orbsLeft), &orbsRight[0], len(orbsRight), isUp, &GSvector[0], Hami.thisptr, &RePart[0], &ImPart[0])
+        return ( RePart, ImPart )
+    def DensityResponseGF_spectral(self, np.ndarray[double, ndim=1, mode="c"] omegas not None, double eta, int orb_alpha, int orb_beta, double GSenergy, np.ndarray[double, ndim=1, mode="c"] GSvector not None):
+        cdef np.ndarray[double, ndim=1, mode="c"] RePart = np.zeros([len(omegas)])
+        cdef np.ndarray[double, ndim=1, mode="c"] ImPart = np.zeros([len(omegas)])
+        assert   omegas.flags['C_CONTIGUOUS']
+        assert GSvector.flags['C_CONTIGUOUS']
+        assert   RePart.flags['C_CONTIGUOUS']
+        assert   ImPart.flags['C_CONTIGUOUS']
+        self.thisptr.DensityResponseGF_spectral(&omegas[0], len(omegas), eta, orb_alpha, orb_beta, GSenergy, &GSvector[0], &RePart[0], &ImPart[0])
+        return ( RePart, ImPart )
 
 